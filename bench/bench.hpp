@@ -0,0 +1,76 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace calc {
+namespace bench {
+
+/**
+ * @brief Тело бенчмарка: выполнить операцию iterations раз
+ */
+using BenchmarkFn = std::function<void(size_t iterations)>;
+
+struct Benchmark {
+    std::string name;
+    BenchmarkFn fn;
+};
+
+/**
+ * @brief Глобальный список бенчмарков (заполняется CALC_BENCHMARK)
+ */
+inline std::vector<Benchmark>& registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+struct Registrar {
+    Registrar(const char* name, BenchmarkFn fn) {
+        registry().push_back({name, std::move(fn)});
+    }
+};
+
+/**
+ * @brief Не даёт компилятору выбросить вычисление результата
+ *
+ * Пустая ассемблерная вставка «читает» значение и память, поэтому результат
+ * обязан быть вычислен к этой точке. Без GNU asm (MSVC) — volatile-чтение.
+ */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (std::is_scalar_v<T>) {
+        asm volatile("" : : "g"(value) : "memory");
+    } else {
+        asm volatile("" : : "m"(value) : "memory");
+    }
+#else
+    const volatile char* bytes = reinterpret_cast<const volatile char*>(&value);
+    static_cast<void>(*bytes);
+    _ReadWriteBarrier();
+#endif
+}
+
+} // namespace bench
+} // namespace calc
+
+#define CALC_BENCH_CONCAT_IMPL(a, b) a##b
+#define CALC_BENCH_CONCAT(a, b) CALC_BENCH_CONCAT_IMPL(a, b)
+
+/**
+ * @brief Регистрация бенчмарка:
+ *        CALC_BENCHMARK("group/name") { for (size_t i = 0; i < iterations; ++i) ...; }
+ */
+#define CALC_BENCHMARK(name)                                                        \
+    static void CALC_BENCH_CONCAT(calc_bench_fn_, __LINE__)(size_t iterations);     \
+    static ::calc::bench::Registrar CALC_BENCH_CONCAT(calc_bench_reg_, __LINE__)(   \
+        name, &CALC_BENCH_CONCAT(calc_bench_fn_, __LINE__));                        \
+    static void CALC_BENCH_CONCAT(calc_bench_fn_, __LINE__)(size_t iterations)
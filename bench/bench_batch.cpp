@@ -0,0 +1,81 @@
+#include "bench.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "program.hpp"
+#include "variables.hpp"
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Одна операция — одно значение кусочной формулы; данные блоками по BLOCK
+constexpr size_t BLOCK = 4096;
+
+// Ступенчатая комиссия: три ветви, условия перемешаны случайно
+const std::string TIERED =
+    "x < 100 ? x * 0.05 : (x < 1000 ? 5 + (x - 100) * 0.03 : 32 + (x - 1000) * 0.01)";
+
+// Дорогая ветвь, выбираемая примерно для половины значений
+const std::string EXPENSIVE = "x > 500 ? sin(x) * exp(x / 1000) + sqrt(x) * ln(x) : x";
+
+calc::Program compile(const std::string& expr) {
+    calc::Variables vars;
+    vars.bind("x");
+    calc::Lexer lexer(expr);
+    calc::Parser parser(lexer.tokenize(), &vars);
+    return calc::Program::compile(*parser.parse(), {"x"});
+}
+
+std::vector<double> amounts(bool sorted) {
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> dist(0.0, 2000.0);
+    std::vector<double> x(BLOCK);
+    for (auto& value : x) {
+        value = dist(rng);
+    }
+    if (sorted) {
+        std::sort(x.begin(), x.end());
+    }
+    return x;
+}
+
+const std::vector<double> MIXED = amounts(false);
+const std::vector<double> SORTED = amounts(true);
+
+void scalarLoop(const std::string& expr, const std::vector<double>& x, size_t iterations) {
+    calc::Program program = compile(expr);
+    calc::ProgramView view = program.view();
+    double value = 0.0;
+    const double* slots[] = {&value};
+    std::vector<double> y(BLOCK);
+    for (size_t done = 0; done < iterations; done += BLOCK) {
+        for (size_t i = 0; i < BLOCK; ++i) {
+            value = x[i];
+            y[i] = view.evaluate(slots);
+        }
+        calc::bench::doNotOptimize(y[0]);
+    }
+}
+
+void batchLoop(const std::string& expr, const std::vector<double>& x, size_t iterations) {
+    calc::Program program = compile(expr);
+    calc::ProgramView view = program.view();
+    const double* columns[] = {x.data()};
+    std::vector<double> y(BLOCK);
+    for (size_t done = 0; done < iterations; done += BLOCK) {
+        view.evaluateBatch(columns, BLOCK, y.data());
+        calc::bench::doNotOptimize(y[0]);
+    }
+}
+
+} // namespace
+
+CALC_BENCHMARK("batch/tiered/scalar_mixed") { scalarLoop(TIERED, MIXED, iterations); }
+CALC_BENCHMARK("batch/tiered/scalar_sorted") { scalarLoop(TIERED, SORTED, iterations); }
+CALC_BENCHMARK("batch/tiered/batch_mixed") { batchLoop(TIERED, MIXED, iterations); }
+CALC_BENCHMARK("batch/tiered/batch_sorted") { batchLoop(TIERED, SORTED, iterations); }
+CALC_BENCHMARK("batch/expensive/scalar_mixed") { scalarLoop(EXPENSIVE, MIXED, iterations); }
+CALC_BENCHMARK("batch/expensive/batch_mixed") { batchLoop(EXPENSIVE, MIXED, iterations); }
+CALC_BENCHMARK("batch/expensive/batch_sorted") { batchLoop(EXPENSIVE, SORTED, iterations); }
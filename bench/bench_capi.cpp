@@ -0,0 +1,106 @@
+#include "bench.hpp"
+#include "calc.h"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "program.hpp"
+#include "variables.hpp"
+#include <string>
+#include <vector>
+
+// Цена границы C API: те же вычисления через calc.h и напрямую через
+// ProgramView. Одна операция — одно значение (в пакетах — одна строка)
+
+namespace {
+
+const char* const EXPRESSION = "x * 2.5 + sqrt(y) - x / (y + 1)";
+const char* const NAMES[] = {"x", "y"};
+constexpr size_t ROWS = 1024;
+
+calc_expression* compiled() {
+    static calc_expression* handle = [] {
+        calc_expression* result = nullptr;
+        calc_compile(EXPRESSION, NAMES, 2, 0, &result);
+        return result;
+    }();
+    return handle;
+}
+
+const calc::Program& program() {
+    static const calc::Program instance = [] {
+        calc::Variables variables;
+        variables.bind("x");
+        variables.bind("y");
+        calc::Lexer lexer(EXPRESSION);
+        calc::Parser parser(lexer.tokenize(), &variables);
+        return calc::Program::compile(*parser.parse(), {"x", "y"});
+    }();
+    return instance;
+}
+
+struct Columns {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> results;
+
+    Columns() : x(ROWS), y(ROWS), results(ROWS) {
+        for (size_t i = 0; i < ROWS; ++i) {
+            x[i] = 0.5 + static_cast<double>(i);
+            y[i] = 1.0 + static_cast<double>(i % 100);
+        }
+    }
+};
+
+} // namespace
+
+CALC_BENCHMARK("capi/evaluate") {
+    calc_expression* handle = compiled();
+    double values[] = {1.5, 4.0};
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; ++i) {
+        double result = 0.0;
+        values[0] = static_cast<double>(i & 1023);
+        calc_evaluate(handle, values, &result);
+        sum += result;
+    }
+    calc::bench::doNotOptimize(sum);
+}
+
+CALC_BENCHMARK("capi/evaluate_direct") {
+    calc::ProgramView view = program().view();
+    double values[] = {1.5, 4.0};
+    const double* slots[] = {&values[0], &values[1]};
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; ++i) {
+        values[0] = static_cast<double>(i & 1023);
+        sum += view.evaluate(slots);
+    }
+    calc::bench::doNotOptimize(sum);
+}
+
+CALC_BENCHMARK("capi/batch") {
+    static Columns data;
+    calc_expression* handle = compiled();
+    const double* columns[] = {data.x.data(), data.y.data()};
+    for (size_t done = 0; done < iterations; done += ROWS) {
+        calc_evaluate_batch(handle, columns, ROWS, data.results.data(), nullptr);
+    }
+    calc::bench::doNotOptimize(data.results[0]);
+}
+
+CALC_BENCHMARK("capi/batch_direct") {
+    static Columns data;
+    calc::ProgramView view = program().view();
+    const double* columns[] = {data.x.data(), data.y.data()};
+    for (size_t done = 0; done < iterations; done += ROWS) {
+        view.evaluateBatch(columns, ROWS, data.results.data());
+    }
+    calc::bench::doNotOptimize(data.results[0]);
+}
+
+CALC_BENCHMARK("capi/compile_release") {
+    for (size_t i = 0; i < iterations; ++i) {
+        calc_expression* handle = nullptr;
+        calc_compile(EXPRESSION, NAMES, 2, 0, &handle);
+        calc_release(handle);
+    }
+}
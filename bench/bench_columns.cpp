@@ -0,0 +1,88 @@
+#include "bench.hpp"
+#include "column_file.hpp"
+#include "batch.hpp"
+#include "format.hpp"
+#include "variables.hpp"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Одна операция — одна строка; запуск по ROWS строк (как csv/*)
+constexpr size_t ROWS = 10000;
+
+// Те же заказы, что в bench_csv.cpp, в двоичных столбцах
+const calc::ColumnFile& orders() {
+    static std::vector<double> storage;
+    static const calc::ColumnFile file = [] {
+        std::vector<double> price(ROWS);
+        std::vector<int64_t> qty(ROWS);
+        std::vector<double> discount(ROWS);
+        for (size_t i = 0; i < ROWS; ++i) {
+            price[i] = 0.5 + static_cast<double>(i % 997) * 0.37;
+            qty[i] = static_cast<int64_t>(1 + i % 12);
+            discount[i] = static_cast<double>(i % 5) * 0.05;
+        }
+        std::FILE* f = std::tmpfile();
+        calc::ColumnWriter writer(f, {{"price", calc::column_format::ColumnType::Float64},
+                                      {"qty", calc::column_format::ColumnType::Int64},
+                                      {"discount", calc::column_format::ColumnType::Float64}}, ROWS);
+        writer.append(price.data(), ROWS);
+        writer.append(qty.data(), ROWS);
+        writer.append(discount.data(), ROWS);
+        writer.finish();
+        size_t size = static_cast<size_t>(std::ftell(f));
+        storage.resize(size / sizeof(double) + 1);
+        std::rewind(f);
+        std::fread(storage.data(), 1, size, f);
+        std::fclose(f);
+        return calc::ColumnFile(storage.data(), size);
+    }();
+    return file;
+}
+
+std::FILE* sink() {
+    static std::FILE* file = std::tmpfile();
+    std::rewind(file);
+    return file;
+}
+
+const char* const EXPRESSION = "price * qty * (1 - discount)";
+
+void binaryOut(size_t iterations) {
+    const calc::ColumnFile& input = orders();
+    for (size_t done = 0; done < iterations; done += ROWS) {
+        calc::ColumnWriter output(sink(), {{"result"}}, input.rows());
+        calc::ColumnStats stats = calc::evaluateColumns(input, EXPRESSION, calc::Variables(), calc::ColumnOptions(),
+            [&](uint64_t, const double* values, size_t count, const std::vector<calc::BatchError>&) {
+                output.append(values, count);
+            });
+        output.finish();
+        calc::bench::doNotOptimize(stats.rows);
+    }
+}
+
+void textOut(size_t iterations) {
+    const calc::ColumnFile& input = orders();
+    std::string text;
+    for (size_t done = 0; done < iterations; done += ROWS) {
+        calc::BufferedWriter output(sink());
+        calc::ColumnStats stats = calc::evaluateColumns(input, EXPRESSION, calc::Variables(), calc::ColumnOptions(),
+            [&](uint64_t, const double* values, size_t count, const std::vector<calc::BatchError>&) {
+                text.clear();
+                for (size_t k = 0; k < count; ++k) {
+                    calc::appendNumber(text, values[k]);
+                    text += '\n';
+                }
+                output.write(text);
+            });
+        output.flush();
+        calc::bench::doNotOptimize(stats.rows);
+    }
+}
+
+} // namespace
+
+CALC_BENCHMARK("columns/binary") { binaryOut(iterations); }
+CALC_BENCHMARK("columns/text_out") { textOut(iterations); }
@@ -0,0 +1,76 @@
+#include "bench.hpp"
+#include "radix.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Замеры движка систем счисления (src/radix.hpp), общего для CLI --convert
+// и NumberConverter программистского режима. Одна операция — одно число
+
+namespace {
+
+const std::vector<int64_t>& values() {
+    static const std::vector<int64_t> numbers = [] {
+        std::vector<int64_t> result;
+        uint64_t state = 1;
+        for (int i = 0; i < 256; ++i) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            // Числа разной длины: от одной цифры до полного 64-битного значения
+            result.push_back(static_cast<int64_t>(state >> (i % 64)));
+        }
+        return result;
+    }();
+    return numbers;
+}
+
+std::vector<std::string> texts(int radix) {
+    std::vector<std::string> result;
+    char buffer[calc::RADIX_BUFFER_SIZE];
+    for (int64_t value : values()) {
+        char* end = calc::formatInteger(buffer, buffer + sizeof(buffer), value, radix);
+        result.emplace_back(buffer, end);
+    }
+    return result;
+}
+
+void toText(int radix, size_t iterations) {
+    const std::vector<int64_t>& numbers = values();
+    char buffer[calc::RADIX_BUFFER_SIZE];
+    for (size_t i = 0; i < iterations; ++i) {
+        char* end = calc::formatInteger(buffer, buffer + sizeof(buffer), numbers[i % numbers.size()], radix);
+        calc::bench::doNotOptimize(end);
+    }
+}
+
+void fromText(int radix, size_t iterations) {
+    std::vector<std::string> numbers = texts(radix);
+    for (size_t i = 0; i < iterations; ++i) {
+        int64_t value = calc::parseInteger(numbers[i % numbers.size()], radix);
+        calc::bench::doNotOptimize(value);
+    }
+}
+
+// Строка --convert: разбор, запись и перевод строки
+void convert(int from, int to, size_t iterations) {
+    std::vector<std::string> numbers = texts(from);
+    std::string out;
+    for (size_t i = 0; i < iterations; ++i) {
+        if (out.size() > 64 * 1024) {
+            out.clear();
+        }
+        calc::convertLine(numbers[i % numbers.size()], from, to, out);
+    }
+    calc::bench::doNotOptimize(out.size());
+}
+
+} // namespace
+
+CALC_BENCHMARK("converter/to_bin") { toText(2, iterations); }
+CALC_BENCHMARK("converter/to_oct") { toText(8, iterations); }
+CALC_BENCHMARK("converter/to_dec") { toText(10, iterations); }
+CALC_BENCHMARK("converter/to_hex") { toText(16, iterations); }
+CALC_BENCHMARK("converter/from_bin") { fromText(2, iterations); }
+CALC_BENCHMARK("converter/from_dec") { fromText(10, iterations); }
+CALC_BENCHMARK("converter/from_hex") { fromText(16, iterations); }
+CALC_BENCHMARK("converter/line_hex_to_bin") { convert(16, 2, iterations); }
+CALC_BENCHMARK("converter/line_dec_to_hex") { convert(10, 16, iterations); }
@@ -0,0 +1,56 @@
+#include "bench.hpp"
+#include "corpus.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "error.hpp"
+#include <string>
+#include <vector>
+
+// Сквозные замеры: разбор и вычисление выражений сгенерированных корпусов,
+// как в пакетном режиме. Одна операция — одно выражение
+
+namespace {
+
+void runCorpus(const std::vector<std::string>& corpus, size_t iterations) {
+    size_t errors = 0;
+    for (size_t i = 0; i < iterations; ++i) {
+        try {
+            calc::Lexer lexer(corpus[i % corpus.size()]);
+            calc::Parser parser(lexer.tokenize());
+            double result = parser.parse()->evaluate();
+            calc::bench::doNotOptimize(result);
+        } catch (const calc::ParseError&) {
+            ++errors;
+        } catch (const calc::EvalError&) {
+            ++errors;
+        }
+    }
+    calc::bench::doNotOptimize(errors);
+}
+
+} // namespace
+
+CALC_BENCHMARK("e2e/additive") {
+    static const std::vector<std::string> corpus = calc::bench::additiveChains(256, 200);
+    runCorpus(corpus, iterations);
+}
+
+CALC_BENCHMARK("e2e/deep_parens") {
+    static const std::vector<std::string> corpus = calc::bench::deepParentheses(256, 200);
+    runCorpus(corpus, iterations);
+}
+
+CALC_BENCHMARK("e2e/functions") {
+    static const std::vector<std::string> corpus = calc::bench::functionHeavy(256, 16);
+    runCorpus(corpus, iterations);
+}
+
+CALC_BENCHMARK("e2e/bitwise") {
+    static const std::vector<std::string> corpus = calc::bench::bitwiseExpressions(256, 16);
+    runCorpus(corpus, iterations);
+}
+
+CALC_BENCHMARK("e2e/malformed") {
+    static const std::vector<std::string> corpus = calc::bench::malformedInputs(256);
+    runCorpus(corpus, iterations);
+}
@@ -0,0 +1,49 @@
+#include "bench.hpp"
+#include "csv.hpp"
+#include "batch.hpp"
+#include "variables.hpp"
+#include <cstdio>
+#include <string>
+
+namespace {
+
+// Одна операция — одна строка CSV; запуск по ROWS строк
+constexpr size_t ROWS = 10000;
+
+// Заказы: текстовый столбец и три числовых
+std::FILE* orders() {
+    static std::FILE* file = [] {
+        std::FILE* f = std::tmpfile();
+        std::fputs("item,price,qty,discount\n", f);
+        for (size_t i = 0; i < ROWS; ++i) {
+            std::fprintf(f, "item%zu,%.2f,%zu,%.2f\n", i, 0.5 + static_cast<double>(i % 997) * 0.37,
+                         1 + i % 12, static_cast<double>(i % 5) * 0.05);
+        }
+        return f;
+    }();
+    std::rewind(file);
+    return file;
+}
+
+std::FILE* sink() {
+    static std::FILE* file = std::tmpfile();
+    std::rewind(file);
+    return file;
+}
+
+void csv(size_t iterations, size_t blockRows) {
+    calc::Variables vars;
+    calc::CsvOptions options;
+    options.blockRows = blockRows;
+    for (size_t done = 0; done < iterations; done += ROWS) {
+        calc::LineReader input(orders());
+        calc::BufferedWriter output(sink());
+        calc::CsvStats stats = calc::runCsv(input, output, "price * qty * (1 - discount)", vars, options);
+        calc::bench::doNotOptimize(stats.rows);
+    }
+}
+
+} // namespace
+
+CALC_BENCHMARK("csv/rows") { csv(iterations, 1); }
+CALC_BENCHMARK("csv/blocks") { csv(iterations, calc::CsvOptions().blockRows); }
@@ -0,0 +1,53 @@
+#include "bench.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "evaluator.hpp"
+#include <string>
+
+namespace {
+
+// Арифметически нагруженное выражение: length слагаемых вида (k*1.5 - k/3)
+std::string arithmeticChain(int length) {
+    std::string expr = "0";
+    for (int k = 1; k <= length; ++k) {
+        std::string n = std::to_string(k);
+        expr += " + (" + n + " * 1.5 - " + n + " / 3)";
+    }
+    return expr;
+}
+
+std::unique_ptr<calc::Node> parse(const std::string& expr) {
+    calc::Lexer lexer(expr);
+    calc::Parser parser(lexer.tokenize());
+    return parser.parse();
+}
+
+void evaluateRepeatedly(const std::string& expr, calc::EvalMode mode, size_t iterations) {
+    auto ast = parse(expr);
+    calc::Evaluator evaluator(mode);
+    for (size_t i = 0; i < iterations; ++i) {
+        double result = evaluator.evaluate(ast);
+        calc::bench::doNotOptimize(result);
+    }
+}
+
+const std::string ARITHMETIC = arithmeticChain(200);
+const std::string FUNCTIONS = "sin(0.5) * cos(0.25) + sqrt(2) * exp(1.5) - log(3) / tanh(0.7)";
+
+} // namespace
+
+CALC_BENCHMARK("evaluator/arithmetic/checked") {
+    evaluateRepeatedly(ARITHMETIC, calc::EvalMode::Checked, iterations);
+}
+
+CALC_BENCHMARK("evaluator/arithmetic/deferred") {
+    evaluateRepeatedly(ARITHMETIC, calc::EvalMode::Deferred, iterations);
+}
+
+CALC_BENCHMARK("evaluator/functions/checked") {
+    evaluateRepeatedly(FUNCTIONS, calc::EvalMode::Checked, iterations);
+}
+
+CALC_BENCHMARK("evaluator/functions/deferred") {
+    evaluateRepeatedly(FUNCTIONS, calc::EvalMode::Deferred, iterations);
+}
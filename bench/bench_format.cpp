@@ -0,0 +1,90 @@
+#include "bench.hpp"
+#include "format.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Одна операция — одно число; запуск по VALUES чисел
+constexpr size_t VALUES = 4096;
+
+// Результаты вычислений: целые, дроби с длинной записью, большие и малые порядки
+const std::vector<double>& values() {
+    static const std::vector<double> data = [] {
+        std::vector<double> v;
+        for (size_t i = 0; i < VALUES; ++i) {
+            double x = static_cast<double>(i) + 1.0;
+            switch (i % 4) {
+                case 0: v.push_back(x); break;
+                case 1: v.push_back(std::sqrt(x)); break;
+                case 2: v.push_back(std::exp(x / 64.0) * 1e12); break;
+                default: v.push_back(1.0 / (x * x * x)); break;
+            }
+        }
+        return v;
+    }();
+    return data;
+}
+
+// Как пакетный режим: числа с переводом строки в общий буфер вывода
+template <typename Format>
+void formatAll(size_t iterations, Format format) {
+    const std::vector<double>& data = values();
+    std::string out;
+    out.reserve(VALUES * 32);
+    for (size_t done = 0; done < iterations; done += VALUES) {
+        out.clear();
+        size_t count = std::min(VALUES, iterations - done);
+        for (size_t i = 0; i < count; ++i) {
+            format(out, data[i]);
+            out += '\n';
+        }
+        calc::bench::doNotOptimize(out.size());
+    }
+}
+
+void snprintfPrecise(std::string& out, double value) {
+    char buf[32];
+    int length = std::snprintf(buf, sizeof(buf), "%.17g", value);
+    out.append(buf, static_cast<size_t>(length));
+}
+
+void snprintfDefault(std::string& out, double value) {
+    char buf[32];
+    int length = std::snprintf(buf, sizeof(buf), "%g", value);
+    out.append(buf, static_cast<size_t>(length));
+}
+
+void ostream(std::string& out, double value) {
+    std::ostringstream stream;
+    stream << value;
+    out += stream.str();
+}
+
+void styled(std::string& out, double value, calc::NumberFormat style) {
+    calc::FormatOptions options;
+    options.style = style;
+    calc::appendNumber(out, value, options);
+}
+
+} // namespace
+
+CALC_BENCHMARK("format/ostream") { formatAll(iterations, ostream); }
+CALC_BENCHMARK("format/snprintf_g") { formatAll(iterations, snprintfDefault); }
+CALC_BENCHMARK("format/snprintf_17g") { formatAll(iterations, snprintfPrecise); }
+CALC_BENCHMARK("format/shortest") {
+    formatAll(iterations, [](std::string& out, double value) { calc::appendNumber(out, value); });
+}
+CALC_BENCHMARK("format/scientific") {
+    formatAll(iterations, [](std::string& out, double value) { styled(out, value, calc::NumberFormat::Scientific); });
+}
+CALC_BENCHMARK("format/engineering") {
+    formatAll(iterations, [](std::string& out, double value) { styled(out, value, calc::NumberFormat::Engineering); });
+}
+CALC_BENCHMARK("format/hex") {
+    formatAll(iterations, [](std::string& out, double value) { styled(out, value, calc::NumberFormat::Hex); });
+}
@@ -0,0 +1,72 @@
+#include "bench.hpp"
+#include "history.hpp"
+#include <filesystem>
+#include <string>
+
+// История вычислений: открытие и поиск не должны зависеть от её длины.
+// Одна операция — одно открытие, одна строка или один поиск. Первый замер
+// history/open_200k включает создание истории: запускайте с --repetitions 2
+
+namespace {
+
+constexpr size_t ENTRIES = 200000;
+
+std::string historyPath(const char* name) {
+    return (std::filesystem::temp_directory_path() / (std::string("calc_bench_") + name + ".log")).string();
+}
+
+void removeHistory(const std::string& path) {
+    for (const char* suffix : {"", ".idx", ".sorted", ".sorted.tmp"}) {
+        std::filesystem::remove(path + suffix);
+    }
+}
+
+// История из ENTRIES записей, созданная один раз за запуск
+const std::string& filledHistory() {
+    static const std::string path = [] {
+        std::string path = historyPath("history");
+        removeHistory(path);
+        calc::HistoryLog log(path);
+        for (size_t i = 0; i < ENTRIES; ++i) {
+            log.append("sqrt(" + std::to_string(i * 7919 % ENTRIES) + ") * 2", std::to_string(i));
+        }
+        return path;
+    }();
+    return path;
+}
+
+} // namespace
+
+CALC_BENCHMARK("history/append") {
+    std::string path = historyPath("append");
+    removeHistory(path);
+    {
+        calc::HistoryLog log(path);
+        for (size_t i = 0; i < iterations; ++i) {
+            log.append("1 + " + std::to_string(i), std::to_string(i + 1));
+        }
+    }
+    removeHistory(path);
+}
+
+CALC_BENCHMARK("history/open_200k") {
+    const std::string& path = filledHistory();
+    for (size_t i = 0; i < iterations; ++i) {
+        calc::HistoryLog log(path);
+        calc::bench::doNotOptimize(log.size());
+    }
+}
+
+CALC_BENCHMARK("history/row_200k") {
+    static calc::HistoryLog log(filledHistory());
+    for (size_t i = 0; i < iterations; ++i) {
+        calc::bench::doNotOptimize(log.at(i * 104729 % log.size()));
+    }
+}
+
+CALC_BENCHMARK("history/find_prefix_200k") {
+    static calc::HistoryLog log(filledHistory());
+    for (size_t i = 0; i < iterations; ++i) {
+        calc::bench::doNotOptimize(log.findPrefix("sqrt(" + std::to_string(i % 1000)).size());
+    }
+}
@@ -0,0 +1,36 @@
+#include "bench.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include <string>
+
+namespace {
+
+std::unique_ptr<calc::Node> parse(const std::string& expr) {
+    calc::Lexer lexer(expr);
+    calc::Parser parser(lexer.tokenize());
+    return parser.parse();
+}
+
+// Одна операция — одно вычисление подынтегральной функции
+void run(const std::string& expr, size_t iterations, size_t threads) {
+    auto ast = parse(expr);
+    const auto& node = static_cast<const calc::IntegralNode&>(*ast);
+    size_t done = 0;
+    while (done < iterations) {
+        calc::bench::doNotOptimize(calc::evaluateIntegral(node, threads));
+        done += node.report().evaluations;
+    }
+}
+
+// Излом и осцилляции: несколько тысяч подынтервалов
+const std::string WIGGLY = "integrate(abs(sin(40 * x)) * exp(-x / 3) + sqrt(abs(x - 1.7)), x, 0, 6, 1e-12)";
+
+// Вложенный integrate не компилируется: точки вычисляются по дереву
+const std::string TREE = "integrate(abs(sin(40 * x)) * exp(-x / 3) + sqrt(abs(x - 1.7)) + "
+                         "integrate(t, t, 0, 0), x, 0, 6, 1e-12)";
+
+} // namespace
+
+CALC_BENCHMARK("integral/tree") { run(TREE, iterations, 1); }
+CALC_BENCHMARK("integral/batch_1_thread") { run(WIGGLY, iterations, 1); }
+CALC_BENCHMARK("integral/batch_all_threads") { run(WIGGLY, iterations, 0); }
@@ -0,0 +1,91 @@
+#include "bench.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "program.hpp"
+#include "formula_library.hpp"
+#include "variables.hpp"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Операция — полный «запуск»: получить все формулы и вычислить каждую один раз
+constexpr int FORMULAS = 1000;
+
+std::string formulaText(int k) {
+    std::string n = std::to_string(k);
+    return "sin(x * " + n + ") + sqrt(x^2 + " + n + ") * 1.5 - log(x + " + n + ") / (3 + x)";
+}
+
+struct Corpus {
+    std::vector<std::string> names;
+    std::vector<std::string> texts;
+    std::string libraryPath;
+
+    Corpus() {
+        calc::Variables vars;
+        vars.bind("x");
+        calc::LibraryWriter writer;
+        for (int k = 0; k < FORMULAS; ++k) {
+            names.push_back("f" + std::to_string(k));
+            texts.push_back(formulaText(k));
+            calc::Lexer lexer(texts.back());
+            calc::Parser parser(lexer.tokenize(), &vars);
+            writer.add(names.back(), calc::Program::compile(*parser.parse(), {"x"}));
+        }
+        libraryPath = (std::filesystem::temp_directory_path() / "calc_bench_library.calclib").string();
+        writer.write(libraryPath);
+    }
+
+    ~Corpus() {
+        std::error_code ignored;
+        std::filesystem::remove(libraryPath, ignored);
+    }
+};
+
+const Corpus& corpus() {
+    static const Corpus instance;
+    return instance;
+}
+
+void startFromLibrary(bool verifyOnOpen, size_t iterations) {
+    const Corpus& data = corpus();
+    calc::LibraryOptions options;
+    options.verifyOnOpen = verifyOnOpen;
+    double x = 0.75;
+    const double* slots[] = {&x};
+    for (size_t i = 0; i < iterations; ++i) {
+        calc::FormulaLibrary library(data.libraryPath, options);
+        double sum = 0.0;
+        for (const auto& name : data.names) {
+            sum += library.find(name)->evaluate(slots);
+        }
+        calc::bench::doNotOptimize(sum);
+    }
+}
+
+} // namespace
+
+CALC_BENCHMARK("library/startup_1000/parse_text") {
+    const Corpus& data = corpus();
+    for (size_t i = 0; i < iterations; ++i) {
+        calc::Variables vars;
+        vars.set("x", 0.75);
+        double sum = 0.0;
+        for (const auto& text : data.texts) {
+            calc::Lexer lexer(text);
+            calc::Parser parser(lexer.tokenize(), &vars);
+            sum += parser.parse()->evaluate();
+        }
+        calc::bench::doNotOptimize(sum);
+    }
+}
+
+CALC_BENCHMARK("library/startup_1000/mmap_verified") {
+    startFromLibrary(true, iterations);
+}
+
+CALC_BENCHMARK("library/startup_1000/mmap_lazy") {
+    startFromLibrary(false, iterations);
+}
@@ -0,0 +1,202 @@
+#include "bench.hpp"
+#include "batch.hpp"
+#include "pipeline.hpp"
+#include "mapped_file.hpp"
+#include "variables.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Одна операция — одна строка; запуск по LINES строк
+constexpr size_t LINES = 10000;
+
+// Файл со смесью коротких выражений и строк с ошибками
+std::FILE* corpus() {
+    static std::FILE* file = [] {
+        const char* lines[] = {
+            "1 + 2 * 3",
+            "sin(x) ^ 2 + cos(x) ^ 2",
+            "sqrt(x * 16) - ln(x + 1) / 3",
+            "2 ^ 10 - 1000 + x",
+            "1 / (x - x)",
+            "max(x, 3) * min(x, 3) % 7",
+        };
+        std::FILE* f = std::tmpfile();
+        for (size_t i = 0; i < LINES; ++i) {
+            std::fputs(lines[i % (sizeof(lines) / sizeof(lines[0]))], f);
+            std::fputc('\n', f);
+        }
+        return f;
+    }();
+    std::rewind(file);
+    return file;
+}
+
+std::FILE* sink() {
+    static std::FILE* file = std::tmpfile();
+    std::rewind(file);
+    return file;
+}
+
+calc::Variables variables() {
+    calc::Variables vars;
+    vars.set("x", 2.0);
+    return vars;
+}
+
+// Как цикл «процесс на выражение»: строка через getline, результат с
+// немедленным сбросом вывода
+void perLineFlush(size_t iterations) {
+    calc::Variables vars = variables();
+    calc::BatchOptions options;
+    std::string line;
+    std::string result;
+    for (size_t done = 0; done < iterations; done += LINES) {
+        std::FILE* input = corpus();
+        std::FILE* output = sink();
+        int c;
+        while ((c = std::fgetc(input)) != EOF) {
+            if (c != '\n') {
+                line += static_cast<char>(c);
+                continue;
+            }
+            result.clear();
+            calc::evaluateLine(line, vars, options, result);
+            std::fputs(result.c_str(), output);
+            std::fflush(output);
+            line.clear();
+        }
+    }
+}
+
+void buffered(size_t iterations) {
+    calc::Variables vars = variables();
+    calc::BatchOptions options;
+    for (size_t done = 0; done < iterations; done += LINES) {
+        calc::LineReader input(corpus());
+        calc::BufferedWriter output(sink());
+        calc::BatchStats stats = calc::runBatch(input, output, vars, options);
+        calc::bench::doNotOptimize(stats.lines);
+    }
+}
+
+// Конвейер на всех ядрах; корпус меньше куска по умолчанию, поэтому куски мельче
+void pipeline(size_t iterations) {
+    calc::Variables vars = variables();
+    calc::PipelineOptions options;
+    options.chunkSize = 16 << 10;
+    for (size_t done = 0; done < iterations; done += LINES) {
+        calc::BufferedWriter output(sink());
+        calc::PipelineStats stats = calc::runPipeline(corpus(), output, vars, options);
+        calc::bench::doNotOptimize(stats.lines);
+    }
+}
+
+// Файл на диске для сравнения stdio и отображения, того же размера в строках
+constexpr size_t FILE_LINES = LINES;
+
+const std::string& corpusPath() {
+    static const std::string path = [] {
+        std::string name = (std::filesystem::temp_directory_path() / "calc_bench_lines.txt").string();
+        std::FILE* file = std::fopen(name.c_str(), "wb");
+        for (size_t i = 0; i < FILE_LINES; ++i) {
+            std::fprintf(file, "sqrt(x * %zu) - ln(x + 1) / 3\n", i);
+        }
+        std::fclose(file);
+        return name;
+    }();
+    return path;
+}
+
+// Холодный кэш: страницы файла выбрасываются из page cache (Linux, BSD);
+// там, где это недоступно, замер совпадает с тёплым
+void dropCache(const std::string& path) {
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd >= 0) {
+        ::fdatasync(fd);
+        ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+        ::close(fd);
+    }
+#else
+    (void)path;
+#endif
+}
+
+// Только чтение и разбиение на строки: так видна разница в вводе
+void scanStream(size_t iterations, bool cold) {
+    for (size_t done = 0; done < iterations; done += FILE_LINES) {
+        if (cold) {
+            dropCache(corpusPath());
+        }
+        std::FILE* file = std::fopen(corpusPath().c_str(), "rb");
+        calc::LineReader reader(file);
+        std::string_view line;
+        size_t bytes = 0;
+        while (reader.next(line)) {
+            bytes += line.size();
+        }
+        std::fclose(file);
+        calc::bench::doNotOptimize(bytes);
+    }
+}
+
+void scanMapped(size_t iterations, bool cold) {
+    for (size_t done = 0; done < iterations; done += FILE_LINES) {
+        if (cold) {
+            dropCache(corpusPath());
+        }
+        calc::MappedFile file(corpusPath());
+        file.adviseSequential();
+        std::string_view rest(file.data(), file.size());
+        size_t bytes = 0;
+        while (!rest.empty()) {
+            size_t newline = rest.find('\n');
+            size_t length = newline == std::string_view::npos ? rest.size() : newline;
+            bytes += length;
+            rest.remove_prefix(std::min(rest.size(), length + 1));
+        }
+        calc::bench::doNotOptimize(bytes);
+    }
+}
+
+// Полный пакетный режим в одном потоке
+void batchFile(size_t iterations, bool mapped) {
+    calc::Variables vars = variables();
+    calc::BatchOptions options;
+    for (size_t done = 0; done < iterations; done += FILE_LINES) {
+        calc::BufferedWriter output(sink());
+        calc::BatchStats stats;
+        if (mapped) {
+            calc::MappedFile file(corpusPath());
+            file.adviseSequential();
+            stats = calc::runBatch(std::string_view(file.data(), file.size()), output, vars, options);
+        } else {
+            std::FILE* file = std::fopen(corpusPath().c_str(), "rb");
+            calc::LineReader input(file);
+            stats = calc::runBatch(input, output, vars, options);
+            std::fclose(file);
+        }
+        calc::bench::doNotOptimize(stats.lines);
+    }
+}
+
+} // namespace
+
+CALC_BENCHMARK("lines/per_line_flush") { perLineFlush(iterations); }
+CALC_BENCHMARK("lines/buffered") { buffered(iterations); }
+CALC_BENCHMARK("lines/pipeline") { pipeline(iterations); }
+CALC_BENCHMARK("lines/scan_stream_warm") { scanStream(iterations, false); }
+CALC_BENCHMARK("lines/scan_mapped_warm") { scanMapped(iterations, false); }
+CALC_BENCHMARK("lines/scan_stream_cold") { scanStream(iterations, true); }
+CALC_BENCHMARK("lines/scan_mapped_cold") { scanMapped(iterations, true); }
+CALC_BENCHMARK("lines/batch_stream") { batchFile(iterations, false); }
+CALC_BENCHMARK("lines/batch_mapped") { batchFile(iterations, true); }
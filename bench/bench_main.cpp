@@ -0,0 +1,246 @@
+#include "bench.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Подобрать число итераций так, чтобы замер длился не меньше minSeconds
+double measureNsPerOp(const calc::bench::Benchmark& benchmark, double minSeconds) {
+    size_t iterations = 1;
+    while (true) {
+        auto start = Clock::now();
+        benchmark.fn(iterations);
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (seconds >= minSeconds || iterations >= (size_t(1) << 40)) {
+            return seconds * 1e9 / static_cast<double>(iterations);
+        }
+        // Увеличиваем с запасом, но не более чем в 100 раз за шаг
+        double scale = seconds > 0.0 ? minSeconds * 1.4 / seconds : 100.0;
+        if (scale > 100.0) scale = 100.0;
+        if (scale < 2.0) scale = 2.0;
+        iterations = static_cast<size_t>(static_cast<double>(iterations) * scale);
+    }
+}
+
+// Эталонная нагрузка, не зависящая от кода калькулятора. Сравнение с базой
+// идёт по отношению времени бенчмарка к ней, замеренной непосредственно
+// перед ним: общее замедление машины (частота, соседи по виртуальной
+// машине) меняет обе величины и регрессией не считается
+void referenceWork(size_t iterations) {
+    uint64_t state = 1;
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        sum += std::sqrt(static_cast<double>(state >> 11));
+    }
+    calc::bench::doNotOptimize(sum);
+}
+
+void print_usage(const char* program_name) {
+    std::printf("Usage: %s [--filter SUBSTRING]... [--min-time SECONDS] [--repetitions N]\n"
+                "       [--json FILE] [--baseline FILE] [--threshold PERCENT]\n"
+                "\n"
+                "  --filter SUBSTRING   Run benchmarks whose name contains SUBSTRING\n"
+                "                       (may be repeated: any of them)\n"
+                "  --repetitions N      Measure N times: the fastest run is reported, the\n"
+                "                       median is compared with the baseline\n"
+                "  --json FILE          Also write the results as JSON (\"-\" for stdout)\n"
+                "  --baseline FILE      Compare with results saved by --json; exit with 1\n"
+                "                       if a benchmark is slower than the baseline by\n"
+                "                       more than --threshold percent (default 25).\n"
+                "                       Times are compared relative to a reference loop\n"
+                "                       measured just before each benchmark\n",
+                program_name);
+}
+
+struct Result {
+    std::string name;
+    double ns = 0.0;
+    double relative = 0.0;      // Медиана по повторам: ns / время эталонной нагрузки
+};
+
+using Results = std::vector<Result>;
+
+std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out;
+}
+
+#ifdef NDEBUG
+constexpr bool OPTIMIZED = true;
+#else
+constexpr bool OPTIMIZED = false;
+#endif
+
+std::string toJson(const Results& results, double minSeconds, int repetitions) {
+    std::ostringstream out;
+    out.precision(17);
+    out << "{\n  \"min_time\": " << minSeconds << ",\n  \"repetitions\": " << repetitions
+        << ",\n  \"optimized\": " << (OPTIMIZED ? "true" : "false") << ",\n  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        out << (i == 0 ? "\n" : ",\n") << "    {\"name\": \"" << jsonEscape(results[i].name)
+            << "\", \"ns_per_op\": " << results[i].ns << ", \"relative\": " << results[i].relative << "}";
+    }
+    out << "\n  ]\n}\n";
+    return out.str();
+}
+
+// Записи name/ns_per_op/relative из файла, записанного toJson: разбор только этой формы
+bool readBaseline(const std::string& path, Results& baseline) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+    const std::string nameKey = "\"name\": \"";
+    const std::string valueKey = "\"ns_per_op\": ";
+    const std::string relativeKey = "\"relative\": ";
+    for (size_t pos = text.find(nameKey); pos != std::string::npos; pos = text.find(nameKey, pos)) {
+        pos += nameKey.size();
+        std::string name;
+        while (pos < text.size() && text[pos] != '"') {
+            if (text[pos] == '\\' && pos + 1 < text.size()) {
+                ++pos;
+            }
+            name += text[pos++];
+        }
+        size_t value = text.find(valueKey, pos);
+        if (value == std::string::npos) {
+            return false;
+        }
+        Result entry;
+        entry.name = name;
+        char* end = nullptr;
+        entry.ns = std::strtod(text.c_str() + value + valueKey.size(), &end);
+        size_t relative = end - text.c_str();
+        if (text.compare(relative, 2 + relativeKey.size(), ", " + relativeKey) == 0) {
+            entry.relative = std::strtod(text.c_str() + relative + 2 + relativeKey.size(), nullptr);
+        }
+        baseline.push_back(entry);
+        pos = value;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> filters;
+    double minSeconds = 0.2;
+    int repetitions = 1;
+    std::string jsonPath;
+    std::string baselinePath;
+    double threshold = 25.0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filters.push_back(argv[++i]);
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minSeconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = std::atof(argv[++i]);
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    Results baseline;
+    if (!baselinePath.empty() && !readBaseline(baselinePath, baseline)) {
+        std::fprintf(stderr, "Cannot read baseline %s\n", baselinePath.c_str());
+        return 1;
+    }
+
+    std::vector<const calc::bench::Benchmark*> selected;
+    for (const auto& benchmark : calc::bench::registry()) {
+        if (filters.empty() || std::any_of(filters.begin(), filters.end(), [&](const std::string& f) {
+                return benchmark.name.find(f) != std::string::npos;
+            })) {
+            selected.push_back(&benchmark);
+        }
+    }
+
+    // Повторы идут проходами по всему набору, а не подряд для одного
+    // бенчмарка: кратковременный шум машины портит один замер из многих,
+    // а в таблицу идёт лучший, в сравнение — медиана
+    const calc::bench::Benchmark reference{"reference", referenceWork};
+    Results results(selected.size());
+    std::vector<std::vector<double>> ratios(selected.size());
+    for (int r = 0; r < repetitions; ++r) {
+        for (size_t i = 0; i < selected.size(); ++i) {
+            double referenceNs = measureNsPerOp(reference, minSeconds / 4);
+            double ns = measureNsPerOp(*selected[i], minSeconds);
+            results[i].name = selected[i]->name;
+            results[i].ns = r == 0 ? ns : std::min(results[i].ns, ns);
+            ratios[i].push_back(ns / referenceNs);
+        }
+    }
+    for (size_t i = 0; i < selected.size(); ++i) {
+        std::nth_element(ratios[i].begin(), ratios[i].begin() + ratios[i].size() / 2, ratios[i].end());
+        results[i].relative = ratios[i][ratios[i].size() / 2];
+    }
+
+    // С --json - таблица уходит в stderr, чтобы stdout был чистым JSON
+    std::FILE* table = jsonPath == "-" ? stderr : stdout;
+    size_t regressions = 0;
+    for (const Result& result : results) {
+        auto base = std::find_if(baseline.begin(), baseline.end(),
+                                 [&](const Result& entry) { return entry.name == result.name; });
+        if (base == baseline.end() || base->ns <= 0.0) {
+            std::fprintf(table, "%-48s %14.1f ns/op\n", result.name.c_str(), result.ns);
+            continue;
+        }
+        // База без relative (записана вручную) сравнивается по абсолютному времени
+        double change = base->relative > 0.0 ? (result.relative / base->relative - 1.0) * 100.0
+                                             : (result.ns / base->ns - 1.0) * 100.0;
+        bool regressed = change > threshold;
+        regressions += regressed ? 1 : 0;
+        std::fprintf(table, "%-48s %14.1f ns/op %+8.1f%%%s\n", result.name.c_str(), result.ns, change,
+                     regressed ? "  REGRESSION" : "");
+    }
+
+    if (!jsonPath.empty()) {
+        std::string json = toJson(results, minSeconds, repetitions);
+        if (jsonPath == "-") {
+            std::fputs(json.c_str(), stdout);
+        } else {
+            std::ofstream file(jsonPath);
+            file << json;
+            if (!file) {
+                std::fprintf(stderr, "Cannot write %s\n", jsonPath.c_str());
+                return 1;
+            }
+        }
+    }
+    if (regressions > 0) {
+        std::fprintf(stderr, "%zu benchmarks slower than the baseline by more than %.0f%%\n", regressions,
+                     threshold);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+#include "bench.hpp"
+#include "corpus.hpp"
+#include "preview.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "evaluator.hpp"
+#include "error.hpp"
+#include <string>
+#include <vector>
+
+// Цена нажатия клавиши для предпросмотра: request() службы против прежнего
+// вычисления в потоке интерфейса. Одна операция — один изменённый текст
+
+namespace {
+
+const std::string& shortText() {
+    static const std::string text = "sqrt(16) * 2 + 10 / 4";
+    return text;
+}
+
+// Цепочка сложений длиной почти в предел лексера (10000 символов)
+const std::string& longText() {
+    static const std::string text = [] {
+        std::string chain = calc::bench::additiveChains(1, 2000).front();
+        size_t cut = 9990;
+        while (cut > 0 && !(chain[cut] == ' ' && (chain[cut + 1] == '+' || chain[cut + 1] == '-'))) {
+            --cut;
+        }
+        return chain.substr(0, cut);
+    }();
+    return text;
+}
+
+void request(size_t iterations, const std::string& text) {
+    calc::PreviewService service([](const calc::PreviewResult&) {});
+    for (size_t i = 0; i < iterations; ++i) {
+        // Текст меняется на каждое нажатие, как при наборе
+        std::string typed = text;
+        typed.back() = static_cast<char>('0' + i % 10);
+        calc::bench::doNotOptimize(service.request(std::move(typed)));
+    }
+}
+
+void synchronous(size_t iterations, const std::string& text) {
+    double sum = 0.0;
+    for (size_t i = 0; i < iterations; ++i) {
+        std::string typed = text;
+        typed.back() = static_cast<char>('0' + i % 10);
+        try {
+            calc::Lexer lexer(typed);
+            calc::Parser parser(lexer.tokenize());
+            auto ast = parser.parse();
+            calc::Evaluator evaluator;
+            sum += evaluator.evaluate(ast);
+        } catch (const std::exception&) {
+        }
+    }
+    calc::bench::doNotOptimize(sum);
+}
+
+} // namespace
+
+CALC_BENCHMARK("preview/request_short") {
+    request(iterations, shortText());
+}
+
+CALC_BENCHMARK("preview/request_10k") {
+    request(iterations, longText());
+}
+
+CALC_BENCHMARK("preview/synchronous_short") {
+    synchronous(iterations, shortText());
+}
+
+CALC_BENCHMARK("preview/synchronous_10k") {
+    synchronous(iterations, longText());
+}
@@ -0,0 +1,49 @@
+#include "bench.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include <string>
+
+namespace {
+
+// Одна операция — одно слагаемое; запуск по TERMS слагаемых
+constexpr size_t TERMS = 1000000;
+
+std::unique_ptr<calc::Node> parse(const std::string& expr) {
+    calc::Lexer lexer(expr);
+    calc::Parser parser(lexer.tokenize());
+    return parser.parse();
+}
+
+void run(const calc::ReductionNode& node, size_t iterations, size_t threads) {
+    for (size_t done = 0; done < iterations; done += TERMS) {
+        calc::bench::doNotOptimize(calc::evaluateReduction(node, threads));
+    }
+}
+
+// Тело не многочлен: компиляция и пакетный перебор
+const std::string ITERATED = "sum(i, 1, 1000000, sin(i) / (1 + i ^ 2))";
+
+// Вложенная сумма не компилируется: перебор по дереву
+const std::string TREE = "sum(i, 1, 1000000, sin(i) / (1 + i ^ 2) + sum(j, 1, 0, j))";
+
+} // namespace
+
+CALC_BENCHMARK("reduction/tree") {
+    auto ast = parse(TREE);
+    run(static_cast<const calc::ReductionNode&>(*ast), iterations, 1);
+}
+CALC_BENCHMARK("reduction/batch_1_thread") {
+    auto ast = parse(ITERATED);
+    run(static_cast<const calc::ReductionNode&>(*ast), iterations, 1);
+}
+CALC_BENCHMARK("reduction/batch_all_threads") {
+    auto ast = parse(ITERATED);
+    run(static_cast<const calc::ReductionNode&>(*ast), iterations, 0);
+}
+// Многочлен: 10^9 слагаемых в замкнутой форме, на операцию — одно вычисление
+CALC_BENCHMARK("reduction/closed_form_1e9") {
+    auto ast = parse("sum(i, 1, 10^9, 3 * i ^ 2 - i + 1)");
+    for (size_t i = 0; i < iterations; ++i) {
+        calc::bench::doNotOptimize(ast->evaluate());
+    }
+}
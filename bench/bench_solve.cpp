@@ -0,0 +1,35 @@
+#include "bench.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include <string>
+
+namespace {
+
+std::unique_ptr<calc::Node> parse(const std::string& expr) {
+    calc::Lexer lexer(expr);
+    calc::Parser parser(lexer.tokenize());
+    return parser.parse();
+}
+
+// Одна операция — одно вычисление функции (просмотр и уточнение)
+void run(const std::string& expr, size_t iterations, size_t threads) {
+    auto ast = parse(expr);
+    const auto& node = static_cast<const calc::SolveNode&>(*ast);
+    size_t done = 0;
+    while (done < iterations) {
+        calc::bench::doNotOptimize(calc::findRoots(node, threads).size());
+        done += node.report().evaluations;
+    }
+}
+
+// Сотни корней: просмотр и уточнение примерно поровну
+const std::string MANY_ROOTS = "solve(sin(40 * x) * exp(-x / 10) - 0.01 * cos(x), x, 0, 30)";
+
+// Вложенная сумма не компилируется: вычисление по дереву
+const std::string TREE = "solve(sin(40 * x) * exp(-x / 10) - 0.01 * cos(x) + sum(i, 1, 0, i), x, 0, 30)";
+
+} // namespace
+
+CALC_BENCHMARK("solve/tree") { run(TREE, iterations, 1); }
+CALC_BENCHMARK("solve/batch_1_thread") { run(MANY_ROOTS, iterations, 1); }
+CALC_BENCHMARK("solve/batch_all_threads") { run(MANY_ROOTS, iterations, 0); }
@@ -0,0 +1,117 @@
+#include "bench.hpp"
+#include "corpus.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "evaluator.hpp"
+#include "variables.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Замеры отдельных стадий: лексер, парсер и вычисление каждого оператора
+// и каждой функции. Одна операция — одно выражение (или один узел)
+
+namespace {
+
+const std::vector<std::string>& additive() {
+    static const std::vector<std::string> corpus = calc::bench::additiveChains(64, 32);
+    return corpus;
+}
+
+const std::vector<std::string>& nested() {
+    static const std::vector<std::string> corpus = calc::bench::deepParentheses(64, 64);
+    return corpus;
+}
+
+const std::vector<std::string>& functions() {
+    static const std::vector<std::string> corpus = calc::bench::functionHeavy(64, 8);
+    return corpus;
+}
+
+void lexCorpus(const std::vector<std::string>& corpus, size_t iterations) {
+    for (size_t i = 0; i < iterations; ++i) {
+        calc::Lexer lexer(corpus[i % corpus.size()]);
+        auto tokens = lexer.tokenize();
+        calc::bench::doNotOptimize(tokens.size());
+    }
+}
+
+// Токены готовы заранее; в замер входит копирование вектора токенов,
+// которое Parser принимает по значению
+void parseCorpus(const std::vector<std::string>& corpus, size_t iterations) {
+    std::vector<std::vector<calc::Token>> tokens;
+    for (const std::string& expr : corpus) {
+        calc::Lexer lexer(expr);
+        tokens.push_back(lexer.tokenize());
+    }
+    for (size_t i = 0; i < iterations; ++i) {
+        calc::Parser parser(tokens[i % tokens.size()]);
+        auto ast = parser.parse();
+        calc::bench::doNotOptimize(ast);
+    }
+}
+
+// Вычисление одного дерева: переменные не дают парсеру свернуть константы
+void evaluate(const std::string& expr, size_t iterations) {
+    calc::Variables variables;
+    variables.set("x", 7.25);
+    variables.set("y", 2.5);
+    variables.set("a", 46421.0);
+    variables.set("b", 3.0);
+    variables.set("n", 10.0);
+    calc::Lexer lexer(expr);
+    calc::Parser parser(lexer.tokenize(), &variables);
+    auto ast = parser.parse();
+    calc::Evaluator evaluator;
+    for (size_t i = 0; i < iterations; ++i) {
+        double result = evaluator.evaluate(ast);
+        calc::bench::doNotOptimize(result);
+    }
+}
+
+} // namespace
+
+CALC_BENCHMARK("lexer/additive") { lexCorpus(additive(), iterations); }
+CALC_BENCHMARK("lexer/deep_parens") { lexCorpus(nested(), iterations); }
+CALC_BENCHMARK("lexer/functions") { lexCorpus(functions(), iterations); }
+
+CALC_BENCHMARK("parser/additive") { parseCorpus(additive(), iterations); }
+CALC_BENCHMARK("parser/deep_parens") { parseCorpus(nested(), iterations); }
+CALC_BENCHMARK("parser/functions") { parseCorpus(functions(), iterations); }
+
+CALC_BENCHMARK("evaluator/op/add") { evaluate("x + y", iterations); }
+CALC_BENCHMARK("evaluator/op/sub") { evaluate("x - y", iterations); }
+CALC_BENCHMARK("evaluator/op/mul") { evaluate("x * y", iterations); }
+CALC_BENCHMARK("evaluator/op/div") { evaluate("x / y", iterations); }
+CALC_BENCHMARK("evaluator/op/mod") { evaluate("x % y", iterations); }
+CALC_BENCHMARK("evaluator/op/pow") { evaluate("x ^ y", iterations); }
+CALC_BENCHMARK("evaluator/op/neg") { evaluate("-x", iterations); }
+CALC_BENCHMARK("evaluator/op/and") { evaluate("a AND b", iterations); }
+CALC_BENCHMARK("evaluator/op/or") { evaluate("a OR b", iterations); }
+CALC_BENCHMARK("evaluator/op/xor") { evaluate("a XOR b", iterations); }
+CALC_BENCHMARK("evaluator/op/not") { evaluate("NOT a", iterations); }
+CALC_BENCHMARK("evaluator/op/shl") { evaluate("a << b", iterations); }
+CALC_BENCHMARK("evaluator/op/shr") { evaluate("a >> b", iterations); }
+CALC_BENCHMARK("evaluator/op/less") { evaluate("x < y", iterations); }
+CALC_BENCHMARK("evaluator/op/equal") { evaluate("x == y", iterations); }
+CALC_BENCHMARK("evaluator/op/conditional") { evaluate("x < y ? x : y", iterations); }
+
+CALC_BENCHMARK("evaluator/func/sin") { evaluate("sin(y)", iterations); }
+CALC_BENCHMARK("evaluator/func/cos") { evaluate("cos(y)", iterations); }
+CALC_BENCHMARK("evaluator/func/tan") { evaluate("tan(y)", iterations); }
+CALC_BENCHMARK("evaluator/func/asin") { evaluate("asin(y / 4)", iterations); }
+CALC_BENCHMARK("evaluator/func/acos") { evaluate("acos(y / 4)", iterations); }
+CALC_BENCHMARK("evaluator/func/atan") { evaluate("atan(y)", iterations); }
+CALC_BENCHMARK("evaluator/func/sinh") { evaluate("sinh(y)", iterations); }
+CALC_BENCHMARK("evaluator/func/cosh") { evaluate("cosh(y)", iterations); }
+CALC_BENCHMARK("evaluator/func/tanh") { evaluate("tanh(y)", iterations); }
+CALC_BENCHMARK("evaluator/func/log") { evaluate("log(x)", iterations); }
+CALC_BENCHMARK("evaluator/func/ln") { evaluate("ln(x)", iterations); }
+CALC_BENCHMARK("evaluator/func/log10") { evaluate("log10(x)", iterations); }
+CALC_BENCHMARK("evaluator/func/exp") { evaluate("exp(y)", iterations); }
+CALC_BENCHMARK("evaluator/func/sqrt") { evaluate("sqrt(x)", iterations); }
+CALC_BENCHMARK("evaluator/func/abs") { evaluate("abs(x)", iterations); }
+CALC_BENCHMARK("evaluator/func/ceil") { evaluate("ceil(x)", iterations); }
+CALC_BENCHMARK("evaluator/func/floor") { evaluate("floor(x)", iterations); }
+CALC_BENCHMARK("evaluator/func/round") { evaluate("round(x)", iterations); }
+CALC_BENCHMARK("evaluator/func/factorial") { evaluate("factorial(n)", iterations); }
@@ -0,0 +1,78 @@
+#include "bench.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "program.hpp"
+#include "sweep.hpp"
+#include "variables.hpp"
+#include <string>
+
+namespace {
+
+// Одна операция — одна точка табулирования; запуск по POINTS точек
+constexpr double POINTS = 10000.0;
+
+// Формула с тяжёлой частью, не зависящей от x
+const std::string FORMULA =
+    "sin(x) * (exp(a) * cos(b) + sqrt(a * b + 1) * ln(a + 2) + atan(b) ^ 2) + "
+    "x ^ 2 / (1 + tanh(a) * sinh(b)) - log10(a * 100) * x";
+
+struct Setup {
+    calc::Variables vars;
+    double* x;
+    std::unique_ptr<calc::Node> ast;
+
+    Setup() {
+        vars.set("a", 1.25);
+        vars.set("b", 0.75);
+        x = vars.bind("x");
+        calc::Lexer lexer(FORMULA);
+        calc::Parser parser(lexer.tokenize(), &vars);
+        ast = parser.parse();
+    }
+};
+
+// Наивное табулирование: всё дерево в каждой точке
+void naiveTree(size_t iterations) {
+    Setup setup;
+    for (size_t done = 0; done < iterations; done += static_cast<size_t>(POINTS)) {
+        double sum = 0.0;
+        for (double k = 0; k < POINTS; ++k) {
+            *setup.x = k * 0.001;
+            sum += setup.ast->evaluate();
+        }
+        calc::bench::doNotOptimize(sum);
+    }
+}
+
+// Наивное табулирование скомпилированной программой
+void naiveProgram(size_t iterations) {
+    Setup setup;
+    calc::Program program = calc::Program::compile(*setup.ast);
+    calc::ProgramView view = program.view();
+    auto slots = view.bind(setup.vars);
+    for (size_t done = 0; done < iterations; done += static_cast<size_t>(POINTS)) {
+        double sum = 0.0;
+        for (double k = 0; k < POINTS; ++k) {
+            *setup.x = k * 0.001;
+            sum += view.evaluate(slots.data());
+        }
+        calc::bench::doNotOptimize(sum);
+    }
+}
+
+void hoisted(size_t iterations) {
+    Setup setup;
+    calc::Sweep sweep(*setup.ast, "x");
+    for (size_t done = 0; done < iterations; done += static_cast<size_t>(POINTS)) {
+        double sum = 0.0;
+        sweep.run(0.0, (POINTS - 1) * 0.001, 0.001, setup.vars,
+                  [&sum](double, double value, const std::string*) { sum += value; });
+        calc::bench::doNotOptimize(sum);
+    }
+}
+
+} // namespace
+
+CALC_BENCHMARK("sweep/naive_tree") { naiveTree(iterations); }
+CALC_BENCHMARK("sweep/naive_program") { naiveProgram(iterations); }
+CALC_BENCHMARK("sweep/hoisted") { hoisted(iterations); }
@@ -0,0 +1,91 @@
+#include "bench.hpp"
+#include "vecmath.hpp"
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// Одна операция — одно значение функции; данные блоками по BLOCK значений
+constexpr size_t BLOCK = 1024;
+
+std::vector<double> inputs(double lo, double hi) {
+    std::vector<double> x(BLOCK);
+    for (size_t i = 0; i < BLOCK; ++i) {
+        x[i] = lo + (hi - lo) * (static_cast<double>(i) + 0.5) / BLOCK;
+    }
+    return x;
+}
+
+template <typename Scalar>
+void scalarLoop(const std::vector<double>& x, Scalar scalar, size_t iterations) {
+    std::vector<double> y(BLOCK);
+    for (size_t done = 0; done < iterations; done += BLOCK) {
+        for (size_t i = 0; i < BLOCK; ++i) {
+            y[i] = scalar(x[i]);
+        }
+        calc::bench::doNotOptimize(y[0]);
+    }
+}
+
+void batchLoop(const std::vector<double>& x, calc::Function function,
+               calc::vecmath::Accuracy accuracy, size_t iterations) {
+    std::vector<double> y(BLOCK);
+    for (size_t done = 0; done < iterations; done += BLOCK) {
+        calc::vecmath::evaluate(function, x.data(), y.data(), BLOCK, accuracy);
+        calc::bench::doNotOptimize(y[0]);
+    }
+}
+
+const std::vector<double> TRIG = inputs(-100.0, 100.0);
+const std::vector<double> EXP = inputs(-50.0, 50.0);
+const std::vector<double> LOG = inputs(1e-3, 1e6);
+
+} // namespace
+
+CALC_BENCHMARK("vecmath/sin/libm") {
+    scalarLoop(TRIG, [](double v) { return std::sin(v); }, iterations);
+}
+
+CALC_BENCHMARK("vecmath/sin/ulp1") {
+    batchLoop(TRIG, calc::Function::Sin, calc::vecmath::Accuracy::Ulp1, iterations);
+}
+
+CALC_BENCHMARK("vecmath/sin/ulp4") {
+    batchLoop(TRIG, calc::Function::Sin, calc::vecmath::Accuracy::Ulp4, iterations);
+}
+
+CALC_BENCHMARK("vecmath/exp/libm") {
+    scalarLoop(EXP, [](double v) { return std::exp(v); }, iterations);
+}
+
+CALC_BENCHMARK("vecmath/exp/ulp1") {
+    batchLoop(EXP, calc::Function::Exp, calc::vecmath::Accuracy::Ulp1, iterations);
+}
+
+CALC_BENCHMARK("vecmath/exp/ulp4") {
+    batchLoop(EXP, calc::Function::Exp, calc::vecmath::Accuracy::Ulp4, iterations);
+}
+
+CALC_BENCHMARK("vecmath/log/libm") {
+    scalarLoop(LOG, [](double v) { return std::log(v); }, iterations);
+}
+
+CALC_BENCHMARK("vecmath/log/ulp1") {
+    batchLoop(LOG, calc::Function::Log, calc::vecmath::Accuracy::Ulp1, iterations);
+}
+
+CALC_BENCHMARK("vecmath/log/ulp4") {
+    batchLoop(LOG, calc::Function::Log, calc::vecmath::Accuracy::Ulp4, iterations);
+}
+
+CALC_BENCHMARK("vecmath/atan/libm") {
+    scalarLoop(TRIG, [](double v) { return std::atan(v); }, iterations);
+}
+
+CALC_BENCHMARK("vecmath/atan/ulp1") {
+    batchLoop(TRIG, calc::Function::Atan, calc::vecmath::Accuracy::Ulp1, iterations);
+}
+
+CALC_BENCHMARK("vecmath/atan/ulp4") {
+    batchLoop(TRIG, calc::Function::Atan, calc::vecmath::Accuracy::Ulp4, iterations);
+}
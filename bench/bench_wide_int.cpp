@@ -0,0 +1,96 @@
+#include "bench.hpp"
+#include "wide_int.hpp"
+#include "programmer.hpp"
+#include <string>
+#include <vector>
+
+// Замеры WideInt (src/wide_int.hpp) программистского режима. 128 бит — быстрый
+// путь, 4096 — циклы по словам; панели HEX/DEC/OCT/BIN перерисовываются
+// четырьмя вызовами toString на каждое изменение значения
+
+namespace {
+
+// Значение во всю разрядность: повторяющийся несимметричный образ
+calc::WideInt pattern(unsigned bits, int seed) {
+    std::string hex;
+    uint64_t state = static_cast<uint64_t>(seed) * 0x9E3779B97F4A7C15ULL + 1;
+    for (unsigned i = 0; i < bits / 4; ++i) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        hex.push_back("0123456789ABCDEF"[state >> 60]);
+    }
+    return calc::WideInt::parse(hex, 16, bits);
+}
+
+template <typename Operation>
+void binary(unsigned bits, size_t iterations, Operation operation) {
+    calc::WideInt a = pattern(bits, 1);
+    calc::WideInt b = pattern(bits, 2);
+    for (size_t i = 0; i < iterations; ++i) {
+        a = operation(a, b);
+        calc::bench::doNotOptimize(a.limb(0));
+    }
+}
+
+void toText(unsigned bits, int radix, size_t iterations) {
+    calc::WideInt value = pattern(bits, 3);
+    for (size_t i = 0; i < iterations; ++i) {
+        std::string text = value.toString(radix, radix == 10);
+        calc::bench::doNotOptimize(text.size());
+    }
+}
+
+// Обновление всех четырёх панелей программистского режима
+void panels(unsigned bits, size_t iterations) {
+    calc::WideInt value = pattern(bits, 4);
+    for (size_t i = 0; i < iterations; ++i) {
+        size_t length = value.toString(16, false).size() + value.toString(10, true).size() +
+                        value.toString(8, false).size() + value.toString(2, false).size();
+        calc::bench::doNotOptimize(length);
+    }
+}
+
+void fromText(unsigned bits, int radix, size_t iterations) {
+    std::string text = pattern(bits, 5).toString(radix, false);
+    for (size_t i = 0; i < iterations; ++i) {
+        calc::WideInt value = calc::WideInt::parse(text, radix, bits);
+        calc::bench::doNotOptimize(value.limb(0));
+    }
+}
+
+void expression(unsigned bits, size_t iterations) {
+    const std::string text = "(DEADBEEF ROL 75 XOR NOT 0 >> 3) * 10001 + CAFE AND FFFFFFFFFFFF0000";
+    for (size_t i = 0; i < iterations; ++i) {
+        calc::WideInt value = calc::evaluateInteger(text, 16, bits);
+        calc::bench::doNotOptimize(value.limb(0));
+    }
+}
+
+} // namespace
+
+CALC_BENCHMARK("wide/xor_128") {
+    binary(128, iterations, [](const calc::WideInt& a, const calc::WideInt& b) { return a ^ b; });
+}
+CALC_BENCHMARK("wide/add_128") {
+    binary(128, iterations, [](const calc::WideInt& a, const calc::WideInt& b) { return a + b; });
+}
+CALC_BENCHMARK("wide/rotate_128") {
+    binary(128, iterations, [](const calc::WideInt& a, const calc::WideInt&) { return a.rotateLeft(13); });
+}
+CALC_BENCHMARK("wide/xor_4096") {
+    binary(4096, iterations, [](const calc::WideInt& a, const calc::WideInt& b) { return a ^ b; });
+}
+CALC_BENCHMARK("wide/add_4096") {
+    binary(4096, iterations, [](const calc::WideInt& a, const calc::WideInt& b) { return a + b; });
+}
+CALC_BENCHMARK("wide/rotate_4096") {
+    binary(4096, iterations, [](const calc::WideInt& a, const calc::WideInt&) { return a.rotateLeft(1001); });
+}
+CALC_BENCHMARK("wide/mul_4096") {
+    binary(4096, iterations, [](const calc::WideInt& a, const calc::WideInt& b) { return a * b; });
+}
+CALC_BENCHMARK("wide/to_hex_4096") { toText(4096, 16, iterations); }
+CALC_BENCHMARK("wide/to_dec_4096") { toText(4096, 10, iterations); }
+CALC_BENCHMARK("wide/to_oct_4096") { toText(4096, 8, iterations); }
+CALC_BENCHMARK("wide/panels_4096") { panels(4096, iterations); }
+CALC_BENCHMARK("wide/from_dec_4096") { fromText(4096, 10, iterations); }
+CALC_BENCHMARK("wide/expression_256") { expression(256, iterations); }
@@ -0,0 +1,132 @@
+#include "corpus.hpp"
+#include <cstdint>
+
+namespace calc {
+namespace bench {
+
+namespace {
+    // Линейный конгруэнтный генератор: одинаковая последовательность на всех платформах
+    class Random {
+    public:
+        explicit Random(uint64_t seed) : state_(seed) {}
+
+        uint32_t next() {
+            state_ = state_ * 6364136223846793005ULL + 1442695040888963407ULL;
+            return static_cast<uint32_t>(state_ >> 33);
+        }
+
+        size_t below(size_t bound) { return next() % bound; }
+
+        std::string number() {
+            // Целые и десятичные дроби разной длины
+            std::string text = std::to_string(1 + below(999));
+            if (below(2) == 0) {
+                text += '.';
+                text += std::to_string(below(1000));
+            }
+            return text;
+        }
+
+    private:
+        uint64_t state_;
+    };
+
+    const char* const FUNCTIONS[] = {"sin", "cos", "tanh", "atan", "sqrt", "exp", "abs", "floor", "log"};
+}
+
+std::vector<std::string> additiveChains(size_t count, size_t terms) {
+    Random random(1);
+    std::vector<std::string> corpus;
+    for (size_t i = 0; i < count; ++i) {
+        std::string expr = random.number();
+        for (size_t t = 1; t < terms; ++t) {
+            expr += random.below(2) == 0 ? " + " : " - ";
+            expr += random.number();
+        }
+        corpus.push_back(std::move(expr));
+    }
+    return corpus;
+}
+
+std::vector<std::string> deepParentheses(size_t count, size_t depth) {
+    Random random(2);
+    const char* const operators[] = {" + ", " - ", " * ", " / "};
+    std::vector<std::string> corpus;
+    for (size_t i = 0; i < count; ++i) {
+        std::string expr(depth, '(');
+        expr += random.number();
+        for (size_t level = 0; level < depth; ++level) {
+            expr += operators[random.below(4)];
+            expr += random.number();
+            expr += ')';
+        }
+        corpus.push_back(std::move(expr));
+    }
+    return corpus;
+}
+
+std::vector<std::string> functionHeavy(size_t count, size_t calls) {
+    Random random(3);
+    std::vector<std::string> corpus;
+    for (size_t i = 0; i < count; ++i) {
+        std::string expr;
+        for (size_t c = 0; c < calls; ++c) {
+            if (c > 0) {
+                expr += random.below(2) == 0 ? " + " : " * ";
+            }
+            // sqrt и log получают abs от аргумента, чтобы не выйти из области определения
+            const char* outer = FUNCTIONS[random.below(sizeof(FUNCTIONS) / sizeof(FUNCTIONS[0]))];
+            const char* inner = FUNCTIONS[random.below(4)];
+            expr += outer;
+            expr += "(1 + abs(";
+            expr += inner;
+            expr += "(0.";
+            expr += std::to_string(1 + random.below(9));
+            expr += ")))";
+        }
+        corpus.push_back(std::move(expr));
+    }
+    return corpus;
+}
+
+std::vector<std::string> bitwiseExpressions(size_t count, size_t operations) {
+    Random random(4);
+    const char* const operators[] = {" AND ", " OR ", " XOR ", " << ", " >> "};
+    std::vector<std::string> corpus;
+    for (size_t i = 0; i < count; ++i) {
+        std::string expr = std::to_string(random.below(1 << 16));
+        for (size_t op = 0; op < operations; ++op) {
+            size_t kind = random.below(5);
+            expr += operators[kind];
+            // Сдвиги — на малые величины, остальное — 16-битные маски
+            std::string operand = std::to_string(kind >= 3 ? random.below(8) : random.below(1 << 16));
+            if (kind < 3 && random.below(4) == 0) {
+                operand = "(NOT " + operand + ")";
+            }
+            expr = "(" + expr + operand + ")";
+        }
+        corpus.push_back(std::move(expr));
+    }
+    return corpus;
+}
+
+std::vector<std::string> malformedInputs(size_t count) {
+    Random random(5);
+    std::vector<std::string> valid = additiveChains(count, 8);
+    std::vector<std::string> corpus;
+    for (size_t i = 0; i < count; ++i) {
+        std::string expr = valid[i];
+        switch (random.below(5)) {
+            case 0: expr += " +"; break;                        // Висящий оператор
+            case 1: expr += " * ()"; break;                     // Пустые скобки
+            case 2: expr += ")"; break;                         // Лишняя скобка
+            case 3: expr += " * undefined_name"; break;         // Неизвестное имя
+            default: expr += " 42"; break;                      // Два числа подряд
+        }
+        corpus.push_back(std::move(expr));
+    }
+    return corpus;
+}
+
+} // namespace bench
+} // namespace calc
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace calc {
+namespace bench {
+
+/**
+ * @brief Генераторы корпусов выражений для сквозных замеров
+ *
+ * Корпуса детерминированы (фиксированное зерно), поэтому замеры разных
+ * сборок сравнимы с сохранённой базой.
+ */
+
+/**
+ * @brief Длинные цепочки сложений и вычитаний: terms слагаемых в выражении
+ */
+std::vector<std::string> additiveChains(size_t count, size_t terms);
+
+/**
+ * @brief Глубоко вложенные скобки: ((((1 + 2) * 3) - 4) ...), depth уровней
+ */
+std::vector<std::string> deepParentheses(size_t count, size_t depth);
+
+/**
+ * @brief Выражения из вложенных вызовов функций с аргументами в их области определения
+ */
+std::vector<std::string> functionHeavy(size_t count, size_t calls);
+
+/**
+ * @brief Целочисленные выражения программистского режима: AND, OR, XOR, NOT, сдвиги
+ */
+std::vector<std::string> bitwiseExpressions(size_t count, size_t operations);
+
+/**
+ * @brief Испорченные выражения: каждое даёт ParseError
+ *
+ * Висящие операторы, лишние и пустые скобки, неизвестные имена,
+ * два числа подряд — как ошибки ввода пользователя.
+ */
+std::vector<std::string> malformedInputs(size_t count);
+
+} // namespace bench
+} // namespace calc
@@ -0,0 +1,63 @@
+// Замена глобальных operator new/delete для учёта выделений в AllocationScope
+// (stats.hpp). Файл компонуется только в программы (calc, calc_tests), а не в
+// libcalc: библиотека не должна подменять распределитель памяти процесса,
+// в который её встроили. Без этого файла AllocationScope считает нули
+#include "stats.hpp"
+#include <cstdlib>
+#include <new>
+
+namespace {
+    void* allocate(std::size_t size) {
+        void* p = std::malloc(size > 0 ? size : 1);
+        if (p) {
+            calc::AllocationScope::record(size);
+        }
+        return p;
+    }
+}
+
+// malloc/free и, во время замера, учёт размера выделения. Выровненные
+// варианты (align_val_t) остаются стандартными и не учитываются
+void* operator new(std::size_t size) {
+    void* p = allocate(size);
+    if (!p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](std::size_t size) {
+    return ::operator new(size);
+}
+
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    return allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, const std::nothrow_t&) noexcept {
+    std::free(p);
+}
@@ -4,6 +4,8 @@
 #include "../error.hpp"
 #include <memory>
 #include <cmath>
+#include <cfenv>
+#include <cstdint>
 
 namespace calc {
 
@@ -19,9 +21,243 @@ enum class BinaryOp {
     BitwiseOr,
     BitwiseXor,
     LeftShift,
-    RightShift
+    RightShift,
+    // Сравнения: 1, если условие выполнено, иначе 0
+    Less,
+    LessEqual,
+    Greater,
+    GreaterEqual,
+    Equal,
+    NotEqual
 };
 
+/**
+ * @brief Результат сравнения (без проверок операндов)
+ */
+inline double applyComparison(BinaryOp op, double left_val, double right_val) {
+    bool result = false;
+    switch (op) {
+        case BinaryOp::Less: result = left_val < right_val; break;
+        case BinaryOp::LessEqual: result = left_val <= right_val; break;
+        case BinaryOp::Greater: result = left_val > right_val; break;
+        case BinaryOp::GreaterEqual: result = left_val >= right_val; break;
+        case BinaryOp::Equal: result = left_val == right_val; break;
+        case BinaryOp::NotEqual: result = left_val != right_val; break;
+        default: break;
+    }
+    return result ? 1.0 : 0.0;
+}
+
+/**
+ * @brief Значение бинарной операции с проверками (ошибки — EvalError)
+ *
+ * Общая часть BinaryOpNode и плоских программ (program.hpp).
+ */
+inline double applyBinary(BinaryOp op, double left_val, double right_val) {
+    // Проверка на NaN и Infinity
+    if (std::isnan(left_val) || std::isnan(right_val)) {
+        throw EvalError("Invalid operand: NaN");
+    }
+    if (std::isinf(left_val) || std::isinf(right_val)) {
+        throw EvalError("Invalid operand: Infinity");
+    }
+    
+    double result = 0.0;
+    
+    switch (op) {
+        case BinaryOp::Add:
+            result = left_val + right_val;
+            if (std::isinf(result)) {
+                throw EvalError("Overflow in addition");
+            }
+            return result;
+            
+        case BinaryOp::Subtract:
+            result = left_val - right_val;
+            if (std::isinf(result)) {
+                throw EvalError("Overflow in subtraction");
+            }
+            return result;
+            
+        case BinaryOp::Multiply:
+            result = left_val * right_val;
+            if (std::isinf(result)) {
+                throw EvalError("Overflow in multiplication");
+            }
+            return result;
+            
+        case BinaryOp::Divide:
+            if (std::abs(right_val) < 1e-15) {
+                throw EvalError("Division by zero");
+            }
+            result = left_val / right_val;
+            if (std::isinf(result)) {
+                throw EvalError("Overflow in division");
+            }
+            return result;
+            
+        case BinaryOp::Modulo:
+            if (std::abs(right_val) < 1e-15) {
+                throw EvalError("Modulo by zero");
+            }
+            result = std::fmod(left_val, right_val);
+            return result;
+            
+        case BinaryOp::Power:
+            // Проверка на потенциальное переполнение
+            if (left_val == 0.0 && right_val < 0.0) {
+                throw EvalError("Zero to negative power");
+            }
+            if (left_val < 0.0 && std::floor(right_val) != right_val) {
+                throw EvalError("Negative base with non-integer exponent");
+            }
+            result = std::pow(left_val, right_val);
+            if (std::isinf(result)) {
+                throw EvalError("Overflow in power operation");
+            }
+            if (std::isnan(result)) {
+                throw EvalError("Invalid power operation result");
+            }
+            return result;
+            
+        // Битовые операции
+        case BinaryOp::BitwiseAnd:
+        case BinaryOp::BitwiseOr:
+        case BinaryOp::BitwiseXor:
+        case BinaryOp::LeftShift:
+        case BinaryOp::RightShift: {
+            // Проверка диапазона для битовых операций
+            constexpr double MAX_INT64 = static_cast<double>(INT64_MAX);
+            constexpr double MIN_INT64 = static_cast<double>(INT64_MIN);
+            
+            if (left_val > MAX_INT64 || left_val < MIN_INT64) {
+                throw EvalError("Left operand out of int64 range for bitwise operation");
+            }
+            if (right_val > MAX_INT64 || right_val < MIN_INT64) {
+                throw EvalError("Right operand out of int64 range for bitwise operation");
+            }
+            
+            int64_t left_int = static_cast<int64_t>(left_val);
+            int64_t right_int = static_cast<int64_t>(right_val);
+            
+            // Дополнительные проверки для сдвигов
+            if (op == BinaryOp::LeftShift || op == BinaryOp::RightShift) {
+                if (right_int < 0) {
+                    throw EvalError("Negative shift count");
+                }
+                if (right_int >= 64) {
+                    throw EvalError("Shift count too large (>= 64)");
+                }
+            }
+            
+            int64_t int_result = 0;
+            switch (op) {
+                case BinaryOp::BitwiseAnd:
+                    int_result = left_int & right_int;
+                    break;
+                case BinaryOp::BitwiseOr:
+                    int_result = left_int | right_int;
+                    break;
+                case BinaryOp::BitwiseXor:
+                    int_result = left_int ^ right_int;
+                    break;
+                case BinaryOp::LeftShift:
+                    int_result = left_int << right_int;
+                    break;
+                case BinaryOp::RightShift:
+                    int_result = left_int >> right_int;
+                    break;
+                default:
+                    break;
+            }
+            return static_cast<double>(int_result);
+        }
+            
+        // Сравнения (точные: 0.1 + 0.2 == 0.3 ложно, как в IEEE 754)
+        case BinaryOp::Less:
+        case BinaryOp::LessEqual:
+        case BinaryOp::Greater:
+        case BinaryOp::GreaterEqual:
+        case BinaryOp::Equal:
+        case BinaryOp::NotEqual:
+            return applyComparison(op, left_val, right_val);
+    }
+    throw EvalError("Unknown binary operator");
+}
+
+/**
+ * @brief Значение бинарной операции без проверок (см. Node::evaluateUnchecked)
+ */
+inline double applyBinaryUnchecked(BinaryOp op, double left_val, double right_val) {
+    // Переполнение, NaN и деление на точный ноль отмечаются флагами
+    // аппаратно; явно поднимаются только флаги для условий, которые
+    // IEEE 754 ошибкой не считает
+    switch (op) {
+        case BinaryOp::Add:
+            return left_val + right_val;
+        case BinaryOp::Subtract:
+            return left_val - right_val;
+        case BinaryOp::Multiply:
+            return left_val * right_val;
+        case BinaryOp::Divide:
+            if (std::abs(right_val) < 1e-15) {
+                std::feraiseexcept(FE_DIVBYZERO);
+            }
+            return left_val / right_val;
+        case BinaryOp::Modulo:
+            if (std::abs(right_val) < 1e-15) {
+                std::feraiseexcept(FE_DIVBYZERO);
+            }
+            return std::fmod(left_val, right_val);
+        case BinaryOp::Power:
+            // 0^(-n) поднимает FE_DIVBYZERO, (-x)^(нецелое) — FE_INVALID
+            return std::pow(left_val, right_val);
+        case BinaryOp::BitwiseAnd:
+        case BinaryOp::BitwiseOr:
+        case BinaryOp::BitwiseXor:
+        case BinaryOp::LeftShift:
+        case BinaryOp::RightShift: {
+            constexpr double MAX_INT64 = static_cast<double>(INT64_MAX);
+            constexpr double MIN_INT64 = static_cast<double>(INT64_MIN);
+            // Отрицательная форма условий ловит и NaN
+            if (!(left_val <= MAX_INT64 && left_val >= MIN_INT64) ||
+                !(right_val <= MAX_INT64 && right_val >= MIN_INT64)) {
+                std::feraiseexcept(FE_INVALID);
+                return 0.0;
+            }
+            int64_t left_int = static_cast<int64_t>(left_val);
+            int64_t right_int = static_cast<int64_t>(right_val);
+            switch (op) {
+                case BinaryOp::BitwiseAnd:
+                    return static_cast<double>(left_int & right_int);
+                case BinaryOp::BitwiseOr:
+                    return static_cast<double>(left_int | right_int);
+                case BinaryOp::BitwiseXor:
+                    return static_cast<double>(left_int ^ right_int);
+                default:
+                    break;
+            }
+            if (right_int < 0 || right_int >= 64) {
+                std::feraiseexcept(FE_INVALID);
+                return 0.0;
+            }
+            return static_cast<double>(op == BinaryOp::LeftShift
+                                       ? left_int << right_int
+                                       : left_int >> right_int);
+        }
+        case BinaryOp::Less:
+        case BinaryOp::LessEqual:
+        case BinaryOp::Greater:
+        case BinaryOp::GreaterEqual:
+        case BinaryOp::Equal:
+        case BinaryOp::NotEqual:
+            // NaN-операнд уже поднял флаг там, где был получен
+            return applyComparison(op, left_val, right_val);
+    }
+    std::feraiseexcept(FE_INVALID);
+    return 0.0;
+}
+
 class BinaryOpNode : public Node {
 public:
     BinaryOpNode(BinaryOp op, std::unique_ptr<Node> left, std::unique_ptr<Node> right)
@@ -34,127 +270,29 @@ public:
         
         double left_val = left_->evaluate();
         double right_val = right_->evaluate();
-        
-        // Проверка на NaN и Infinity
-        if (std::isnan(left_val) || std::isnan(right_val)) {
-            throw EvalError("Invalid operand: NaN");
-        }
-        if (std::isinf(left_val) || std::isinf(right_val)) {
-            throw EvalError("Invalid operand: Infinity");
+        return applyBinary(op_, left_val, right_val);
+    }
+    
+    double evaluateUnchecked() const override {
+        if (!left_ || !right_) {
+            std::feraiseexcept(FE_INVALID);
+            return 0.0;
         }
         
-        double result = 0.0;
-        
-        switch (op_) {
-            case BinaryOp::Add:
-                result = left_val + right_val;
-                if (std::isinf(result)) {
-                    throw EvalError("Overflow in addition");
-                }
-                return result;
-                
-            case BinaryOp::Subtract:
-                result = left_val - right_val;
-                if (std::isinf(result)) {
-                    throw EvalError("Overflow in subtraction");
-                }
-                return result;
-                
-            case BinaryOp::Multiply:
-                result = left_val * right_val;
-                if (std::isinf(result)) {
-                    throw EvalError("Overflow in multiplication");
-                }
-                return result;
-                
-            case BinaryOp::Divide:
-                if (std::abs(right_val) < 1e-15) {
-                    throw EvalError("Division by zero");
-                }
-                result = left_val / right_val;
-                if (std::isinf(result)) {
-                    throw EvalError("Overflow in division");
-                }
-                return result;
-                
-            case BinaryOp::Modulo:
-                if (std::abs(right_val) < 1e-15) {
-                    throw EvalError("Modulo by zero");
-                }
-                result = std::fmod(left_val, right_val);
-                return result;
-                
-            case BinaryOp::Power:
-                // Проверка на потенциальное переполнение
-                if (left_val == 0.0 && right_val < 0.0) {
-                    throw EvalError("Zero to negative power");
-                }
-                if (left_val < 0.0 && std::floor(right_val) != right_val) {
-                    throw EvalError("Negative base with non-integer exponent");
-                }
-                result = std::pow(left_val, right_val);
-                if (std::isinf(result)) {
-                    throw EvalError("Overflow in power operation");
-                }
-                if (std::isnan(result)) {
-                    throw EvalError("Invalid power operation result");
-                }
-                return result;
-                
-            // Битовые операции
-            case BinaryOp::BitwiseAnd:
-            case BinaryOp::BitwiseOr:
-            case BinaryOp::BitwiseXor:
-            case BinaryOp::LeftShift:
-            case BinaryOp::RightShift: {
-                // Проверка диапазона для битовых операций
-                constexpr double MAX_INT64 = static_cast<double>(INT64_MAX);
-                constexpr double MIN_INT64 = static_cast<double>(INT64_MIN);
-                
-                if (left_val > MAX_INT64 || left_val < MIN_INT64) {
-                    throw EvalError("Left operand out of int64 range for bitwise operation");
-                }
-                if (right_val > MAX_INT64 || right_val < MIN_INT64) {
-                    throw EvalError("Right operand out of int64 range for bitwise operation");
-                }
-                
-                int64_t left_int = static_cast<int64_t>(left_val);
-                int64_t right_int = static_cast<int64_t>(right_val);
-                
-                // Дополнительные проверки для сдвигов
-                if (op_ == BinaryOp::LeftShift || op_ == BinaryOp::RightShift) {
-                    if (right_int < 0) {
-                        throw EvalError("Negative shift count");
-                    }
-                    if (right_int >= 64) {
-                        throw EvalError("Shift count too large (>= 64)");
-                    }
-                }
-                
-                int64_t int_result = 0;
-                switch (op_) {
-                    case BinaryOp::BitwiseAnd:
-                        int_result = left_int & right_int;
-                        break;
-                    case BinaryOp::BitwiseOr:
-                        int_result = left_int | right_int;
-                        break;
-                    case BinaryOp::BitwiseXor:
-                        int_result = left_int ^ right_int;
-                        break;
-                    case BinaryOp::LeftShift:
-                        int_result = left_int << right_int;
-                        break;
-                    case BinaryOp::RightShift:
-                        int_result = left_int >> right_int;
-                        break;
-                    default:
-                        break;
-                }
-                return static_cast<double>(int_result);
-            }
-        }
-        throw EvalError("Unknown binary operator");
+        double left_val = left_->evaluateUnchecked();
+        double right_val = right_->evaluateUnchecked();
+        return applyBinaryUnchecked(op_, left_val, right_val);
+    }
+    
+    BinaryOp op() const { return op_; }
+    const Node* left() const { return left_.get(); }
+    const Node* right() const { return right_.get(); }
+    std::unique_ptr<Node> releaseLeft() { return std::move(left_); }
+    std::unique_ptr<Node> releaseRight() { return std::move(right_); }
+    
+    size_t childCount() const override { return 2; }
+    const Node* child(size_t index) const override {
+        return index == 0 ? left_.get() : (index == 1 ? right_.get() : nullptr);
     }
     
 private:
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "node.hpp"
+#include "../error.hpp"
+#include <memory>
+#include <cfenv>
+
+namespace calc {
+
+/**
+ * @brief Условное выражение: cond ? then : else или if(cond, then, else)
+ *
+ * Условие истинно, если его значение не равно нулю. Вычисляется только
+ * выбранная ветвь, поэтому ошибки невыбранной ветви не возникают:
+ * x > 0 ? ln(x) : 0 определено для любого x.
+ */
+class ConditionalNode : public Node {
+public:
+    ConditionalNode(std::unique_ptr<Node> condition, std::unique_ptr<Node> thenBranch,
+                    std::unique_ptr<Node> elseBranch)
+        : condition_(std::move(condition)), then_(std::move(thenBranch)),
+          else_(std::move(elseBranch)) {}
+
+    double evaluate() const override {
+        if (!condition_ || !then_ || !else_) {
+            throw EvalError("Invalid operands: null pointer");
+        }
+
+        return condition_->evaluate() != 0.0 ? then_->evaluate() : else_->evaluate();
+    }
+
+    double evaluateUnchecked() const override {
+        if (!condition_ || !then_ || !else_) {
+            std::feraiseexcept(FE_INVALID);
+            return 0.0;
+        }
+
+        // NaN в условии уже поднял флаг; выбор ветви для него не важен
+        return condition_->evaluateUnchecked() != 0.0 ? then_->evaluateUnchecked()
+                                                      : else_->evaluateUnchecked();
+    }
+
+    const Node* condition() const { return condition_.get(); }
+    const Node* thenBranch() const { return then_.get(); }
+    const Node* elseBranch() const { return else_.get(); }
+    std::unique_ptr<Node> releaseCondition() { return std::move(condition_); }
+    std::unique_ptr<Node> releaseThen() { return std::move(then_); }
+    std::unique_ptr<Node> releaseElse() { return std::move(else_); }
+
+    size_t childCount() const override { return 3; }
+    const Node* child(size_t index) const override {
+        switch (index) {
+            case 0: return condition_.get();
+            case 1: return then_.get();
+            case 2: return else_.get();
+            default: return nullptr;
+        }
+    }
+
+private:
+    std::unique_ptr<Node> condition_;
+    std::unique_ptr<Node> then_;
+    std::unique_ptr<Node> else_;
+};
+
+} // namespace calc
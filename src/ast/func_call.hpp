@@ -4,16 +4,258 @@
 #include "../error.hpp"
 #include <memory>
 #include <cmath>
+#include <cfenv>
 #include <string>
 #include <unordered_map>
-#include <functional>
 
 namespace calc {
 
+/**
+ * @brief Встроенные функции (идентификатор для путей без поиска по имени)
+ */
+enum class Function {
+    Sin, Cos, Tan,
+    Asin, Acos, Atan,
+    Sinh, Cosh, Tanh,
+    Log, Ln, Log10,
+    Exp, Sqrt,
+    Abs, Ceil, Floor, Round,
+    Factorial,
+    Unknown
+};
+
+inline Function lookupFunction(const std::string& name) {
+    static const std::unordered_map<std::string, Function> ids = {
+        {"sin", Function::Sin}, {"cos", Function::Cos}, {"tan", Function::Tan},
+        {"asin", Function::Asin}, {"acos", Function::Acos}, {"atan", Function::Atan},
+        {"sinh", Function::Sinh}, {"cosh", Function::Cosh}, {"tanh", Function::Tanh},
+        {"log", Function::Log}, {"ln", Function::Ln}, {"log10", Function::Log10},
+        {"exp", Function::Exp}, {"sqrt", Function::Sqrt},
+        {"abs", Function::Abs}, {"ceil", Function::Ceil},
+        {"floor", Function::Floor}, {"round", Function::Round},
+        {"factorial", Function::Factorial}
+    };
+    auto it = ids.find(name);
+    return it == ids.end() ? Function::Unknown : it->second;
+}
+
+/**
+ * @brief Имя встроенной функции (для сообщений об ошибках)
+ */
+inline const char* functionName(Function function) {
+    switch (function) {
+        case Function::Sin: return "sin";
+        case Function::Cos: return "cos";
+        case Function::Tan: return "tan";
+        case Function::Asin: return "asin";
+        case Function::Acos: return "acos";
+        case Function::Atan: return "atan";
+        case Function::Sinh: return "sinh";
+        case Function::Cosh: return "cosh";
+        case Function::Tanh: return "tanh";
+        case Function::Log: return "log";
+        case Function::Ln: return "ln";
+        case Function::Log10: return "log10";
+        case Function::Exp: return "exp";
+        case Function::Sqrt: return "sqrt";
+        case Function::Abs: return "abs";
+        case Function::Ceil: return "ceil";
+        case Function::Floor: return "floor";
+        case Function::Round: return "round";
+        case Function::Factorial: return "factorial";
+        case Function::Unknown: break;
+    }
+    return "unknown";
+}
+
+inline void checkFunctionArgument(double val) {
+    // Проверка на NaN и Infinity во входных данных
+    if (std::isnan(val)) {
+        throw EvalError("Invalid function argument: NaN");
+    }
+    if (std::isinf(val)) {
+        throw EvalError("Invalid function argument: Infinity");
+    }
+}
+
+/**
+ * @brief Значение встроенной функции с проверками (ошибки — EvalError)
+ *
+ * Общая часть FuncCallNode и плоских программ (program.hpp).
+ */
+inline double applyFunction(Function function, double x) {
+    checkFunctionArgument(x);
+    
+    double result = 0.0;
+    switch (function) {
+        // Базовые тригонометрические функции
+        case Function::Sin:
+            result = std::sin(x);
+            if (std::isnan(result)) throw EvalError("sin: invalid result");
+            break;
+        case Function::Cos:
+            result = std::cos(x);
+            if (std::isnan(result)) throw EvalError("cos: invalid result");
+            break;
+        case Function::Tan:
+            result = std::tan(x);
+            if (std::isnan(result) || std::isinf(result)) {
+                throw EvalError("tan: result is undefined or infinite");
+            }
+            break;
+            
+        // Обратные тригонометрические функции
+        case Function::Asin:
+            if (x < -1.0 || x > 1.0) {
+                throw EvalError("asin: argument must be in range [-1, 1]");
+            }
+            result = std::asin(x);
+            break;
+        case Function::Acos:
+            if (x < -1.0 || x > 1.0) {
+                throw EvalError("acos: argument must be in range [-1, 1]");
+            }
+            result = std::acos(x);
+            break;
+        case Function::Atan:
+            result = std::atan(x);
+            break;
+            
+        // Гиперболические функции
+        case Function::Sinh:
+            result = std::sinh(x);
+            if (std::isinf(result)) throw EvalError("sinh: overflow");
+            break;
+        case Function::Cosh:
+            result = std::cosh(x);
+            if (std::isinf(result)) throw EvalError("cosh: overflow");
+            break;
+        case Function::Tanh:
+            result = std::tanh(x);
+            break;
+            
+        // Логарифмические функции
+        case Function::Log:
+        case Function::Ln:
+        case Function::Log10:
+            if (x <= 0.0) {
+                throw EvalError(std::string(functionName(function)) + ": argument must be positive");
+            }
+            result = function == Function::Log10 ? std::log10(x) : std::log(x);
+            if (std::isinf(result)) {
+                throw EvalError(std::string(functionName(function)) + ": result is infinite");
+            }
+            break;
+            
+        // Экспонента и корень
+        case Function::Exp:
+            if (x > 709.0) throw EvalError("exp: argument too large, would overflow");
+            result = std::exp(x);
+            if (std::isinf(result)) throw EvalError("exp: overflow");
+            break;
+        case Function::Sqrt:
+            if (x < 0.0) throw EvalError("sqrt: argument must be non-negative");
+            result = std::sqrt(x);
+            break;
+            
+        // Дополнительные математические функции
+        case Function::Abs:
+            result = std::abs(x);
+            break;
+        case Function::Ceil:
+            result = std::ceil(x);
+            break;
+        case Function::Floor:
+            result = std::floor(x);
+            break;
+        case Function::Round:
+            result = std::round(x);
+            break;
+            
+        // Факториал (для целых чисел)
+        case Function::Factorial:
+            if (x < 0.0) {
+                throw EvalError("factorial: argument must be non-negative");
+            }
+            if (x != std::floor(x)) {
+                throw EvalError("factorial: argument must be an integer");
+            }
+            if (x > 170.0) {
+                throw EvalError("factorial: argument too large (max 170)");
+            }
+            result = 1.0;
+            for (int i = 2; i <= static_cast<int>(x); ++i) {
+                result *= i;
+                if (std::isinf(result)) {
+                    throw EvalError("factorial: overflow during calculation");
+                }
+            }
+            break;
+            
+        case Function::Unknown:
+            throw EvalError("Unknown function");
+    }
+    
+    // Финальная проверка результата
+    if (std::isnan(result)) {
+        throw EvalError(std::string(functionName(function)) + ": result is NaN");
+    }
+    
+    return result;
+}
+
+/**
+ * @brief Значение встроенной функции без проверок (см. Node::evaluateUnchecked)
+ */
+inline double applyFunctionUnchecked(Function function, double x) {
+    // Выход за область определения libm отмечает FE_INVALID/FE_DIVBYZERO,
+    // переполнение sinh/cosh/exp — FE_OVERFLOW
+    switch (function) {
+        case Function::Sin: return std::sin(x);
+        case Function::Cos: return std::cos(x);
+        case Function::Tan: return std::tan(x);
+        case Function::Asin: return std::asin(x);
+        case Function::Acos: return std::acos(x);
+        case Function::Atan: return std::atan(x);
+        case Function::Sinh: return std::sinh(x);
+        case Function::Cosh: return std::cosh(x);
+        case Function::Tanh: return std::tanh(x);
+        case Function::Log:
+        case Function::Ln: return std::log(x);
+        case Function::Log10: return std::log10(x);
+        case Function::Exp:
+            // Проверенный режим отвергает x > 709 раньше фактического переполнения
+            if (x > 709.0) {
+                std::feraiseexcept(FE_OVERFLOW);
+            }
+            return std::exp(x);
+        case Function::Sqrt: return std::sqrt(x);
+        case Function::Abs: return std::abs(x);
+        case Function::Ceil: return std::ceil(x);
+        case Function::Floor: return std::floor(x);
+        case Function::Round: return std::round(x);
+        case Function::Factorial: {
+            if (!(x >= 0.0) || x != std::floor(x) || x > 170.0) {
+                std::feraiseexcept(FE_INVALID);
+                return 0.0;
+            }
+            double result = 1.0;
+            for (int i = 2; i <= static_cast<int>(x); ++i) {
+                result *= i;
+            }
+            return result;
+        }
+        case Function::Unknown:
+            break;
+    }
+    std::feraiseexcept(FE_INVALID);
+    return 0.0;
+}
+
 class FuncCallNode : public Node {
 public:
     FuncCallNode(const std::string& name, std::unique_ptr<Node> arg)
-        : name_(name), arg_(std::move(arg)) {}
+        : name_(name), function_(lookupFunction(name)), arg_(std::move(arg)) {}
     
     double evaluate() const override {
         if (!arg_) {
@@ -22,140 +264,36 @@ public:
         
         double val = arg_->evaluate();
         
-        // Проверка на NaN и Infinity во входных данных
-        if (std::isnan(val)) {
-            throw EvalError("Invalid function argument: NaN");
-        }
-        if (std::isinf(val)) {
-            throw EvalError("Invalid function argument: Infinity");
-        }
-        
-        static const std::unordered_map<std::string, std::function<double(double)>> funcs = {
-            // Базовые тригонометрические функции
-            {"sin", [](double x) { 
-                double result = std::sin(x);
-                if (std::isnan(result)) throw EvalError("sin: invalid result");
-                return result;
-            }},
-            {"cos", [](double x) { 
-                double result = std::cos(x);
-                if (std::isnan(result)) throw EvalError("cos: invalid result");
-                return result;
-            }},
-            {"tan", [](double x) { 
-                double result = std::tan(x);
-                if (std::isnan(result) || std::isinf(result)) {
-                    throw EvalError("tan: result is undefined or infinite");
-                }
-                return result;
-            }},
-            
-            // Обратные тригонометрические функции
-            {"asin", [](double x) { 
-                if (x < -1.0 || x > 1.0) {
-                    throw EvalError("asin: argument must be in range [-1, 1]");
-                }
-                return std::asin(x); 
-            }},
-            {"acos", [](double x) { 
-                if (x < -1.0 || x > 1.0) {
-                    throw EvalError("acos: argument must be in range [-1, 1]");
-                }
-                return std::acos(x); 
-            }},
-            {"atan", [](double x) { return std::atan(x); }},
-            
-            // Гиперболические функции
-            {"sinh", [](double x) { 
-                double result = std::sinh(x);
-                if (std::isinf(result)) throw EvalError("sinh: overflow");
-                return result;
-            }},
-            {"cosh", [](double x) { 
-                double result = std::cosh(x);
-                if (std::isinf(result)) throw EvalError("cosh: overflow");
-                return result;
-            }},
-            {"tanh", [](double x) { return std::tanh(x); }},
-            
-            // Логарифмические функции
-            {"log", [](double x) { 
-                if (x <= 0.0) throw EvalError("log: argument must be positive");
-                double result = std::log(x);
-                if (std::isinf(result)) throw EvalError("log: result is infinite");
-                return result;
-            }},
-            {"ln", [](double x) { 
-                if (x <= 0.0) throw EvalError("ln: argument must be positive");
-                double result = std::log(x);
-                if (std::isinf(result)) throw EvalError("ln: result is infinite");
-                return result;
-            }},
-            {"log10", [](double x) { 
-                if (x <= 0.0) throw EvalError("log10: argument must be positive");
-                double result = std::log10(x);
-                if (std::isinf(result)) throw EvalError("log10: result is infinite");
-                return result;
-            }},
-            
-            // Экспонента и корень
-            {"exp", [](double x) { 
-                if (x > 709.0) throw EvalError("exp: argument too large, would overflow");
-                double result = std::exp(x);
-                if (std::isinf(result)) throw EvalError("exp: overflow");
-                return result;
-            }},
-            {"sqrt", [](double x) { 
-                if (x < 0.0) throw EvalError("sqrt: argument must be non-negative");
-                return std::sqrt(x); 
-            }},
-            
-            // Дополнительные математические функции
-            {"abs", [](double x) { return std::abs(x); }},
-            {"ceil", [](double x) { return std::ceil(x); }},
-            {"floor", [](double x) { return std::floor(x); }},
-            {"round", [](double x) { return std::round(x); }},
-            
-            // Факториал (для целых чисел)
-            {"factorial", [](double x) {
-                if (x < 0.0) {
-                    throw EvalError("factorial: argument must be non-negative");
-                }
-                if (x != std::floor(x)) {
-                    throw EvalError("factorial: argument must be an integer");
-                }
-                if (x > 170.0) {
-                    throw EvalError("factorial: argument too large (max 170)");
-                }
-                
-                double result = 1.0;
-                for (int i = 2; i <= static_cast<int>(x); ++i) {
-                    result *= i;
-                    if (std::isinf(result)) {
-                        throw EvalError("factorial: overflow during calculation");
-                    }
-                }
-                return result;
-            }}
-        };
-        
-        auto it = funcs.find(name_);
-        if (it == funcs.end()) {
+        if (function_ == Function::Unknown) {
+            checkFunctionArgument(val);
             throw EvalError("Unknown function: " + name_);
         }
         
-        double result = it->second(val);
-        
-        // Финальная проверка результата
-        if (std::isnan(result)) {
-            throw EvalError(name_ + ": result is NaN");
+        return applyFunction(function_, val);
+    }
+    
+    double evaluateUnchecked() const override {
+        if (!arg_) {
+            std::feraiseexcept(FE_INVALID);
+            return 0.0;
         }
         
-        return result;
+        return applyFunctionUnchecked(function_, arg_->evaluateUnchecked());
+    }
+    
+    const std::string& name() const { return name_; }
+    Function function() const { return function_; }
+    const Node* argument() const { return arg_.get(); }
+    std::unique_ptr<Node> releaseArgument() { return std::move(arg_); }
+    
+    size_t childCount() const override { return 1; }
+    const Node* child(size_t index) const override {
+        return index == 0 ? arg_.get() : nullptr;
     }
     
 private:
     std::string name_;
+    Function function_;
     std::unique_ptr<Node> arg_;
 };
 
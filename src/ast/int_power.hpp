@@ -0,0 +1,113 @@
+#pragma once
+
+#include "node.hpp"
+#include "../error.hpp"
+#include <memory>
+#include <cmath>
+#include <cfenv>
+
+namespace calc {
+
+/**
+ * @brief x^exponent цепочкой умножений с проверками (ошибки — EvalError)
+ */
+inline double applyIntPower(double x, int exponent) {
+    if (std::isnan(x)) {
+        throw EvalError("Invalid operand: NaN");
+    }
+    if (std::isinf(x)) {
+        throw EvalError("Invalid operand: Infinity");
+    }
+    if (x == 0.0 && exponent < 0) {
+        throw EvalError("Zero to negative power");
+    }
+    
+    // Бинарное возведение в степень
+    unsigned n = exponent < 0 ? 0u - static_cast<unsigned>(exponent)
+                              : static_cast<unsigned>(exponent);
+    double result = 1.0;
+    double factor = x;
+    while (n != 0) {
+        if (n & 1u) {
+            result *= factor;
+        }
+        n >>= 1;
+        if (n != 0) {
+            factor *= factor;
+        }
+    }
+    if (exponent < 0) {
+        result = 1.0 / result;
+    }
+    
+    if (std::isinf(result)) {
+        throw EvalError("Overflow in power operation");
+    }
+    return result;
+}
+
+/**
+ * @brief x^exponent цепочкой умножений без проверок
+ */
+inline double applyIntPowerUnchecked(double x, int exponent) {
+    // 1/0 поднимает FE_DIVBYZERO, переполнение — FE_OVERFLOW
+    unsigned n = exponent < 0 ? 0u - static_cast<unsigned>(exponent)
+                              : static_cast<unsigned>(exponent);
+    double result = 1.0;
+    double factor = x;
+    while (n != 0) {
+        if (n & 1u) {
+            result *= factor;
+        }
+        n >>= 1;
+        if (n != 0) {
+            factor *= factor;
+        }
+    }
+    return exponent < 0 ? 1.0 / result : result;
+}
+
+/**
+ * @brief Возведение в целую степень цепочкой умножений
+ *
+ * Создаётся оптимизатором (только в режиме fastMath) вместо Power с
+ * константным целым показателем: std::pow округляет не всегда так же,
+ * как цепочка умножений. Сообщения об ошибках совпадают с BinaryOp::Power.
+ */
+class IntPowerNode : public Node {
+public:
+    IntPowerNode(std::unique_ptr<Node> base, int exponent)
+        : base_(std::move(base)), exponent_(exponent) {}
+    
+    double evaluate() const override {
+        if (!base_) {
+            throw EvalError("Invalid operands: null pointer");
+        }
+        
+        return applyIntPower(base_->evaluate(), exponent_);
+    }
+    
+    double evaluateUnchecked() const override {
+        if (!base_) {
+            std::feraiseexcept(FE_INVALID);
+            return 0.0;
+        }
+        
+        return applyIntPowerUnchecked(base_->evaluateUnchecked(), exponent_);
+    }
+    
+    const Node* base() const { return base_.get(); }
+    int exponent() const { return exponent_; }
+    std::unique_ptr<Node> releaseBase() { return std::move(base_); }
+    
+    size_t childCount() const override { return 1; }
+    const Node* child(size_t index) const override {
+        return index == 0 ? base_.get() : nullptr;
+    }
+    
+private:
+    std::unique_ptr<Node> base_;
+    int exponent_;
+};
+
+} // namespace calc
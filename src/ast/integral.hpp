@@ -0,0 +1,95 @@
+#pragma once
+
+#include "node.hpp"
+#include <memory>
+#include <string>
+
+namespace calc {
+
+/**
+ * @brief Итог последнего вычисления integrate()
+ */
+struct IntegrationReport {
+    double value = 0.0;
+    double errorEstimate = 0.0;     // Оценка абсолютной ошибки
+    size_t evaluations = 0;         // Вычислений подынтегральной функции
+    size_t intervals = 0;           // Подынтервалов в итоговом разбиении
+};
+
+class IntegralNode;
+
+/**
+ * @brief Значение integrate() с проверками (ошибки — EvalError), см. integral.cpp
+ *
+ * threads — число потоков (0 — по числу ядер); результат от него не зависит.
+ */
+double evaluateIntegral(const IntegralNode& node, size_t threads = 0);
+
+/**
+ * @brief integrate(expr, x, a, b) и integrate(expr, x, a, b, tol)
+ *
+ * Адаптивная квадратура Гаусса–Кронрода 7–15. Требуемая точность:
+ * оценка ошибки не больше tol * max(1, |результат|), по умолчанию
+ * tol = 1e-10; если её не достичь за бюджет вычислений, выбрасывается
+ * EvalError с достигнутой оценкой. Переменная интегрирования, как и
+ * переменная цикла sum, видна только в expr и принадлежит узлу.
+ */
+class IntegralNode : public Node {
+public:
+    IntegralNode(std::string variable, std::unique_ptr<double> cell, std::unique_ptr<Node> body,
+                 std::unique_ptr<Node> lower, std::unique_ptr<Node> upper,
+                 std::unique_ptr<Node> tolerance = nullptr)
+        : variable_(std::move(variable)), cell_(std::move(cell)), body_(std::move(body)),
+          lower_(std::move(lower)), upper_(std::move(upper)), tolerance_(std::move(tolerance)) {}
+
+    double evaluate() const override {
+        return evaluateIntegral(*this);
+    }
+
+    double evaluateUnchecked() const override {
+        return evaluateIsolated();
+    }
+
+    const std::string& variable() const { return variable_; }
+    double* cell() const { return cell_.get(); }
+    const Node* body() const { return body_.get(); }
+    const Node* lower() const { return lower_.get(); }
+    const Node* upper() const { return upper_.get(); }
+    const Node* tolerance() const { return tolerance_.get(); }  // nullptr — по умолчанию
+    std::unique_ptr<double> releaseCell() { return std::move(cell_); }
+    std::unique_ptr<Node> releaseBody() { return std::move(body_); }
+    std::unique_ptr<Node> releaseLower() { return std::move(lower_); }
+    std::unique_ptr<Node> releaseUpper() { return std::move(upper_); }
+    std::unique_ptr<Node> releaseTolerance() { return std::move(tolerance_); }
+
+    /**
+     * @brief Оценка ошибки и затраты последнего успешного вычисления
+     *
+     * Как и ячейка переменной, не предназначен для одновременного
+     * вычисления узла из нескольких потоков.
+     */
+    const IntegrationReport& report() const { return report_; }
+    void setReport(const IntegrationReport& report) const { report_ = report; }
+
+    size_t childCount() const override { return tolerance_ ? 4 : 3; }
+    const Node* child(size_t index) const override {
+        switch (index) {
+            case 0: return body_.get();
+            case 1: return lower_.get();
+            case 2: return upper_.get();
+            case 3: return tolerance_.get();
+            default: return nullptr;
+        }
+    }
+
+private:
+    std::string variable_;
+    std::unique_ptr<double> cell_;
+    std::unique_ptr<Node> body_;
+    std::unique_ptr<Node> lower_;
+    std::unique_ptr<Node> upper_;
+    std::unique_ptr<Node> tolerance_;
+    mutable IntegrationReport report_;
+};
+
+} // namespace calc
@@ -1,11 +1,51 @@
 #pragma once
 
+#include "../error.hpp"
+#include <cfenv>
+#include <cstddef>
+
 namespace calc {
 
 class Node {
 public:
     virtual ~Node() = default;
     virtual double evaluate() const = 0;
+    
+    /**
+     * @brief Вычисление без проверок после каждой операции
+     *
+     * Ошибки не выбрасываются, а оставляют флаги FE_INVALID, FE_DIVBYZERO
+     * или FE_OVERFLOW из <cfenv>; условия, которые IEEE 754 не отмечает
+     * флагами (например, деление на 1e-16), поднимают их явно.
+     * Используется Evaluator в режиме EvalMode::Deferred.
+     */
+    virtual double evaluateUnchecked() const { return evaluate(); }
+    
+    // Обход дерева (оптимизатор, подсчёт узлов)
+    virtual size_t childCount() const { return 0; }
+    virtual const Node* child(size_t /*index*/) const { return nullptr; }
+
+protected:
+    /**
+     * @brief evaluateUnchecked для узлов, которые проверяют себя сами
+     *
+     * Флаги, поднятые внутри evaluate (перебор sum, точки integrate), наружу
+     * не попадают, а ошибка отмечается FE_INVALID, чтобы Evaluator повторил
+     * вычисление с проверками и получил сообщение в порядке режима Checked.
+     */
+    double evaluateIsolated() const {
+        std::fexcept_t saved;
+        std::fegetexceptflag(&saved, FE_ALL_EXCEPT);
+        try {
+            double value = evaluate();
+            std::fesetexceptflag(&saved, FE_ALL_EXCEPT);
+            return value;
+        } catch (const EvalError&) {
+            std::fesetexceptflag(&saved, FE_ALL_EXCEPT);
+            std::feraiseexcept(FE_INVALID);
+            return 0.0;
+        }
+    }
 };
 
 } // namespace calc
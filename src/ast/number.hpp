@@ -12,6 +12,12 @@ public:
         return value_;
     }
     
+    double evaluateUnchecked() const override {
+        return value_;
+    }
+    
+    double value() const { return value_; }
+    
 private:
     double value_;
 };
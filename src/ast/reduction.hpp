@@ -0,0 +1,78 @@
+#pragma once
+
+#include "node.hpp"
+#include <memory>
+#include <string>
+
+namespace calc {
+
+enum class ReductionKind {
+    Sum,
+    Product
+};
+
+class ReductionNode;
+
+/**
+ * @brief Значение sum/prod с проверками (ошибки — EvalError), см. reduction.cpp
+ *
+ * threads — число потоков для длинных диапазонов (0 — по числу ядер);
+ * результат от него не зависит.
+ */
+double evaluateReduction(const ReductionNode& node, size_t threads = 0);
+
+/**
+ * @brief sum(i, from, to, body) и prod(i, from, to, body)
+ *
+ * Переменная цикла видна только в body; её ячейка принадлежит узлу, и
+ * узлы VariableNode тела ссылаются на неё. Границы — целые числа, пустой
+ * диапазон (to < from) даёт 0 для суммы и 1 для произведения. Ошибка
+ * слагаемого (множителя) сообщается для наименьшего i.
+ */
+class ReductionNode : public Node {
+public:
+    ReductionNode(ReductionKind kind, std::string variable, std::unique_ptr<double> cell,
+                  std::unique_ptr<Node> from, std::unique_ptr<Node> to, std::unique_ptr<Node> body)
+        : kind_(kind), variable_(std::move(variable)), cell_(std::move(cell)),
+          from_(std::move(from)), to_(std::move(to)), body_(std::move(body)) {}
+
+    double evaluate() const override {
+        return evaluateReduction(*this);
+    }
+
+    double evaluateUnchecked() const override {
+        return evaluateIsolated();
+    }
+
+    ReductionKind kind() const { return kind_; }
+    const char* name() const { return kind_ == ReductionKind::Sum ? "sum" : "prod"; }
+    const std::string& variable() const { return variable_; }
+    double* cell() const { return cell_.get(); }
+    const Node* from() const { return from_.get(); }
+    const Node* to() const { return to_.get(); }
+    const Node* body() const { return body_.get(); }
+    std::unique_ptr<double> releaseCell() { return std::move(cell_); }
+    std::unique_ptr<Node> releaseFrom() { return std::move(from_); }
+    std::unique_ptr<Node> releaseTo() { return std::move(to_); }
+    std::unique_ptr<Node> releaseBody() { return std::move(body_); }
+
+    size_t childCount() const override { return 3; }
+    const Node* child(size_t index) const override {
+        switch (index) {
+            case 0: return from_.get();
+            case 1: return to_.get();
+            case 2: return body_.get();
+            default: return nullptr;
+        }
+    }
+
+private:
+    ReductionKind kind_;
+    std::string variable_;
+    std::unique_ptr<double> cell_;
+    std::unique_ptr<Node> from_;
+    std::unique_ptr<Node> to_;
+    std::unique_ptr<Node> body_;
+};
+
+} // namespace calc
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "node.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace calc {
+
+/**
+ * @brief Итог последнего вычисления solve()
+ */
+struct SolveReport {
+    std::vector<double> roots;      // Все найденные корни по возрастанию
+    size_t evaluations = 0;         // Вычислений функции (просмотр и уточнение)
+    size_t brackets = 0;            // Отрезков со сменой знака
+};
+
+class SolveNode;
+
+/**
+ * @brief Все корни expr на [lo, hi] по возрастанию (ошибки — EvalError), см. solve.cpp
+ *
+ * threads — число потоков (0 — по числу ядер); результат от него не зависит.
+ */
+std::vector<double> findRoots(const SolveNode& node, size_t threads = 0);
+
+/**
+ * @brief Значение solve(): n-й по возрастанию корень
+ */
+double evaluateSolve(const SolveNode& node, size_t threads = 0);
+
+/**
+ * @brief solve(expr, x, lo, hi) и solve(expr, x, lo, hi, n)
+ *
+ * Отрезок просматривается на равномерной сетке; каждый отрезок сетки со
+ * сменой знака уточняется методом Брента. Находятся корни со сменой знака
+ * и корни, попавшие точно в узлы сетки; полюсы (1/x) отбрасываются.
+ * Значение — n-й по возрастанию корень (по умолчанию первый).
+ */
+class SolveNode : public Node {
+public:
+    SolveNode(std::string variable, std::unique_ptr<double> cell, std::unique_ptr<Node> body,
+              std::unique_ptr<Node> lower, std::unique_ptr<Node> upper,
+              std::unique_ptr<Node> index = nullptr)
+        : variable_(std::move(variable)), cell_(std::move(cell)), body_(std::move(body)),
+          lower_(std::move(lower)), upper_(std::move(upper)), index_(std::move(index)) {}
+
+    double evaluate() const override {
+        return evaluateSolve(*this);
+    }
+
+    double evaluateUnchecked() const override {
+        return evaluateIsolated();
+    }
+
+    const std::string& variable() const { return variable_; }
+    double* cell() const { return cell_.get(); }
+    const Node* body() const { return body_.get(); }
+    const Node* lower() const { return lower_.get(); }
+    const Node* upper() const { return upper_.get(); }
+    const Node* index() const { return index_.get(); }     // nullptr — первый корень
+    std::unique_ptr<double> releaseCell() { return std::move(cell_); }
+    std::unique_ptr<Node> releaseBody() { return std::move(body_); }
+    std::unique_ptr<Node> releaseLower() { return std::move(lower_); }
+    std::unique_ptr<Node> releaseUpper() { return std::move(upper_); }
+    std::unique_ptr<Node> releaseIndex() { return std::move(index_); }
+
+    /**
+     * @brief Корни и затраты последнего успешного поиска (см. IntegralNode::report)
+     */
+    const SolveReport& report() const { return report_; }
+    void setReport(SolveReport report) const { report_ = std::move(report); }
+
+    size_t childCount() const override { return index_ ? 4 : 3; }
+    const Node* child(size_t index) const override {
+        switch (index) {
+            case 0: return body_.get();
+            case 1: return lower_.get();
+            case 2: return upper_.get();
+            case 3: return index_.get();
+            default: return nullptr;
+        }
+    }
+
+private:
+    std::string variable_;
+    std::unique_ptr<double> cell_;
+    std::unique_ptr<Node> body_;
+    std::unique_ptr<Node> lower_;
+    std::unique_ptr<Node> upper_;
+    std::unique_ptr<Node> index_;
+    mutable SolveReport report_;
+};
+
+} // namespace calc
@@ -4,6 +4,8 @@
 #include "../error.hpp"
 #include <memory>
 #include <cmath>
+#include <cfenv>
+#include <cstdint>
 
 namespace calc {
 
@@ -13,6 +15,64 @@ enum class UnaryOp {
     BitwiseNot  // Битовое НЕ
 };
 
+/**
+ * @brief Значение унарной операции с проверками (ошибки — EvalError)
+ */
+inline double applyUnary(UnaryOp op, double val) {
+    // Проверка на NaN и Infinity
+    if (std::isnan(val)) {
+        throw EvalError("Invalid operand: NaN");
+    }
+    if (std::isinf(val)) {
+        throw EvalError("Invalid operand: Infinity");
+    }
+    
+    switch (op) {
+        case UnaryOp::Plus:
+            return val;
+            
+        case UnaryOp::Minus:
+            return -val;
+            
+        case UnaryOp::BitwiseNot: {
+            // Проверка диапазона для битовой операции
+            constexpr double MAX_INT64 = static_cast<double>(INT64_MAX);
+            constexpr double MIN_INT64 = static_cast<double>(INT64_MIN);
+            
+            if (val > MAX_INT64 || val < MIN_INT64) {
+                throw EvalError("Operand out of int64 range for bitwise NOT");
+            }
+            
+            int64_t int_val = static_cast<int64_t>(val);
+            return static_cast<double>(~int_val);
+        }
+    }
+    throw EvalError("Unknown unary operator");
+}
+
+/**
+ * @brief Значение унарной операции без проверок (см. Node::evaluateUnchecked)
+ */
+inline double applyUnaryUnchecked(UnaryOp op, double val) {
+    switch (op) {
+        case UnaryOp::Plus:
+            return val;
+        case UnaryOp::Minus:
+            return -val;
+        case UnaryOp::BitwiseNot: {
+            constexpr double MAX_INT64 = static_cast<double>(INT64_MAX);
+            constexpr double MIN_INT64 = static_cast<double>(INT64_MIN);
+            // Отрицательная форма условия ловит и NaN
+            if (!(val <= MAX_INT64 && val >= MIN_INT64)) {
+                std::feraiseexcept(FE_INVALID);
+                return 0.0;
+            }
+            return static_cast<double>(~static_cast<int64_t>(val));
+        }
+    }
+    std::feraiseexcept(FE_INVALID);
+    return 0.0;
+}
 
 class UnaryOpNode : public Node {
 public:
@@ -24,37 +84,25 @@ public:
             throw EvalError("Invalid operand: null pointer");
         }
         
-        double val = operand_->evaluate();
-        
-        // Проверка на NaN и Infinity
-        if (std::isnan(val)) {
-            throw EvalError("Invalid operand: NaN");
-        }
-        if (std::isinf(val)) {
-            throw EvalError("Invalid operand: Infinity");
+        return applyUnary(op_, operand_->evaluate());
+    }
+    
+    double evaluateUnchecked() const override {
+        if (!operand_) {
+            std::feraiseexcept(FE_INVALID);
+            return 0.0;
         }
         
-        switch (op_) {
-            case UnaryOp::Plus:
-                return val;
-                
-            case UnaryOp::Minus:
-                return -val;
-                
-            case UnaryOp::BitwiseNot: {
-                // Проверка диапазона для битовой операции
-                constexpr double MAX_INT64 = static_cast<double>(INT64_MAX);
-                constexpr double MIN_INT64 = static_cast<double>(INT64_MIN);
-                
-                if (val > MAX_INT64 || val < MIN_INT64) {
-                    throw EvalError("Operand out of int64 range for bitwise NOT");
-                }
-                
-                int64_t int_val = static_cast<int64_t>(val);
-                return static_cast<double>(~int_val);
-            }
-        }
-        throw EvalError("Unknown unary operator");
+        return applyUnaryUnchecked(op_, operand_->evaluateUnchecked());
+    }
+    
+    UnaryOp op() const { return op_; }
+    const Node* operand() const { return operand_.get(); }
+    std::unique_ptr<Node> releaseOperand() { return std::move(operand_); }
+    
+    size_t childCount() const override { return 1; }
+    const Node* child(size_t index) const override {
+        return index == 0 ? operand_.get() : nullptr;
     }
     
 private:
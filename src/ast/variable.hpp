@@ -0,0 +1,55 @@
+#pragma once
+
+#include "node.hpp"
+#include "../error.hpp"
+#include <cmath>
+#include <cfenv>
+#include <string>
+
+namespace calc {
+
+class VariableNode : public Node {
+public:
+    VariableNode(std::string name, const double* slot)
+        : name_(std::move(name)), slot_(slot) {}
+    
+    double evaluate() const override {
+        if (!slot_) {
+            throw EvalError("Unbound variable: " + name_);
+        }
+        
+        double val = *slot_;
+        
+        // Значения узлов всегда конечны: на это опираются остальные проверки
+        if (std::isnan(val)) {
+            throw EvalError("Invalid value of variable " + name_ + ": NaN");
+        }
+        if (std::isinf(val)) {
+            throw EvalError("Invalid value of variable " + name_ + ": Infinity");
+        }
+        
+        return val;
+    }
+    
+    double evaluateUnchecked() const override {
+        if (!slot_) {
+            std::feraiseexcept(FE_INVALID);
+            return 0.0;
+        }
+        double val = *slot_;
+        // Тихий NaN не поднимает флагов при дальнейших операциях
+        if (!std::isfinite(val)) {
+            std::feraiseexcept(FE_INVALID);
+        }
+        return val;
+    }
+    
+    const std::string& name() const { return name_; }
+    const double* slot() const { return slot_; }
+    
+private:
+    std::string name_;
+    const double* slot_;
+};
+
+} // namespace calc
@@ -0,0 +1,37 @@
+#include "async_evaluation.hpp"
+#include <chrono>
+#include <exception>
+#include <utility>
+
+namespace calc {
+
+AsyncEvaluation::AsyncEvaluation(std::unique_ptr<Node> root, AsyncOptions options)
+    : token_(options.token ? std::move(options.token) : std::make_shared<CancellationToken>()),
+      root_(std::move(root)) {
+    std::promise<double> promise;
+    result_ = promise.get_future();
+    thread_ = std::thread([this, promise = std::move(promise), options = std::move(options)]() mutable {
+        try {
+            CancellationScope scope(token_.get(), std::move(options.progress));
+            CancellationScope::checkpoint();
+            Evaluator evaluator(options.mode);
+            promise.set_value(evaluator.evaluate(root_));
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+        if (options.finished) {
+            options.finished();
+        }
+    });
+}
+
+AsyncEvaluation::~AsyncEvaluation() {
+    cancel();
+    thread_.join();
+}
+
+bool AsyncEvaluation::ready() const {
+    return result_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+} // namespace calc
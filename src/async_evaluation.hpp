@@ -0,0 +1,61 @@
+#pragma once
+
+#include "ast/node.hpp"
+#include "cancellation.hpp"
+#include "evaluator.hpp"
+#include <functional>
+#include <future>
+#include <memory>
+#include <thread>
+
+namespace calc {
+
+/**
+ * @brief Параметры AsyncEvaluation
+ */
+struct AsyncOptions {
+    EvalMode mode = EvalMode::Checked;
+    std::shared_ptr<CancellationToken> token;   // nullptr — собственный токен вычисления
+    ProgressCallback progress;                  // Вызывается в потоке вычисления
+    std::function<void()> finished;             // В потоке вычисления, когда результат готов
+};
+
+/**
+ * @brief Вычисление дерева в отдельном потоке
+ *
+ * Дерево принадлежит вычислению; ячейки его переменных (Variables, с
+ * которыми оно разобрано) должны жить до окончания и не меняться.
+ * Результат и исключения (ParseError, EvalError, CancelledError)
+ * передаются через std::future. Деструктор отменяет вычисление и ждёт
+ * поток; finished не должен уничтожать объект.
+ */
+class AsyncEvaluation {
+public:
+    explicit AsyncEvaluation(std::unique_ptr<Node> root, AsyncOptions options = {});
+    ~AsyncEvaluation();
+
+    AsyncEvaluation(const AsyncEvaluation&) = delete;
+    AsyncEvaluation& operator=(const AsyncEvaluation&) = delete;
+
+    /**
+     * @brief Отменить вычисление; get() выбросит CancelledError, если
+     * вычисление не успело закончиться
+     */
+    void cancel() noexcept { token_->cancel(); }
+
+    bool ready() const;
+    void wait() const { result_.wait(); }
+
+    /**
+     * @brief Дождаться результата (только один раз)
+     */
+    double get() { return result_.get(); }
+
+private:
+    std::shared_ptr<CancellationToken> token_;
+    std::unique_ptr<Node> root_;
+    std::future<double> result_;
+    std::thread thread_;
+};
+
+} // namespace calc
@@ -0,0 +1,226 @@
+#include "batch.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "error.hpp"
+#include "stats.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace calc {
+
+namespace {
+    bool isBlank(std::string_view line) {
+        for (char c : line) {
+            if (c != ' ' && c != '\t') {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // evaluateLine с замером фаз в options.stats
+    bool evaluateProfiled(std::string_view line, const Variables& variables, const BatchOptions& options,
+                          std::string& out) {
+        ExpressionStats stats;
+        bool ok = false;
+        try {
+            appendNumber(out, profileExpression(line, variables, options, stats), options.format);
+            ok = true;
+        } catch (const ParseError& e) {
+            out += "error: ";
+            out += e.what();
+        } catch (const EvalError& e) {
+            out += "error: ";
+            out += e.what();
+        }
+        out += '\n';
+        options.stats->add(stats);
+        return ok;
+    }
+}
+
+LineReader::LineReader(std::FILE* file, size_t bufferSize)
+    : file_(file), buffer_(bufferSize > 0 ? bufferSize : 1) {}
+
+bool LineReader::fill() {
+    if (eof_) {
+        return false;
+    }
+    // Незаконченная строка переносится в начало буфера
+    if (begin_ > 0) {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+    if (end_ == buffer_.size()) {
+        buffer_.resize(buffer_.size() * 2);
+    }
+    size_t read = std::fread(buffer_.data() + end_, 1, buffer_.size() - end_, file_);
+    if (read == 0) {
+        if (std::ferror(file_)) {
+            throw std::runtime_error(std::string("Read error: ") + std::strerror(errno));
+        }
+        eof_ = true;
+        return false;
+    }
+    end_ += read;
+    return true;
+}
+
+bool LineReader::next(std::string_view& line) {
+    size_t scanned = begin_;
+    while (true) {
+        const char* start = buffer_.data() + begin_;
+        const void* newline = std::memchr(buffer_.data() + scanned, '\n', end_ - scanned);
+        if (newline) {
+            size_t length = static_cast<const char*>(newline) - start;
+            begin_ += length + 1;
+            if (length > 0 && start[length - 1] == '\r') {
+                --length;
+            }
+            line = std::string_view(start, length);
+            return true;
+        }
+        scanned = end_ - begin_;
+        if (!fill()) {
+            break;
+        }
+        // fill сдвигает данные в начало буфера
+        scanned += begin_;
+    }
+    if (begin_ == end_) {
+        return false;
+    }
+    // Последняя строка без '\n'
+    size_t length = end_ - begin_;
+    const char* start = buffer_.data() + begin_;
+    begin_ = end_;
+    if (start[length - 1] == '\r') {
+        --length;
+    }
+    line = std::string_view(start, length);
+    return true;
+}
+
+BufferedWriter::BufferedWriter(std::FILE* file, size_t bufferSize)
+    : file_(file), capacity_(bufferSize) {
+    pending_.reserve(capacity_);
+}
+
+BufferedWriter::~BufferedWriter() {
+    if (!pending_.empty()) {
+        std::fwrite(pending_.data(), 1, pending_.size(), file_);
+    }
+    std::fflush(file_);
+}
+
+void BufferedWriter::write(std::string_view text) {
+    pending_.append(text.data(), text.size());
+    if (pending_.size() >= capacity_) {
+        flush();
+    }
+}
+
+void BufferedWriter::flush() {
+    if (!pending_.empty()) {
+        size_t size = pending_.size();
+        size_t written = std::fwrite(pending_.data(), 1, size, file_);
+        pending_.clear();
+        if (written != size) {
+            throw std::runtime_error(std::string("Write error: ") + std::strerror(errno));
+        }
+    }
+    if (std::fflush(file_) != 0) {
+        throw std::runtime_error(std::string("Write error: ") + std::strerror(errno));
+    }
+}
+
+bool evaluateLine(std::string_view line, const Variables& variables, const BatchOptions& options,
+                  std::string& out) {
+    if (isBlank(line)) {
+        out += '\n';
+        return true;
+    }
+    if (options.stats) {
+        return evaluateProfiled(line, variables, options, out);
+    }
+    try {
+        Lexer lexer(line);
+        Parser parser(lexer.tokenize(), &variables);
+        auto ast = parser.parse();
+        if (options.optimize) {
+            Optimizer optimizer(options.optimizer);
+            ast = optimizer.optimize(std::move(ast));
+        }
+        appendNumber(out, Evaluator(options.mode).evaluate(ast), options.format);
+        out += '\n';
+        return true;
+    } catch (const ParseError& e) {
+        out += "error: ";
+        out += e.what();
+    } catch (const EvalError& e) {
+        out += "error: ";
+        out += e.what();
+    }
+    out += '\n';
+    return false;
+}
+
+BatchStats runBatch(LineReader& input, BufferedWriter& output, const Variables& variables,
+                    const BatchOptions& options) {
+    BatchStats stats;
+    std::string result;
+    std::string_view line;
+    while (input.next(line)) {
+        result.clear();
+        if (!evaluateLine(line, variables, options, result)) {
+            ++stats.errors;
+        }
+        ++stats.lines;
+        output.write(result);
+    }
+    output.flush();
+    return stats;
+}
+
+BatchStats evaluateLines(std::string_view text, const Variables& variables, const BatchOptions& options,
+                         std::string& out) {
+    BatchStats stats;
+    while (!text.empty()) {
+        size_t newline = text.find('\n');
+        std::string_view line = text.substr(0, newline);
+        text.remove_prefix(newline == std::string_view::npos ? text.size() : newline + 1);
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        if (!evaluateLine(line, variables, options, out)) {
+            ++stats.errors;
+        }
+        ++stats.lines;
+    }
+    return stats;
+}
+
+BatchStats runBatch(std::string_view input, BufferedWriter& output, const Variables& variables,
+                    const BatchOptions& options) {
+    // Куски по границам строк, чтобы результаты не копились целиком в памяти
+    BatchStats stats;
+    std::string result;
+    while (!input.empty()) {
+        size_t end = std::min(input.size(), LineReader::DEFAULT_BUFFER);
+        size_t newline = input.find('\n', end - 1);
+        end = newline == std::string_view::npos ? input.size() : newline + 1;
+        result.clear();
+        BatchStats part = evaluateLines(input.substr(0, end), variables, options, result);
+        output.write(result);
+        stats.lines += part.lines;
+        stats.errors += part.errors;
+        input.remove_prefix(end);
+    }
+    output.flush();
+    return stats;
+}
+
+} // namespace calc
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "evaluator.hpp"
+#include "format.hpp"
+#include "optimizer.hpp"
+#include "variables.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace calc {
+
+class StatsCollector;
+
+/**
+ * @brief Чтение строк из файла большими блоками
+ *
+ * Строки выдаются как string_view внутрь буфера, без копирования; буфер
+ * растёт, если строка в него не помещается. Ошибка чтения —
+ * std::runtime_error.
+ */
+class LineReader {
+public:
+    static constexpr size_t DEFAULT_BUFFER = 1 << 20;
+
+    explicit LineReader(std::FILE* file, size_t bufferSize = DEFAULT_BUFFER);
+
+    /**
+     * @brief Следующая строка без завершающих '\n' и '\r'
+     *
+     * line действительна до следующего вызова. false — ввод закончился.
+     * Последняя строка может не заканчиваться '\n'.
+     */
+    bool next(std::string_view& line);
+
+private:
+    bool fill();
+
+    std::FILE* file_;
+    std::vector<char> buffer_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    bool eof_ = false;
+};
+
+/**
+ * @brief Запись в файл большими блоками
+ *
+ * Данные копятся в буфере и уходят одним fwrite, когда он заполнен, и
+ * при flush(). Ошибка записи — std::runtime_error из write/flush;
+ * деструктор дописывает остаток, не сообщая об ошибках.
+ */
+class BufferedWriter {
+public:
+    static constexpr size_t DEFAULT_BUFFER = 1 << 20;
+
+    explicit BufferedWriter(std::FILE* file, size_t bufferSize = DEFAULT_BUFFER);
+    ~BufferedWriter();
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    void write(std::string_view text);
+    void flush();
+
+private:
+    std::FILE* file_;
+    size_t capacity_;
+    std::string pending_;
+};
+
+/**
+ * @brief Параметры пакетного режима
+ */
+struct BatchOptions {
+    bool optimize = false;
+    OptimizerOptions optimizer;
+    FormatOptions format;
+    EvalMode mode = EvalMode::Checked;
+    StatsCollector* stats = nullptr;    // Замер фаз каждой строки (--stats); nullptr — без замеров
+};
+
+/**
+ * @brief Итог пакетного режима
+ */
+struct BatchStats {
+    size_t lines = 0;
+    size_t errors = 0;
+};
+
+/**
+ * @brief Вычислить одну строку и дописать результат в out
+ *
+ * Дописывается значение или "error: сообщение" и '\n'; для пустой
+ * строки (только пробелы) — пустая строка. false — строка с ошибкой.
+ */
+bool evaluateLine(std::string_view line, const Variables& variables, const BatchOptions& options,
+                  std::string& out);
+
+/**
+ * @brief Вычислить все строки text и дописать результаты в out
+ *
+ * Строки разделены '\n' ('\r' перед ним отбрасывается) и разбираются
+ * прямо в text, без копирования; последняя строка может не заканчиваться
+ * '\n'.
+ */
+BatchStats evaluateLines(std::string_view text, const Variables& variables, const BatchOptions& options,
+                         std::string& out);
+
+/**
+ * @brief Вычислить все строки input, по строке результата на строку ввода
+ *
+ * Ошибка в строке не прерывает обработку: сообщение пишется на месте
+ * результата (см. evaluateLine).
+ */
+BatchStats runBatch(LineReader& input, BufferedWriter& output, const Variables& variables,
+                    const BatchOptions& options);
+
+/**
+ * @brief runBatch для ввода, целиком лежащего в памяти (отображённого файла)
+ */
+BatchStats runBatch(std::string_view input, BufferedWriter& output, const Variables& variables,
+                    const BatchOptions& options);
+
+} // namespace calc
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace calc {
+
+/**
+ * @brief Ограниченная очередь без блокировок для нескольких писателей и читателей
+ *
+ * Кольцо ячеек с порядковыми номерами (очередь Вьюкова): tryPush и tryPop
+ * захватывают позицию одним compare_exchange и не ждут друг друга.
+ * Ёмкость округляется вверх до степени двойки. Полная очередь не
+ * принимает элементы — так медленный потребитель притормаживает
+ * производителя.
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        mask_ = size - 1;
+        cells_.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    size_t capacity() const { return mask_ + 1; }
+
+    /**
+     * @brief Приблизительное число элементов (точное, если очередь никто не меняет)
+     */
+    size_t size() const {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        size_t head = head_.load(std::memory_order_relaxed);
+        return tail >= head ? tail - head : 0;
+    }
+
+    /**
+     * @brief Добавить элемент; false — очередь полна, value не тронут
+     */
+    bool tryPush(T& value) {
+        size_t position = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[position & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == position) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    cell.value = std::move(value);
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (sequence < position) {
+                return false;
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /**
+     * @brief Извлечь элемент; false — очередь пуста
+     */
+    bool tryPop(T& value) {
+        size_t position = head_.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& cell = cells_[position & mask_];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            if (sequence == position + 1) {
+                if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    value = std::move(cell.value);
+                    cell.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (sequence < position + 1) {
+                return false;
+            } else {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    // Голова и хвост в разных строках кэша: читатели и писатели не мешают друг другу
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+    alignas(64) size_t mask_ = 0;
+    std::unique_ptr<Cell[]> cells_;
+};
+
+/**
+ * @brief Ожидание при полной или пустой очереди
+ *
+ * Первые попытки уступают процессор, дальше поток засыпает на короткое
+ * время, чтобы простаивающие стадии не занимали ядра.
+ */
+class Backoff {
+public:
+    void wait() {
+        if (attempts_ < YIELDS) {
+            ++attempts_;
+            std::this_thread::yield();
+        } else {
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+    }
+
+    void reset() { attempts_ = 0; }
+
+private:
+    static constexpr unsigned YIELDS = 64;
+    unsigned attempts_ = 0;
+};
+
+} // namespace calc
@@ -0,0 +1,129 @@
+#ifndef CALC_H
+#define CALC_H
+
+/*
+ * libcalc — C API калькулятора для встраивания (в том числе через FFI из Go,
+ * Rust и других языков).
+ *
+ * Выражение компилируется один раз в непрозрачный дескриптор, затем
+ * вычисляется для одного набора значений переменных или для столбцов
+ * значений и освобождается. Исключения C++ через границу не проходят:
+ * каждая функция возвращает код calc_status, текст последней ошибки потока —
+ * calc_last_error().
+ *
+ * Статическая библиотека: определите CALC_STATIC до включения заголовка
+ * (цель Calc::calc_static пакета CMake делает это сама).
+ */
+
+#include <stddef.h>
+
+#if defined(CALC_STATIC)
+#define CALC_API
+#elif defined(_WIN32)
+#ifdef CALC_BUILDING_LIBRARY
+#define CALC_API __declspec(dllexport)
+#else
+#define CALC_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define CALC_API __attribute__((visibility("default")))
+#else
+#define CALC_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Версия C API; меняется при несовместимых изменениях */
+#define CALC_API_VERSION 1
+
+/**
+ * @brief Результат вызова функции библиотеки
+ */
+typedef enum calc_status {
+    CALC_OK = 0,
+    CALC_ERROR_PARSE = 1,       /* Синтаксическая ошибка, неизвестное имя */
+    CALC_ERROR_EVAL = 2,        /* Ошибка вычисления: деление на ноль, область определения */
+    CALC_ERROR_ARGUMENT = 3,    /* Нулевой указатель, недопустимое имя переменной */
+    CALC_ERROR_MEMORY = 4,      /* Не хватило памяти */
+    CALC_ERROR_INTERNAL = 5     /* Непредвиденная ошибка */
+} calc_status;
+
+/** @brief Флаги calc_compile */
+#define CALC_COMPILE_OPTIMIZE 1u    /* Алгебраические упрощения (как calc --optimize) */
+#define CALC_COMPILE_ULP1 2u        /* Функции в calc_evaluate_batch — ядра до 1 ULP */
+#define CALC_COMPILE_ULP4 4u        /* Функции в calc_evaluate_batch — ядра до 4 ULP */
+
+/**
+ * @brief Скомпилированное выражение (непрозрачный дескриптор)
+ *
+ * Вычисление одного дескриптора из нескольких потоков одновременно
+ * допустимо.
+ */
+typedef struct calc_expression calc_expression;
+
+/**
+ * @brief Версия C API собранной библиотеки (сравните с CALC_API_VERSION)
+ */
+CALC_API int calc_api_version(void);
+
+/**
+ * @brief Текст ошибки последнего неудачного вызова в этом потоке
+ *
+ * Строка действительна до следующего вызова библиотеки в этом потоке;
+ * пустая, если ошибок не было.
+ */
+CALC_API const char* calc_last_error(void);
+
+/**
+ * @brief Скомпилировать выражение
+ *
+ * @param expression     Текст выражения в UTF-8, оканчивающийся нулём
+ * @param variables      Имена переменных; их значения передаются в том же порядке
+ * @param variable_count Число имён (variables может быть NULL при 0)
+ * @param flags          0 или CALC_COMPILE_OPTIMIZE, CALC_COMPILE_ULP1,
+ *                       CALC_COMPILE_ULP4 через | (ULP1 и ULP4 вместе —
+ *                       CALC_ERROR_ARGUMENT)
+ * @param out            Дескриптор; при ошибке — NULL
+ */
+CALC_API calc_status calc_compile(const char* expression, const char* const* variables,
+                                  size_t variable_count, unsigned flags, calc_expression** out);
+
+/**
+ * @brief Вычислить выражение для одного набора значений
+ *
+ * @param values Значения переменных в порядке calc_compile (NULL при 0 переменных)
+ * @param result Результат; при ошибке не меняется
+ */
+CALC_API calc_status calc_evaluate(const calc_expression* expression, const double* values,
+                                   double* result);
+
+/**
+ * @brief Вычислить выражение для rows наборов значений
+ *
+ * columns[i] — rows значений i-й переменной. Строки с ошибкой получают NaN;
+ * тогда возвращается CALC_ERROR_EVAL, а calc_last_error() сообщает первую
+ * из них ("row N: ...", N считается с нуля). failed_rows (если не NULL) —
+ * число таких строк. Без флагов CALC_COMPILE_ULP1/ULP4 результаты побитово
+ * совпадают с calc_evaluate.
+ */
+CALC_API calc_status calc_evaluate_batch(const calc_expression* expression,
+                                         const double* const* columns, size_t rows,
+                                         double* results, size_t* failed_rows);
+
+/**
+ * @brief Число переменных выражения (как при calc_compile)
+ */
+CALC_API size_t calc_variable_count(const calc_expression* expression);
+
+/**
+ * @brief Освободить дескриптор (NULL допустим)
+ */
+CALC_API void calc_release(calc_expression* expression);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CALC_H */
@@ -0,0 +1,219 @@
+#include "calc.h"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "optimizer.hpp"
+#include "program.hpp"
+#include "variables.hpp"
+#include "vecmath.hpp"
+#include "error.hpp"
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <vector>
+
+struct calc_expression {
+    calc::Variables variables;
+    std::vector<double*> cells;         // Ячейки переменных в порядке calc_compile
+    std::unique_ptr<calc::Node> tree;
+    calc::Program program;              // Переменная i программы — i-е имя calc_compile
+    calc::ProgramView view;
+    bool compiled = false;
+    calc::vecmath::Accuracy accuracy = calc::vecmath::Accuracy::Libm;  // Для calc_evaluate_batch
+    // sum/prod/integrate/solve не компилируются: дерево читает значения из cells
+    mutable std::mutex treeMutex;
+};
+
+namespace {
+    thread_local std::string lastError;
+
+    calc_status fail(calc_status status, const char* message) noexcept {
+        try {
+            lastError = message;
+        } catch (...) {
+            lastError.clear();
+        }
+        return status;
+    }
+
+    // Исключения C++ не должны выйти за границу C API
+    template<typename Body>
+    calc_status guarded(Body body) noexcept {
+        try {
+            return body();
+        } catch (const calc::ParseError& e) {
+            return fail(CALC_ERROR_PARSE, e.what());
+        } catch (const calc::EvalError& e) {
+            return fail(CALC_ERROR_EVAL, e.what());
+        } catch (const std::bad_alloc&) {
+            return fail(CALC_ERROR_MEMORY, "Out of memory");
+        } catch (const std::exception& e) {
+            return fail(CALC_ERROR_INTERNAL, e.what());
+        } catch (...) {
+            return fail(CALC_ERROR_INTERNAL, "Unknown error");
+        }
+    }
+}
+
+extern "C" {
+
+int calc_api_version(void) {
+    return CALC_API_VERSION;
+}
+
+const char* calc_last_error(void) {
+    return lastError.c_str();
+}
+
+calc_status calc_compile(const char* expression, const char* const* variables, size_t variable_count,
+                         unsigned flags, calc_expression** out) {
+    if (out) {
+        *out = nullptr;
+    }
+    if (!expression || !out || (variable_count > 0 && !variables)) {
+        return fail(CALC_ERROR_ARGUMENT, "Null pointer argument");
+    }
+    if ((flags & CALC_COMPILE_ULP1) && (flags & CALC_COMPILE_ULP4)) {
+        return fail(CALC_ERROR_ARGUMENT, "CALC_COMPILE_ULP1 and CALC_COMPILE_ULP4 are mutually exclusive");
+    }
+    return guarded([&] {
+        auto handle = std::make_unique<calc_expression>();
+        if (flags & CALC_COMPILE_ULP1) {
+            handle->accuracy = calc::vecmath::Accuracy::Ulp1;
+        } else if (flags & CALC_COMPILE_ULP4) {
+            handle->accuracy = calc::vecmath::Accuracy::Ulp4;
+        }
+        std::vector<std::string> names;
+        for (size_t i = 0; i < variable_count; ++i) {
+            if (!variables[i] || !calc::isVariableName(variables[i])) {
+                return fail(CALC_ERROR_ARGUMENT, ("Invalid variable name: " +
+                                                  std::string(variables[i] ? variables[i] : "NULL")).c_str());
+            }
+            if (handle->variables.find(variables[i])) {
+                return fail(CALC_ERROR_ARGUMENT, ("Duplicate variable name: " + std::string(variables[i])).c_str());
+            }
+            names.emplace_back(variables[i]);
+            handle->cells.push_back(handle->variables.bind(names.back()));
+        }
+
+        calc::Lexer lexer(expression);
+        calc::Parser parser(lexer.tokenize(), &handle->variables);
+        handle->tree = parser.parse();
+        if (flags & CALC_COMPILE_OPTIMIZE) {
+            calc::Optimizer optimizer;
+            handle->tree = optimizer.optimize(std::move(handle->tree));
+        }
+        try {
+            handle->program = calc::Program::compile(*handle->tree, names);
+            handle->view = handle->program.view();
+            handle->compiled = true;
+        } catch (const calc::EvalError&) {
+            // Вычисление деревом: то же сообщит об ошибке при вызове
+        }
+        *out = handle.release();
+        return CALC_OK;
+    });
+}
+
+calc_status calc_evaluate(const calc_expression* expression, const double* values, double* result) {
+    if (!expression || !result || (!values && !expression->cells.empty())) {
+        return fail(CALC_ERROR_ARGUMENT, "Null pointer argument");
+    }
+    return guarded([&] {
+        size_t count = expression->cells.size();
+        double value = 0.0;
+        if (expression->compiled) {
+            // Ячейки программы указывают прямо в values; обычно хватает стека
+            constexpr size_t INLINE_SLOTS = 16;
+            const double* inlineSlots[INLINE_SLOTS]{};
+            std::vector<const double*> heapSlots;
+            const double** slots = inlineSlots;
+            if (count > INLINE_SLOTS) {
+                heapSlots.resize(count);
+                slots = heapSlots.data();
+            }
+            for (size_t i = 0; i < count; ++i) {
+                slots[i] = values + i;
+            }
+            value = expression->view.evaluate(slots);
+        } else {
+            std::lock_guard<std::mutex> lock(expression->treeMutex);
+            for (size_t i = 0; i < count; ++i) {
+                *expression->cells[i] = values[i];
+            }
+            value = expression->tree->evaluate();
+        }
+        *result = value;
+        return CALC_OK;
+    });
+}
+
+calc_status calc_evaluate_batch(const calc_expression* expression, const double* const* columns, size_t rows,
+                                double* results, size_t* failed_rows) {
+    if (failed_rows) {
+        *failed_rows = 0;
+    }
+    if (!expression) {
+        return fail(CALC_ERROR_ARGUMENT, "Null pointer argument");
+    }
+    if (rows == 0) {
+        return CALC_OK;
+    }
+    size_t count = expression->cells.size();
+    if (!results || (!columns && count > 0)) {
+        return fail(CALC_ERROR_ARGUMENT, "Null pointer argument");
+    }
+    for (size_t i = 0; i < count; ++i) {
+        if (!columns[i]) {
+            return fail(CALC_ERROR_ARGUMENT, "Null pointer argument");
+        }
+    }
+    return guarded([&] {
+        size_t failed = 0;
+        size_t firstRow = 0;
+        std::string firstMessage;
+        if (expression->compiled) {
+            std::vector<calc::BatchError> errors;
+            failed = expression->view.evaluateBatch(columns, rows, results, &errors, expression->accuracy);
+            if (!errors.empty()) {
+                firstRow = errors.front().index;
+                firstMessage = std::move(errors.front().message);
+            }
+        } else {
+            std::lock_guard<std::mutex> lock(expression->treeMutex);
+            for (size_t row = 0; row < rows; ++row) {
+                for (size_t i = 0; i < count; ++i) {
+                    *expression->cells[i] = columns[i][row];
+                }
+                try {
+                    results[row] = expression->tree->evaluate();
+                } catch (const calc::EvalError& e) {
+                    results[row] = std::numeric_limits<double>::quiet_NaN();
+                    if (failed++ == 0) {
+                        firstRow = row;
+                        firstMessage = e.what();
+                    }
+                }
+            }
+        }
+        if (failed_rows) {
+            *failed_rows = failed;
+        }
+        if (failed > 0) {
+            return fail(CALC_ERROR_EVAL, ("row " + std::to_string(firstRow) + ": " + firstMessage).c_str());
+        }
+        return CALC_OK;
+    });
+}
+
+size_t calc_variable_count(const calc_expression* expression) {
+    return expression ? expression->cells.size() : 0;
+}
+
+void calc_release(calc_expression* expression) {
+    delete expression;
+}
+
+} // extern "C"
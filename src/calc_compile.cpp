@@ -0,0 +1,181 @@
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "optimizer.hpp"
+#include "program.hpp"
+#include "formula_library.hpp"
+#include "variables.hpp"
+#include "error.hpp"
+
+void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " [options] INPUT -o OUTPUT\n"
+              << "Compile text formulas into a binary formula library.\n"
+              << "\n"
+              << "Options:\n"
+              << "  -h, --help          Show this help message\n"
+              << "  -o FILE             Output library file\n"
+              << "  -O, --optimize      Simplify formulas before compiling\n"
+              << "  --fast-math         Also allow simplifications that change\n"
+              << "                      rounding (implies --optimize)\n"
+              << "\n"
+              << "INPUT has one formula per line:\n"
+              << "  name = expression\n"
+              << "  name(x, y) = expression\n"
+              << "Empty lines and lines starting with '#' are ignored.\n";
+}
+
+namespace {
+
+bool isIdentifier(const std::string& text) {
+    if (text.empty() || !(std::isalpha(static_cast<unsigned char>(text[0])) || text[0] == '_')) {
+        return false;
+    }
+    for (char c : text) {
+        if (!std::isalnum(static_cast<unsigned char>(c)) && c != '_') {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+struct Definition {
+    std::string name;
+    std::vector<std::string> parameters;
+    std::string expression;
+};
+
+// Разбор строки "name(x, y) = expression"
+Definition parse_definition(const std::string& line) {
+    size_t eq = line.find('=');
+    if (eq == std::string::npos) {
+        throw calc::ParseError("Expected 'name = expression'");
+    }
+    Definition definition;
+    std::string head = trim(line.substr(0, eq));
+    definition.expression = trim(line.substr(eq + 1));
+
+    size_t paren = head.find('(');
+    if (paren != std::string::npos) {
+        if (head.back() != ')') {
+            throw calc::ParseError("Expected ')' after parameter list");
+        }
+        std::string list = head.substr(paren + 1, head.size() - paren - 2);
+        head = trim(head.substr(0, paren));
+        size_t start = 0;
+        while (!trim(list).empty()) {
+            size_t comma = list.find(',', start);
+            std::string parameter = trim(list.substr(start, comma - start));
+            if (!isIdentifier(parameter)) {
+                throw calc::ParseError("Invalid parameter name: '" + parameter + "'");
+            }
+            definition.parameters.push_back(parameter);
+            if (comma == std::string::npos) {
+                break;
+            }
+            start = comma + 1;
+        }
+    }
+    if (!isIdentifier(head)) {
+        throw calc::ParseError("Invalid formula name: '" + head + "'");
+    }
+    definition.name = head;
+    return definition;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string input;
+    std::string output;
+    bool optimize = false;
+    calc::OptimizerOptions optimizerOptions;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        }
+        if (std::strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+            continue;
+        }
+        if (std::strcmp(argv[i], "--optimize") == 0 || std::strcmp(argv[i], "-O") == 0) {
+            optimize = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--fast-math") == 0) {
+            optimize = true;
+            optimizerOptions.fastMath = true;
+            continue;
+        }
+        if (argv[i][0] != '-' && input.empty()) {
+            input = argv[i];
+            continue;
+        }
+        std::cerr << "Unknown argument: " << argv[i] << std::endl;
+        return 1;
+    }
+    if (input.empty() || output.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::ifstream in(input);
+    if (!in) {
+        std::cerr << "Cannot open file: " << input << std::endl;
+        return 1;
+    }
+
+    calc::LibraryWriter writer;
+    std::string line;
+    size_t lineNumber = 0;
+    while (std::getline(in, line)) {
+        ++lineNumber;
+        std::string text = trim(line);
+        if (text.empty() || text[0] == '#') {
+            continue;
+        }
+        try {
+            Definition definition = parse_definition(text);
+
+            calc::Variables variables;
+            for (const auto& parameter : definition.parameters) {
+                variables.bind(parameter);
+            }
+            calc::Lexer lexer(definition.expression);
+            calc::Parser parser(lexer.tokenize(), &variables);
+            auto ast = parser.parse();
+            if (optimize) {
+                calc::Optimizer optimizer(optimizerOptions);
+                ast = optimizer.optimize(std::move(ast));
+            }
+            writer.add(definition.name, calc::Program::compile(*ast, definition.parameters));
+        } catch (const std::exception& e) {
+            std::cerr << input << ":" << lineNumber << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+
+    try {
+        writer.write(output);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::cerr << "Compiled " << writer.size() << " formulas into " << output << std::endl;
+    return 0;
+}
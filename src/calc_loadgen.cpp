@@ -0,0 +1,212 @@
+// Генератор нагрузки для calc --serve: несколько соединений, в каждом до
+// depth запросов в полёте; в конце — пропускная способность и перцентили
+// задержки (от отправки запроса до получения его ответа)
+#include "server_protocol.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string socketPath;
+    size_t connections = 4;
+    size_t requests = 100000;
+    size_t depth = 16;
+    std::vector<std::string> expressions;
+};
+
+struct Result {
+    std::vector<uint64_t> latencies;    // Наносекунды
+    size_t errors = 0;
+    std::string failure;
+};
+
+void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " --socket PATH [options]\n"
+              << "\n"
+              << "Options:\n"
+              << "  --socket PATH       Socket of a running calc --serve\n"
+              << "  --connections N     Parallel connections (default: 4)\n"
+              << "  --requests N        Requests in total (default: 100000)\n"
+              << "  --depth N           Requests in flight per connection (default: 16)\n"
+              << "  --expr EXPR         Expression to send (may be repeated; requests\n"
+              << "                      cycle through them)\n";
+}
+
+bool parse_count(const char* text, size_t max, size_t& value) {
+    char* end = nullptr;
+    unsigned long long parsed = std::strtoull(text, &end, 10);
+    if (*end != '\0' || parsed < 1 || parsed > max) {
+        return false;
+    }
+    value = static_cast<size_t>(parsed);
+    return true;
+}
+
+bool write_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t written = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written <= 0) {
+            return false;
+        }
+        sent += static_cast<size_t>(written);
+    }
+    return true;
+}
+
+void run_connection(const Options& options, size_t quota, size_t offset, Result& result) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, options.socketPath.c_str(), sizeof(address.sun_path) - 1);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        result.failure = std::string("Cannot connect to ") + options.socketPath + ": " + std::strerror(errno);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return;
+    }
+
+    result.latencies.reserve(quota);
+    // Время отправки запросов в полёте: их не больше depth
+    std::vector<Clock::time_point> sentAt(options.depth);
+    calc::protocol::FrameBuffer input;
+    std::string output;
+    size_t sent = 0;
+    size_t received = 0;
+    while (received < quota) {
+        output.clear();
+        Clock::time_point now = Clock::now();
+        while (sent < quota && sent - received < options.depth) {
+            const std::string& expression = options.expressions[(offset + sent) % options.expressions.size()];
+            calc::protocol::appendFrame(output, expression);
+            sentAt[sent % options.depth] = now;
+            ++sent;
+        }
+        if (!output.empty() && !write_all(fd, output)) {
+            result.failure = std::string("Write failed: ") + std::strerror(errno);
+            break;
+        }
+        char* buffer = input.prepare(64 << 10);
+        ssize_t read = ::recv(fd, buffer, 64 << 10, 0);
+        if (read < 0 && errno == EINTR) {
+            continue;
+        }
+        if (read <= 0) {
+            result.failure = read == 0 ? "Server closed the connection"
+                                       : std::string("Read failed: ") + std::strerror(errno);
+            break;
+        }
+        input.commit(static_cast<size_t>(read));
+        Clock::time_point arrived = Clock::now();
+        std::string_view payload;
+        while (input.next(payload)) {
+            auto latency = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                arrived - sentAt[received % options.depth]);
+            result.latencies.push_back(static_cast<uint64_t>(latency.count()));
+            if (payload.empty() || payload[0] != static_cast<char>(calc::protocol::ResponseStatus::Ok)) {
+                ++result.errors;
+            }
+            ++received;
+        }
+    }
+    ::close(fd);
+}
+
+double percentile_us(const std::vector<uint64_t>& sorted, double fraction) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(fraction * static_cast<double>(sorted.size()));
+    return sorted[std::min(rank, sorted.size() - 1)] / 1000.0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        }
+        if (std::strcmp(argv[i], "--socket") == 0 && hasValue) {
+            options.socketPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--connections") == 0 && hasValue &&
+                   parse_count(argv[i + 1], 1024, options.connections)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--requests") == 0 && hasValue &&
+                   parse_count(argv[i + 1], SIZE_MAX, options.requests)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--depth") == 0 && hasValue &&
+                   parse_count(argv[i + 1], 4096, options.depth)) {
+            ++i;
+        } else if (std::strcmp(argv[i], "--expr") == 0 && hasValue) {
+            options.expressions.push_back(argv[++i]);
+        } else {
+            std::cerr << "Invalid argument: " << argv[i] << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.socketPath.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (options.expressions.empty()) {
+        options.expressions = {"1 + 2 * 3", "sqrt(2) * sin(pi / 4)", "2 ^ 10 - 1", "ln(10) / ln(2)"};
+    }
+    options.connections = std::min(options.connections, options.requests);
+
+    std::vector<Result> results(options.connections);
+    std::vector<std::thread> threads;
+    Clock::time_point started = Clock::now();
+    for (size_t c = 0; c < options.connections; ++c) {
+        size_t quota = options.requests / options.connections + (c < options.requests % options.connections ? 1 : 0);
+        threads.emplace_back(run_connection, std::cref(options), quota, c, std::ref(results[c]));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - started).count();
+
+    std::vector<uint64_t> latencies;
+    size_t errors = 0;
+    for (const Result& result : results) {
+        if (!result.failure.empty()) {
+            std::cerr << result.failure << std::endl;
+            return 1;
+        }
+        latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+        errors += result.errors;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::printf("requests    %zu (%zu errors) over %zu connections, depth %zu\n",
+                latencies.size(), errors, options.connections, options.depth);
+    std::printf("throughput  %.0f requests/s\n", latencies.size() / seconds);
+    std::printf("latency     p50 %.1f us, p99 %.1f us, p999 %.1f us, max %.1f us\n",
+                percentile_us(latencies, 0.50), percentile_us(latencies, 0.99),
+                percentile_us(latencies, 0.999), percentile_us(latencies, 1.0));
+    return 0;
+}
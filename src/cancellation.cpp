@@ -0,0 +1,51 @@
+#include "cancellation.hpp"
+#include "error.hpp"
+
+namespace calc {
+
+namespace {
+    // Прогресс сообщается не чаще, чем через эту долю работы
+    constexpr double PROGRESS_STEP = 0.001;
+}
+
+thread_local CancellationScope* CancellationScope::current_ = nullptr;
+
+CancellationScope::CancellationScope(const CancellationToken* token, ProgressCallback progress)
+    : token_(token), progress_(std::move(progress)), previous_(current_) {
+    current_ = this;
+}
+
+CancellationScope::~CancellationScope() {
+    current_ = previous_;
+}
+
+void CancellationScope::throwCancelled() {
+    throw CancelledError();
+}
+
+ProgressStage::ProgressStage() : scope_(CancellationScope::current_) {
+    if (scope_) {
+        outermost_ = scope_->stages_++ == 0;
+    }
+}
+
+ProgressStage::~ProgressStage() {
+    if (scope_) {
+        --scope_->stages_;
+    }
+}
+
+void ProgressStage::report(size_t done, size_t total) const {
+    CancellationScope::checkpoint();
+    // В рабочем потоке parallelFor текущая область — другая
+    if (!outermost_ || CancellationScope::current_ != scope_ || !scope_->progress_ || total == 0) {
+        return;
+    }
+    double fraction = static_cast<double>(done) / static_cast<double>(total);
+    if (fraction >= reported_ + PROGRESS_STEP || (done == total && fraction > reported_)) {
+        reported_ = fraction;
+        scope_->progress_(fraction);
+    }
+}
+
+} // namespace calc
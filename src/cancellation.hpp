@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+
+namespace calc {
+
+/**
+ * @brief Флаг отмены вычисления
+ *
+ * cancel() можно вызывать из любого потока и из обработчика сигнала.
+ */
+class CancellationToken {
+public:
+    void cancel() noexcept { cancelled_.store(true, std::memory_order_relaxed); }
+    bool cancelled() const noexcept { return cancelled_.load(std::memory_order_relaxed); }
+
+private:
+    static_assert(std::atomic<bool>::is_always_lock_free, "cancel() must be async-signal-safe");
+    std::atomic<bool> cancelled_{false};
+};
+
+/**
+ * @brief Получатель прогресса: доля выполненной работы от 0 до 1
+ */
+using ProgressCallback = std::function<void(double fraction)>;
+
+/**
+ * @brief Пока объект жив, вычисления в этом потоке можно отменить
+ *
+ * Долгие конструкции (sum/prod, integrate, solve, табулирование)
+ * периодически вызывают checkpoint() и при отмене выбрасывают
+ * CancelledError. parallelFor передаёт токен своим рабочим потокам.
+ * Вне области checkpoint() проверяет только указатель потока.
+ */
+class CancellationScope {
+public:
+    /**
+     * @param token    Токен; должен жить дольше объекта (nullptr — без отмены)
+     * @param progress Вызывается в этом потоке
+     */
+    explicit CancellationScope(const CancellationToken* token, ProgressCallback progress = {});
+    ~CancellationScope();
+
+    CancellationScope(const CancellationScope&) = delete;
+    CancellationScope& operator=(const CancellationScope&) = delete;
+
+    /**
+     * @brief Выбросить CancelledError, если вычисление отменено
+     */
+    static void checkpoint() {
+        if (current_ && current_->token_ && current_->token_->cancelled()) {
+            throwCancelled();
+        }
+    }
+
+    /**
+     * @brief Токен области этого потока (nullptr — вне области)
+     */
+    static const CancellationToken* currentToken() { return current_ ? current_->token_ : nullptr; }
+
+private:
+    friend class ProgressStage;
+
+    [[noreturn]] static void throwCancelled();
+
+    static thread_local CancellationScope* current_;
+
+    const CancellationToken* token_;
+    ProgressCallback progress_;
+    CancellationScope* previous_;
+    size_t stages_ = 0;
+};
+
+/**
+ * @brief Долгая конструкция, сообщающая прогресс
+ *
+ * Прогресс сообщает только внешний этап: sum внутри integrate не
+ * начинает шкалу заново для каждой точки. report() можно вызывать и из
+ * рабочих потоков parallelFor — тогда он только проверяет отмену.
+ */
+class ProgressStage {
+public:
+    ProgressStage();
+    ~ProgressStage();
+
+    ProgressStage(const ProgressStage&) = delete;
+    ProgressStage& operator=(const ProgressStage&) = delete;
+
+    /**
+     * @brief Выполнено done из total; проверяет отмену
+     */
+    void report(size_t done, size_t total) const;
+
+private:
+    CancellationScope* scope_;
+    bool outermost_ = false;
+    mutable double reported_ = -1.0;
+};
+
+} // namespace calc
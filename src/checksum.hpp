@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace calc {
+
+/**
+ * @brief CRC-32 (полином IEEE 802.3, как в zlib)
+ *
+ * Для подсчёта по частям результат передаётся следующему вызову:
+ * crc32(b, nb, crc32(a, na)) == crc32(ab, na + nb).
+ */
+uint32_t crc32(const void* data, size_t size, uint32_t crc = 0);
+
+} // namespace calc
@@ -0,0 +1,340 @@
+#include "column_file.hpp"
+#include "checksum.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "error.hpp"
+#include "ast/variable.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace calc {
+
+using column_format::ColumnEntry;
+using column_format::ColumnFileHeader;
+using column_format::ColumnType;
+
+namespace {
+    constexpr size_t VALUE_SIZE = 8;
+
+    uint64_t alignUp(uint64_t value) {
+        return (value + column_format::ALIGNMENT - 1) / column_format::ALIGNMENT * column_format::ALIGNMENT;
+    }
+
+    // Заголовок (с нулём в поле суммы), описания столбцов и имена
+    uint32_t headerChecksum(ColumnFileHeader header, const ColumnEntry* columns, const char* strings) {
+        header.headerChecksum = 0;
+        uint32_t crc = crc32(&header, sizeof(header));
+        crc = crc32(columns, header.columnCount * sizeof(ColumnEntry), crc);
+        return crc32(strings, header.stringsSize, crc);
+    }
+
+    bool sectionFits(uint64_t offset, uint64_t count, uint64_t elementSize, size_t fileSize) {
+        return offset <= fileSize && count <= (fileSize - offset) / elementSize;
+    }
+
+    // Ячейки переменных, на которые ссылается дерево
+    void collectSlots(const Node* node, std::vector<const double*>& slots) {
+        if (auto* variable = dynamic_cast<const VariableNode*>(node)) {
+            slots.push_back(variable->slot());
+        }
+        for (size_t i = 0; i < node->childCount(); ++i) {
+            collectSlots(node->child(i), slots);
+        }
+    }
+}
+
+ColumnWriter::ColumnWriter(std::FILE* file, std::vector<ColumnSpec> columns, uint64_t rows)
+    : file_(file), columns_(std::move(columns)), rows_(rows) {
+    if (rows_ > std::numeric_limits<uint64_t>::max() / VALUE_SIZE / 2) {
+        throw std::invalid_argument("Too many rows for a column file");
+    }
+    std::string strings;
+    std::vector<ColumnEntry> entries(columns_.size());
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        entries[i].name = {static_cast<uint32_t>(strings.size()), static_cast<uint32_t>(columns_[i].name.size())};
+        entries[i].type = columns_[i].type;
+        entries[i].reserved = 0;
+        strings += columns_[i].name;
+    }
+
+    ColumnFileHeader header{};
+    std::memcpy(header.magic, column_format::MAGIC, sizeof(header.magic));
+    header.version = column_format::VERSION;
+    header.byteOrder = column_format::BYTE_ORDER_MARK;
+    header.columnCount = static_cast<uint32_t>(columns_.size());
+    header.stringsSize = static_cast<uint32_t>(strings.size());
+    header.rowCount = rows_;
+    header.columnsOffset = sizeof(ColumnFileHeader);
+    header.stringsOffset = header.columnsOffset + entries.size() * sizeof(ColumnEntry);
+
+    // Значения столбцов — подряд, каждый с границы ALIGNMENT
+    uint64_t dataOffset = alignUp(header.stringsOffset + strings.size());
+    uint64_t stride = alignUp(rows_ * VALUE_SIZE);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        entries[i].offset = dataOffset + i * stride;
+    }
+    header.fileSize = entries.empty() ? header.stringsOffset + strings.size()
+                                      : entries.back().offset + rows_ * VALUE_SIZE;
+    header.headerChecksum = headerChecksum(header, entries.data(), strings.data());
+
+    write(&header, sizeof(header));
+    write(entries.data(), entries.size() * sizeof(ColumnEntry));
+    write(strings.data(), strings.size());
+    if (!entries.empty()) {
+        static const char padding[column_format::ALIGNMENT] = {};
+        write(padding, dataOffset - header.stringsOffset - strings.size());
+    }
+}
+
+void ColumnWriter::append(const double* values, size_t count) {
+    appendRaw(values, count, ColumnType::Float64);
+}
+
+void ColumnWriter::append(const int64_t* values, size_t count) {
+    appendRaw(values, count, ColumnType::Int64);
+}
+
+void ColumnWriter::appendRaw(const void* values, size_t count, ColumnType type) {
+    const char* bytes = static_cast<const char*>(values);
+    while (count > 0) {
+        if (column_ == columns_.size()) {
+            throw std::invalid_argument("Too many values for the column file");
+        }
+        if (columns_[column_].type != type) {
+            throw std::invalid_argument("Wrong value type for column " + columns_[column_].name);
+        }
+        size_t n = static_cast<size_t>(std::min<uint64_t>(count, rows_ - written_));
+        write(bytes, n * VALUE_SIZE);
+        bytes += n * VALUE_SIZE;
+        count -= n;
+        written_ += n;
+        if (written_ == rows_) {
+            // Столбец заполнен: выравнивание перед следующим
+            ++column_;
+            written_ = 0;
+            if (column_ < columns_.size()) {
+                static const char padding[column_format::ALIGNMENT] = {};
+                write(padding, alignUp(rows_ * VALUE_SIZE) - rows_ * VALUE_SIZE);
+            }
+        }
+    }
+}
+
+void ColumnWriter::finish() {
+    if (rows_ > 0 && column_ < columns_.size()) {
+        throw std::runtime_error("Column file is incomplete: column " + columns_[column_].name +
+                                 " has " + std::to_string(written_) + " of " + std::to_string(rows_) +
+                                 " values");
+    }
+    if (std::fflush(file_) != 0) {
+        throw std::runtime_error(std::string("Write error: ") + std::strerror(errno));
+    }
+}
+
+void ColumnWriter::write(const void* data, size_t size) {
+    if (size > 0 && std::fwrite(data, 1, size, file_) != size) {
+        throw std::runtime_error(std::string("Write error: ") + std::strerror(errno));
+    }
+}
+
+ColumnFile::ColumnFile(const std::string& path)
+    : file_(path) {
+    open(file_.data(), file_.size());
+}
+
+ColumnFile::ColumnFile(const void* data, size_t size) {
+    open(static_cast<const char*>(data), size);
+}
+
+void ColumnFile::open(const char* data, size_t size) {
+    if (size < sizeof(ColumnFileHeader)) {
+        throw FormatError("Not a column file: file too short");
+    }
+    if (reinterpret_cast<uintptr_t>(data) % alignof(double) != 0) {
+        throw FormatError("Column file buffer is not 8-byte aligned");
+    }
+
+    const auto* header = reinterpret_cast<const ColumnFileHeader*>(data);
+    if (std::memcmp(header->magic, column_format::MAGIC, sizeof(header->magic)) != 0) {
+        throw FormatError("Not a column file: bad magic");
+    }
+    if (header->byteOrder != column_format::BYTE_ORDER_MARK) {
+        throw FormatError("Column file has foreign byte order");
+    }
+    if (header->version != column_format::VERSION) {
+        throw FormatError("Unsupported column file version " + std::to_string(header->version));
+    }
+    if (header->fileSize != size) {
+        throw FormatError("Column file size mismatch (truncated file?)");
+    }
+    if (header->columnsOffset % alignof(ColumnEntry) != 0 ||
+        !sectionFits(header->columnsOffset, header->columnCount, sizeof(ColumnEntry), size) ||
+        !sectionFits(header->stringsOffset, header->stringsSize, 1, size)) {
+        throw FormatError("Column file section out of range");
+    }
+    const auto* columns = reinterpret_cast<const ColumnEntry*>(data + header->columnsOffset);
+    const char* strings = data + header->stringsOffset;
+    if (header->headerChecksum != headerChecksum(*header, columns, strings)) {
+        throw FormatError("Column file header checksum mismatch");
+    }
+    for (uint32_t i = 0; i < header->columnCount; ++i) {
+        const ColumnEntry& column = columns[i];
+        if (column.name.offset > header->stringsSize ||
+            column.name.length > header->stringsSize - column.name.offset ||
+            (column.type != ColumnType::Float64 && column.type != ColumnType::Int64) ||
+            column.offset % column_format::ALIGNMENT != 0 ||
+            !sectionFits(column.offset, header->rowCount, VALUE_SIZE, size)) {
+            throw FormatError("Column file entry " + std::to_string(i) + " out of range");
+        }
+    }
+
+    data_ = data;
+    header_ = header;
+    columns_ = columns;
+    strings_ = strings;
+}
+
+std::string_view ColumnFile::name(size_t column) const {
+    const NameRef& ref = columns_[column].name;
+    return std::string_view(strings_ + ref.offset, ref.length);
+}
+
+const double* ColumnFile::float64(size_t column) const {
+    if (columns_[column].type != ColumnType::Float64) {
+        throw std::invalid_argument("Column " + std::string(name(column)) + " is not float64");
+    }
+    return reinterpret_cast<const double*>(data_ + columns_[column].offset);
+}
+
+const int64_t* ColumnFile::int64(size_t column) const {
+    if (columns_[column].type != ColumnType::Int64) {
+        throw std::invalid_argument("Column " + std::string(name(column)) + " is not int64");
+    }
+    return reinterpret_cast<const int64_t*>(data_ + columns_[column].offset);
+}
+
+std::optional<size_t> ColumnFile::find(std::string_view name) const {
+    for (size_t i = 0; i < columnCount(); ++i) {
+        if (this->name(i) == name) {
+            return i;
+        }
+    }
+    return std::nullopt;
+}
+
+ColumnStats evaluateColumns(const ColumnFile& input, const std::string& expression,
+                            const Variables& variables, const ColumnOptions& options,
+                            const ColumnSink& sink) {
+    size_t blockRows = std::max<size_t>(options.blockRows, 1);
+
+    // Столбцы объявляются переменными поверх variables
+    Variables scope = variables;
+    std::vector<double*> slots(input.columnCount());
+    for (size_t c = 0; c < input.columnCount(); ++c) {
+        std::string name(input.name(c));
+        // Выражение прочитало бы константу или операцию, а не столбец:
+        // такой столбец не связывается, а ссылка на него — ошибка
+        if (isReservedWord(name)) {
+            if (containsWord(expression, name)) {
+                throw ParseError("Invalid column name: " + name);
+            }
+            continue;
+        }
+        slots[c] = scope.bind(name);
+    }
+    Lexer lexer(expression);
+    Parser parser(lexer.tokenize(), &scope);
+    auto ast = parser.parse();
+    if (options.optimize) {
+        Optimizer optimizer(options.optimizer);
+        ast = optimizer.optimize(std::move(ast));
+    }
+
+    ColumnStats stats;
+    std::vector<const double*> referenced;
+    collectSlots(ast.get(), referenced);
+    std::vector<size_t> used;
+    for (size_t c = 0; c < slots.size(); ++c) {
+        if (slots[c] && std::find(referenced.begin(), referenced.end(), slots[c]) != referenced.end()) {
+            used.push_back(c);
+            stats.columns++;
+            if (input.type(c) == ColumnType::Int64) {
+                stats.converted++;
+            }
+        }
+    }
+
+    Program program;
+    try {
+        program = Program::compile(*ast);
+        stats.compiled = true;
+    } catch (const EvalError&) {
+        // sum/integrate/solve: вычисление деревом по строкам
+    }
+
+    // Переменная программы: столбец файла (номер) или постоянное значение
+    ProgramView view = program.view();
+    std::vector<std::optional<size_t>> sources(view.variableCount());
+    std::vector<std::vector<double>> buffers(view.variableCount());
+    std::vector<const double*> columns(view.variableCount(), nullptr);
+    for (size_t v = 0; v < view.variableCount(); ++v) {
+        sources[v] = input.find(view.variableName(v));
+        if (!sources[v] || input.type(*sources[v]) == ColumnType::Int64) {
+            buffers[v].resize(blockRows);
+        }
+        if (!sources[v]) {
+            if (const double* slot = scope.find(std::string(view.variableName(v)))) {
+                std::fill(buffers[v].begin(), buffers[v].end(), *slot);
+                columns[v] = buffers[v].data();
+            }
+        }
+    }
+
+    std::vector<double> results(blockRows);
+    std::vector<BatchError> errors;
+    for (uint64_t first = 0; first < input.rows(); first += blockRows) {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(blockRows, input.rows() - first));
+        errors.clear();
+        if (stats.compiled) {
+            for (size_t v = 0; v < sources.size(); ++v) {
+                if (!sources[v]) {
+                    continue;
+                }
+                if (input.type(*sources[v]) == ColumnType::Float64) {
+                    // Без копирования: столбец блока — участок отображённого файла
+                    columns[v] = input.float64(*sources[v]) + first;
+                } else {
+                    const int64_t* values = input.int64(*sources[v]) + first;
+                    std::transform(values, values + n, buffers[v].begin(),
+                                   [](int64_t value) { return static_cast<double>(value); });
+                    columns[v] = buffers[v].data();
+                }
+            }
+            stats.errors += view.evaluateBatch(columns.data(), n, results.data(), &errors, options.accuracy);
+        } else {
+            for (size_t k = 0; k < n; ++k) {
+                for (size_t c : used) {
+                    *slots[c] = input.type(c) == ColumnType::Float64
+                                    ? input.float64(c)[first + k]
+                                    : static_cast<double>(input.int64(c)[first + k]);
+                }
+                try {
+                    results[k] = ast->evaluate();
+                } catch (const EvalError& e) {
+                    results[k] = std::nan("");
+                    errors.push_back({k, e.what()});
+                    ++stats.errors;
+                }
+            }
+        }
+        sink(first, results.data(), n, errors);
+        stats.rows += n;
+    }
+    return stats;
+}
+
+} // namespace calc
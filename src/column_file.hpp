@@ -0,0 +1,205 @@
+#pragma once
+
+#include "mapped_file.hpp"
+#include "optimizer.hpp"
+#include "program.hpp"
+#include "variables.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace calc {
+
+/**
+ * @brief Двоичный формат файла столбцов (версия 1)
+ *
+ * Столбцы — сырые массивы значений по rowCount элементов, каждый с
+ * границы 64 байт, поэтому столбец double передаётся в пакетное
+ * вычисление прямо из отображённой памяти. Порядок байтов — как у
+ * записавшей машины (на практике little endian), файл с чужим порядком
+ * отвергается:
+ *
+ *   ColumnFileHeader
+ *   ColumnEntry[columnCount]     — описания столбцов
+ *   char[stringsSize]            — имена столбцов
+ *   значения столбцов            — по смещениям из ColumnEntry
+ *
+ * Контрольная сумма покрывает заголовок, описания и имена; значения не
+ * проверяются, иначе открытие читало бы весь файл.
+ */
+namespace column_format {
+
+constexpr char MAGIC[8] = {'C', 'A', 'L', 'C', 'C', 'O', 'L', '\0'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+constexpr size_t ALIGNMENT = 64;
+
+enum class ColumnType : uint32_t {
+    Float64 = 1,
+    Int64 = 2
+};
+
+struct ColumnFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;         // BYTE_ORDER_MARK в порядке байтов записавшей машины
+    uint32_t columnCount;
+    uint32_t stringsSize;
+    uint32_t headerChecksum;    // CRC-32 заголовка (с нулём в этом поле), описаний и имён
+    uint32_t reserved;
+    uint64_t rowCount;
+    uint64_t fileSize;
+    uint64_t columnsOffset;
+    uint64_t stringsOffset;
+};
+
+struct ColumnEntry {
+    NameRef name;
+    ColumnType type;
+    uint32_t reserved;
+    uint64_t offset;            // Начало значений, кратно ALIGNMENT
+};
+
+static_assert(sizeof(ColumnFileHeader) == 64, "ColumnFileHeader is part of the binary format");
+static_assert(sizeof(ColumnEntry) == 24, "ColumnEntry is part of the binary format");
+
+} // namespace column_format
+
+/**
+ * @brief Имя и тип столбца для ColumnWriter
+ */
+struct ColumnSpec {
+    std::string name;
+    column_format::ColumnType type = column_format::ColumnType::Float64;
+};
+
+/**
+ * @brief Потоковая запись файла столбцов
+ *
+ * Заголовок пишется сразу (число строк известно заранее), затем значения
+ * столбцов по порядку: столбец за столбцом, каждый любыми порциями.
+ * Запись в файл без позиционирования, поэтому подходит и stdout. Порция
+ * не того типа или сверх rowCount — std::invalid_argument, ошибка
+ * записи — std::runtime_error.
+ */
+class ColumnWriter {
+public:
+    ColumnWriter(std::FILE* file, std::vector<ColumnSpec> columns, uint64_t rows);
+
+    ColumnWriter(const ColumnWriter&) = delete;
+    ColumnWriter& operator=(const ColumnWriter&) = delete;
+
+    void append(const double* values, size_t count);
+    void append(const int64_t* values, size_t count);
+
+    /**
+     * @brief Проверить, что записаны все значения, и сбросить буферы
+     */
+    void finish();
+
+private:
+    void appendRaw(const void* values, size_t count, column_format::ColumnType type);
+    void write(const void* data, size_t size);
+
+    std::FILE* file_;
+    std::vector<ColumnSpec> columns_;
+    uint64_t rows_;
+    size_t column_ = 0;         // Столбец, значения которого пишутся
+    uint64_t written_ = 0;      // Записано значений текущего столбца
+};
+
+/**
+ * @brief Файл столбцов, открытый из файла (mmap) или буфера в памяти
+ *
+ * Значения возвращаются указателями внутрь отображения и действительны,
+ * пока жив объект. Повреждённый или несовместимый файл — FormatError.
+ */
+class ColumnFile {
+public:
+    explicit ColumnFile(const std::string& path);
+
+    /**
+     * @brief Файл над чужим буфером (должен жить дольше объекта, выровнен
+     * на 8 байт)
+     */
+    ColumnFile(const void* data, size_t size);
+
+    uint64_t rows() const { return header_->rowCount; }
+    size_t columnCount() const { return header_->columnCount; }
+    std::string_view name(size_t column) const;
+    column_format::ColumnType type(size_t column) const { return columns_[column].type; }
+
+    /**
+     * @brief Значения столбца; тип должен совпадать
+     */
+    const double* float64(size_t column) const;
+    const int64_t* int64(size_t column) const;
+
+    std::optional<size_t> find(std::string_view name) const;
+
+    /**
+     * @brief Подсказка ядру: значения будут читаться подряд
+     */
+    void adviseSequential() const { file_.adviseSequential(); }
+
+private:
+    void open(const char* data, size_t size);
+
+    MappedFile file_;
+    const char* data_ = nullptr;
+    const column_format::ColumnFileHeader* header_ = nullptr;
+    const column_format::ColumnEntry* columns_ = nullptr;
+    const char* strings_ = nullptr;
+};
+
+/**
+ * @brief Параметры вычисления по файлу столбцов
+ */
+struct ColumnOptions {
+    size_t blockRows = 4096;    // Строк в одном вызове evaluateBatch
+    bool optimize = false;
+    OptimizerOptions optimizer;
+    vecmath::Accuracy accuracy = vecmath::Accuracy::Libm;  // Точность функций в блоках
+};
+
+/**
+ * @brief Итог вычисления по файлу столбцов
+ */
+struct ColumnStats {
+    size_t rows = 0;
+    size_t errors = 0;
+    size_t columns = 0;         // Столбцов, на которые ссылается выражение
+    size_t converted = 0;       // Из них int64, преобразуемых в double поблочно
+    bool compiled = false;      // Блоки вычислялись программой (иначе — дерево по строкам)
+};
+
+/**
+ * @brief Получатель результатов: значения строк [firstRow, firstRow + count)
+ *
+ * errors — ошибки строк блока (индексы от начала блока); значения этих
+ * строк — NaN.
+ */
+using ColumnSink = std::function<void(uint64_t firstRow, const double* values, size_t count,
+                                      const std::vector<BatchError>& errors)>;
+
+/**
+ * @brief Вычислить expression для каждой строки файла столбцов
+ *
+ * Столбцы — переменные выражения (закрывают одноимённые переменные из
+ * variables). Столбцы double передаются в ProgramView::evaluateBatch
+ * прямо из файла, без копирования и преобразования; int64 преобразуются
+ * в double поблочно. Выражения с sum/prod/integrate/solve вычисляются
+ * деревом по строкам. Столбец с именем константы или операции (e, pi,
+ * AND, ...) не связывается; ошибка разбора выражения и такое слово в
+ * выражении — ParseError.
+ */
+ColumnStats evaluateColumns(const ColumnFile& input, const std::string& expression,
+                            const Variables& variables, const ColumnOptions& options,
+                            const ColumnSink& sink);
+
+} // namespace calc
@@ -0,0 +1,377 @@
+#include "csv.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "program.hpp"
+#include "error.hpp"
+#include "ast/variable.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+
+#if defined(__cpp_lib_to_chars) || (defined(_MSC_VER) && _MSC_VER >= 1924)
+#include <charconv>
+#define CALC_FLOAT_FROM_CHARS 1
+#endif
+
+namespace calc {
+
+namespace {
+    std::string_view trim(std::string_view text) {
+        while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+            text.remove_prefix(1);
+        }
+        while (!text.empty() && (text.back() == ' ' || text.back() == '\t')) {
+            text.remove_suffix(1);
+        }
+        return text;
+    }
+
+    // Поля строки без окружающих пробелов и кавычек ("" внутри поля
+    // остаются удвоенными: числам они не нужны)
+    void splitFields(std::string_view line, char delimiter, std::vector<std::string_view>& fields) {
+        fields.clear();
+        size_t pos = 0;
+        while (true) {
+            size_t start = pos;
+            while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) {
+                ++pos;
+            }
+            if (pos < line.size() && line[pos] == '"') {
+                size_t open = ++pos;
+                while (pos < line.size() && !(line[pos] == '"' && (pos + 1 == line.size() || line[pos + 1] != '"'))) {
+                    pos += line[pos] == '"' ? 2 : 1;
+                }
+                fields.push_back(line.substr(open, pos - open));
+                pos = line.find(delimiter, pos);
+            } else {
+                pos = line.find(delimiter, start);
+                fields.push_back(trim(line.substr(start, pos == std::string_view::npos ? pos : pos - start)));
+            }
+            if (pos == std::string_view::npos) {
+                return;
+            }
+            ++pos;
+        }
+    }
+
+    std::string unescape(std::string_view field) {
+        std::string text(field);
+        for (size_t pos = text.find("\"\""); pos != std::string::npos; pos = text.find("\"\"", pos + 1)) {
+            text.erase(pos, 1);
+        }
+        return text;
+    }
+
+    bool isIdentifier(const std::string& name) {
+        if (name.empty() || !(std::isalpha(static_cast<unsigned char>(name[0])) || name[0] == '_')) {
+            return false;
+        }
+        return std::all_of(name.begin(), name.end(), [](char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+        });
+    }
+
+    bool parseNumber(std::string_view text, double& value) {
+        if (text.empty()) {
+            return false;
+        }
+#ifdef CALC_FLOAT_FROM_CHARS
+        std::from_chars_result result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+#else
+        char buf[64];
+        if (text.size() >= sizeof(buf)) {
+            return false;
+        }
+        std::memcpy(buf, text.data(), text.size());
+        buf[text.size()] = '\0';
+        char* end = nullptr;
+        value = std::strtod(buf, &end);
+        return end == buf + text.size();
+#endif
+    }
+
+    // Текстовое поле вывода: в кавычках, если содержит разделитель или кавычку
+    void appendField(std::string& out, std::string_view text, char delimiter) {
+        if (text.find(delimiter) == std::string_view::npos && text.find('"') == std::string_view::npos) {
+            out += text;
+            return;
+        }
+        out += '"';
+        for (char c : text) {
+            if (c == '"') {
+                out += '"';
+            }
+            out += c;
+        }
+        out += '"';
+    }
+
+    // Ячейки переменных, на которые ссылается дерево
+    void collectSlots(const Node* node, std::vector<const double*>& slots) {
+        if (auto* variable = dynamic_cast<const VariableNode*>(node)) {
+            slots.push_back(variable->slot());
+        }
+        for (size_t i = 0; i < node->childCount(); ++i) {
+            collectSlots(node->child(i), slots);
+        }
+    }
+
+    struct Column {
+        size_t field;                   // Номер поля в строке
+        std::string name;
+        double* slot;                   // Ячейка переменной (для вычисления деревом)
+        std::vector<double> values;     // Значения блока
+    };
+
+    struct RowError {
+        size_t row;
+        std::string message;
+    };
+
+    /**
+     * @brief Блок строк: исходный текст и столбцы значений
+     */
+    class Block {
+    public:
+        Block(std::vector<Column>& columns, size_t fieldCount, const CsvOptions& options)
+            : columns_(columns), fieldCount_(fieldCount), options_(options) {
+            for (Column& column : columns_) {
+                column.values.assign(options_.blockRows, 0.0);
+            }
+            ends_.reserve(options_.blockRows);
+            failed_.assign(options_.blockRows, 0);
+        }
+
+        bool full() const { return rows_ == options_.blockRows; }
+        size_t rows() const { return rows_; }
+
+        void add(std::string_view line) {
+            if (!options_.resultOnly) {
+                text_ += line;
+                ends_.push_back(text_.size());
+            }
+            splitFields(line, options_.delimiter, fields_);
+            if (fields_.size() != fieldCount_) {
+                fail("Expected " + std::to_string(fieldCount_) + " fields, got " +
+                     std::to_string(fields_.size()));
+            } else {
+                for (Column& column : columns_) {
+                    std::string_view field = fields_[column.field];
+                    if (!parseNumber(field, column.values[rows_])) {
+                        column.values[rows_] = 0.0;
+                        fail("Not a number in column " + column.name + ": \"" + std::string(field) + "\"");
+                        break;
+                    }
+                }
+            }
+            ++rows_;
+        }
+
+        /**
+         * @brief Записать строки блока с результатами results (ошибки — errors)
+         */
+        size_t write(const double* results, std::vector<RowError>& errors, std::string& out) {
+            // Ошибка разбора поля закрывает ошибку вычисления той же строки
+            errors.insert(errors.begin(), std::make_move_iterator(rowErrors_.begin()),
+                          std::make_move_iterator(rowErrors_.end()));
+            std::stable_sort(errors.begin(), errors.end(),
+                             [](const RowError& a, const RowError& b) { return a.row < b.row; });
+            size_t failed = 0;
+            size_t next = 0;
+            for (size_t row = 0; row < rows_; ++row) {
+                if (!options_.resultOnly) {
+                    size_t begin = row == 0 ? 0 : ends_[row - 1];
+                    out.append(text_, begin, ends_[row] - begin);
+                    out += options_.delimiter;
+                }
+                if (next < errors.size() && errors[next].row == row) {
+                    appendField(out, "error: " + errors[next].message, options_.delimiter);
+                    ++failed;
+                    while (next < errors.size() && errors[next].row == row) {
+                        ++next;
+                    }
+                } else {
+                    appendNumber(out, results[row], options_.format);
+                }
+                out += '\n';
+            }
+            return failed;
+        }
+
+        bool rowFailed(size_t row) const { return failed_[row] != 0; }
+
+        void clear() {
+            rows_ = 0;
+            text_.clear();
+            ends_.clear();
+            rowErrors_.clear();
+            std::fill(failed_.begin(), failed_.end(), 0);
+        }
+
+    private:
+        void fail(std::string message) {
+            rowErrors_.push_back({rows_, std::move(message)});
+            failed_[rows_] = 1;
+        }
+
+        std::vector<Column>& columns_;
+        size_t fieldCount_;
+        const CsvOptions& options_;
+        size_t rows_ = 0;
+        std::string text_;
+        std::vector<size_t> ends_;
+        std::vector<std::string_view> fields_;
+        std::vector<RowError> rowErrors_;
+        std::vector<char> failed_;
+    };
+}
+
+CsvStats runCsv(LineReader& input, BufferedWriter& output, const std::string& expression,
+                const Variables& variables, const CsvOptions& requested) {
+    CsvOptions options = requested;
+    options.blockRows = std::max<size_t>(options.blockRows, 1);
+    std::string_view line;
+    if (!input.next(line)) {
+        throw std::runtime_error("CSV input has no header");
+    }
+    std::vector<std::string_view> fields;
+    splitFields(line, options.delimiter, fields);
+    size_t fieldCount = fields.size();
+
+    // Столбцы-идентификаторы объявляются переменными поверх variables
+    Variables scope = variables;
+    std::vector<std::string> names;
+    for (std::string_view field : fields) {
+        names.push_back(unescape(field));
+    }
+    std::vector<Column> candidates;
+    for (size_t i = 0; i < names.size(); ++i) {
+        bool duplicate = std::any_of(candidates.begin(), candidates.end(),
+                                     [&](const Column& column) { return column.name == names[i]; });
+        // Столбец e или pi выражение прочитало бы как константу: такой
+        // столбец не связывается, а ссылка на него — ошибка
+        if (isReservedWord(names[i])) {
+            if (containsWord(expression, names[i])) {
+                throw ParseError("Invalid column name: " + names[i]);
+            }
+            continue;
+        }
+        if (isIdentifier(names[i]) && !duplicate) {
+            candidates.push_back({i, names[i], scope.bind(names[i]), {}});
+        }
+    }
+
+    Lexer lexer(expression);
+    Parser parser(lexer.tokenize(), &scope);
+    auto ast = parser.parse();
+    if (options.optimize) {
+        Optimizer optimizer(options.optimizer);
+        ast = optimizer.optimize(std::move(ast));
+    }
+
+    std::string out;
+    if (!options.resultOnly) {
+        out += line;
+        out += options.delimiter;
+    }
+    appendField(out, options.resultColumn, options.delimiter);
+    out += '\n';
+    output.write(out);
+
+    // Разбираются только столбцы, на которые ссылается выражение
+    std::vector<const double*> referenced;
+    collectSlots(ast.get(), referenced);
+    std::vector<Column> columns;
+    for (Column& column : candidates) {
+        if (std::find(referenced.begin(), referenced.end(), column.slot) != referenced.end()) {
+            columns.push_back(std::move(column));
+        }
+    }
+
+    CsvStats stats;
+    stats.columns = columns.size();
+    Program program;
+    try {
+        program = Program::compile(*ast);
+        stats.compiled = true;
+    } catch (const EvalError&) {
+        // sum/integrate/solve: вычисление деревом по строкам
+    }
+
+    // Столбцы программы: значения блока или постоянное значение переменной
+    ProgramView view = program.view();
+    std::vector<const double*> programColumns(view.variableCount(), nullptr);
+    std::vector<std::vector<double>> constantColumns(view.variableCount());
+    Block block(columns, fieldCount, options);
+    for (size_t v = 0; v < view.variableCount(); ++v) {
+        std::string name(view.variableName(v));
+        auto column = std::find_if(columns.begin(), columns.end(),
+                                   [&](const Column& c) { return c.name == name; });
+        if (column != columns.end()) {
+            programColumns[v] = column->values.data();
+        } else if (const double* slot = scope.find(name)) {
+            constantColumns[v].assign(options.blockRows, *slot);
+            programColumns[v] = constantColumns[v].data();
+        }
+    }
+
+    std::vector<double> results(options.blockRows);
+    std::vector<BatchError> batchErrors;
+    std::vector<RowError> errors;
+    auto flush = [&]() {
+        size_t rows = block.rows();
+        errors.clear();
+        if (stats.compiled) {
+            batchErrors.clear();
+            view.evaluateBatch(programColumns.data(), rows, results.data(), &batchErrors, options.accuracy);
+            for (BatchError& error : batchErrors) {
+                errors.push_back({error.index, std::move(error.message)});
+            }
+        } else {
+            for (size_t row = 0; row < rows; ++row) {
+                if (block.rowFailed(row)) {
+                    continue;
+                }
+                for (Column& column : columns) {
+                    *column.slot = column.values[row];
+                }
+                try {
+                    results[row] = ast->evaluate();
+                } catch (const EvalError& e) {
+                    errors.push_back({row, e.what()});
+                }
+            }
+        }
+        out.clear();
+        stats.errors += block.write(results.data(), errors, out);
+        stats.rows += rows;
+        output.write(out);
+        block.clear();
+    };
+
+    while (input.next(line)) {
+        if (trim(line).empty()) {
+            continue;
+        }
+        block.add(line);
+        if (block.full()) {
+            flush();
+        }
+    }
+    if (block.rows() > 0) {
+        flush();
+    }
+    output.flush();
+    return stats;
+}
+
+} // namespace calc
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "batch.hpp"
+#include "format.hpp"
+#include "optimizer.hpp"
+#include "variables.hpp"
+#include "vecmath.hpp"
+#include <cstddef>
+#include <string>
+
+namespace calc {
+
+/**
+ * @brief Параметры вычисления по столбцам CSV
+ */
+struct CsvOptions {
+    char delimiter = ',';
+    std::string resultColumn = "result";    // Заголовок столбца результата
+    bool resultOnly = false;                // Писать только результат, без исходных столбцов
+    size_t blockRows = 4096;                // Строк в блоке столбцов
+    bool optimize = false;
+    OptimizerOptions optimizer;
+    FormatOptions format;
+    vecmath::Accuracy accuracy = vecmath::Accuracy::Libm;  // Точность функций в блоках
+};
+
+/**
+ * @brief Итог вычисления по CSV
+ */
+struct CsvStats {
+    size_t rows = 0;
+    size_t errors = 0;          // Строк с ошибкой разбора поля или вычисления
+    size_t columns = 0;         // Столбцов файла, на которые ссылается выражение
+    bool compiled = false;      // Блоки вычислялись программой (иначе — дерево по строкам)
+};
+
+/**
+ * @brief Вычислить expression для каждой строки CSV
+ *
+ * Первая строка — заголовок: столбцы, имена которых — идентификаторы,
+ * становятся переменными выражения (и закрывают одноимённые переменные
+ * из variables). Файл читается блоками; поля столбцов, на которые
+ * ссылается выражение, разбираются в столбцовые буферы по blockRows
+ * строк, и выражение, скомпилированное в Program, вычисляется над всем
+ * блоком (ProgramView::evaluateBatch). Выражения с sum/prod/integrate/
+ * solve вычисляются деревом по строкам.
+ *
+ * В вывод пишется заголовок и по строке на строку ввода: исходная
+ * строка и результат через разделитель (или только результат).
+ * Нечисловое поле, неверное число полей и ошибка вычисления пишутся на
+ * месте результата как "error: сообщение" и не прерывают обработку;
+ * пустые строки пропускаются. Поля в кавычках ("a,b", "" внутри)
+ * поддерживаются, перевод строки внутри поля — нет.
+ *
+ * Столбец с именем константы или операции (e, pi, AND, ...) не
+ * связывается; если это слово есть в выражении — ParseError, как и
+ * ошибка разбора выражения. Файл без заголовка — std::runtime_error.
+ */
+CsvStats runCsv(LineReader& input, BufferedWriter& output, const std::string& expression,
+                const Variables& variables, const CsvOptions& options);
+
+} // namespace calc
@@ -17,4 +17,24 @@ public:
         : std::runtime_error(message) {}
 };
 
+/**
+ * @brief Повреждённый или несовместимый двоичный файл (библиотека формул)
+ */
+class FormatError : public std::runtime_error {
+public:
+    explicit FormatError(const std::string& message)
+        : std::runtime_error(message) {}
+};
+
+/**
+ * @brief Вычисление отменено (CancellationToken)
+ *
+ * Не наследует EvalError: отмена прерывает всё вычисление, а не одну
+ * строку пакета или точку табулирования.
+ */
+class CancelledError : public std::runtime_error {
+public:
+    CancelledError() : std::runtime_error("Evaluation cancelled") {}
+};
+
 } // namespace calc
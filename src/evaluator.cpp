@@ -1,12 +1,53 @@
 #include "evaluator.hpp"
+#include <cfenv>
+#include <cmath>
+
+#ifdef _MSC_VER
+#pragma fenv_access (on)
+#endif
 
 namespace calc {
 
+namespace {
+    constexpr int DEFERRED_FLAGS = FE_OVERFLOW | FE_INVALID | FE_DIVBYZERO;
+}
+
 double Evaluator::evaluate(const std::unique_ptr<Node>& root) {
     if (!root) {
         return 0.0;
     }
+    if (mode_ == EvalMode::Deferred) {
+        return evaluateDeferred(*root);
+    }
     return root->evaluate();
 }
 
+double Evaluator::evaluateDeferred(const Node& root) {
+    // fetestexcept дешёв, а feclearexcept (x87 fnstenv/fldenv) стоит
+    // около сотни наносекунд, поэтому флаги сбрасываются только тогда,
+    // когда они действительно подняты. Флаги вызывающего кода сохраняются.
+    int before = std::fetestexcept(DEFERRED_FLAGS);
+    std::fexcept_t saved;
+    if (before != 0) {
+        std::fegetexceptflag(&saved, DEFERRED_FLAGS);
+        std::feclearexcept(DEFERRED_FLAGS);
+    }
+    
+    double result = root.evaluateUnchecked();
+    int raised = std::fetestexcept(DEFERRED_FLAGS);
+    bool failed = raised != 0 || !std::isfinite(result);
+    
+    if (before != 0) {
+        std::fesetexceptflag(&saved, DEFERRED_FLAGS);
+    } else if (raised != 0) {
+        std::feclearexcept(raised);
+    }
+    
+    if (failed) {
+        // Повторное вычисление с проверками даёт то же сообщение, что и режим Checked
+        return root.evaluate();
+    }
+    return result;
+}
+
 } // namespace calc
@@ -5,9 +5,28 @@
 
 namespace calc {
 
+/**
+ * @brief Режим проверки ошибок при вычислении
+ */
+enum class EvalMode {
+    Checked,    // Проверка NaN/Infinity после каждой операции
+    Deferred    // Вычисление без проверок и одна проверка флагов <cfenv> в конце;
+                // при поднятом флаге выражение перевычисляется в режиме Checked,
+                // чтобы получить точное сообщение об ошибке
+};
+
 class Evaluator {
 public:
+    explicit Evaluator(EvalMode mode = EvalMode::Checked) : mode_(mode) {}
+    
     double evaluate(const std::unique_ptr<Node>& root);
+    
+    EvalMode mode() const { return mode_; }
+    
+private:
+    double evaluateDeferred(const Node& root);
+    
+    EvalMode mode_;
 };
 
 } // namespace calc
@@ -0,0 +1,276 @@
+#include "format.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if __has_include(<version>)
+#include <version>
+#endif
+
+#if defined(__cpp_lib_to_chars) || (defined(_MSC_VER) && _MSC_VER >= 1924)
+#include <charconv>
+#define CALC_FLOAT_TO_CHARS 1
+#endif
+
+namespace calc {
+
+namespace {
+
+    char* copy(char* first, char* last, const char* text, size_t size) {
+        if (static_cast<size_t>(last - first) < size) {
+            return nullptr;
+        }
+        std::memcpy(first, text, size);
+        return first + size;
+    }
+
+#ifdef CALC_FLOAT_TO_CHARS
+    // std::to_chars: кратчайшая запись по алгоритму Ryu (libstdc++, MSVC)
+    char* checked(std::to_chars_result result) {
+        return result.ec == std::errc() ? result.ptr : nullptr;
+    }
+
+    char* toChars(char* first, char* last, double value, std::chars_format format, int precision) {
+        return checked(precision < 0 ? std::to_chars(first, last, value, format)
+                                     : std::to_chars(first, last, value, format, precision));
+    }
+#else
+    // Стандартная библиотека без std::to_chars для double (старый libc++):
+    // кратчайшая запись подбирается по числу цифр с проверкой strtod
+    // snprintf пишет завершающий нуль: печать во временный буфер
+    char* print(char* first, char* last, const char* format, int digits, double value,
+                bool roundTrip = false) {
+        char buf[FORMAT_BUFFER_SIZE + 1];
+        int length = std::snprintf(buf, sizeof(buf), format, digits, value);
+        if (length < 0 || (roundTrip && std::strtod(buf, nullptr) != value)) {
+            return nullptr;
+        }
+        return copy(first, last, buf, static_cast<size_t>(length));
+    }
+
+    char* printShortest(char* first, char* last, double value, const char* format, int from, int to) {
+        for (int digits = from; digits < to; ++digits) {
+            if (char* end = print(first, last, format, digits, value, true)) {
+                return end;
+            }
+        }
+        return print(first, last, format, to, value);
+    }
+#endif
+
+    char* writeGeneral(char* first, char* last, double value, int precision) {
+#ifdef CALC_FLOAT_TO_CHARS
+        return precision < 0 ? checked(std::to_chars(first, last, value))
+                             : toChars(first, last, value, std::chars_format::general, std::max(precision, 1));
+#else
+        if (precision < 0) {
+            return printShortest(first, last, value, "%.*g", 15, 17);
+        }
+        return print(first, last, "%.*g", std::max(precision, 1), value);
+#endif
+    }
+
+    char* writeScientific(char* first, char* last, double value, int precision) {
+#ifdef CALC_FLOAT_TO_CHARS
+        return toChars(first, last, value, std::chars_format::scientific, precision);
+#else
+        if (precision < 0) {
+            return printShortest(first, last, value, "%.*e", 0, 16);
+        }
+        return print(first, last, "%.*e", precision, value);
+#endif
+    }
+
+    char* writeHex(char* first, char* last, double value, int precision) {
+#ifdef CALC_FLOAT_TO_CHARS
+        // to_chars пишет без "0x": префикс вставляется после знака
+        char* digits = first + (std::signbit(value) ? 1 : 0);
+        if (last - digits < 2) {
+            return nullptr;
+        }
+        char* end = toChars(digits + 2, last, std::fabs(value), std::chars_format::hex, precision);
+        if (!end) {
+            return nullptr;
+        }
+        if (digits != first) {
+            first[0] = '-';
+        }
+        digits[0] = '0';
+        digits[1] = 'x';
+        return end;
+#else
+        return precision < 0 ? printShortest(first, last, value, "%.*a", 0, 13)
+                             : print(first, last, "%.*a", precision, value);
+#endif
+    }
+
+    // Цифры digits[0..count) с intDigits цифрами до точки: intDigits <= 0
+    // даёт "0.00ddd", intDigits > count дополняется нулями
+    char* writePositional(char* first, char* last, const char* digits, int count, int intDigits) {
+        size_t size = intDigits <= 0 ? 2 + static_cast<size_t>(count - intDigits)
+                                     : static_cast<size_t>(std::max(count, intDigits) + (count > intDigits ? 1 : 0));
+        if (static_cast<size_t>(last - first) < size) {
+            return nullptr;
+        }
+        if (intDigits <= 0) {
+            *first++ = '0';
+            *first++ = '.';
+            first = std::fill_n(first, -intDigits, '0');
+            return std::copy(digits, digits + count, first);
+        }
+        int head = std::min(count, intDigits);
+        first = std::copy(digits, digits + head, first);
+        first = std::fill_n(first, intDigits - head, '0');
+        if (count > intDigits) {
+            *first++ = '.';
+            first = std::copy(digits + intDigits, digits + count, first);
+        }
+        return first;
+    }
+
+    // Разбор научной записи [-]d[.ddd]e±XX: цифры без точки и порядок
+    struct Decomposed {
+        bool negative = false;
+        char digits[MAX_PRECISION + 2];
+        int count = 0;
+        int exponent = 0;
+    };
+
+    Decomposed decompose(const char* first, const char* last) {
+        Decomposed result;
+        if (*first == '-') {
+            result.negative = true;
+            ++first;
+        }
+        for (; first < last && *first != 'e'; ++first) {
+            if (*first != '.') {
+                result.digits[result.count++] = *first;
+            }
+        }
+        // Буфер не завершён нулём: порядок разбирается до last
+        bool negativeExponent = first + 1 < last && first[1] == '-';
+        for (first += 2; first < last; ++first) {
+            result.exponent = result.exponent * 10 + (*first - '0');
+        }
+        if (negativeExponent) {
+            result.exponent = -result.exponent;
+        }
+        return result;
+    }
+
+    // Порядок как у to_chars: знак и не меньше двух цифр
+    char* writeExponent(char* first, char* last, int exponent) {
+        char buf[8];
+        char* end = buf + sizeof(buf);
+        char* begin = end;
+        unsigned magnitude = static_cast<unsigned>(exponent < 0 ? -exponent : exponent);
+        do {
+            *--begin = static_cast<char>('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude > 0 || end - begin < 2);
+        *--begin = exponent < 0 ? '-' : '+';
+        *--begin = 'e';
+        return copy(first, last, begin, static_cast<size_t>(end - begin));
+    }
+
+    char* writeEngineering(char* first, char* last, double value, int precision) {
+        char scientific[MAX_PRECISION + 16];
+        char* end = writeScientific(scientific, scientific + sizeof(scientific), value, precision);
+        if (!end) {
+            return nullptr;
+        }
+        Decomposed number = decompose(scientific, end);
+        // Порядок опускается до кратного трём, точка сдвигается вправо
+        int shift = ((number.exponent % 3) + 3) % 3;
+        if (number.negative) {
+            first = copy(first, last, "-", 1);
+        }
+        if (first) {
+            first = writePositional(first, last, number.digits, number.count, shift + 1);
+        }
+        return first ? writeExponent(first, last, number.exponent - shift) : nullptr;
+    }
+
+    char* writeFixed(char* first, char* last, double value, int precision) {
+#ifdef CALC_FLOAT_TO_CHARS
+        return toChars(first, last, value, std::chars_format::fixed, precision);
+#else
+        if (precision >= 0) {
+            return print(first, last, "%.*f", precision, value);
+        }
+        // Кратчайшие цифры научной записи, расставленные без порядка
+        char scientific[32];
+        char* end = writeScientific(scientific, scientific + sizeof(scientific), value, -1);
+        if (!end) {
+            return nullptr;
+        }
+        Decomposed number = decompose(scientific, end);
+        if (number.count == 1 && number.digits[0] == '0') {
+            number.exponent = 0;
+        }
+        if (number.negative) {
+            first = copy(first, last, "-", 1);
+        }
+        return first ? writePositional(first, last, number.digits, number.count, number.exponent + 1) : nullptr;
+#endif
+    }
+}
+
+char* formatNumber(char* first, char* last, double value, const FormatOptions& options) {
+    if (std::isnan(value)) {
+        return copy(first, last, "nan", 3);
+    }
+    if (std::isinf(value)) {
+        return value < 0 ? copy(first, last, "-inf", 4) : copy(first, last, "inf", 3);
+    }
+    int precision = std::min(options.precision, MAX_PRECISION);
+    switch (options.style) {
+        case NumberFormat::Shortest:
+            return writeGeneral(first, last, value, precision);
+        case NumberFormat::Fixed:
+            return writeFixed(first, last, value, precision);
+        case NumberFormat::Scientific:
+            return writeScientific(first, last, value, precision);
+        case NumberFormat::Hex:
+            return writeHex(first, last, value, precision);
+        case NumberFormat::Engineering:
+            return writeEngineering(first, last, value, precision);
+    }
+    return nullptr;
+}
+
+void appendNumber(std::string& out, double value, const FormatOptions& options) {
+    char buf[FORMAT_BUFFER_SIZE];
+    char* end = formatNumber(buf, buf + sizeof(buf), value, options);
+    out.append(buf, static_cast<size_t>(end - buf));
+}
+
+std::string formatNumber(double value, const FormatOptions& options) {
+    std::string text;
+    appendNumber(text, value, options);
+    return text;
+}
+
+bool parseNumberFormat(const std::string& name, NumberFormat& style) {
+    static const struct {
+        const char* name;
+        NumberFormat style;
+    } styles[] = {
+        {"shortest", NumberFormat::Shortest},
+        {"fixed", NumberFormat::Fixed},
+        {"scientific", NumberFormat::Scientific},
+        {"hex", NumberFormat::Hex},
+        {"engineering", NumberFormat::Engineering},
+    };
+    for (const auto& entry : styles) {
+        if (name == entry.name) {
+            style = entry.style;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace calc
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace calc {
+
+/**
+ * @brief Запись числа
+ */
+enum class NumberFormat {
+    Shortest,       // Кратчайшая запись, которая читается обратно в то же число
+    Fixed,          // 1234.5
+    Scientific,     // 1.2345e+03
+    Hex,            // 0x1.34a0000000000p+10 (точное двоичное значение)
+    Engineering     // 1.2345e+03, порядок кратен трём: 12.5e+03, 125e-06
+};
+
+/**
+ * @brief Параметры форматирования результата
+ *
+ * precision < 0 — кратчайшая запись в выбранном виде, при которой число
+ * читается обратно без потерь. Иначе — цифр после точки (для Fixed), цифр
+ * после первой значащей (для Scientific, Hex и Engineering); для Shortest
+ * — значащих цифр, как %g. precision больше MAX_PRECISION ограничивается.
+ */
+struct FormatOptions {
+    NumberFormat style = NumberFormat::Shortest;
+    int precision = -1;
+};
+
+constexpr int MAX_PRECISION = 40;
+
+/**
+ * @brief Размер буфера, в который помещается любое число в любом виде
+ *
+ * Самая длинная запись — Fixed для ±1.8e308: 309 цифр целой части, точка
+ * и MAX_PRECISION дробных.
+ */
+constexpr size_t FORMAT_BUFFER_SIZE = 384;
+
+/**
+ * @brief Записать value в [first, last), без выделения памяти
+ *
+ * Возвращает конец записанного (без завершающего нуля) или nullptr, если
+ * буфер мал; буфера FORMAT_BUFFER_SIZE хватает всегда. Бесконечность и
+ * NaN — "inf", "-inf", "nan".
+ */
+char* formatNumber(char* first, char* last, double value, const FormatOptions& options = FormatOptions());
+
+/**
+ * @brief Дописать value в конец out
+ */
+void appendNumber(std::string& out, double value, const FormatOptions& options = FormatOptions());
+
+/**
+ * @brief value строкой
+ */
+std::string formatNumber(double value, const FormatOptions& options = FormatOptions());
+
+/**
+ * @brief Разобрать имя вида: "shortest", "fixed", "scientific", "hex", "engineering"
+ *
+ * false — имя неизвестно.
+ */
+bool parseNumberFormat(const std::string& name, NumberFormat& style);
+
+} // namespace calc
@@ -0,0 +1,276 @@
+#include "formula_library.hpp"
+#include "checksum.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace calc {
+
+using library_format::FormulaEntry;
+using library_format::LibraryHeader;
+
+namespace {
+    constexpr size_t ALIGNMENT = 8;
+
+    size_t alignUp(size_t value) {
+        return (value + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    // Контрольная сумма формулы: код, константы, имя и имена переменных
+    uint32_t entryChecksum(const FormulaEntry& entry, const Instruction* code,
+                           const double* constants, const NameRef* names, const char* strings) {
+        uint32_t crc = crc32(code + entry.codeIndex, entry.codeCount * sizeof(Instruction));
+        crc = crc32(constants + entry.constantIndex, entry.constantCount * sizeof(double), crc);
+        crc = crc32(strings + entry.name.offset, entry.name.length, crc);
+        for (uint32_t i = 0; i < entry.variableCount; ++i) {
+            const NameRef& ref = names[entry.variableIndex + i];
+            crc = crc32(&ref.length, sizeof(ref.length), crc);
+            crc = crc32(strings + ref.offset, ref.length, crc);
+        }
+        return crc;
+    }
+
+    uint32_t headerChecksum(LibraryHeader header) {
+        header.headerChecksum = 0;
+        return crc32(&header, sizeof(header));
+    }
+
+    // Секция из count элементов размера elementSize по смещению offset лежит в файле
+    bool sectionFits(uint64_t offset, uint64_t count, uint64_t elementSize, size_t fileSize,
+                     bool aligned = true) {
+        if (offset > fileSize || (aligned && offset % ALIGNMENT != 0)) {
+            return false;
+        }
+        return count <= (fileSize - offset) / elementSize;
+    }
+
+    bool rangeFits(uint32_t start, uint32_t count, uint32_t total) {
+        return start <= total && count <= total - start;
+    }
+}
+
+void LibraryWriter::add(const std::string& name, const Program& program) {
+    for (const auto& formula : formulas_) {
+        if (formula.first == name) {
+            throw std::invalid_argument("Duplicate formula name: " + name);
+        }
+    }
+    formulas_.emplace_back(name, program);
+}
+
+std::string LibraryWriter::serialize() const {
+    std::vector<const std::pair<std::string, Program>*> sorted;
+    sorted.reserve(formulas_.size());
+    for (const auto& formula : formulas_) {
+        sorted.push_back(&formula);
+    }
+    std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) {
+        return a->first < b->first;
+    });
+
+    std::vector<FormulaEntry> index;
+    std::vector<Instruction> code;
+    std::vector<double> constants;
+    std::vector<NameRef> names;
+    std::vector<char> strings;
+
+    auto addString = [&strings](std::string_view text) {
+        NameRef ref;
+        ref.offset = static_cast<uint32_t>(strings.size());
+        ref.length = static_cast<uint32_t>(text.size());
+        strings.insert(strings.end(), text.begin(), text.end());
+        return ref;
+    };
+
+    for (const auto* formula : sorted) {
+        const Program& program = formula->second;
+        ProgramView view = program.view();
+
+        FormulaEntry entry{};
+        entry.name = addString(formula->first);
+        entry.codeIndex = static_cast<uint32_t>(code.size());
+        entry.codeCount = static_cast<uint32_t>(view.size());
+        entry.constantIndex = static_cast<uint32_t>(constants.size());
+        entry.constantCount = static_cast<uint32_t>(view.constantCount());
+        entry.variableIndex = static_cast<uint32_t>(names.size());
+        entry.variableCount = static_cast<uint32_t>(view.variableCount());
+        entry.maxStack = static_cast<uint32_t>(view.maxStack());
+
+        code.insert(code.end(), program.code().begin(), program.code().end());
+        constants.insert(constants.end(), program.constants().begin(), program.constants().end());
+        for (size_t i = 0; i < view.variableCount(); ++i) {
+            names.push_back(addString(view.variableName(i)));
+        }
+        index.push_back(entry);
+    }
+    for (auto& entry : index) {
+        entry.checksum = entryChecksum(entry, code.data(), constants.data(), names.data(), strings.data());
+    }
+
+    LibraryHeader header{};
+    std::memcpy(header.magic, library_format::MAGIC, sizeof(header.magic));
+    header.version = library_format::VERSION;
+    header.byteOrder = library_format::BYTE_ORDER_MARK;
+    header.formulaCount = static_cast<uint32_t>(index.size());
+    header.codeCount = static_cast<uint32_t>(code.size());
+    header.constantCount = static_cast<uint32_t>(constants.size());
+    header.nameCount = static_cast<uint32_t>(names.size());
+    header.stringsSize = static_cast<uint32_t>(strings.size());
+    header.indexOffset = sizeof(LibraryHeader);
+    header.codeOffset = alignUp(header.indexOffset + index.size() * sizeof(FormulaEntry));
+    header.constantsOffset = alignUp(header.codeOffset + code.size() * sizeof(Instruction));
+    header.namesOffset = alignUp(header.constantsOffset + constants.size() * sizeof(double));
+    header.stringsOffset = alignUp(header.namesOffset + names.size() * sizeof(NameRef));
+    header.fileSize = header.stringsOffset + strings.size();
+
+    std::string image(static_cast<size_t>(header.fileSize), '\0');
+    auto place = [&image](uint64_t offset, const void* data, size_t size) {
+        if (size > 0) {
+            std::memcpy(&image[static_cast<size_t>(offset)], data, size);
+        }
+    };
+    place(header.indexOffset, index.data(), index.size() * sizeof(FormulaEntry));
+    place(header.codeOffset, code.data(), code.size() * sizeof(Instruction));
+    place(header.constantsOffset, constants.data(), constants.size() * sizeof(double));
+    place(header.namesOffset, names.data(), names.size() * sizeof(NameRef));
+    place(header.stringsOffset, strings.data(), strings.size());
+
+    header.payloadChecksum = crc32(image.data() + sizeof(LibraryHeader),
+                                   image.size() - sizeof(LibraryHeader));
+    header.headerChecksum = headerChecksum(header);
+    place(0, &header, sizeof(header));
+    return image;
+}
+
+void LibraryWriter::write(const std::string& path) const {
+    std::string image = serialize();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open file for writing: " + path);
+    }
+    out.write(image.data(), static_cast<std::streamsize>(image.size()));
+    if (!out) {
+        throw std::runtime_error("Cannot write file: " + path);
+    }
+}
+
+FormulaLibrary::FormulaLibrary(const std::string& path, LibraryOptions options)
+    : file_(path), options_(options) {
+    open(file_.data(), file_.size());
+}
+
+FormulaLibrary::FormulaLibrary(const void* data, size_t size, LibraryOptions options)
+    : options_(options) {
+    open(static_cast<const char*>(data), size);
+}
+
+void FormulaLibrary::open(const char* data, size_t size) {
+    if (size < sizeof(LibraryHeader)) {
+        throw FormatError("Not a formula library: file too short");
+    }
+    if (reinterpret_cast<uintptr_t>(data) % ALIGNMENT != 0) {
+        throw FormatError("Formula library buffer is not 8-byte aligned");
+    }
+
+    const auto* header = reinterpret_cast<const LibraryHeader*>(data);
+    if (std::memcmp(header->magic, library_format::MAGIC, sizeof(header->magic)) != 0) {
+        throw FormatError("Not a formula library: bad magic");
+    }
+    if (header->byteOrder != library_format::BYTE_ORDER_MARK) {
+        throw FormatError("Formula library has foreign byte order");
+    }
+    if (header->version != library_format::VERSION) {
+        throw FormatError("Unsupported formula library version " + std::to_string(header->version));
+    }
+    if (header->headerChecksum != headerChecksum(*header)) {
+        throw FormatError("Formula library header checksum mismatch");
+    }
+    if (header->fileSize != size) {
+        throw FormatError("Formula library size mismatch (truncated file?)");
+    }
+    if (!sectionFits(header->indexOffset, header->formulaCount, sizeof(FormulaEntry), size) ||
+        !sectionFits(header->codeOffset, header->codeCount, sizeof(Instruction), size) ||
+        !sectionFits(header->constantsOffset, header->constantCount, sizeof(double), size) ||
+        !sectionFits(header->namesOffset, header->nameCount, sizeof(NameRef), size) ||
+        !sectionFits(header->stringsOffset, header->stringsSize, 1, size, false)) {
+        throw FormatError("Formula library section out of range");
+    }
+
+    header_ = header;
+    index_ = reinterpret_cast<const FormulaEntry*>(data + header->indexOffset);
+    code_ = reinterpret_cast<const Instruction*>(data + header->codeOffset);
+    constants_ = reinterpret_cast<const double*>(data + header->constantsOffset);
+    names_ = reinterpret_cast<const NameRef*>(data + header->namesOffset);
+    strings_ = data + header->stringsOffset;
+
+    // Индекс проверяется всегда: от него зависят границы всех остальных чтений
+    for (uint32_t i = 0; i < header->formulaCount; ++i) {
+        const FormulaEntry& entry = index_[i];
+        if (!rangeFits(entry.name.offset, entry.name.length, header->stringsSize) ||
+            !rangeFits(entry.codeIndex, entry.codeCount, header->codeCount) ||
+            !rangeFits(entry.constantIndex, entry.constantCount, header->constantCount) ||
+            !rangeFits(entry.variableIndex, entry.variableCount, header->nameCount) ||
+            entry.maxStack == 0 || entry.maxStack > entry.codeCount) {
+            throw FormatError("Formula library index entry " + std::to_string(i) + " out of range");
+        }
+    }
+
+    if (options_.verifyOnOpen) {
+        uint32_t payload = crc32(data + sizeof(LibraryHeader), size - sizeof(LibraryHeader));
+        if (payload != header->payloadChecksum) {
+            throw FormatError("Formula library checksum mismatch");
+        }
+        for (uint32_t i = 0; i < header->formulaCount; ++i) {
+            viewOf(index_[i]).validate(header->stringsSize);
+        }
+    }
+}
+
+ProgramView FormulaLibrary::viewOf(const FormulaEntry& entry) const {
+    return ProgramView(code_ + entry.codeIndex, entry.codeCount,
+                       constants_ + entry.constantIndex, entry.constantCount,
+                       names_ + entry.variableIndex, entry.variableCount,
+                       strings_, entry.maxStack);
+}
+
+void FormulaLibrary::verifyEntry(const FormulaEntry& entry) const {
+    ProgramView view = viewOf(entry);
+    // Имена переменных проверяются до подсчёта суммы, которая их читает
+    view.validate(header_->stringsSize);
+    if (entryChecksum(entry, code_, constants_, names_, strings_) != entry.checksum) {
+        throw FormatError("Checksum mismatch in formula " + std::string(name(&entry - index_)));
+    }
+}
+
+std::string_view FormulaLibrary::name(size_t index) const {
+    const NameRef& ref = index_[index].name;
+    return std::string_view(strings_ + ref.offset, ref.length);
+}
+
+ProgramView FormulaLibrary::program(size_t index) const {
+    if (!options_.verifyOnOpen) {
+        verifyEntry(index_[index]);
+    }
+    return viewOf(index_[index]);
+}
+
+std::optional<ProgramView> FormulaLibrary::find(std::string_view name) const {
+    size_t lo = 0;
+    size_t hi = size();
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        std::string_view candidate = this->name(mid);
+        if (candidate < name) {
+            lo = mid + 1;
+        } else if (name < candidate) {
+            hi = mid;
+        } else {
+            return program(mid);
+        }
+    }
+    return std::nullopt;
+}
+
+} // namespace calc
@@ -0,0 +1,157 @@
+#pragma once
+
+#include "program.hpp"
+#include "mapped_file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace calc {
+
+/**
+ * @brief Двоичный формат библиотеки скомпилированных формул (версия 1)
+ *
+ * Файл целиком состоит из смещений и индексов, поэтому используется прямо
+ * из отображённой памяти без разбора и выделений. Порядок байтов — как у
+ * записавшей машины (на практике little endian), файл с чужим порядком
+ * отвергается; секции выровнены на 8 байт:
+ *
+ *   LibraryHeader
+ *   FormulaEntry[formulaCount]   — индекс, отсортированный по имени
+ *   Instruction[codeCount]       — код всех формул подряд
+ *   double[constantCount]        — константы
+ *   NameRef[nameCount]           — имена переменных
+ *   char[stringsSize]            — имена формул и переменных
+ *
+ * Индексы инструкций (константы, переменные) отсчитываются от начала
+ * участка своей формулы.
+ */
+namespace library_format {
+
+constexpr char MAGIC[8] = {'C', 'A', 'L', 'C', 'L', 'I', 'B', '\0'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+struct LibraryHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;         // BYTE_ORDER_MARK в порядке байтов записавшей машины
+    uint32_t formulaCount;
+    uint32_t codeCount;
+    uint32_t constantCount;
+    uint32_t nameCount;
+    uint32_t stringsSize;
+    uint32_t payloadChecksum;   // CRC-32 всего, что следует за заголовком
+    uint32_t headerChecksum;    // CRC-32 заголовка с нулём в этом поле
+    uint32_t reserved;
+    uint64_t fileSize;
+    uint64_t indexOffset;
+    uint64_t codeOffset;
+    uint64_t constantsOffset;
+    uint64_t namesOffset;
+    uint64_t stringsOffset;
+};
+
+struct FormulaEntry {
+    NameRef name;
+    uint32_t codeIndex;
+    uint32_t codeCount;
+    uint32_t constantIndex;
+    uint32_t constantCount;
+    uint32_t variableIndex;
+    uint32_t variableCount;
+    uint32_t maxStack;
+    uint32_t checksum;          // CRC-32 кода, констант и имён формулы
+};
+
+static_assert(sizeof(LibraryHeader) == 96, "LibraryHeader is part of the binary format");
+static_assert(sizeof(FormulaEntry) == 40, "FormulaEntry is part of the binary format");
+
+} // namespace library_format
+
+/**
+ * @brief Сборка библиотеки формул
+ */
+class LibraryWriter {
+public:
+    /**
+     * @brief Добавить формулу; повторное имя — std::invalid_argument
+     */
+    void add(const std::string& name, const Program& program);
+
+    size_t size() const { return formulas_.size(); }
+
+    /**
+     * @brief Образ файла библиотеки
+     */
+    std::string serialize() const;
+
+    /**
+     * @brief Записать библиотеку в файл (ошибка записи — std::runtime_error)
+     */
+    void write(const std::string& path) const;
+
+private:
+    std::vector<std::pair<std::string, Program>> formulas_;
+};
+
+/**
+ * @brief Параметры открытия библиотеки
+ */
+struct LibraryOptions {
+    /**
+     * true — при открытии проверяются контрольная сумма всего файла и
+     * структура каждой формулы (читается весь файл).
+     * false — при открытии проверяются только заголовок и индекс, а
+     * контрольная сумма и структура формулы — при каждом find(); открытие
+     * не зависит от размера библиотеки.
+     */
+    bool verifyOnOpen = true;
+};
+
+/**
+ * @brief Библиотека формул, открытая из файла или буфера в памяти
+ *
+ * Поиск по имени — двоичный поиск по индексу; формулы возвращаются как
+ * ProgramView над памятью библиотеки и действительны, пока жив объект.
+ * Повреждённый или несовместимый файл — FormatError.
+ */
+class FormulaLibrary {
+public:
+    explicit FormulaLibrary(const std::string& path, LibraryOptions options = {});
+
+    /**
+     * @brief Библиотека над чужим буфером (должен жить дольше объекта,
+     * выровнен на 8 байт)
+     */
+    FormulaLibrary(const void* data, size_t size, LibraryOptions options = {});
+
+    size_t size() const { return header_->formulaCount; }
+    std::string_view name(size_t index) const;
+    ProgramView program(size_t index) const;
+
+    /**
+     * @brief Формула по имени (std::nullopt, если её нет)
+     */
+    std::optional<ProgramView> find(std::string_view name) const;
+
+private:
+    void open(const char* data, size_t size);
+    ProgramView viewOf(const library_format::FormulaEntry& entry) const;
+    void verifyEntry(const library_format::FormulaEntry& entry) const;
+
+    MappedFile file_;
+    LibraryOptions options_;
+    const library_format::LibraryHeader* header_ = nullptr;
+    const library_format::FormulaEntry* index_ = nullptr;
+    const Instruction* code_ = nullptr;
+    const double* constants_ = nullptr;
+    const NameRef* names_ = nullptr;
+    const char* strings_ = nullptr;
+};
+
+} // namespace calc
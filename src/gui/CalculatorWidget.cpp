@@ -1,13 +1,16 @@
 #include "CalculatorWidget.hpp"
 #include "../lexer.hpp"
 #include "../parser.hpp"
-#include "../evaluator.hpp"
 #include "../error.hpp"
+#include "../format.hpp"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QMessageBox>
-#include <sstream>
-#include <iomanip>
+#include <QMetaObject>
+#include <QShortcut>
+#include <QStandardPaths>
+#include <QDir>
+#include <QFile>
 
 namespace calc {
 
@@ -16,6 +19,11 @@ CalculatorWidget::CalculatorWidget(QWidget* parent)
     setupUI();
 }
 
+CalculatorWidget::~CalculatorWidget() {
+    // Отменить и дождаться потока, пока виджет ещё жив
+    evaluation_.reset();
+}
+
 void CalculatorWidget::setupUI() {
     auto* mainLayout = new QVBoxLayout(this);
     mainLayout->setContentsMargins(0, 0, 0, 0);
@@ -49,6 +57,35 @@ void CalculatorWidget::setupUI() {
     
     headerLayout->addStretch();
     
+    // Прогресс и отмена долгого вычисления
+    progressBar_ = new QProgressBar(this);
+    progressBar_->setObjectName("evaluationProgress");
+    progressBar_->setRange(0, 1000);
+    progressBar_->setTextVisible(false);
+    progressBar_->setFixedWidth(120);
+    headerLayout->addWidget(progressBar_);
+    
+    cancelButton_ = new QPushButton("✕", this);
+    cancelButton_->setObjectName("cancelButton");
+    cancelButton_->setFixedSize(32, 32);
+    cancelButton_->setToolTip("Отменить вычисление (Esc)");
+    connect(cancelButton_, &QPushButton::clicked, this, &CalculatorWidget::onCancelClicked);
+    headerLayout->addWidget(cancelButton_);
+    
+    auto* cancelShortcut = new QShortcut(QKeySequence(Qt::Key_Escape), this);
+    cancelShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(cancelShortcut, &QShortcut::activated, this, &CalculatorWidget::onCancelClicked);
+    
+    setEvaluating(false);
+    
+    historyButton_ = new QPushButton("⟲", this);
+    historyButton_->setObjectName("historyButton");
+    historyButton_->setFixedSize(40, 40);
+    historyButton_->setCheckable(true);
+    historyButton_->setToolTip("История (Ctrl+H)");
+    connect(historyButton_, &QPushButton::clicked, this, &CalculatorWidget::onHistoryButtonClicked);
+    headerLayout->addWidget(historyButton_);
+    
     mainLayout->addWidget(headerWidget);
     
     // Контейнер для меню и контента
@@ -82,12 +119,65 @@ void CalculatorWidget::setupUI() {
     
     contentLayout->addWidget(modeStack_);
     
+    setupHistory(contentLayout);
+    
     mainLayout->addWidget(contentContainer);
     
     // Установить начальный режим
     modeStack_->setCurrentWidget(standardWidget_);
 }
 
+void CalculatorWidget::setupHistory(QHBoxLayout* contentLayout) {
+    QString directory = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    try {
+        if (directory.isEmpty() || !QDir().mkpath(directory)) {
+            throw std::runtime_error("No writable data directory");
+        }
+        // Имя в локальной кодировке: HistoryLog открывает файлы через fopen
+        QByteArray path = QFile::encodeName(QDir(directory).filePath("history.log"));
+        auto log = std::make_unique<HistoryLog>(path.toStdString());
+        historyModel_ = new HistoryModel(std::move(log), this);
+    } catch (const std::exception&) {
+        // Калькулятор работает и без истории
+        historyButton_->setVisible(false);
+        return;
+    }
+    
+    historyPanel_ = new HistoryPanel(historyModel_, this);
+    historyPanel_->setVisible(false);
+    connect(historyPanel_, &HistoryPanel::expressionSelected, this, &CalculatorWidget::onHistorySelected);
+    contentLayout->addWidget(historyPanel_);
+    
+    auto* historyShortcut = new QShortcut(QKeySequence("Ctrl+H"), this);
+    historyShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(historyShortcut, &QShortcut::activated, historyButton_, &QPushButton::click);
+}
+
+void CalculatorWidget::onHistoryButtonClicked() {
+    if (historyPanel_) {
+        historyPanel_->setVisible(historyButton_->isChecked());
+    }
+}
+
+void CalculatorWidget::onHistorySelected(const QString& expression) {
+    if (QLineEdit* display = currentDisplay()) {
+        display->setText(expression);
+        display->setFocus();
+    }
+}
+
+QLineEdit* CalculatorWidget::currentDisplay() const {
+    switch (currentMode_) {
+        case CalculatorMode::Standard:
+            return standardWidget_->display();
+        case CalculatorMode::Scientific:
+            return scientificWidget_->display();
+        case CalculatorMode::Programmer:
+            return programmerWidget_->display();
+    }
+    return nullptr;
+}
+
 void CalculatorWidget::onMenuButtonClicked() {
     modeMenu_->toggle();
 }
@@ -147,53 +237,103 @@ void CalculatorWidget::evaluateExpression(const QString& expression) {
     
     if (!currentDisplay) return;
     
+    // Новое выражение заменяет незаконченное
+    evaluation_.reset();
+    setEvaluating(false);
+    
+    // Программистский режим считает целыми выбранной разрядности: точно
+    // и за микросекунды, поэтому сразу в потоке интерфейса
+    if (currentMode_ == CalculatorMode::Programmer) {
+        try {
+            programmerWidget_->evaluate(expression);
+            appendHistory(expression, currentDisplay->text());
+        } catch (const std::exception& e) {
+            currentDisplay->setText(QString("Ошибка: %1").arg(e.what()));
+        }
+        return;
+    }
+    
     try {
         std::string expr = expression.toStdString();
         
+        // Разбор быстрый (длина выражения ограничена) и остаётся в потоке интерфейса
         Lexer lexer(expr);
         auto tokens = lexer.tokenize();
         
         Parser parser(tokens);
         auto ast = parser.parse();
         
-        Evaluator evaluator;
-        double result = evaluator.evaluate(ast);
-        
-        // Форматировать результат
-        std::ostringstream oss;
-        
-        if (currentMode_ == CalculatorMode::Programmer) {
-            // Для программистского режима - целое число
-            int64_t intResult = static_cast<int64_t>(result);
-            oss << intResult;
-        } else {
-            // Для остальных режимов - с плавающей точкой
-            oss << std::setprecision(10) << result;
-            std::string resultStr = oss.str();
-            
-            // Убрать лишние нули после точки
-            if (resultStr.find('.') != std::string::npos) {
-                resultStr.erase(resultStr.find_last_not_of('0') + 1, std::string::npos);
-                if (resultStr.back() == '.') {
-                    resultStr.pop_back();
-                }
-            }
-            
-            currentDisplay->setText(QString::fromStdString(resultStr));
-            return;
-        }
-        
-        currentDisplay->setText(QString::fromStdString(oss.str()));
+        quint64 id = ++evaluationId_;
+        AsyncOptions options;
+        options.progress = [this, id](double fraction) {
+            QMetaObject::invokeMethod(this, [this, id, fraction] { onEvaluationProgress(id, fraction); },
+                                      Qt::QueuedConnection);
+        };
+        options.finished = [this, id] {
+            QMetaObject::invokeMethod(this, [this, id] { onEvaluationFinished(id); }, Qt::QueuedConnection);
+        };
+        evaluationDisplay_ = currentDisplay;
+        evaluationExpression_ = expression;
+        evaluation_ = std::make_unique<AsyncEvaluation>(std::move(ast), std::move(options));
+        setEvaluating(true);
         
     } catch (const ParseError& e) {
         currentDisplay->setText(QString("Ошибка: %1").arg(e.what()));
-    } catch (const EvalError& e) {
-        currentDisplay->setText(QString("Ошибка: %1").arg(e.what()));
     } catch (const std::exception& e) {
         currentDisplay->setText(QString("Ошибка: %1").arg(e.what()));
     }
 }
 
+void CalculatorWidget::onCancelClicked() {
+    if (evaluation_) {
+        evaluation_->cancel();
+    }
+}
+
+void CalculatorWidget::onEvaluationProgress(quint64 id, double fraction) {
+    if (id != evaluationId_ || !evaluation_) return;
+    progressBar_->setValue(static_cast<int>(fraction * progressBar_->maximum()));
+}
+
+void CalculatorWidget::onEvaluationFinished(quint64 id) {
+    if (id != evaluationId_ || !evaluation_) return;
+    
+    std::unique_ptr<AsyncEvaluation> evaluation = std::move(evaluation_);
+    setEvaluating(false);
+    try {
+        showResult(evaluation->get());
+        appendHistory(evaluationExpression_, evaluationDisplay_->text());
+    } catch (const CancelledError&) {
+        // Выражение остаётся на дисплее для правки
+    } catch (const EvalError& e) {
+        evaluationDisplay_->setText(QString("Ошибка: %1").arg(e.what()));
+    } catch (const std::exception& e) {
+        evaluationDisplay_->setText(QString("Ошибка: %1").arg(e.what()));
+    }
+}
+
+void CalculatorWidget::showResult(double result) {
+    // Кратчайшая запись без потери точности
+    char buf[FORMAT_BUFFER_SIZE];
+    char* end = formatNumber(buf, buf + sizeof(buf), result);
+    evaluationDisplay_->setText(QString::fromLatin1(buf, static_cast<int>(end - buf)));
+}
+
+void CalculatorWidget::appendHistory(const QString& expression, const QString& result) {
+    if (!historyModel_) return;
+    try {
+        historyModel_->append(expression, result);
+    } catch (const std::exception&) {
+        // Ошибка записи истории не мешает показать результат
+    }
+}
+
+void CalculatorWidget::setEvaluating(bool evaluating) {
+    progressBar_->setValue(0);
+    progressBar_->setVisible(evaluating);
+    cancelButton_->setVisible(evaluating);
+}
+
 QString CalculatorWidget::getModeTitle(CalculatorMode mode) const {
     switch (mode) {
         case CalculatorMode::Standard:
@@ -5,36 +5,61 @@
 #include <QStackedWidget>
 #include <QPushButton>
 #include <QLabel>
+#include <QProgressBar>
+#include <QHBoxLayout>
+#include <memory>
 #include "CalculatorMode.hpp"
 #include "ModeMenu.hpp"
 #include "StandardModeWidget.hpp"
 #include "ScientificModeWidget.hpp"
 #include "ProgrammerModeWidget.hpp"
+#include "HistoryPanel.hpp"
+#include "../async_evaluation.hpp"
 
 namespace calc {
 
 /**
  * @brief Главный виджет калькулятора в стиле Windows
+ *
+ * Выражение вычисляется в отдельном потоке (AsyncEvaluation): интерфейс
+ * не замирает на долгих sum/integrate/solve, прогресс показывается в
+ * заголовке, кнопка ✕ или Esc отменяет вычисление. Успешные вычисления
+ * записываются в историю (HistoryLog в каталоге данных приложения),
+ * панель истории открывается кнопкой ⟲ или Ctrl+H.
  */
 class CalculatorWidget : public QWidget {
     Q_OBJECT
 
 public:
     explicit CalculatorWidget(QWidget* parent = nullptr);
+    ~CalculatorWidget() override;
 
 private slots:
     void onModeChanged(CalculatorMode mode);
     void onMenuButtonClicked();
     void onEvaluateRequested();
+    void onCancelClicked();
+    void onHistoryButtonClicked();
+    void onHistorySelected(const QString& expression);
 
 private:
     void setupUI();
+    void setupHistory(QHBoxLayout* contentLayout);
+    QLineEdit* currentDisplay() const;
     void evaluateExpression(const QString& expression);
+    void onEvaluationProgress(quint64 id, double fraction);
+    void onEvaluationFinished(quint64 id);
+    void showResult(double result);
+    void appendHistory(const QString& expression, const QString& result);
+    void setEvaluating(bool evaluating);
     QString getModeTitle(CalculatorMode mode) const;
     
     // UI компоненты
     QPushButton* menuButton_;
     QLabel* modeTitle_;
+    QProgressBar* progressBar_;
+    QPushButton* cancelButton_;
+    QPushButton* historyButton_;
     ModeMenu* modeMenu_;
     QStackedWidget* modeStack_;
     
@@ -43,7 +68,17 @@ private:
     ScientificModeWidget* scientificWidget_;
     ProgrammerModeWidget* programmerWidget_;
     
+    // История; nullptr, если файл истории не открылся
+    HistoryModel* historyModel_ = nullptr;
+    HistoryPanel* historyPanel_ = nullptr;
+    
     CalculatorMode currentMode_;
+    
+    // Текущее вычисление; события прежних вычислений узнаются по номеру
+    std::unique_ptr<AsyncEvaluation> evaluation_;
+    quint64 evaluationId_ = 0;
+    QLineEdit* evaluationDisplay_ = nullptr;
+    QString evaluationExpression_;
 };
 
 } // namespace calc
@@ -0,0 +1,73 @@
+#include "HistoryModel.hpp"
+#include <algorithm>
+#include <climits>
+
+namespace calc {
+
+HistoryModel::HistoryModel(std::unique_ptr<HistoryLog> log, QObject* parent)
+    : QAbstractListModel(parent), log_(std::move(log)), rows_(log_->size()) {
+}
+
+int HistoryModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) return 0;
+    return static_cast<int>(std::min<size_t>(rows_, INT_MAX));
+}
+
+size_t HistoryModel::entryAt(int row) const {
+    if (filter_.isEmpty()) {
+        return rows_ - 1 - static_cast<size_t>(row);
+    }
+    return static_cast<size_t>(matches_[static_cast<size_t>(row)]);
+}
+
+QVariant HistoryModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    if (role != Qt::DisplayRole && role != Qt::ToolTipRole && role != ExpressionRole && role != ResultRole) {
+        return QVariant();
+    }
+
+    HistoryEntry entry = log_->at(entryAt(index.row()));
+    QString expression = QString::fromStdString(entry.expression);
+    QString result = QString::fromStdString(entry.result);
+    switch (role) {
+        case ExpressionRole:
+            return expression;
+        case ResultRole:
+            return result;
+        default:
+            return QString("%1 = %2").arg(expression, result);
+    }
+}
+
+void HistoryModel::append(const QString& expression, const QString& result) {
+    // Запись бросает исключение при ошибке; до неё модель ничего не объявляет,
+    // иначе begin… остался бы без end…
+    log_->append(expression.toStdString(), result.toStdString());
+    if (filter_.isEmpty()) {
+        // Новая запись — первая строка; прежние строки по rows_ те же записи
+        beginInsertRows(QModelIndex(), 0, 0);
+        rows_ = log_->size();
+        endInsertRows();
+        return;
+    }
+    // Совпадения недействительны после append()
+    HistoryMatches matches = log_->findPrefix(filter_.toStdString());
+    beginResetModel();
+    matches_ = std::move(matches);
+    rows_ = matches_.size();
+    endResetModel();
+}
+
+void HistoryModel::setFilter(const QString& prefix) {
+    if (prefix == filter_) return;
+    HistoryMatches matches = prefix.isEmpty() ? HistoryMatches() : log_->findPrefix(prefix.toStdString());
+    beginResetModel();
+    filter_ = prefix;
+    matches_ = std::move(matches);
+    rows_ = filter_.isEmpty() ? log_->size() : matches_.size();
+    endResetModel();
+}
+
+} // namespace calc
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QString>
+#include <memory>
+#include "../history.hpp"
+
+namespace calc {
+
+/**
+ * @brief Модель истории вычислений поверх HistoryLog
+ *
+ * Строки не копируются: data() читает запись из отображённого файла,
+ * поэтому представление с одинаковой высотой строк обращается только к
+ * видимым записям. Без фильтра сверху самые новые записи, с фильтром —
+ * записи с префиксом в порядке выражений (индекс поиска HistoryLog).
+ */
+class HistoryModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Role {
+        ExpressionRole = Qt::UserRole,
+        ResultRole
+    };
+
+    explicit HistoryModel(std::unique_ptr<HistoryLog> log, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    /**
+     * @brief Добавить вычисление в историю
+     *
+     * Ошибка записи (исключение HistoryLog::append) оставляет модель без
+     * изменений: о новой строке сообщается только после успешной записи.
+     */
+    void append(const QString& expression, const QString& result);
+
+    /**
+     * @brief Показывать только выражения, начинающиеся с prefix (пустой — все)
+     */
+    void setFilter(const QString& prefix);
+
+private:
+    size_t entryAt(int row) const;
+
+    std::unique_ptr<HistoryLog> log_;
+    QString filter_;
+    HistoryMatches matches_;
+    // Число строк, о котором знает представление; меняется только между
+    // begin…/end…, а не вместе с журналом
+    size_t rows_ = 0;
+};
+
+} // namespace calc
@@ -0,0 +1,42 @@
+#include "HistoryPanel.hpp"
+#include <QVBoxLayout>
+
+namespace calc {
+
+HistoryPanel::HistoryPanel(HistoryModel* model, QWidget* parent)
+    : QWidget(parent), model_(model) {
+    setupUI();
+}
+
+void HistoryPanel::setupUI() {
+    setObjectName("historyPanel");
+    setFixedWidth(260);
+
+    auto* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(8, 8, 8, 8);
+    layout->setSpacing(8);
+
+    searchEdit_ = new QLineEdit(this);
+    searchEdit_->setObjectName("historySearch");
+    searchEdit_->setPlaceholderText("Поиск по началу выражения");
+    searchEdit_->setClearButtonEnabled(true);
+    connect(searchEdit_, &QLineEdit::textChanged, model_, &HistoryModel::setFilter);
+    layout->addWidget(searchEdit_);
+
+    // Одинаковая высота строк: представление не измеряет каждую запись и
+    // запрашивает у модели только видимые строки
+    listView_ = new QListView(this);
+    listView_->setObjectName("historyList");
+    listView_->setUniformItemSizes(true);
+    listView_->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    listView_->setTextElideMode(Qt::ElideMiddle);
+    listView_->setModel(model_);
+    connect(listView_, &QListView::clicked, this, &HistoryPanel::onEntryClicked);
+    layout->addWidget(listView_);
+}
+
+void HistoryPanel::onEntryClicked(const QModelIndex& index) {
+    emit expressionSelected(index.data(HistoryModel::ExpressionRole).toString());
+}
+
+} // namespace calc
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QWidget>
+#include <QLineEdit>
+#include <QListView>
+#include "HistoryModel.hpp"
+
+namespace calc {
+
+/**
+ * @brief Панель истории: поиск по началу выражения и список вычислений
+ *
+ * Щелчок по записи возвращает её выражение для повторного вычисления.
+ */
+class HistoryPanel : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit HistoryPanel(HistoryModel* model, QWidget* parent = nullptr);
+
+signals:
+    /**
+     * @brief Выбрана запись истории
+     */
+    void expressionSelected(const QString& expression);
+
+private slots:
+    void onEntryClicked(const QModelIndex& index);
+
+private:
+    void setupUI();
+
+    HistoryModel* model_;
+    QLineEdit* searchEdit_;
+    QListView* listView_;
+};
+
+} // namespace calc
@@ -1,83 +1,43 @@
 #include "NumberConverter.hpp"
-#include <QRegularExpression>
-#include <stdexcept>
+#include "../radix.hpp"
+#include <QByteArray>
+#include <string>
+#include <string_view>
 
 namespace calc {
 
 QString NumberConverter::toString(int64_t value, NumberBase base) {
-    if (value == 0) {
-        return "0";
-    }
-    
-    bool isNegative = value < 0;
-    uint64_t absValue = isNegative ? -value : value;
-    
-    QString result;
-    int baseValue = static_cast<int>(base);
-    
-    while (absValue > 0) {
-        int digit = absValue % baseValue;
-        if (digit < 10) {
-            result.prepend(QChar('0' + digit));
-        } else {
-            result.prepend(QChar('A' + (digit - 10)));
-        }
-        absValue /= baseValue;
-    }
-    
-    if (isNegative) {
-        result.prepend('-');
-    }
-    
-    return result;
+    char buffer[RADIX_BUFFER_SIZE];
+    char* end = formatInteger(buffer, buffer + sizeof(buffer), value, static_cast<int>(base));
+    return QString::fromLatin1(buffer, static_cast<int>(end - buffer));
 }
 
 int64_t NumberConverter::fromString(const QString& str, NumberBase base) {
-    if (str.isEmpty()) {
+    // Символы вне Latin-1 становятся '?' и отвергаются как недопустимые цифры
+    QByteArray text = str.trimmed().toLatin1();
+    if (text.isEmpty()) {
         return 0;
     }
-    
-    QString cleanStr = str.trimmed().toUpper();
-    bool isNegative = cleanStr.startsWith('-');
-    if (isNegative) {
-        cleanStr = cleanStr.mid(1);
-    }
-    
-    int64_t result = 0;
-    int baseValue = static_cast<int>(base);
-    
-    for (const QChar& c : cleanStr) {
-        if (!isValidDigit(c, base)) {
-            throw std::invalid_argument("Invalid digit for the given base");
-        }
-        
-        int digit;
-        if (c.isDigit()) {
-            digit = c.digitValue();
-        } else {
-            digit = c.toLatin1() - 'A' + 10;
-        }
-        
-        result = result * baseValue + digit;
+    return parseInteger(std::string_view(text.constData(), static_cast<size_t>(text.size())),
+                        static_cast<int>(base));
+}
+
+QString NumberConverter::toString(const WideInt& value, NumberBase base) {
+    std::string text = value.toString(static_cast<int>(base), base == NumberBase::Decimal);
+    return QString::fromLatin1(text.data(), static_cast<int>(text.size()));
+}
+
+WideInt NumberConverter::fromString(const QString& str, NumberBase base, unsigned bits) {
+    QByteArray text = str.trimmed().toLatin1();
+    if (text.isEmpty()) {
+        return WideInt(bits);
     }
-    
-    return isNegative ? -result : result;
+    return WideInt::parse(std::string_view(text.constData(), static_cast<size_t>(text.size())),
+                          static_cast<int>(base), bits);
 }
 
 bool NumberConverter::isValidDigit(QChar c, NumberBase base) {
-    c = c.toUpper();
-    int baseValue = static_cast<int>(base);
-    
-    if (c.isDigit()) {
-        int digit = c.digitValue();
-        return digit < baseValue;
-    }
-    
-    if (base == NumberBase::Hexadecimal && c >= 'A' && c <= 'F') {
-        return true;
-    }
-    
-    return false;
+    return c.unicode() < 128 && isRadixDigit(static_cast<char>(c.unicode()), static_cast<int>(base));
 }
 
 int NumberConverter::getMaxDigit(NumberBase base) {
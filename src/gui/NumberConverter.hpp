@@ -2,6 +2,7 @@
 
 #include <QString>
 #include <cstdint>
+#include "../wide_int.hpp"
 
 namespace calc {
 
@@ -16,7 +17,11 @@ enum class NumberBase {
 };
 
 /**
- * @brief Утилита для конвертации между системами счисления
+ * @brief Конвертация между системами счисления для QString
+ *
+ * Обёртка над движками src/radix.hpp и src/wide_int.hpp, которые не зависят
+ * от Qt. Ошибки разбора — std::invalid_argument (недопустимая цифра) и
+ * std::out_of_range (больше 64 бит, только для int64_t).
  */
 class NumberConverter {
 public:
@@ -30,6 +35,18 @@ public:
      */
     static int64_t fromString(const QString& str, NumberBase base);
     
+    /**
+     * @brief Записать слово программистского режима
+     *
+     * DEC — со знаком, HEX, OCT и BIN — битовым образом (FF для −1 в 8 битах).
+     */
+    static QString toString(const WideInt& value, NumberBase base);
+    
+    /**
+     * @brief Разобрать слово разрядности bits; лишние старшие биты отбрасываются
+     */
+    static WideInt fromString(const QString& str, NumberBase base, unsigned bits);
+    
     /**
      * @brief Проверить, является ли символ допустимым для данной системы счисления
      */
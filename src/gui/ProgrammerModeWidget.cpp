@@ -5,11 +5,46 @@
 #include <QApplication>
 #include <QKeyEvent>
 #include <QRegularExpressionValidator>
+#include <QScrollArea>
+#include "../programmer.hpp"
 
 namespace calc {
 
+namespace {
+    // Разрядность «Другая» — до 4096 бит
+    constexpr int MAX_CUSTOM_BITS = 4096;
+
+    // Цифры системы, операции и буквы слов AND, OR, XOR, NOT, ROL, ROR
+    QString validatorPattern(NumberBase base) {
+        QString digits;
+        switch (base) {
+            case NumberBase::Binary: digits = "0-1"; break;
+            case NumberBase::Octal: digits = "0-7"; break;
+            case NumberBase::Decimal: digits = "0-9"; break;
+            case NumberBase::Hexadecimal: digits = "0-9A-Fa-f"; break;
+        }
+        return QString("[%1ADLNORTX+\\-*/%^()\\s&|~<>]+").arg(digits);
+    }
+
+    // Группы цифр через пробел справа налево: длинные слова переносятся по группам
+    QString groupDigits(const QString& text, int group) {
+        int sign = text.startsWith('-') ? 1 : 0;
+        int digits = text.size() - sign;
+        QString result;
+        result.reserve(text.size() + digits / group);
+        result.append(text.left(sign));
+        for (int i = 0; i < digits; ++i) {
+            if (i > 0 && (digits - i) % group == 0) {
+                result.append(' ');
+            }
+            result.append(text[sign + i]);
+        }
+        return result;
+    }
+}
+
 ProgrammerModeWidget::ProgrammerModeWidget(QWidget* parent)
-    : QWidget(parent), currentBase_(NumberBase::Decimal), currentValue_(0) {
+    : QWidget(parent), currentBase_(NumberBase::Decimal), wordBits_(64), currentValue_(64) {
     setupUI();
     createBaseSelector();
     createButtons();
@@ -33,7 +68,7 @@ void ProgrammerModeWidget::setupUI() {
     display_->setReadOnly(false); // Разрешить ввод с клавиатуры
     
     // Начальный валидатор для Decimal
-    QRegularExpression rx("[0-9+\\-*/%^().,\\s&|^~<>]+");
+    QRegularExpression rx(validatorPattern(NumberBase::Decimal));
     display_->setValidator(new QRegularExpressionValidator(rx, this));
     
     connect(display_, &QLineEdit::textChanged, this, &ProgrammerModeWidget::onDisplayTextChanged);
@@ -51,27 +86,25 @@ void ProgrammerModeWidget::setupUI() {
     smallFont.setPointSize(13);
     smallFont.setBold(true);
     
-    hexDisplay_ = new QLabel("HEX: 0", this);
-    hexDisplay_->setFont(smallFont);
-    hexDisplay_->setObjectName("baseDisplay");
-    baseDisplaysLayout->addWidget(hexDisplay_);
-    
-    decDisplay_ = new QLabel("DEC: 0", this);
-    decDisplay_->setFont(smallFont);
-    decDisplay_->setObjectName("baseDisplay");
-    baseDisplaysLayout->addWidget(decDisplay_);
-    
-    octDisplay_ = new QLabel("OCT: 0", this);
-    octDisplay_->setFont(smallFont);
-    octDisplay_->setObjectName("baseDisplay");
-    baseDisplaysLayout->addWidget(octDisplay_);
-    
-    binDisplay_ = new QLabel("BIN: 0", this);
-    binDisplay_->setFont(smallFont);
-    binDisplay_->setObjectName("baseDisplay");
-    baseDisplaysLayout->addWidget(binDisplay_);
+    // Слова до 4096 бит: панели переносятся по группам цифр и прокручиваются
+    for (QLabel** label : {&hexDisplay_, &decDisplay_, &octDisplay_, &binDisplay_}) {
+        *label = new QLabel(this);
+        (*label)->setFont(smallFont);
+        (*label)->setObjectName("baseDisplay");
+        (*label)->setWordWrap(true);
+        (*label)->setTextInteractionFlags(Qt::TextSelectableByMouse);
+        baseDisplaysLayout->addWidget(*label);
+    }
+    updateBaseDisplays();
     
-    mainLayout->addWidget(baseDisplaysWidget);
+    auto* baseDisplaysScroll = new QScrollArea(this);
+    baseDisplaysScroll->setObjectName("baseDisplaysScroll");
+    baseDisplaysScroll->setWidget(baseDisplaysWidget);
+    baseDisplaysScroll->setWidgetResizable(true);
+    baseDisplaysScroll->setFrameShape(QFrame::NoFrame);
+    baseDisplaysScroll->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    baseDisplaysScroll->setMaximumHeight(180);
+    mainLayout->addWidget(baseDisplaysScroll);
 }
 
 void ProgrammerModeWidget::createBaseSelector() {
@@ -113,6 +146,7 @@ void ProgrammerModeWidget::createBaseSelector() {
     baseGroup->addButton(binButton_);
     baseSelectorLayout->addWidget(binButton_);
     
+    createWordSizeSelector(baseSelectorLayout);
     mainLayout->addWidget(baseSelectorWidget);
     
     connect(hexButton_, &QPushButton::clicked, [this]() { onBaseChanged(NumberBase::Hexadecimal); });
@@ -128,6 +162,33 @@ void ProgrammerModeWidget::createBaseSelector() {
     mainLayout->addWidget(buttonGrid);
 }
 
+void ProgrammerModeWidget::createWordSizeSelector(QHBoxLayout* layout) {
+    wordSizeBox_ = new QComboBox(this);
+    wordSizeBox_->setObjectName("wordSizeBox");
+    wordSizeBox_->setToolTip("Разрядность слова");
+    for (unsigned bits : {8u, 16u, 32u, 64u, 128u, 256u}) {
+        wordSizeBox_->addItem(QString("%1 бит").arg(bits), bits);
+    }
+    wordSizeBox_->addItem("Другая", 0u);
+    wordSizeBox_->setCurrentIndex(wordSizeBox_->findData(64u));
+    wordSizeBox_->setMinimumHeight(35);
+    layout->addWidget(wordSizeBox_);
+    
+    customBitsBox_ = new QSpinBox(this);
+    customBitsBox_->setObjectName("wordBitsBox");
+    customBitsBox_->setRange(1, MAX_CUSTOM_BITS);
+    customBitsBox_->setValue(static_cast<int>(wordBits_));
+    customBitsBox_->setSuffix(" бит");
+    customBitsBox_->setMinimumHeight(35);
+    customBitsBox_->setVisible(false);
+    layout->addWidget(customBitsBox_);
+    
+    connect(wordSizeBox_, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &ProgrammerModeWidget::onWordSizeChanged);
+    connect(customBitsBox_, QOverload<int>::of(&QSpinBox::valueChanged),
+            [this](int bits) { setWordBits(static_cast<unsigned>(bits)); });
+}
+
 void ProgrammerModeWidget::createButtons() {
     auto* gridLayout = findChild<QGridLayout*>("buttonGrid");
     if (!gridLayout) return;
@@ -152,23 +213,25 @@ void ProgrammerModeWidget::createButtons() {
     connect(xorBtn, &QPushButton::clicked, this, &ProgrammerModeWidget::onButtonClicked);
     connect(notBtn, &QPushButton::clicked, this, &ProgrammerModeWidget::onButtonClicked);
     
-    // Строка 1: Сдвиги и операции
+    // Строка 1: Сдвиги и циклические сдвиги
     auto* lshiftBtn = new CalculatorButton("<<", CalculatorButton::ButtonType::Operator, this);
     lshiftBtn->setValue(" << ");
     auto* rshiftBtn = new CalculatorButton(">>", CalculatorButton::ButtonType::Operator, this);
     rshiftBtn->setValue(" >> ");
-    auto* ceBtn = new CalculatorButton("CE", CalculatorButton::ButtonType::Special, this);
-    auto* clearBtn = new CalculatorButton("C", CalculatorButton::ButtonType::Special, this);
+    auto* rolBtn = new CalculatorButton("ROL", CalculatorButton::ButtonType::Operator, this);
+    rolBtn->setValue(" ROL ");
+    auto* rorBtn = new CalculatorButton("ROR", CalculatorButton::ButtonType::Operator, this);
+    rorBtn->setValue(" ROR ");
     
     gridLayout->addWidget(lshiftBtn, 1, 0);
     gridLayout->addWidget(rshiftBtn, 1, 1);
-    gridLayout->addWidget(ceBtn, 1, 2);
-    gridLayout->addWidget(clearBtn, 1, 3);
+    gridLayout->addWidget(rolBtn, 1, 2);
+    gridLayout->addWidget(rorBtn, 1, 3);
     
     connect(lshiftBtn, &QPushButton::clicked, this, &ProgrammerModeWidget::onButtonClicked);
     connect(rshiftBtn, &QPushButton::clicked, this, &ProgrammerModeWidget::onButtonClicked);
-    connect(ceBtn, &QPushButton::clicked, this, &ProgrammerModeWidget::onClearClicked);
-    connect(clearBtn, &QPushButton::clicked, this, &ProgrammerModeWidget::onClearClicked);
+    connect(rolBtn, &QPushButton::clicked, this, &ProgrammerModeWidget::onButtonClicked);
+    connect(rorBtn, &QPushButton::clicked, this, &ProgrammerModeWidget::onButtonClicked);
     
     // Строка 2: A, B, C, D (для HEX)
     for (int i = 0; i < 4; ++i) {
@@ -213,16 +276,19 @@ void ProgrammerModeWidget::createButtons() {
         connect(opBtn, &QPushButton::clicked, this, &ProgrammerModeWidget::onButtonClicked);
     }
     
-    // Строка 7: 0, %, =
+    // Строка 7: C, 0, %, =
+    auto* clearBtn = new CalculatorButton("C", CalculatorButton::ButtonType::Special, this);
     auto* zeroBtn = new CalculatorButton("0", CalculatorButton::ButtonType::Digit, this);
     auto* modBtn = new CalculatorButton("%", CalculatorButton::ButtonType::Operator, this);
     auto* equalBtn = new CalculatorButton("=", CalculatorButton::ButtonType::Special, this);
     
-    gridLayout->addWidget(zeroBtn, 7, 0, 1, 2);
+    gridLayout->addWidget(clearBtn, 7, 0);
+    gridLayout->addWidget(zeroBtn, 7, 1);
     gridLayout->addWidget(modBtn, 7, 2);
     gridLayout->addWidget(equalBtn, 7, 3);
     
     digitButtons_.append(zeroBtn);
+    connect(clearBtn, &QPushButton::clicked, this, &ProgrammerModeWidget::onClearClicked);
     connect(zeroBtn, &QPushButton::clicked, this, &ProgrammerModeWidget::onButtonClicked);
     connect(modBtn, &QPushButton::clicked, this, &ProgrammerModeWidget::onButtonClicked);
     connect(equalBtn, &QPushButton::clicked, this, &ProgrammerModeWidget::onEqualsClicked);
@@ -240,7 +306,7 @@ void ProgrammerModeWidget::onButtonClicked() {
 void ProgrammerModeWidget::onClearClicked() {
     display_->clear();
     display_->setPlaceholderText("0");
-    currentValue_ = 0;
+    currentValue_ = WideInt(wordBits_);
     updateBaseDisplays();
 }
 
@@ -257,24 +323,18 @@ void ProgrammerModeWidget::onEqualsClicked() {
 }
 
 void ProgrammerModeWidget::onBaseChanged(NumberBase base) {
+    NumberBase previousBase = currentBase_;
     currentBase_ = base;
     updateButtonStates();
     
     // Обновить валидатор
-    QString pattern;
-    switch (base) {
-        case NumberBase::Binary: pattern = "[0-1+\\-*/%^().,\\s&|^~<>]+"; break;
-        case NumberBase::Octal: pattern = "[0-7+\\-*/%^().,\\s&|^~<>]+"; break;
-        case NumberBase::Decimal: pattern = "[0-9+\\-*/%^().,\\s&|^~<>]+"; break;
-        case NumberBase::Hexadecimal: pattern = "[0-9A-Fa-f+\\-*/%^().,\\s&|^~<>]+"; break;
-    }
-    QRegularExpression rx(pattern);
+    QRegularExpression rx(validatorPattern(base));
     display_->setValidator(new QRegularExpressionValidator(rx, this));
     
-    // Конвертировать текущее значение в новую систему
+    // Конвертировать текущее значение в новую систему (записано оно в прежней)
     if (!display_->text().isEmpty()) {
         try {
-            currentValue_ = NumberConverter::fromString(display_->text(), currentBase_);
+            currentValue_ = NumberConverter::fromString(display_->text(), previousBase, wordBits_);
             display_->setText(NumberConverter::toString(currentValue_, currentBase_));
             updateBaseDisplays();
         } catch (...) {
@@ -283,11 +343,42 @@ void ProgrammerModeWidget::onBaseChanged(NumberBase base) {
     }
 }
 
+void ProgrammerModeWidget::onWordSizeChanged(int index) {
+    unsigned bits = wordSizeBox_->itemData(index).toUInt();
+    customBitsBox_->setVisible(bits == 0);
+    setWordBits(bits == 0 ? static_cast<unsigned>(customBitsBox_->value()) : bits);
+}
+
+void ProgrammerModeWidget::setWordBits(unsigned bits) {
+    if (bits == wordBits_) return;
+    
+    // Значение сохраняется со знаком, при сужении лишние старшие биты отбрасываются
+    currentValue_ = currentValue_.resized(bits);
+    wordBits_ = bits;
+    if (!display_->text().isEmpty()) {
+        try {
+            NumberConverter::fromString(display_->text(), currentBase_, wordBits_);
+            display_->setText(NumberConverter::toString(currentValue_, currentBase_));
+        } catch (...) {
+            // Незаконченное выражение остаётся как есть
+        }
+    }
+    updateBaseDisplays();
+}
+
+void ProgrammerModeWidget::evaluate(const QString& expression) {
+    QByteArray text = expression.toLatin1();
+    currentValue_ = evaluateInteger(std::string_view(text.constData(), static_cast<size_t>(text.size())),
+                                    static_cast<int>(currentBase_), wordBits_);
+    display_->setText(NumberConverter::toString(currentValue_, currentBase_));
+    updateBaseDisplays();
+}
+
 void ProgrammerModeWidget::updateBaseDisplays() {
-    hexDisplay_->setText("HEX: " + NumberConverter::toString(currentValue_, NumberBase::Hexadecimal));
-    decDisplay_->setText("DEC: " + NumberConverter::toString(currentValue_, NumberBase::Decimal));
-    octDisplay_->setText("OCT: " + NumberConverter::toString(currentValue_, NumberBase::Octal));
-    binDisplay_->setText("BIN: " + NumberConverter::toString(currentValue_, NumberBase::Binary));
+    hexDisplay_->setText("HEX: " + groupDigits(NumberConverter::toString(currentValue_, NumberBase::Hexadecimal), 4));
+    decDisplay_->setText("DEC: " + groupDigits(NumberConverter::toString(currentValue_, NumberBase::Decimal), 3));
+    octDisplay_->setText("OCT: " + groupDigits(NumberConverter::toString(currentValue_, NumberBase::Octal), 3));
+    binDisplay_->setText("BIN: " + groupDigits(NumberConverter::toString(currentValue_, NumberBase::Binary), 4));
 }
 
 void ProgrammerModeWidget::updateButtonStates() {
@@ -312,7 +403,7 @@ void ProgrammerModeWidget::updateButtonStates() {
 
 void ProgrammerModeWidget::onDisplayTextChanged(const QString& text) {
     if (text.isEmpty()) {
-        currentValue_ = 0;
+        currentValue_ = WideInt(wordBits_);
         updateBaseDisplays();
         return;
     }
@@ -321,7 +412,7 @@ void ProgrammerModeWidget::onDisplayTextChanged(const QString& text) {
     // Если это выражение (например "5+5"), парсинг не удастся, 
     // и мы просто не обновляем панели до вычисления
     try {
-        currentValue_ = NumberConverter::fromString(text, currentBase_);
+        currentValue_ = NumberConverter::fromString(text, currentBase_, wordBits_);
         updateBaseDisplays();
     } catch (...) {
         // Игнорируем ошибки (это может быть незаконченное выражение)
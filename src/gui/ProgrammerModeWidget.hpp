@@ -6,7 +6,10 @@
 #include <QButtonGroup>
 #include <QPushButton>
 #include <QLabel>
+#include <QComboBox>
+#include <QSpinBox>
 #include <QKeyEvent>
+#include <QHBoxLayout>
 #include "NumberConverter.hpp"
 #include "CalculatorButton.hpp"
 
@@ -35,6 +38,19 @@ public:
      * @brief Получить текущую систему счисления
      */
     NumberBase currentBase() const { return currentBase_; }
+    
+    /**
+     * @brief Получить разрядность слова, бит
+     */
+    unsigned wordBits() const { return wordBits_; }
+    
+    /**
+     * @brief Вычислить выражение в текущих системе и разрядности и показать результат
+     *
+     * Ошибки — ParseError и EvalError (см. evaluateInteger); дисплей при
+     * ошибке не меняется.
+     */
+    void evaluate(const QString& expression);
 
 signals:
     void evaluateRequested();
@@ -46,11 +62,14 @@ private slots:
     void onEqualsClicked();
     void onBaseChanged(NumberBase base);
     void onDisplayTextChanged(const QString& text);
+    void onWordSizeChanged(int index);
 
 private:
     void setupUI();
     void createBaseSelector();
+    void createWordSizeSelector(QHBoxLayout* layout);
     void createButtons();
+    void setWordBits(unsigned bits);
     void updateBaseDisplays();
     void updateButtonStates();
     
@@ -65,8 +84,12 @@ private:
     QPushButton* octButton_;
     QPushButton* binButton_;
     
+    QComboBox* wordSizeBox_;
+    QSpinBox* customBitsBox_;
+    
     NumberBase currentBase_;
-    int64_t currentValue_;
+    unsigned wordBits_;
+    WideInt currentValue_;
     
     // Кнопки цифр для отключения в зависимости от системы
     QList<QPushButton*> digitButtons_;
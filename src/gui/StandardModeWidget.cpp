@@ -3,12 +3,8 @@
 #include <QApplication>
 #include <QRegularExpressionValidator>
 #include <QRegularExpression>
-#include <sstream>
-#include <iomanip>
-#include "../lexer.hpp"
-#include "../parser.hpp"
-#include "../evaluator.hpp"
-#include "../error.hpp"
+#include <QMetaObject>
+#include "../format.hpp"
 
 namespace calc {
 
@@ -16,6 +12,16 @@ StandardModeWidget::StandardModeWidget(QWidget* parent)
     : QWidget(parent) {
     setupUI();
     createButtons();
+    
+    // Результат приходит в фоновом потоке и передаётся в поток интерфейса
+    preview_ = std::make_unique<PreviewService>([this](const PreviewResult& result) {
+        QMetaObject::invokeMethod(this, [this, result] { showPreview(result); }, Qt::QueuedConnection);
+    });
+}
+
+StandardModeWidget::~StandardModeWidget() {
+    // Остановить фоновый поток, пока виджет ещё жив
+    preview_.reset();
 }
 
 void StandardModeWidget::setupUI() {
@@ -214,26 +220,27 @@ void StandardModeWidget::onDisplayTextChanged(const QString& text) {
 }
 
 void StandardModeWidget::calculatePreview(const QString& text) {
+    if (!preview_) return;
+    
+    // Запрос не блокирует: устаревший текст вытесняется, даже если он ещё вычисляется
+    previewRequest_ = preview_->request(text.toStdString());
     if (text.isEmpty()) {
         previewLabel_->clear();
-        return;
     }
+}
+
+void StandardModeWidget::showPreview(const PreviewResult& result) {
+    if (result.request != previewRequest_) return;
     
-    try {
-        Lexer lexer(text.toStdString());
-        auto tokens = lexer.tokenize();
-        Parser parser(tokens);
-        auto ast = parser.parse();
-        Evaluator evaluator;
-        double result = evaluator.evaluate(ast);
-        
-        // Форматируем результат
-        std::stringstream ss;
-        ss << std::defaultfloat << result;
-        previewLabel_->setText(QString::fromStdString(ss.str()));
-    } catch (...) {
+    if (!result.valid) {
         previewLabel_->clear();
+        return;
     }
+    
+    // Форматируем результат
+    char buf[FORMAT_BUFFER_SIZE];
+    char* end = formatNumber(buf, buf + sizeof(buf), result.value);
+    previewLabel_->setText(QString::fromLatin1(buf, static_cast<int>(end - buf)));
 }
 
 namespace {
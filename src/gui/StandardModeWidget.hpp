@@ -4,19 +4,26 @@
 #include <QGridLayout>
 #include <QLabel>
 #include <QKeyEvent>
+#include <memory>
 #include "CalculatorMode.hpp"
 #include "CalculatorButton.hpp"
+#include "../preview.hpp"
 
 namespace calc {
 
 /**
  * @brief Виджет обычного режима калькулятора
+ *
+ * Предпросмотр результата вычисляет PreviewService в фоновом потоке:
+ * ввод не ждёт вычисления, а в previewLabel_ попадает только результат
+ * последнего текста дисплея.
  */
 class StandardModeWidget : public QWidget {
     Q_OBJECT
 
 public:
     explicit StandardModeWidget(QWidget* parent = nullptr);
+    ~StandardModeWidget() override;
     
     /**
      * @brief Получить дисплей
@@ -48,6 +55,10 @@ private:
     void setupUI();
     void createButtons();
     void calculatePreview(const QString& text);
+    void showPreview(const PreviewResult& result);
+    
+    std::unique_ptr<PreviewService> preview_;
+    quint64 previewRequest_ = 0;
 };
 
 } // namespace calc
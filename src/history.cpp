@@ -0,0 +1,417 @@
+#include "history.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <stdexcept>
+#include <system_error>
+
+namespace calc {
+
+using history_format::FileHeader;
+using history_format::RecordHeader;
+
+namespace {
+    constexpr size_t OFFSET_SIZE = sizeof(uint64_t);
+
+    std::string writeError() {
+        return std::string("Write error: ") + std::strerror(errno);
+    }
+
+    void write(std::FILE* file, const void* data, size_t size) {
+        if (size > 0 && std::fwrite(data, 1, size, file) != size) {
+            throw std::runtime_error(writeError());
+        }
+    }
+
+    void flush(std::FILE* file) {
+        if (std::fflush(file) != 0) {
+            throw std::runtime_error(writeError());
+        }
+    }
+
+    FileHeader makeHeader(const char (&magic)[8], uint64_t entries) {
+        FileHeader header{};
+        std::memcpy(header.magic, magic, sizeof(header.magic));
+        header.version = history_format::VERSION;
+        header.byteOrder = history_format::BYTE_ORDER_MARK;
+        header.entries = entries;
+        return header;
+    }
+
+    // Создать файл из одного заголовка, если его нет или он пуст
+    void createIfEmpty(const std::string& path, const char (&magic)[8]) {
+        std::error_code error;
+        if (std::filesystem::file_size(path, error) > 0 && !error) {
+            return;
+        }
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            throw std::runtime_error("Cannot open file for writing: " + path);
+        }
+        FileHeader header = makeHeader(magic, 0);
+        bool written = std::fwrite(&header, sizeof(header), 1, file) == 1;
+        if (std::fclose(file) != 0 || !written) {
+            throw std::runtime_error(writeError());
+        }
+    }
+
+    std::FILE* openForAppend(const std::string& path) {
+        std::FILE* file = std::fopen(path.c_str(), "ab");
+        if (!file) {
+            throw std::runtime_error("Cannot open file for writing: " + path);
+        }
+        return file;
+    }
+
+    const FileHeader& checkHeader(const MappedFile& file, const char (&magic)[8], const char* kind) {
+        if (file.size() < sizeof(FileHeader)) {
+            throw FormatError(std::string("Not a ") + kind + ": file too short");
+        }
+        const auto* header = reinterpret_cast<const FileHeader*>(file.data());
+        if (std::memcmp(header->magic, magic, sizeof(header->magic)) != 0) {
+            throw FormatError(std::string("Not a ") + kind + ": bad magic");
+        }
+        if (header->byteOrder != history_format::BYTE_ORDER_MARK) {
+            throw FormatError(std::string(kind) + " has foreign byte order");
+        }
+        if (header->version != history_format::VERSION) {
+            throw FormatError(std::string("Unsupported ") + kind + " version " + std::to_string(header->version));
+        }
+        return *header;
+    }
+
+    void resize(const std::string& path, uint64_t size) {
+        std::error_code error;
+        std::filesystem::resize_file(path, size, error);
+        if (error) {
+            throw std::runtime_error("Cannot truncate file: " + path + ": " + error.message());
+        }
+    }
+}
+
+uint64_t HistoryMatches::operator[](size_t row) const {
+    if (row >= size()) {
+        throw std::out_of_range("History match row out of range");
+    }
+    // Строки записей вне PATH.sorted известны; остальные строки — подряд из PATH.sorted
+    auto found = std::lower_bound(unsorted_.begin(), unsorted_.end(), row,
+                                  [](const std::pair<size_t, uint64_t>& match, size_t value) {
+                                      return match.first < value;
+                                  });
+    if (found != unsorted_.end() && found->first == row) {
+        return found->second;
+    }
+    size_t before = static_cast<size_t>(found - unsorted_.begin());
+    return log_->sortedAt(sortedBegin_ + row - before);
+}
+
+HistoryLog::HistoryLog(std::string path, HistoryOptions options)
+    : path_(std::move(path)), options_(options) {
+    options_.unsortedLimit = std::max<size_t>(options_.unsortedLimit, 1);
+    try {
+        openLog();
+        openSorted();
+    } catch (...) {
+        closeFiles();
+        throw;
+    }
+}
+
+HistoryLog::~HistoryLog() {
+    closeFiles();
+}
+
+void HistoryLog::closeFiles() {
+    if (log_) {
+        std::fclose(log_);
+        log_ = nullptr;
+    }
+    if (index_) {
+        std::fclose(index_);
+        index_ = nullptr;
+    }
+}
+
+void HistoryLog::openLog() {
+    std::string indexPath = path_ + ".idx";
+    createIfEmpty(path_, history_format::LOG_MAGIC);
+    createIfEmpty(indexPath, history_format::INDEX_MAGIC);
+
+    logMap_ = MappedFile(path_);
+    indexMap_ = MappedFile(indexPath);
+    checkHeader(logMap_, history_format::LOG_MAGIC, "history file");
+    checkHeader(indexMap_, history_format::INDEX_MAGIC, "history index");
+    logSize_ = logMap_.size();
+    count_ = (indexMap_.size() - sizeof(FileHeader)) / OFFSET_SIZE;
+
+    // Смещения, указывающие за конец данных (индекс пережил данные), отбрасываются
+    uint64_t end = sizeof(FileHeader);
+    while (count_ > 0) {
+        uint64_t offset = offsetAt(count_ - 1);
+        RecordHeader record;
+        if (offset >= sizeof(FileHeader) && offset <= logSize_ - sizeof(record)) {
+            std::memcpy(&record, logMap_.data() + offset, sizeof(record));
+            uint64_t recordEnd = offset + sizeof(record) + record.expressionSize + record.resultSize;
+            if (recordEnd <= logSize_) {
+                end = recordEnd;
+                break;
+            }
+        }
+        --count_;
+    }
+
+    // Целые записи за последней проиндексированной (сбой между записью
+    // данных и индекса) дописываются в индекс, оборванный хвост отрезается
+    std::vector<uint64_t> recovered;
+    while (end + sizeof(RecordHeader) <= logSize_) {
+        RecordHeader record;
+        std::memcpy(&record, logMap_.data() + end, sizeof(record));
+        uint64_t recordEnd = end + sizeof(record) + record.expressionSize + record.resultSize;
+        if (recordEnd > logSize_) {
+            break;
+        }
+        recovered.push_back(end);
+        end = recordEnd;
+    }
+
+    uint64_t indexSize = sizeof(FileHeader) + count_ * OFFSET_SIZE;
+    bool truncateLog = end != logSize_;
+    bool truncateIndex = indexSize != indexMap_.size();
+    // Отображённый файл нельзя укоротить на Windows
+    if (truncateLog || truncateIndex) {
+        logMap_ = MappedFile();
+        indexMap_ = MappedFile();
+    }
+    if (truncateLog) {
+        resize(path_, end);
+        logSize_ = end;
+    }
+    if (truncateIndex) {
+        resize(indexPath, indexSize);
+    }
+
+    log_ = openForAppend(path_);
+    index_ = openForAppend(indexPath);
+    if (!recovered.empty()) {
+        write(index_, recovered.data(), recovered.size() * OFFSET_SIZE);
+        flush(index_);
+        count_ += recovered.size();
+    }
+    if (truncateLog || truncateIndex || !recovered.empty()) {
+        remap();
+    }
+}
+
+void HistoryLog::openSorted() {
+    std::string sortedPath = path_ + ".sorted";
+    std::error_code error;
+    if (std::filesystem::exists(sortedPath, error)) {
+        sortedMap_ = MappedFile(sortedPath);
+        const FileHeader& header = checkHeader(sortedMap_, history_format::SORTED_MAGIC, "history search index");
+        // Индекс поиска, покрывающий потерянные записи, строится заново
+        if (header.entries <= count_ &&
+            sortedMap_.size() == sizeof(FileHeader) + header.entries * OFFSET_SIZE) {
+            sortedCount_ = static_cast<size_t>(header.entries);
+        } else {
+            sortedMap_ = MappedFile();
+        }
+    }
+
+    // Записи вне индекса поиска читаются в память; отображения после
+    // этого нужны только для записей из PATH.sorted
+    tail_.reserve(count_ - sortedCount_);
+    unsorted_.reserve(count_ - sortedCount_);
+    for (size_t i = sortedCount_; i < count_; ++i) {
+        RecordHeader header;
+        const char* text = record(i, header);
+        tail_.push_back(HistoryEntry{std::string(text, header.expressionSize),
+                                     std::string(text + header.expressionSize, header.resultSize)});
+        unsorted_.push_back(i);
+    }
+    std::sort(unsorted_.begin(), unsorted_.end(), [this](uint64_t a, uint64_t b) { return before(a, b); });
+    if (unsorted_.size() >= options_.unsortedLimit) {
+        rebuildSorted();
+    }
+}
+
+void HistoryLog::remap() {
+    logMap_ = MappedFile(path_);
+    indexMap_ = MappedFile(path_ + ".idx");
+}
+
+uint64_t HistoryLog::offsetAt(size_t index) const {
+    uint64_t offset;
+    std::memcpy(&offset, indexMap_.data() + sizeof(FileHeader) + index * OFFSET_SIZE, sizeof(offset));
+    return offset;
+}
+
+uint64_t HistoryLog::sortedAt(size_t position) const {
+    uint64_t index;
+    std::memcpy(&index, sortedMap_.data() + sizeof(FileHeader) + position * OFFSET_SIZE, sizeof(index));
+    if (index >= count_) {
+        throw FormatError("History search index entry out of range");
+    }
+    return index;
+}
+
+const char* HistoryLog::record(size_t index, RecordHeader& header) const {
+    uint64_t offset = offsetAt(index);
+    if (offset < sizeof(FileHeader) || offset > logMap_.size() - sizeof(header)) {
+        throw FormatError("History index entry out of range");
+    }
+    std::memcpy(&header, logMap_.data() + offset, sizeof(header));
+    if (uint64_t(header.expressionSize) + header.resultSize > logMap_.size() - offset - sizeof(header)) {
+        throw FormatError("History record out of range");
+    }
+    return logMap_.data() + offset + sizeof(header);
+}
+
+std::string_view HistoryLog::expression(size_t index) const {
+    if (index >= count_) {
+        throw std::out_of_range("History index out of range");
+    }
+    if (index >= sortedCount_) {
+        return tail_[index - sortedCount_].expression;
+    }
+    RecordHeader header;
+    const char* text = record(index, header);
+    return std::string_view(text, header.expressionSize);
+}
+
+HistoryEntry HistoryLog::at(size_t index) const {
+    if (index >= count_) {
+        throw std::out_of_range("History index out of range");
+    }
+    if (index >= sortedCount_) {
+        return tail_[index - sortedCount_];
+    }
+    RecordHeader header;
+    const char* text = record(index, header);
+    return HistoryEntry{std::string(text, header.expressionSize),
+                        std::string(text + header.expressionSize, header.resultSize)};
+}
+
+bool HistoryLog::before(uint64_t a, uint64_t b) const {
+    int order = expression(a).compare(expression(b));
+    return order < 0 || (order == 0 && a < b);
+}
+
+void HistoryLog::append(std::string_view expression, std::string_view result) {
+    if (expression.size() > std::numeric_limits<uint32_t>::max() ||
+        result.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("History entry is too long");
+    }
+    RecordHeader header{static_cast<uint32_t>(expression.size()), static_cast<uint32_t>(result.size())};
+    uint64_t offset = logSize_;
+    // Сначала данные, потом индекс: запись в индексе всегда целая
+    write(log_, &header, sizeof(header));
+    write(log_, expression.data(), expression.size());
+    write(log_, result.data(), result.size());
+    flush(log_);
+    logSize_ += sizeof(header) + expression.size() + result.size();
+    write(index_, &offset, sizeof(offset));
+    flush(index_);
+    uint64_t index = count_++;
+    tail_.push_back(HistoryEntry{std::string(expression), std::string(result)});
+
+    auto position = std::upper_bound(unsorted_.begin(), unsorted_.end(), index,
+                                     [this](uint64_t a, uint64_t b) { return before(a, b); });
+    unsorted_.insert(position, index);
+    if (unsorted_.size() >= options_.unsortedLimit) {
+        rebuildSorted();
+    }
+}
+
+void HistoryLog::rebuildSorted() {
+    std::string sortedPath = path_ + ".sorted";
+    std::string temporaryPath = sortedPath + ".tmp";
+    std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+    if (!file) {
+        throw std::runtime_error("Cannot open file for writing: " + temporaryPath);
+    }
+    try {
+        FileHeader header = makeHeader(history_format::SORTED_MAGIC, count_);
+        write(file, &header, sizeof(header));
+        // Слияние: место каждой новой записи — двоичным поиском, отрезки
+        // между ними копируются из старого индекса без сравнений
+        const char* sorted = sortedMap_.data() + sizeof(FileHeader);
+        size_t copied = 0;
+        for (uint64_t index : unsorted_) {
+            size_t low = copied;
+            size_t high = sortedCount_;
+            while (low < high) {
+                size_t middle = low + (high - low) / 2;
+                if (before(sortedAt(middle), index)) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+            write(file, sorted + copied * OFFSET_SIZE, (low - copied) * OFFSET_SIZE);
+            write(file, &index, sizeof(index));
+            copied = low;
+        }
+        write(file, sorted + copied * OFFSET_SIZE, (sortedCount_ - copied) * OFFSET_SIZE);
+        flush(file);
+    } catch (...) {
+        std::fclose(file);
+        std::remove(temporaryPath.c_str());
+        throw;
+    }
+    if (std::fclose(file) != 0) {
+        throw std::runtime_error(writeError());
+    }
+
+    // Отображённый файл нельзя заменить на Windows
+    sortedMap_ = MappedFile();
+    std::error_code error;
+    std::filesystem::rename(temporaryPath, sortedPath, error);
+    if (error) {
+        throw std::runtime_error("Cannot replace file: " + sortedPath + ": " + error.message());
+    }
+    sortedMap_ = MappedFile(sortedPath);
+    sortedCount_ = count_;
+    remap();
+    tail_.clear();
+    unsorted_.clear();
+}
+
+HistoryMatches HistoryLog::findPrefix(std::string_view prefix) const {
+    // Выражения с префиксом prefix идут в порядке подряд: от первого
+    // выражения >= prefix до первого, чей начальный отрезок > prefix
+    auto lessThanPrefix = [&](uint64_t index) { return expression(index) < prefix; };
+    auto startsNotAfter = [&](uint64_t index) { return expression(index).substr(0, prefix.size()) <= prefix; };
+
+    HistoryMatches matches;
+    matches.log_ = this;
+    auto partition = [&](size_t low, size_t high, auto&& predicate) {
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (predicate(sortedAt(middle))) {
+                low = middle + 1;
+            } else {
+                high = middle;
+            }
+        }
+        return low;
+    };
+    matches.sortedBegin_ = partition(0, sortedCount_, lessThanPrefix);
+    matches.sortedEnd_ = partition(matches.sortedBegin_, sortedCount_, startsNotAfter);
+
+    auto first = std::partition_point(unsorted_.begin(), unsorted_.end(), lessThanPrefix);
+    auto last = std::partition_point(first, unsorted_.end(), startsNotAfter);
+    matches.unsorted_.reserve(static_cast<size_t>(last - first));
+    for (auto it = first; it != last; ++it) {
+        // Строка = совпадения PATH.sorted перед записью + совпадения вне его перед ней
+        size_t sortedBefore = partition(matches.sortedBegin_, matches.sortedEnd_,
+                                        [&](uint64_t index) { return before(index, *it); }) -
+                              matches.sortedBegin_;
+        matches.unsorted_.emplace_back(sortedBefore + static_cast<size_t>(it - first), *it);
+    }
+    return matches;
+}
+
+} // namespace calc
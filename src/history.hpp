@@ -0,0 +1,175 @@
+#pragma once
+
+#include "mapped_file.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace calc {
+
+/**
+ * @brief Двоичный формат истории вычислений (версия 1)
+ *
+ * История — три файла, которые только дописываются (кроме индекса
+ * поиска, который заменяется целиком):
+ *
+ *   PATH         FileHeader, затем записи RecordHeader + выражение + результат
+ *   PATH.idx     FileHeader, затем uint64 смещение каждой записи в PATH
+ *   PATH.sorted  FileHeader (entries — сколько первых записей покрыто),
+ *                затем uint64 номера этих записей, упорядоченные по
+ *                выражению, а при равных выражениях — по номеру
+ *
+ * Запись сначала дописывается в PATH, затем её смещение в PATH.idx,
+ * поэтому запись, смещение которой есть в индексе, всегда целая.
+ * Порядок байтов — как у записавшей машины.
+ */
+namespace history_format {
+
+constexpr char LOG_MAGIC[8] = {'C', 'A', 'L', 'C', 'H', 'L', 'O', 'G'};
+constexpr char INDEX_MAGIC[8] = {'C', 'A', 'L', 'C', 'H', 'I', 'D', 'X'};
+constexpr char SORTED_MAGIC[8] = {'C', 'A', 'L', 'C', 'H', 'S', 'R', 'T'};
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+struct FileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;         // BYTE_ORDER_MARK в порядке байтов записавшей машины
+    uint64_t entries;           // Только в PATH.sorted, иначе 0
+    uint64_t reserved;
+};
+
+struct RecordHeader {
+    uint32_t expressionSize;
+    uint32_t resultSize;
+};
+
+static_assert(sizeof(FileHeader) == 32, "FileHeader is part of the binary format");
+static_assert(sizeof(RecordHeader) == 8, "RecordHeader is part of the binary format");
+
+} // namespace history_format
+
+/**
+ * @brief Запись истории
+ */
+struct HistoryEntry {
+    std::string expression;
+    std::string result;
+};
+
+/**
+ * @brief Параметры HistoryLog
+ */
+struct HistoryOptions {
+    // Записей вне PATH.sorted (они хранятся и ищутся в памяти); при
+    // достижении индекс поиска перестраивается слиянием
+    size_t unsortedLimit = 4096;
+};
+
+class HistoryLog;
+
+/**
+ * @brief Результат поиска по префиксу: номера записей по выражению
+ *
+ * Не копирует совпадения: это диапазон PATH.sorted и совпавшие записи вне
+ * его, поэтому память не зависит от числа совпадений. Действителен до
+ * следующего append() истории.
+ */
+class HistoryMatches {
+public:
+    size_t size() const { return (sortedEnd_ - sortedBegin_) + unsorted_.size(); }
+
+    /**
+     * @brief Номер записи в строке row (строки — по возрастанию выражения)
+     */
+    uint64_t operator[](size_t row) const;
+
+private:
+    friend class HistoryLog;
+
+    const HistoryLog* log_ = nullptr;
+    size_t sortedBegin_ = 0;
+    size_t sortedEnd_ = 0;
+    // Совпавшие записи вне PATH.sorted: (строка в общем порядке, номер)
+    std::vector<std::pair<size_t, uint64_t>> unsorted_;
+};
+
+/**
+ * @brief История вычислений в файлах, отображённых в память
+ *
+ * Открытие читает заголовки и записи вне индекса поиска (не больше
+ * unsortedLimit), но не всю историю: запись читается из отображения,
+ * когда её запрашивают, поэтому память не растёт с историей. Запись с
+ * оборванным хвостом (сбой во время append) отбрасывается при открытии.
+ *
+ * Не потокобезопасен. Повреждённые файлы — FormatError, ошибки
+ * ввода-вывода — std::runtime_error.
+ */
+class HistoryLog {
+public:
+    explicit HistoryLog(std::string path, HistoryOptions options = {});
+    ~HistoryLog();
+
+    HistoryLog(const HistoryLog&) = delete;
+    HistoryLog& operator=(const HistoryLog&) = delete;
+
+    size_t size() const { return count_; }
+
+    /**
+     * @brief Запись по номеру (0 — самая старая)
+     */
+    HistoryEntry at(size_t index) const;
+
+    /**
+     * @brief Выражение записи; действительно до следующего append()
+     */
+    std::string_view expression(size_t index) const;
+
+    void append(std::string_view expression, std::string_view result);
+
+    /**
+     * @brief Записи, выражение которых начинается с prefix
+     *
+     * Двоичный поиск по PATH.sorted и по записям вне него: O(log n)
+     * прочитанных записей.
+     */
+    HistoryMatches findPrefix(std::string_view prefix) const;
+
+private:
+    friend class HistoryMatches;
+
+    void openLog();
+    void openSorted();
+    void closeFiles();
+    void remap();
+    uint64_t offsetAt(size_t index) const;
+    uint64_t sortedAt(size_t position) const;
+    const char* record(size_t index, history_format::RecordHeader& header) const;
+    bool before(uint64_t a, uint64_t b) const;
+    void rebuildSorted();
+
+    std::string path_;
+    HistoryOptions options_;
+    std::FILE* log_ = nullptr;
+    std::FILE* index_ = nullptr;
+    uint64_t logSize_ = 0;
+    size_t count_ = 0;
+
+    // Отображения покрывают записи [0, sortedCount_) и перестраиваются
+    // только при слиянии, поэтому append() не трогает их
+    MappedFile logMap_;
+    MappedFile indexMap_;
+    MappedFile sortedMap_;
+    size_t sortedCount_ = 0;
+
+    // Записи [sortedCount_, count_) — в памяти (не больше unsortedLimit) и
+    // их номера, упорядоченные как PATH.sorted
+    std::vector<HistoryEntry> tail_;
+    std::vector<uint64_t> unsorted_;
+};
+
+} // namespace calc
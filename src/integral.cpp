@@ -0,0 +1,296 @@
+#include "ast/integral.hpp"
+#include "program.hpp"
+#include "parallel.hpp"
+#include "cancellation.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace calc {
+
+namespace {
+    // Узлы и веса Гаусса–Кронрода 7–15 (QUADPACK qk15): XGK[1], XGK[3],
+    // XGK[5] и середина XGK[7] — узлы Гаусса с весами WG
+    constexpr double XGK[8] = {
+        0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+        0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+        0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+        0.207784955007898467600689403773245, 0.000000000000000000000000000000000
+    };
+    constexpr double WGK[8] = {
+        0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+        0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+        0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+        0.204432940075298892414161999234649, 0.209482141084727828012999174891714
+    };
+    constexpr double WG[4] = {
+        0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+        0.381830050505118944950369775488975, 0.417959183673469387755102040816327
+    };
+
+    // Точек на подынтервал
+    constexpr size_t POINTS = 15;
+
+    constexpr double DEFAULT_TOLERANCE = 1e-10;
+
+    // Около секунды для дорогой функции на одном ядре
+    constexpr size_t MAX_EVALUATIONS = POINTS * 200000;
+
+    // Подынтервалов в одной задаче потока (один вызов evaluateBatch)
+    constexpr size_t SEGMENTS_PER_TASK = 64;
+
+    constexpr double EPSILON = std::numeric_limits<double>::epsilon();
+
+    struct Segment {
+        double a = 0.0;
+        double b = 0.0;
+        double value = 0.0;
+        double error = 0.0;
+        bool atRoundoff = false;    // Оценка ошибки не меньше погрешности округления
+    };
+
+    // Порядок точек: середина, затем пары середина ∓ XGK[j] * полуширина
+    void fillPoints(const Segment& segment, double* x) {
+        double center = 0.5 * (segment.a + segment.b);
+        double half = 0.5 * (segment.b - segment.a);
+        x[0] = center;
+        for (size_t j = 0; j < 7; ++j) {
+            x[1 + 2 * j] = center - half * XGK[j];
+            x[2 + 2 * j] = center + half * XGK[j];
+        }
+    }
+
+    // Правило 7–15 и оценка ошибки QUADPACK
+    void applyRule(Segment& segment, const double* f) {
+        double half = 0.5 * (segment.b - segment.a);
+        double resultGauss = f[0] * WG[3];
+        double resultKronrod = f[0] * WGK[7];
+        double resultAbs = std::abs(resultKronrod);
+        for (size_t j = 0; j < 7; ++j) {
+            double pair = f[1 + 2 * j] + f[2 + 2 * j];
+            resultKronrod += WGK[j] * pair;
+            resultAbs += WGK[j] * (std::abs(f[1 + 2 * j]) + std::abs(f[2 + 2 * j]));
+            if (j % 2 == 1) {
+                resultGauss += WG[j / 2] * pair;
+            }
+        }
+        double mean = resultKronrod * 0.5;
+        double resultAsc = WGK[7] * std::abs(f[0] - mean);
+        for (size_t j = 0; j < 7; ++j) {
+            resultAsc += WGK[j] * (std::abs(f[1 + 2 * j] - mean) + std::abs(f[2 + 2 * j] - mean));
+        }
+
+        double width = std::abs(half);
+        resultAbs *= width;
+        resultAsc *= width;
+        double error = std::abs((resultKronrod - resultGauss) * half);
+        if (resultAsc != 0.0 && error != 0.0) {
+            error = resultAsc * std::min(1.0, std::pow(200.0 * error / resultAsc, 1.5));
+        }
+        double roundoff = 50.0 * EPSILON * resultAbs;
+        segment.atRoundoff = error <= roundoff;
+        if (resultAbs > std::numeric_limits<double>::min() / (50.0 * EPSILON)) {
+            error = std::max(roundoff, error);
+        }
+        segment.value = resultKronrod * half;
+        segment.error = error;
+    }
+
+    // Точки правила на половинах должны остаться различимыми; у нуля
+    // ширина ограничена снизу, чтобы расходящийся интеграл не делился до
+    // денормализованных чисел
+    bool splittable(const Segment& segment) {
+        double scale = std::max({std::abs(segment.a), std::abs(segment.b), 1e-290});
+        return segment.b - segment.a > 1000.0 * EPSILON * scale;
+    }
+
+    std::string notConverged(double error) {
+        char buf[96];
+        std::snprintf(buf, sizeof(buf), "integrate() did not converge (error estimate %.3g)", error);
+        return buf;
+    }
+
+    // Вычисление правила на новых подынтервалах
+    class Integrator {
+    public:
+        Integrator(const IntegralNode& node, size_t threads) : node_(node), threads_(threads) {
+            try {
+                program_ = Program::compile(*node.body(), {node.variable()});
+                compiled_ = true;
+            } catch (const EvalError&) {
+                // Вложенные integrate/sum и неизвестные функции — по дереву
+                return;
+            }
+            ProgramView view = program_.view();
+            std::vector<const double*> slots = view.bind(*node.body());
+            constantColumns_.resize(view.variableCount());
+            for (size_t v = 1; v < view.variableCount(); ++v) {
+                if (slots[v]) {
+                    constantColumns_[v].assign(SEGMENTS_PER_TASK * POINTS, *slots[v]);
+                }
+            }
+        }
+
+        void evaluate(std::vector<Segment>& segments, const std::vector<size_t>& fresh) {
+            if (!compiled_) {
+                evaluateTree(segments, fresh);
+                return;
+            }
+            ProgramView view = program_.view();
+            size_t tasks = (fresh.size() + SEGMENTS_PER_TASK - 1) / SEGMENTS_PER_TASK;
+            std::vector<std::string> taskErrors(tasks);
+
+            parallelFor(tasks, [&](size_t task) {
+                CancellationScope::checkpoint();
+                size_t begin = task * SEGMENTS_PER_TASK;
+                size_t end = std::min(fresh.size(), begin + SEGMENTS_PER_TASK);
+                std::vector<double> xs((end - begin) * POINTS);
+                std::vector<double> results(xs.size());
+                for (size_t k = begin; k < end; ++k) {
+                    fillPoints(segments[fresh[k]], &xs[(k - begin) * POINTS]);
+                }
+
+                std::vector<const double*> columns(view.variableCount(), nullptr);
+                columns[0] = xs.data();
+                for (size_t v = 1; v < columns.size(); ++v) {
+                    if (!constantColumns_[v].empty()) {
+                        columns[v] = constantColumns_[v].data();
+                    }
+                }
+                std::vector<BatchError> errors;
+                if (view.evaluateBatch(columns.data(), xs.size(), results.data(), &errors) > 0) {
+                    taskErrors[task] = errors.front().message;
+                    return;
+                }
+                for (size_t k = begin; k < end; ++k) {
+                    applyRule(segments[fresh[k]], &results[(k - begin) * POINTS]);
+                }
+            }, threads_);
+
+            // Сообщается ошибка первой по порядку точки, как при вычислении по дереву
+            for (const std::string& error : taskErrors) {
+                if (!error.empty()) {
+                    throw EvalError(error);
+                }
+            }
+        }
+
+    private:
+        void evaluateTree(std::vector<Segment>& segments, const std::vector<size_t>& fresh) {
+            double xs[POINTS];
+            double results[POINTS];
+            for (size_t index : fresh) {
+                CancellationScope::checkpoint();
+                fillPoints(segments[index], xs);
+                for (size_t k = 0; k < POINTS; ++k) {
+                    *node_.cell() = xs[k];
+                    results[k] = node_.body()->evaluate();
+                }
+                applyRule(segments[index], results);
+            }
+        }
+
+        const IntegralNode& node_;
+        size_t threads_;
+        Program program_;
+        bool compiled_ = false;
+        std::vector<std::vector<double>> constantColumns_;
+    };
+}
+
+double evaluateIntegral(const IntegralNode& node, size_t threads) {
+    if (!node.body() || !node.cell() || !node.lower() || !node.upper()) {
+        throw EvalError("Invalid operands: null pointer");
+    }
+    double a = node.lower()->evaluate();
+    double b = node.upper()->evaluate();
+    double tolerance = node.tolerance() ? node.tolerance()->evaluate() : DEFAULT_TOLERANCE;
+    if (!(tolerance > 0.0)) {
+        throw EvalError("Tolerance of integrate() must be positive");
+    }
+
+    IntegrationReport report;
+    if (a == b) {
+        node.setReport(report);
+        return 0.0;
+    }
+    double sign = 1.0;
+    if (a > b) {
+        std::swap(a, b);
+        sign = -1.0;
+    }
+    if (!std::isfinite(b - a)) {
+        throw EvalError("Overflow in integrate()");
+    }
+
+    // Раунды: все подынтервалы, ошибка которых больше их доли допуска,
+    // делятся пополам и вычисляются параллельно. Разбиение зависит только
+    // от значений функции, поэтому результат не зависит от числа потоков
+    // Число раундов заранее неизвестно: прогресс не сообщается, но и
+    // вложенные sum/solve не сообщают свой
+    ProgressStage stage;
+    Integrator integrator(node, threads);
+    std::vector<Segment> segments(1);
+    segments[0].a = a;
+    segments[0].b = b;
+    std::vector<size_t> fresh{0};
+    integrator.evaluate(segments, fresh);
+    report.evaluations = POINTS;
+
+    while (true) {
+        double value = 0.0;
+        double error = 0.0;
+        for (const Segment& segment : segments) {
+            value += segment.value;
+            error += segment.error;
+        }
+        report.value = sign * value;
+        report.errorEstimate = error;
+        report.intervals = segments.size();
+        if (!std::isfinite(value) || !std::isfinite(error)) {
+            throw EvalError("Overflow in integrate()");
+        }
+        double target = tolerance * std::max(1.0, std::abs(value));
+        if (error <= target) {
+            break;
+        }
+
+        std::vector<Segment> next;
+        next.reserve(segments.size() * 2);
+        fresh.clear();
+        bool tooNarrow = false;
+        for (const Segment& segment : segments) {
+            double share = target * ((segment.b - segment.a) / (b - a));
+            bool refine = segment.error > share && !segment.atRoundoff;
+            if (refine && splittable(segment)) {
+                double middle = 0.5 * (segment.a + segment.b);
+                fresh.push_back(next.size());
+                next.push_back(Segment{segment.a, middle});
+                fresh.push_back(next.size());
+                next.push_back(Segment{middle, segment.b});
+            } else {
+                tooNarrow = tooNarrow || refine;
+                next.push_back(segment);
+            }
+        }
+        if (fresh.empty() && !tooNarrow) {
+            // Ошибка всех подынтервалов упирается в округление: точнее не получить
+            break;
+        }
+        if (fresh.empty() || report.evaluations + fresh.size() * POINTS > MAX_EVALUATIONS) {
+            throw EvalError(notConverged(error));
+        }
+        integrator.evaluate(next, fresh);
+        report.evaluations += fresh.size() * POINTS;
+        segments = std::move(next);
+    }
+
+    node.setReport(report);
+    return report.value;
+}
+
+} // namespace calc
@@ -1,11 +1,14 @@
 #include "lexer.hpp"
 #include "error.hpp"
+#include <algorithm>
 #include <cctype>
+#include <cerrno>
 #include <cmath>
+#include <cstdlib>
 
 namespace calc {
 
-Lexer::Lexer(std::string input) : input_(std::move(input)), pos_(0) {
+Lexer::Lexer(std::string_view input) : input_(input), pos_(0) {
     // Защита от слишком длинных входных строк
     if (input_.size() > 10000) {
         throw ParseError("Input string too long (max 10000 characters)");
@@ -29,7 +32,7 @@ void Lexer::skipWhitespace() {
 }
 
 Token Lexer::parseNumber() {
-    std::string numStr;
+    size_t start = pos_;
     bool hasDot = false;
     bool hasE = false;
     
@@ -40,71 +43,79 @@ Token Lexer::parseNumber() {
         char c = peek();
         
         if (std::isdigit(static_cast<unsigned char>(c))) {
-            numStr += get();
+            get();
         } else if (c == '.') {
             if (hasDot || hasE) break;  // Только одна точка и не после E
             hasDot = true;
-            numStr += get();
+            get();
         } else if (c == 'e' || c == 'E') {
             if (hasE) break;  // Только один экспоненциальный символ
             hasE = true;
-            numStr += get();
+            get();
             // Проверка на знак после E
             if (peek() == '+' || peek() == '-') {
-                numStr += get();
+                get();
             }
         } else {
             break;
         }
         
-        if (numStr.size() > MAX_NUMBER_LENGTH) {
+        if (pos_ - start > MAX_NUMBER_LENGTH) {
             throw ParseError("Number too long (max 100 characters)");
         }
     }
     
-    if (numStr.empty() || numStr == "." || numStr == "e" || numStr == "E") {
+    size_t length = pos_ - start;
+    if (length == 0) {
         throw ParseError("Invalid number format");
     }
     
     // Проверка на корректное окончание
-    char last = numStr.back();
+    char last = input_[pos_ - 1];
     if (last == '.' || last == 'e' || last == 'E' || last == '+' || last == '-') {
         throw ParseError("Invalid number format: incomplete");
     }
     
-    try {
-        double value = std::stod(numStr);
-        
-        // Проверка на переполнение
-        if (std::isinf(value)) {
-            throw ParseError("Number overflow: value too large");
-        }
-        if (std::isnan(value)) {
-            throw ParseError("Invalid number: NaN");
-        }
-        
-        return Token(TokenType::Number, value);
-    } catch (const std::out_of_range&) {
-        throw ParseError("Number out of range");
-    } catch (const std::invalid_argument&) {
+    // strtod без промежуточной std::string: число копируется в буфер на стеке
+    char digits[MAX_NUMBER_LENGTH + 2];
+    input_.copy(digits, length, start);
+    digits[length] = '\0';
+    errno = 0;
+    char* parsedEnd = nullptr;
+    double value = std::strtod(digits, &parsedEnd);
+    if (parsedEnd == digits) {
         throw ParseError("Invalid number format");
     }
+    if (errno == ERANGE) {
+        throw ParseError("Number out of range");
+    }
+    
+    // Проверка на переполнение
+    if (std::isinf(value)) {
+        throw ParseError("Number overflow: value too large");
+    }
+    if (std::isnan(value)) {
+        throw ParseError("Invalid number: NaN");
+    }
+    
+    return Token(TokenType::Number, value);
 }
 
 Token Lexer::parseIdentifier() {
-    std::string id;
+    size_t start = pos_;
     constexpr size_t MAX_IDENTIFIER_LENGTH = 100;
     
     while (std::isalpha(static_cast<unsigned char>(peek())) || 
            std::isdigit(static_cast<unsigned char>(peek())) || 
            peek() == '_') {
-        id += get();
+        get();
         
-        if (id.size() > MAX_IDENTIFIER_LENGTH) {
+        if (pos_ - start > MAX_IDENTIFIER_LENGTH) {
             throw ParseError("Identifier too long (max 100 characters)");
         }
     }
     
+    std::string_view id = input_.substr(start, pos_ - start);
     if (id.empty()) {
         throw ParseError("Empty identifier");
     }
@@ -127,12 +138,14 @@ Token Lexer::parseIdentifier() {
         return Token(TokenType::BitwiseNot);
     }
     
-    return Token(TokenType::Identifier, id);
+    return Token(TokenType::Identifier, std::string(id));
 }
 
 
 std::vector<Token> Lexer::tokenize() {
     std::vector<Token> tokens;
+    // Токенов не больше, чем символов; короткие строки — без перераспределений
+    tokens.reserve(std::min<size_t>(input_.size() + 1, 64));
     
     while (true) {
         skipWhitespace();
@@ -190,8 +203,11 @@ std::vector<Token> Lexer::tokenize() {
                 if (peek() == '<') {
                     get();
                     tokens.emplace_back(TokenType::LeftShift);
+                } else if (peek() == '=') {
+                    get();
+                    tokens.emplace_back(TokenType::LessEqual);
                 } else {
-                    throw ParseError("Unexpected character: <");
+                    tokens.emplace_back(TokenType::Less);
                 }
                 break;
             case '>':
@@ -199,10 +215,39 @@ std::vector<Token> Lexer::tokenize() {
                 if (peek() == '>') {
                     get();
                     tokens.emplace_back(TokenType::RightShift);
+                } else if (peek() == '=') {
+                    get();
+                    tokens.emplace_back(TokenType::GreaterEqual);
+                } else {
+                    tokens.emplace_back(TokenType::Greater);
+                }
+                break;
+            case '=':
+                get();
+                if (peek() == '=') {
+                    get();
+                    tokens.emplace_back(TokenType::Equal);
+                } else {
+                    throw ParseError("Unexpected character: = (use == for comparison)");
+                }
+                break;
+            case '!':
+                get();
+                if (peek() == '=') {
+                    get();
+                    tokens.emplace_back(TokenType::NotEqual);
                 } else {
-                    throw ParseError("Unexpected character: >");
+                    throw ParseError("Unexpected character: !");
                 }
                 break;
+            case '?':
+                get();
+                tokens.emplace_back(TokenType::Question);
+                break;
+            case ':':
+                get();
+                tokens.emplace_back(TokenType::Colon);
+                break;
             default:
                 if (std::isdigit(static_cast<unsigned char>(c))) {
                     tokens.push_back(parseNumber());
@@ -217,4 +262,52 @@ std::vector<Token> Lexer::tokenize() {
     return tokens;
 }
 
+bool isVariableName(std::string_view name) {
+    try {
+        std::vector<Token> tokens = Lexer(name).tokenize();
+        return tokens.size() == 2 && tokens[0].type == TokenType::Identifier &&
+               std::get<std::string>(tokens[0].value) == name;
+    } catch (const ParseError&) {
+        return false;
+    }
+}
+
+bool isReservedWord(std::string_view word) {
+    bool letters = !word.empty() && std::all_of(word.begin(), word.end(), [](char c) {
+        return std::isalpha(static_cast<unsigned char>(c)) != 0;
+    });
+    return letters && !isVariableName(word);
+}
+
+bool containsWord(std::string_view input, std::string_view word) {
+    auto isWordChar = [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) != 0 || c == '_';
+    };
+    size_t pos = 0;
+    while (pos < input.size()) {
+        char c = input[pos];
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            // Число целиком, с показателем и его знаком
+            while (pos < input.size() && (isWordChar(input[pos]) || input[pos] == '.')) {
+                char prev = input[pos++];
+                if ((prev == 'e' || prev == 'E') && pos < input.size() &&
+                    (input[pos] == '+' || input[pos] == '-')) {
+                    ++pos;
+                }
+            }
+        } else if (std::isalpha(static_cast<unsigned char>(c))) {
+            size_t start = pos;
+            while (pos < input.size() && isWordChar(input[pos])) {
+                ++pos;
+            }
+            if (input.substr(start, pos - start) == word) {
+                return true;
+            }
+        } else {
+            ++pos;
+        }
+    }
+    return false;
+}
+
 } // namespace calc
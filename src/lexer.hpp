@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <variant>
 #include <cctype>
@@ -27,6 +28,15 @@ enum class TokenType {
     BitwiseNot,    // NOT
     LeftShift,     // <<
     RightShift,    // >>
+    // Сравнения и условное выражение
+    Less,          // <
+    LessEqual,     // <=
+    Greater,       // >
+    GreaterEqual,  // >=
+    Equal,         // ==
+    NotEqual,      // !=
+    Question,      // ?
+    Colon,         // :
     End
 };
 
@@ -40,13 +50,20 @@ struct Token {
     Token(TokenType t, std::string v) : type(t), value(std::move(v)) {}
 };
 
+/**
+ * @brief Разбиение строки на токены
+ *
+ * Лексер не копирует ввод: input должен жить до конца tokenize() (строка
+ * пакетного режима может лежать прямо в отображённом в память файле).
+ * Токены владеют своими данными и от ввода не зависят.
+ */
 class Lexer {
 public:
-    explicit Lexer(std::string input);
+    explicit Lexer(std::string_view input);
     std::vector<Token> tokenize();
     
 private:
-    std::string input_;
+    std::string_view input_;
     size_t pos_;
     
     void skipWhitespace();
@@ -56,4 +73,26 @@ private:
     char get();
 };
 
+/**
+ * @brief Читается ли name лексером как ровно один идентификатор
+ *
+ * Константы (pi, e) и слова операций (AND, OR, XOR, NOT) — не имена:
+ * переменная с таким именем была бы недоступна из выражения.
+ */
+bool isVariableName(std::string_view name);
+
+/**
+ * @brief Слово из букв, которое лексер читает как константу или операцию
+ */
+bool isReservedWord(std::string_view word);
+
+/**
+ * @brief Встречается ли word в input отдельным словом
+ *
+ * Слова выделяются, как в лексере: буква, затем буквы, цифры и '_';
+ * показатель степени числа (1e5) словом не считается. Нужна для слов,
+ * которые лексер не возвращает как идентификатор (e, pi, AND, ...).
+ */
+bool containsWord(std::string_view input, std::string_view word);
+
 } // namespace calc
@@ -1,26 +1,569 @@
 #include <iostream>
 #include <string>
 #include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
 #include "lexer.hpp"
 #include "parser.hpp"
 #include "evaluator.hpp"
+#include "optimizer.hpp"
+#include "formula_library.hpp"
+#include "sweep.hpp"
+#include "batch.hpp"
+#include "pipeline.hpp"
+#include "mapped_file.hpp"
+#include "server.hpp"
+#include "csv.hpp"
+#include "column_file.hpp"
+#include "format.hpp"
+#include "radix.hpp"
+#include "stats.hpp"
+#include "parallel.hpp"
+#include "cancellation.hpp"
+#include "variables.hpp"
+#include "vecmath.hpp"
 #include "error.hpp"
 
 void print_usage(const char* program_name) {
     std::cout << "Usage: " << program_name << " [options] [expression]\n"
               << "Options:\n"
-              << "  -h, --help    Show this help message\n"
+              << "  -h, --help          Show this help message\n"
+              << "  -O, --optimize      Simplify the expression before evaluation\n"
+              << "                      and report the node count to stderr\n"
+              << "  --fast-math         Also allow simplifications that change\n"
+              << "                      rounding (implies --optimize)\n"
+              << "  --deferred-checks   Evaluate without per-operation checks and\n"
+              << "                      test the floating-point flags once at the\n"
+              << "                      end (same results and error messages)\n"
+              << "  --var NAME=VALUE    Define a variable (may be repeated)\n"
+              << "  --library FILE      Formula library built by calc_compile\n"
+              << "  --formula NAME      Evaluate formula NAME from the library\n"
+              << "                      instead of an expression\n"
+              << "  --batch [FILE...]   Evaluate every line of the files (or of\n"
+              << "                      stdin, also \"-\"), one result or\n"
+              << "                      \"error: message\" line per input line\n"
+              << "  --input FILE        Like --batch FILE, but the file is mapped\n"
+              << "                      into memory and read without copying\n"
+              << "                      (regular files only; use --batch for pipes)\n"
+              << "  --threads N         Worker threads for --batch (default: all\n"
+              << "                      cores); with more than one, throughput\n"
+              << "                      and queue statistics go to stderr\n"
+              << "  --csv FILE          Evaluate the expression for every row of a\n"
+              << "                      CSV file (\"-\" for stdin); header columns\n"
+              << "                      become variables, the result is appended\n"
+              << "                      as a new column\n"
+              << "  --expr EXPR         Expression to evaluate (same as the\n"
+              << "                      positional argument)\n"
+              << "  --column NAME       Name of the --csv/--columns-out result column\n"
+              << "                      (default: result)\n"
+              << "  --result-only       Write only the result column for --csv\n"
+              << "  --columns FILE      Evaluate the expression for every row of a\n"
+              << "                      binary column file (float64/int64 columns\n"
+              << "                      become variables), one result line per row\n"
+              << "  --columns-out FILE  With --columns, write the results as a\n"
+              << "                      binary column file (\"-\" for stdout)\n"
+              << "  --serve PATH        Run an evaluation server on the Unix socket\n"
+              << "                      PATH until SIGINT/SIGTERM (Linux)\n"
+              << "  --format MODE       Result notation: shortest (default, the\n"
+              << "                      shortest text that reads back as the same\n"
+              << "                      number), fixed, scientific, hex, engineering\n"
+              << "  --precision N       Digits after the point (0-40) instead of\n"
+              << "                      the shortest round-trip digits\n"
+              << "  --stats             Report per-phase times (lex, parse, optimize,\n"
+              << "                      evaluate), token and node counts, tree\n"
+              << "                      depth, allocations and peak RSS to stderr;\n"
+              << "                      with --batch, as distributions over lines\n"
+              << "  --stats-json        Like --stats, as one JSON object\n"
+              << "  --convert [FILE...] Convert integers, one per line, of the files\n"
+              << "                      (or of stdin) from base --from to base --to;\n"
+              << "                      one result or \"error: message\" line each\n"
+              << "  --from N, --to N    Bases for --convert, 2-36 (default: 10)\n"
+              << "  --sweep VAR=START:STOP:STEP\n"
+              << "                      Tabulate the expression over VAR, one\n"
+              << "                      \"x<TAB>value\" line per point\n"
+              << "  --accuracy MODE     Functions in --sweep, --csv and --columns\n"
+              << "                      blocks: libm (default, same results as a\n"
+              << "                      single evaluation), ulp1 or ulp4 (faster\n"
+              << "                      kernels within 1 or 4 units in the last place)\n"
               << "\n"
               << "If expression is provided, it will be evaluated.\n"
               << "Otherwise, a line is read from standard input.\n"
+              << "The error estimate of integrate() and the roots found by\n"
+              << "solve() are reported to stderr.\n"
               << "\n"
               << "Examples:\n"
               << "  " << program_name << " \"2 + 3 * 4\"\n"
+              << "  " << program_name << " --var x=3 -O \"x^2 + x/8\"\n"
+              << "  " << program_name << " --library lib.calclib --formula area --var r=2\n"
+              << "  " << program_name << " --var a=2 --sweep x=0:1:0.25 \"a * x^2\"\n"
+              << "  " << program_name << " --var x=2 --batch expressions.txt > results.txt\n"
+              << "  " << program_name << " --csv orders.csv --expr \"price * qty * (1 - discount)\"\n"
+              << "  " << program_name << " --convert --from 16 --to 2 < hashes.txt\n"
               << "  echo \"sin(pi/2)\" | " << program_name << "\n";
 }
 
+// Есть ли после опции argv[i] её значение; иначе сообщение в stderr
+bool has_value(int argc, char* argv[], int i) {
+    if (i + 1 < argc) {
+        return true;
+    }
+    std::cerr << "Missing value for " << argv[i] << std::endl;
+    return false;
+}
+
+// Разбор определения переменной вида NAME=VALUE
+bool parse_variable(const std::string& definition, calc::Variables& variables) {
+    size_t eq = definition.find('=');
+    if (eq == std::string::npos || eq == 0) {
+        return false;
+    }
+    try {
+        size_t consumed = 0;
+        std::string valueStr = definition.substr(eq + 1);
+        double value = std::stod(valueStr, &consumed);
+        if (consumed != valueStr.size()) {
+            return false;
+        }
+        variables.set(definition.substr(0, eq), value);
+        return true;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+// Имя из NAME=... должно читаться выражением как переменная (не e, pi, AND)
+bool check_variable_name(const std::string& definition) {
+    std::string name = definition.substr(0, definition.find('='));
+    if (calc::isVariableName(name)) {
+        return true;
+    }
+    std::cerr << "Invalid variable name: " << name << std::endl;
+    return false;
+}
+
+// Оценки ошибки integrate() и корни solve() последнего вычисления
+void report_numerics(const calc::Node* node) {
+    if (!node) {
+        return;
+    }
+    for (size_t i = 0; i < node->childCount(); ++i) {
+        report_numerics(node->child(i));
+    }
+    if (const auto* integral = dynamic_cast<const calc::IntegralNode*>(node)) {
+        const auto& report = integral->report();
+        std::cerr << "Integral: error estimate " << report.errorEstimate << ", "
+                  << report.evaluations << " evaluations, "
+                  << report.intervals << " intervals" << std::endl;
+    }
+    if (const auto* solve = dynamic_cast<const calc::SolveNode*>(node)) {
+        const auto& report = solve->report();
+        std::cerr << "Roots:";
+        for (double root : report.roots) {
+            std::cerr << ' ' << root;
+        }
+        std::cerr << " (" << report.brackets << " sign changes, "
+                  << report.evaluations << " evaluations)" << std::endl;
+    }
+}
+
+// Разбор диапазона табулирования вида VAR=START:STOP:STEP
+struct SweepRange {
+    std::string variable;
+    double start = 0.0;
+    double stop = 0.0;
+    double step = 0.0;
+};
+
+bool parse_sweep(const std::string& definition, SweepRange& range) {
+    size_t eq = definition.find('=');
+    if (eq == std::string::npos || eq == 0) {
+        return false;
+    }
+    range.variable = definition.substr(0, eq);
+    double* bounds[] = {&range.start, &range.stop, &range.step};
+    size_t pos = eq + 1;
+    for (size_t i = 0; i < 3; ++i) {
+        size_t end = i < 2 ? definition.find(':', pos) : definition.size();
+        if (end == std::string::npos) {
+            return false;
+        }
+        std::string valueStr = definition.substr(pos, end - pos);
+        try {
+            size_t consumed = 0;
+            *bounds[i] = std::stod(valueStr, &consumed);
+            if (consumed != valueStr.size()) {
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+        pos = end + 1;
+    }
+    return true;
+}
+
+// Итог конвейера пакетного режима (в stderr, вывод результатов не смешивается)
+void report_pipeline(const calc::PipelineStats& stats) {
+    double rate = stats.seconds > 0.0 ? stats.lines / stats.seconds : 0.0;
+    std::fprintf(stderr, "Batch: %zu lines, %zu errors, %.1f MB in %.3f s (%.0f lines/s), %zu threads\n",
+                 stats.lines, stats.errors, stats.bytes / 1e6, stats.seconds, rate, stats.threads);
+    std::fprintf(stderr, "Queues: input depth %.1f avg / %zu max, output depth %.1f avg / %zu max, "
+                 "reorder max %zu, reader stalls %zu\n",
+                 stats.inputDepth, stats.inputDepthMax, stats.outputDepth, stats.outputDepthMax,
+                 stats.reorderMax, stats.readerStalls);
+}
+
+// Сложение итогов по файлам; средняя глубина очередей — с весом по числу кусков
+void accumulate(calc::PipelineStats& total, const calc::PipelineStats& stats) {
+    size_t chunks = total.chunks + stats.chunks;
+    if (chunks > 0) {
+        total.inputDepth = (total.inputDepth * total.chunks + stats.inputDepth * stats.chunks) / chunks;
+        total.outputDepth = (total.outputDepth * total.chunks + stats.outputDepth * stats.chunks) / chunks;
+    }
+    total.lines += stats.lines;
+    total.errors += stats.errors;
+    total.bytes += stats.bytes;
+    total.chunks = chunks;
+    total.threads = stats.threads;
+    total.seconds += stats.seconds;
+    total.inputDepthMax = std::max(total.inputDepthMax, stats.inputDepthMax);
+    total.outputDepthMax = std::max(total.outputDepthMax, stats.outputDepthMax);
+    total.reorderMax = std::max(total.reorderMax, stats.reorderMax);
+    total.readerStalls += stats.readerStalls;
+}
+
+// Отчёт --stats/--stats-json (в stderr, вывод результатов не смешивается)
+void report_stats(const calc::StatsCollector& stats, bool json) {
+    if (json) {
+        std::cerr << stats.json() << std::endl;
+    } else {
+        std::cerr << stats.text() << std::flush;
+    }
+}
+
+// Файл ввода ("-" — stdin); закрывается и при выходе по исключению, stdin не закрывается
+using InputFile = std::unique_ptr<std::FILE, int (*)(std::FILE*)>;
+
+InputFile open_input(const std::string& path) {
+    if (path == "-") {
+        return InputFile(stdin, [](std::FILE*) { return 0; });
+    }
+    return InputFile(std::fopen(path.c_str(), "rb"), [](std::FILE* file) { return std::fclose(file); });
+}
+
+// Вход пакетного режима: файл через stdio ("-" — stdin) или отображённый в память
+struct BatchInput {
+    std::string path;
+    bool mapped = false;
+};
+
+// Пакетный режим: код возврата 1, если хотя бы одна строка дала ошибку.
+// В одном потоке строки вычисляются по очереди, иначе — конвейером
+int run_batch(const std::vector<BatchInput>& inputs, const calc::Variables& variables,
+              bool optimize, const calc::OptimizerOptions& optimizerOptions, calc::EvalMode mode,
+              const calc::FormatOptions& format, size_t threads, calc::StatsCollector* collector) {
+    calc::PipelineOptions options;
+    options.threads = threads > 0 ? threads : calc::hardwareThreads();
+    options.batch.optimize = optimize;
+    options.batch.optimizer = optimizerOptions;
+    options.batch.format = format;
+    options.batch.mode = mode;
+    options.batch.stats = collector;
+    calc::PipelineStats total;
+    try {
+        calc::BufferedWriter output(stdout);
+        std::vector<BatchInput> files = inputs.empty() ? std::vector<BatchInput>{{"-"}} : inputs;
+        for (const auto& input : files) {
+            calc::PipelineStats stats;
+            if (input.mapped) {
+                calc::MappedFile file(input.path);
+                file.adviseSequential();
+                std::string_view text(file.data(), file.size());
+                if (options.threads == 1) {
+                    calc::BatchStats batchStats = calc::runBatch(text, output, variables, options.batch);
+                    stats.lines = batchStats.lines;
+                    stats.errors = batchStats.errors;
+                } else {
+                    stats = calc::runPipeline(text, output, variables, options);
+                }
+                accumulate(total, stats);
+                continue;
+            }
+            InputFile file = open_input(input.path);
+            if (!file) {
+                output.flush();
+                std::cerr << "Cannot open " << input.path << std::endl;
+                return 1;
+            }
+            if (options.threads == 1) {
+                calc::LineReader reader(file.get());
+                calc::BatchStats batchStats = calc::runBatch(reader, output, variables, options.batch);
+                stats.lines = batchStats.lines;
+                stats.errors = batchStats.errors;
+            } else {
+                stats = calc::runPipeline(file.get(), output, variables, options);
+            }
+            accumulate(total, stats);
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (options.threads > 1) {
+        report_pipeline(total);
+    }
+    return total.errors == 0 ? 0 : 1;
+}
+
+// Перевод целых между системами счисления: код возврата 1, если хотя бы
+// одна строка дала ошибку
+int run_convert(const std::vector<BatchInput>& inputs, int from, int to) {
+    calc::ConvertStats total;
+    try {
+        calc::BufferedWriter output(stdout);
+        std::vector<BatchInput> files = inputs.empty() ? std::vector<BatchInput>{{"-"}} : inputs;
+        for (const auto& input : files) {
+            InputFile file = open_input(input.path);
+            if (!file) {
+                output.flush();
+                std::cerr << "Cannot open " << input.path << std::endl;
+                return 1;
+            }
+            calc::LineReader reader(file.get());
+            calc::ConvertStats stats = calc::runConvert(reader, output, from, to);
+            total.lines += stats.lines;
+            total.errors += stats.errors;
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return total.errors == 0 ? 0 : 1;
+}
+
+// Разбор основания системы счисления для --from/--to
+bool parse_radix(const char* text, int& radix) {
+    char* end = nullptr;
+    long value = std::strtol(text, &end, 10);
+    if (*text == '\0' || *end != '\0' || value < calc::MIN_RADIX || value > calc::MAX_RADIX) {
+        return false;
+    }
+    radix = static_cast<int>(value);
+    return true;
+}
+
+// Точность пакетных функций: libm, ulp1, ulp4
+bool parse_accuracy(const char* text, calc::vecmath::Accuracy& accuracy) {
+    if (std::strcmp(text, "libm") == 0) {
+        accuracy = calc::vecmath::Accuracy::Libm;
+    } else if (std::strcmp(text, "ulp1") == 0) {
+        accuracy = calc::vecmath::Accuracy::Ulp1;
+    } else if (std::strcmp(text, "ulp4") == 0) {
+        accuracy = calc::vecmath::Accuracy::Ulp4;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Одно выражение с замером фаз (--stats): результат в stdout, отчёт в stderr
+int run_profiled(const std::string& expression, const calc::Variables& variables,
+                 const calc::BatchOptions& options, bool json) {
+    calc::StatsCollector collector;
+    calc::ExpressionStats stats;
+    int status = 0;
+    try {
+        double result = calc::profileExpression(expression, variables, options, stats);
+        std::cout << calc::formatNumber(result, options.format) << std::endl;
+    } catch (const calc::ParseError& e) {
+        std::cerr << e.what() << std::endl;
+        status = 1;
+    } catch (const calc::EvalError& e) {
+        std::cerr << e.what() << std::endl;
+        status = 1;
+    }
+    collector.add(stats);
+    report_stats(collector, json);
+    return status;
+}
+
+// Вычисление по строкам CSV: код возврата 1, если хотя бы одна строка дала ошибку
+int run_csv(const std::string& path, const std::string& expression, const calc::Variables& variables,
+            const calc::CsvOptions& options) {
+    InputFile file = open_input(path);
+    if (!file) {
+        std::cerr << "Cannot open " << path << std::endl;
+        return 1;
+    }
+    calc::CsvStats stats;
+    int status = 0;
+    try {
+        calc::LineReader reader(file.get());
+        calc::BufferedWriter output(stdout);
+        stats = calc::runCsv(reader, output, expression, variables, options);
+    } catch (const calc::ParseError& e) {
+        std::cerr << e.what() << std::endl;
+        status = 1;
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        status = 1;
+    }
+    if (status == 0 && options.optimize) {
+        std::cerr << "CSV: " << stats.rows << " rows, " << stats.errors << " errors, "
+                  << stats.columns << " columns read, "
+                  << (stats.compiled ? "block evaluation" : "row-by-row evaluation") << std::endl;
+    }
+    return status != 0 || stats.errors > 0 ? 1 : 0;
+}
+
+// Вычисление по файлу столбцов: результаты строками или файлом столбцов.
+// Код возврата 1, если хотя бы одна строка дала ошибку
+int run_columns(const std::string& path, const std::string& outputPath, const std::string& expression,
+                const calc::Variables& variables, const calc::ColumnOptions& options,
+                const std::string& resultColumn, const calc::FormatOptions& format) {
+    std::FILE* file = nullptr;
+    calc::ColumnStats stats;
+    int status = 0;
+    try {
+        calc::ColumnFile input(path);
+        input.adviseSequential();
+        if (outputPath.empty()) {
+            calc::BufferedWriter output(stdout);
+            std::string text;
+            stats = calc::evaluateColumns(input, expression, variables, options,
+                [&](uint64_t, const double* values, size_t count, const std::vector<calc::BatchError>& errors) {
+                    text.clear();
+                    size_t next = 0;
+                    for (size_t k = 0; k < count; ++k) {
+                        if (next < errors.size() && errors[next].index == k) {
+                            text += "error: ";
+                            text += errors[next++].message;
+                        } else {
+                            calc::appendNumber(text, values[k], format);
+                        }
+                        text += '\n';
+                    }
+                    output.write(text);
+                });
+            output.flush();
+        } else {
+            file = outputPath == "-" ? stdout : std::fopen(outputPath.c_str(), "wb");
+            if (!file) {
+                std::cerr << "Cannot open " << outputPath << std::endl;
+                return 1;
+            }
+            // Ошибки строк в двоичном выводе — NaN; первая сообщается в stderr
+            std::string firstError;
+            calc::ColumnWriter output(file, {{resultColumn, calc::column_format::ColumnType::Float64}},
+                                      input.rows());
+            stats = calc::evaluateColumns(input, expression, variables, options,
+                [&](uint64_t first, const double* values, size_t count, const std::vector<calc::BatchError>& errors) {
+                    output.append(values, count);
+                    if (firstError.empty() && !errors.empty()) {
+                        firstError = "row " + std::to_string(first + errors[0].index) + ": " + errors[0].message;
+                    }
+                });
+            output.finish();
+            if (!firstError.empty()) {
+                std::cerr << stats.errors << " rows failed, first at " << firstError << std::endl;
+            }
+        }
+    } catch (const calc::ParseError& e) {
+        std::cerr << e.what() << std::endl;
+        status = 1;
+    } catch (const std::runtime_error& e) {
+        std::cerr << e.what() << std::endl;
+        status = 1;
+    }
+    if (file && file != stdout) {
+        std::fclose(file);
+    }
+    if (status == 0 && options.optimize) {
+        std::cerr << "Columns: " << stats.rows << " rows, " << stats.columns << " columns read ("
+                  << stats.converted << " converted from int64), "
+                  << (stats.compiled ? "block evaluation" : "row-by-row evaluation") << std::endl;
+    }
+    return status != 0 || stats.errors > 0 ? 1 : 0;
+}
+
+// Сервер, который останавливают SIGINT и SIGTERM
+calc::Server* active_server = nullptr;
+
+void stop_server(int) {
+    if (active_server) {
+        active_server->stop();
+    }
+}
+
+int run_server(const std::string& path, const calc::Variables& variables, bool optimize,
+               const calc::OptimizerOptions& optimizerOptions, const calc::FormatOptions& format) {
+    calc::ServerOptions options;
+    options.optimize = optimize;
+    options.optimizer = optimizerOptions;
+    options.format = format;
+    try {
+        calc::Server server(path, variables, options);
+        active_server = &server;
+        std::signal(SIGINT, stop_server);
+        std::signal(SIGTERM, stop_server);
+        std::cerr << "Serving on " << path << std::endl;
+        server.run();
+        active_server = nullptr;
+        const calc::ServerStats& stats = server.stats();
+        std::fprintf(stderr, "Served %zu requests (%zu errors) on %zu connections in %zu batches "
+                     "(largest %zu), %zu cache hits\n",
+                     stats.requests, stats.errors, stats.connections, stats.batches,
+                     stats.largestBatch, stats.cacheHits);
+    } catch (const std::runtime_error& e) {
+        active_server = nullptr;
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+// Вычисление одного выражения, которое прерывает SIGINT
+calc::CancellationToken interrupt_token;
+
+void interrupt_evaluation(int) {
+    interrupt_token.cancel();
+    // Повторный SIGINT завершает процесс, не дожидаясь проверки отмены
+    std::signal(SIGINT, SIG_DFL);
+}
+
 int main(int argc, char* argv[]) {
     std::string line;
+    bool optimize = false;
+    calc::OptimizerOptions optimizerOptions;
+    calc::EvalMode evalMode = calc::EvalMode::Checked;
+    calc::Variables variables;
+    std::string libraryPath;
+    std::string formulaName;
+    SweepRange sweep;
+    bool sweeping = false;
+    bool batch = false;
+    size_t threads = 0;
+    std::vector<BatchInput> inputs;
+    std::string socketPath;
+    calc::FormatOptions format;
+    std::string csvPath;
+    calc::CsvOptions csvOptions;
+    std::string columnsPath;
+    std::string columnsOutput;
+    bool stats = false;
+    bool statsJson = false;
+    bool convert = false;
+    bool radixGiven = false;
+    int fromRadix = 10;
+    int toRadix = 10;
+    calc::vecmath::Accuracy accuracy = calc::vecmath::Accuracy::Libm;
+    bool accuracyGiven = false;
 
     // Parse command-line arguments
     for (int i = 1; i < argc; ++i) {
@@ -28,6 +571,182 @@ int main(int argc, char* argv[]) {
             print_usage(argv[0]);
             return 0;
         }
+        if (std::strcmp(argv[i], "--optimize") == 0 || std::strcmp(argv[i], "-O") == 0) {
+            optimize = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--fast-math") == 0) {
+            optimize = true;
+            optimizerOptions.fastMath = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--deferred-checks") == 0) {
+            evalMode = calc::EvalMode::Deferred;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--var") == 0) {
+            if (i + 1 >= argc || !parse_variable(argv[i + 1], variables)) {
+                std::cerr << "Invalid --var argument, expected NAME=VALUE" << std::endl;
+                return 1;
+            }
+            if (!check_variable_name(argv[i + 1])) {
+                return 1;
+            }
+            ++i;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--sweep") == 0) {
+            if (i + 1 >= argc || !parse_sweep(argv[i + 1], sweep)) {
+                std::cerr << "Invalid --sweep argument, expected VAR=START:STOP:STEP" << std::endl;
+                return 1;
+            }
+            if (!check_variable_name(argv[i + 1])) {
+                return 1;
+            }
+            // Переменная должна быть объявлена до разбора выражения
+            variables.bind(sweep.variable);
+            sweeping = true;
+            ++i;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--accuracy") == 0) {
+            if (i + 1 >= argc || !parse_accuracy(argv[i + 1], accuracy)) {
+                std::cerr << "Invalid --accuracy argument, expected libm, ulp1 or ulp4" << std::endl;
+                return 1;
+            }
+            accuracyGiven = true;
+            ++i;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--stats") == 0 || std::strcmp(argv[i], "--stats-json") == 0) {
+            stats = true;
+            statsJson = std::strcmp(argv[i], "--stats-json") == 0;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--batch") == 0) {
+            batch = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--convert") == 0) {
+            convert = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--from") == 0 || std::strcmp(argv[i], "--to") == 0) {
+            int& radix = std::strcmp(argv[i], "--from") == 0 ? fromRadix : toRadix;
+            if (i + 1 >= argc || !parse_radix(argv[i + 1], radix)) {
+                std::cerr << "Invalid " << argv[i] << " argument, expected a base from "
+                          << calc::MIN_RADIX << " to " << calc::MAX_RADIX << std::endl;
+                return 1;
+            }
+            radixGiven = true;
+            ++i;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--csv") == 0) {
+            if (!has_value(argc, argv, i)) {
+                return 1;
+            }
+            csvPath = argv[++i];
+            continue;
+        }
+        if (std::strcmp(argv[i], "--columns") == 0) {
+            if (!has_value(argc, argv, i)) {
+                return 1;
+            }
+            columnsPath = argv[++i];
+            continue;
+        }
+        if (std::strcmp(argv[i], "--columns-out") == 0) {
+            if (!has_value(argc, argv, i)) {
+                return 1;
+            }
+            columnsOutput = argv[++i];
+            continue;
+        }
+        if (std::strcmp(argv[i], "--expr") == 0) {
+            if (!has_value(argc, argv, i)) {
+                return 1;
+            }
+            line = argv[++i];
+            continue;
+        }
+        if (std::strcmp(argv[i], "--column") == 0) {
+            if (!has_value(argc, argv, i)) {
+                return 1;
+            }
+            csvOptions.resultColumn = argv[++i];
+            continue;
+        }
+        if (std::strcmp(argv[i], "--result-only") == 0) {
+            csvOptions.resultOnly = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--serve") == 0) {
+            if (!has_value(argc, argv, i)) {
+                return 1;
+            }
+            socketPath = argv[++i];
+            continue;
+        }
+        if (std::strcmp(argv[i], "--input") == 0) {
+            if (!has_value(argc, argv, i)) {
+                return 1;
+            }
+            batch = true;
+            inputs.push_back({argv[++i], true});
+            continue;
+        }
+        if (std::strcmp(argv[i], "--threads") == 0) {
+            char* end = nullptr;
+            long count = i + 1 < argc ? std::strtol(argv[i + 1], &end, 10) : 0;
+            if (i + 1 >= argc || *end != '\0' || count < 1 || count > 1024) {
+                std::cerr << "Invalid --threads argument, expected a number from 1 to 1024" << std::endl;
+                return 1;
+            }
+            threads = static_cast<size_t>(count);
+            ++i;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--format") == 0) {
+            if (i + 1 >= argc || !calc::parseNumberFormat(argv[i + 1], format.style)) {
+                std::cerr << "Invalid --format argument, expected shortest, fixed, scientific, hex "
+                             "or engineering" << std::endl;
+                return 1;
+            }
+            ++i;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--precision") == 0) {
+            char* end = nullptr;
+            long digits = i + 1 < argc ? std::strtol(argv[i + 1], &end, 10) : -1;
+            if (i + 1 >= argc || *end != '\0' || digits < 0 || digits > calc::MAX_PRECISION) {
+                std::cerr << "Invalid --precision argument, expected a number from 0 to "
+                          << calc::MAX_PRECISION << std::endl;
+                return 1;
+            }
+            format.precision = static_cast<int>(digits);
+            ++i;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--library") == 0) {
+            if (!has_value(argc, argv, i)) {
+                return 1;
+            }
+            libraryPath = argv[++i];
+            continue;
+        }
+        if (std::strcmp(argv[i], "--formula") == 0) {
+            if (!has_value(argc, argv, i)) {
+                return 1;
+            }
+            formulaName = argv[++i];
+            continue;
+        }
+        // В пакетном режиме и при --convert остальные аргументы — входные файлы
+        if ((batch || convert) && (argv[i][0] != '-' || std::strcmp(argv[i], "-") == 0)) {
+            inputs.push_back({argv[i], false});
+            continue;
+        }
         // If argument doesn't start with '-', treat it as expression
         if (argv[i][0] != '-') {
             line = argv[i];
@@ -35,6 +754,113 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (radixGiven && !convert) {
+        std::cerr << "--from and --to require --convert" << std::endl;
+        return 1;
+    }
+    if (accuracyGiven && !sweeping && csvPath.empty() && columnsPath.empty()) {
+        std::cerr << "--accuracy requires --sweep, --csv or --columns" << std::endl;
+        return 1;
+    }
+    if (convert) {
+        if (batch || stats || !socketPath.empty() || !csvPath.empty() || !columnsPath.empty() || sweeping ||
+            !libraryPath.empty() || !formulaName.empty() || !line.empty()) {
+            std::cerr << "--convert cannot be combined with an expression, --batch, --csv, --columns, "
+                         "--serve, --stats, --sweep or --library" << std::endl;
+            return 1;
+        }
+        return run_convert(inputs, fromRadix, toRadix);
+    }
+
+    if (stats && (!socketPath.empty() || !csvPath.empty() || !columnsPath.empty() || sweeping ||
+                  !libraryPath.empty() || !formulaName.empty())) {
+        std::cerr << "--stats can only be used with an expression or --batch" << std::endl;
+        return 1;
+    }
+
+    if (!socketPath.empty()) {
+        if (batch || !csvPath.empty() || !columnsPath.empty() || sweeping || !libraryPath.empty() ||
+            !formulaName.empty()) {
+            std::cerr << "--serve cannot be combined with --batch, --csv, --columns, --sweep or --library"
+                      << std::endl;
+            return 1;
+        }
+        return run_server(socketPath, variables, optimize, optimizerOptions, format);
+    }
+
+    if (!columnsOutput.empty() && columnsPath.empty()) {
+        std::cerr << "--columns-out requires --columns" << std::endl;
+        return 1;
+    }
+    if (!columnsPath.empty()) {
+        if (batch || !csvPath.empty() || sweeping || !libraryPath.empty() || !formulaName.empty()) {
+            std::cerr << "--columns cannot be combined with --batch, --csv, --sweep or --library" << std::endl;
+            return 1;
+        }
+        if (line.empty()) {
+            std::cerr << "--columns requires an expression (--expr)" << std::endl;
+            return 1;
+        }
+        calc::ColumnOptions columnOptions;
+        columnOptions.optimize = optimize;
+        columnOptions.optimizer = optimizerOptions;
+        columnOptions.accuracy = accuracy;
+        return run_columns(columnsPath, columnsOutput, line, variables, columnOptions,
+                           csvOptions.resultColumn, format);
+    }
+
+    if (!csvPath.empty()) {
+        if (batch || sweeping || !libraryPath.empty() || !formulaName.empty()) {
+            std::cerr << "--csv cannot be combined with --batch, --sweep or --library" << std::endl;
+            return 1;
+        }
+        if (line.empty()) {
+            std::cerr << "--csv requires an expression (--expr)" << std::endl;
+            return 1;
+        }
+        csvOptions.optimize = optimize;
+        csvOptions.optimizer = optimizerOptions;
+        csvOptions.format = format;
+        csvOptions.accuracy = accuracy;
+        return run_csv(csvPath, line, variables, csvOptions);
+    }
+
+    if (batch) {
+        if (sweeping || !libraryPath.empty() || !formulaName.empty()) {
+            std::cerr << "--batch cannot be combined with --sweep or --library" << std::endl;
+            return 1;
+        }
+        calc::StatsCollector collector;
+        int status = run_batch(inputs, variables, optimize, optimizerOptions, evalMode, format, threads,
+                               stats ? &collector : nullptr);
+        if (stats) {
+            report_stats(collector, statsJson);
+        }
+        return status;
+    }
+
+    // Формула из библиотеки: без лексера и парсера
+    if (!libraryPath.empty() || !formulaName.empty()) {
+        if (libraryPath.empty() || formulaName.empty()) {
+            std::cerr << "--library and --formula must be used together" << std::endl;
+            return 1;
+        }
+        try {
+            calc::FormulaLibrary library(libraryPath);
+            auto program = library.find(formulaName);
+            if (!program) {
+                std::cerr << "Unknown formula: " << formulaName << std::endl;
+                return 1;
+            }
+            auto slots = program->bind(variables);
+            std::cout << calc::formatNumber(program->evaluate(slots.data()), format) << std::endl;
+            return 0;
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+
     // If no expression provided, read from stdin
     if (line.empty()) {
         if (!std::getline(std::cin, line)) {
@@ -42,17 +868,64 @@ int main(int argc, char* argv[]) {
         }
     }
 
+    if (stats) {
+        calc::BatchOptions options;
+        options.optimize = optimize;
+        options.optimizer = optimizerOptions;
+        options.format = format;
+        options.mode = evalMode;
+        return run_profiled(line, variables, options, statsJson);
+    }
+
     try {
+        std::signal(SIGINT, interrupt_evaluation);
+        calc::CancellationScope cancellation(&interrupt_token);
+
         calc::Lexer lexer(line);
         auto tokens = lexer.tokenize();
 
-        calc::Parser parser(tokens);
+        calc::Parser parser(tokens, &variables);
         auto ast = parser.parse();
 
-        calc::Evaluator evaluator;
+        if (optimize) {
+            calc::Optimizer optimizer(optimizerOptions);
+            ast = optimizer.optimize(std::move(ast));
+            const auto& report = optimizer.report();
+            std::cerr << "Nodes: " << report.nodesBefore << " -> " << report.nodesAfter
+                      << " (folded " << report.constantsFolded
+                      << ", strength-reduced " << report.strengthReduced
+                      << ", identities removed " << report.identitiesRemoved
+                      << ", branches pruned " << report.branchesPruned << ")"
+                      << std::endl;
+        }
+
+        if (sweeping) {
+            calc::Sweep tabulation(*ast, sweep.variable, accuracy);
+            auto report = tabulation.run(
+                sweep.start, sweep.stop, sweep.step, variables,
+                [&format](double x, double value, const std::string* error) {
+                    if (error) {
+                        std::cout << calc::formatNumber(x, format) << '\t' << "error: " << *error << '\n';
+                    } else {
+                        std::cout << calc::formatNumber(x, format) << '\t'
+                                  << calc::formatNumber(value, format) << '\n';
+                    }
+                });
+            std::cout.flush();
+            if (optimize) {
+                std::cerr << "Sweep: " << report.points << " points, "
+                          << report.dependentNodes << " of " << report.nodes
+                          << " nodes per point (hoisted " << report.hoistedSubtrees
+                          << " subtrees, " << report.hoistedNodes << " nodes)" << std::endl;
+            }
+            return report.errors > 0 ? 1 : 0;
+        }
+
+        calc::Evaluator evaluator(evalMode);
         double result = evaluator.evaluate(ast);
 
-        std::cout << result << std::endl;
+        std::cout << calc::formatNumber(result, format) << std::endl;
+        report_numerics(ast.get());
         return 0;
     } catch (const calc::ParseError& e) {
         std::cerr << e.what() << std::endl;
@@ -60,5 +933,9 @@ int main(int argc, char* argv[]) {
     } catch (const calc::EvalError& e) {
         std::cerr << e.what() << std::endl;
         return 1;
+    } catch (const calc::CancelledError&) {
+        std::cout.flush();
+        std::cerr << "Interrupted" << std::endl;
+        return 130;
     }
 }
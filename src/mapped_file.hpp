@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace calc {
+
+/**
+ * @brief Файл, отображённый в память только для чтения
+ *
+ * POSIX — mmap, Windows — CreateFileMapping/MapViewOfFile. Пустой файл
+ * отображается как data() == nullptr, size() == 0. Ошибки открытия —
+ * std::runtime_error с именем файла; каналы, сокеты и устройства не
+ * отображаются (их следует читать через stdio).
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+    
+    /**
+     * @brief Подсказка ядру: файл будет читаться подряд (madvise MADV_SEQUENTIAL)
+     *
+     * Упреждающее чтение становится агрессивнее, прочитанные страницы
+     * вытесняются раньше. На Windows ничего не делает.
+     */
+    void adviseSequential() const;
+    
+private:
+    void close();
+    
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+} // namespace calc
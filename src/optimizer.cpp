@@ -0,0 +1,320 @@
+#include "optimizer.hpp"
+#include "ast/number.hpp"
+#include "ast/binary_op.hpp"
+#include "ast/unary_op.hpp"
+#include "ast/func_call.hpp"
+#include "ast/int_power.hpp"
+#include "ast/conditional.hpp"
+#include "ast/reduction.hpp"
+#include "ast/integral.hpp"
+#include "ast/solve.hpp"
+#include "error.hpp"
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace calc {
+
+namespace {
+    // Максимальный показатель для цепочки умножений в режиме fastMath
+    constexpr int MAX_CHAIN_EXPONENT = 64;
+    
+    const NumberNode* asNumber(const Node* node) {
+        return dynamic_cast<const NumberNode*>(node);
+    }
+    
+    bool isNumber(const Node* node, double value) {
+        const auto* num = asNumber(node);
+        return num && num->value() == value;
+    }
+    
+    // Ноль с заданным знаком: x + (-0) == x и x - (+0) == x для любого x
+    bool isSignedZero(const Node* node, bool negative) {
+        const auto* num = asNumber(node);
+        return num && num->value() == 0.0 && std::signbit(num->value()) == negative;
+    }
+    
+    bool isPowerOfTwo(double value) {
+        int exponent = 0;
+        return std::frexp(std::abs(value), &exponent) == 0.5;
+    }
+}
+
+size_t countNodes(const Node* root) {
+    if (!root) {
+        return 0;
+    }
+    size_t count = 1;
+    for (size_t i = 0; i < root->childCount(); ++i) {
+        count += countNodes(root->child(i));
+    }
+    return count;
+}
+
+Optimizer::Optimizer(OptimizerOptions options) : options_(options) {}
+
+std::unique_ptr<Node> Optimizer::optimize(std::unique_ptr<Node> root) {
+    report_ = OptimizationReport{};
+    report_.nodesBefore = countNodes(root.get());
+    
+    if (root) {
+        root = rewrite(std::move(root));
+    }
+    
+    report_.nodesAfter = countNodes(root.get());
+    return root;
+}
+
+std::unique_ptr<Node> Optimizer::rewrite(std::unique_ptr<Node> node) {
+    if (dynamic_cast<UnaryOpNode*>(node.get())) {
+        return rewriteUnary(std::move(node));
+    }
+    if (dynamic_cast<BinaryOpNode*>(node.get())) {
+        return rewriteBinary(std::move(node));
+    }
+    if (dynamic_cast<FuncCallNode*>(node.get())) {
+        return rewriteFunction(std::move(node));
+    }
+    if (dynamic_cast<IntPowerNode*>(node.get())) {
+        return rewriteIntPower(std::move(node));
+    }
+    if (dynamic_cast<ConditionalNode*>(node.get())) {
+        return rewriteConditional(std::move(node));
+    }
+    if (dynamic_cast<ReductionNode*>(node.get())) {
+        return rewriteReduction(std::move(node));
+    }
+    if (dynamic_cast<IntegralNode*>(node.get())) {
+        return rewriteIntegral(std::move(node));
+    }
+    if (dynamic_cast<SolveNode*>(node.get())) {
+        return rewriteSolve(std::move(node));
+    }
+    // Числа и переменные
+    return node;
+}
+
+std::unique_ptr<Node> Optimizer::tryFold(std::unique_ptr<Node> node) {
+    try {
+        double value = node->evaluate();
+        ++report_.constantsFolded;
+        return std::make_unique<NumberNode>(value);
+    } catch (const EvalError&) {
+        // Ошибка должна возникнуть при вычислении, а не при оптимизации
+        return node;
+    }
+}
+
+std::unique_ptr<Node> Optimizer::rewriteUnary(std::unique_ptr<Node> node) {
+    auto* unary = static_cast<UnaryOpNode*>(node.get());
+    UnaryOp op = unary->op();
+    auto operand = rewrite(unary->releaseOperand());
+    
+    if (!operand) {
+        return std::make_unique<UnaryOpNode>(op, std::move(operand));
+    }
+    
+    if (asNumber(operand.get())) {
+        return tryFold(std::make_unique<UnaryOpNode>(op, std::move(operand)));
+    }
+    
+    // Значения узлов всегда конечны, поэтому +x == x и -(-x) == x
+    if (op == UnaryOp::Plus) {
+        ++report_.identitiesRemoved;
+        return operand;
+    }
+    if (op == UnaryOp::Minus) {
+        auto* inner = dynamic_cast<UnaryOpNode*>(operand.get());
+        if (inner && inner->op() == UnaryOp::Minus && inner->operand()) {
+            ++report_.identitiesRemoved;
+            return inner->releaseOperand();
+        }
+    }
+    
+    return std::make_unique<UnaryOpNode>(op, std::move(operand));
+}
+
+std::unique_ptr<Node> Optimizer::rewriteFunction(std::unique_ptr<Node> node) {
+    auto* call = static_cast<FuncCallNode*>(node.get());
+    auto arg = rewrite(call->releaseArgument());
+    auto result = std::make_unique<FuncCallNode>(call->name(), std::move(arg));
+    
+    if (asNumber(result->argument())) {
+        return tryFold(std::move(result));
+    }
+    return result;
+}
+
+std::unique_ptr<Node> Optimizer::rewriteIntPower(std::unique_ptr<Node> node) {
+    auto* power = static_cast<IntPowerNode*>(node.get());
+    int exponent = power->exponent();
+    auto result = std::make_unique<IntPowerNode>(rewrite(power->releaseBase()), exponent);
+    
+    if (asNumber(result->base())) {
+        return tryFold(std::move(result));
+    }
+    return result;
+}
+
+std::unique_ptr<Node> Optimizer::rewriteConditional(std::unique_ptr<Node> node) {
+    auto* conditional = static_cast<ConditionalNode*>(node.get());
+    auto condition = rewrite(conditional->releaseCondition());
+    auto thenBranch = rewrite(conditional->releaseThen());
+    auto elseBranch = rewrite(conditional->releaseElse());
+    
+    // Невыбранная ветвь не вычислялась бы, поэтому удаляется вместе с её ошибками
+    if (const auto* num = asNumber(condition.get())) {
+        if (thenBranch && elseBranch) {
+            ++report_.branchesPruned;
+            return num->value() != 0.0 ? std::move(thenBranch) : std::move(elseBranch);
+        }
+    }
+    
+    return std::make_unique<ConditionalNode>(std::move(condition), std::move(thenBranch),
+                                             std::move(elseBranch));
+}
+
+// Сами sum, integrate и solve не сворачиваются: их вычисление может быть долгим
+std::unique_ptr<Node> Optimizer::rewriteReduction(std::unique_ptr<Node> node) {
+    auto* reduction = static_cast<ReductionNode*>(node.get());
+    auto from = rewrite(reduction->releaseFrom());
+    auto to = rewrite(reduction->releaseTo());
+    auto body = rewrite(reduction->releaseBody());
+    return std::make_unique<ReductionNode>(reduction->kind(), reduction->variable(),
+                                           reduction->releaseCell(), std::move(from),
+                                           std::move(to), std::move(body));
+}
+
+std::unique_ptr<Node> Optimizer::rewriteIntegral(std::unique_ptr<Node> node) {
+    auto* integral = static_cast<IntegralNode*>(node.get());
+    auto body = rewrite(integral->releaseBody());
+    auto lower = rewrite(integral->releaseLower());
+    auto upper = rewrite(integral->releaseUpper());
+    auto tolerance = integral->tolerance() ? rewrite(integral->releaseTolerance()) : nullptr;
+    return std::make_unique<IntegralNode>(integral->variable(), integral->releaseCell(),
+                                          std::move(body), std::move(lower), std::move(upper),
+                                          std::move(tolerance));
+}
+
+std::unique_ptr<Node> Optimizer::rewriteSolve(std::unique_ptr<Node> node) {
+    auto* solve = static_cast<SolveNode*>(node.get());
+    auto body = rewrite(solve->releaseBody());
+    auto lower = rewrite(solve->releaseLower());
+    auto upper = rewrite(solve->releaseUpper());
+    auto index = solve->index() ? rewrite(solve->releaseIndex()) : nullptr;
+    return std::make_unique<SolveNode>(solve->variable(), solve->releaseCell(), std::move(body),
+                                       std::move(lower), std::move(upper), std::move(index));
+}
+
+std::unique_ptr<Node> Optimizer::rewriteBinary(std::unique_ptr<Node> node) {
+    // Левоассоциативная цепочка 1 + 2 + 3 + ... разбирается циклом по левым
+    // потомкам, а не рекурсией: длинная строка не переполняет стек.
+    // Порядок обхода прежний — левое поддерево, затем правое
+    std::vector<std::pair<BinaryOp, std::unique_ptr<Node>>> spine;
+    while (auto* binary = dynamic_cast<BinaryOpNode*>(node.get())) {
+        spine.emplace_back(binary->op(), binary->releaseRight());
+        node = binary->releaseLeft();
+    }
+    
+    auto left = rewrite(std::move(node));
+    for (auto link = spine.rbegin(); link != spine.rend(); ++link) {
+        left = simplifyBinary(link->first, std::move(left), rewrite(std::move(link->second)));
+    }
+    return left;
+}
+
+std::unique_ptr<Node> Optimizer::simplifyBinary(BinaryOp op, std::unique_ptr<Node> left,
+                                                std::unique_ptr<Node> right) {
+    if (!left || !right) {
+        return std::make_unique<BinaryOpNode>(op, std::move(left), std::move(right));
+    }
+    
+    if (asNumber(left.get()) && asNumber(right.get())) {
+        return tryFold(std::make_unique<BinaryOpNode>(op, std::move(left), std::move(right)));
+    }
+    
+    switch (op) {
+        case BinaryOp::Add:
+            if (isSignedZero(right.get(), true) ||
+                (options_.fastMath && isNumber(right.get(), 0.0))) {
+                ++report_.identitiesRemoved;
+                return left;
+            }
+            if (isSignedZero(left.get(), true) ||
+                (options_.fastMath && isNumber(left.get(), 0.0))) {
+                ++report_.identitiesRemoved;
+                return right;
+            }
+            break;
+            
+        case BinaryOp::Subtract:
+            if (isSignedZero(right.get(), false) ||
+                (options_.fastMath && isNumber(right.get(), 0.0))) {
+                ++report_.identitiesRemoved;
+                return left;
+            }
+            break;
+            
+        case BinaryOp::Multiply:
+            if (isNumber(right.get(), 1.0)) {
+                ++report_.identitiesRemoved;
+                return left;
+            }
+            if (isNumber(left.get(), 1.0)) {
+                ++report_.identitiesRemoved;
+                return right;
+            }
+            break;
+            
+        case BinaryOp::Divide: {
+            if (isNumber(right.get(), 1.0)) {
+                ++report_.identitiesRemoved;
+                return left;
+            }
+            const auto* divisor = asNumber(right.get());
+            if (!divisor) {
+                break;
+            }
+            double c = divisor->value();
+            // Для |c| >= 1 ни x/c, ни x*(1/c) не переполняются, а для степени
+            // двойки обратное значение точно, поэтому результат совпадает побитово
+            bool exact = std::abs(c) >= 1.0 && isPowerOfTwo(c);
+            bool allowed = options_.fastMath && std::abs(c) >= 1e-15 &&
+                           std::isfinite(1.0 / c);
+            if (exact || allowed) {
+                ++report_.strengthReduced;
+                return std::make_unique<BinaryOpNode>(
+                    BinaryOp::Multiply, std::move(left),
+                    std::make_unique<NumberNode>(1.0 / c));
+            }
+            break;
+        }
+            
+        case BinaryOp::Power: {
+            const auto* exponentNode = asNumber(right.get());
+            if (!exponentNode) {
+                break;
+            }
+            double n = exponentNode->value();
+            if (n == 1.0) {
+                ++report_.identitiesRemoved;
+                return left;
+            }
+            // std::pow не всегда округляет корректно (даже pow(x, 2) != x*x
+            // для некоторых x), поэтому цепочка умножений только в fastMath
+            if (options_.fastMath && n == std::floor(n) &&
+                std::abs(n) <= MAX_CHAIN_EXPONENT) {
+                ++report_.strengthReduced;
+                return std::make_unique<IntPowerNode>(std::move(left), static_cast<int>(n));
+            }
+            break;
+        }
+            
+        default:
+            break;
+    }
+    
+    return std::make_unique<BinaryOpNode>(op, std::move(left), std::move(right));
+}
+
+} // namespace calc
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "ast/node.hpp"
+#include "ast/binary_op.hpp"
+#include <cstddef>
+#include <memory>
+
+namespace calc {
+
+/**
+ * @brief Параметры оптимизатора
+ */
+struct OptimizerOptions {
+    /**
+     * По умолчанию выполняются только преобразования, дающие побитово тот же
+     * результат и те же ошибки. fastMath разрешает преобразования, меняющие
+     * округление (x^n -> цепочка умножений, x/c -> x*(1/c) для любого c,
+     * x+0 -> x) и, при переполнении, текст сообщения об ошибке.
+     * Без fastMath деление заменяется умножением только на степень двойки.
+     */
+    bool fastMath = false;
+};
+
+/**
+ * @brief Отчёт о работе оптимизатора
+ */
+struct OptimizationReport {
+    size_t nodesBefore = 0;
+    size_t nodesAfter = 0;
+    size_t constantsFolded = 0;     // Свёрнутые константные поддеревья
+    size_t strengthReduced = 0;     // Степени и деления, заменённые умножением
+    size_t identitiesRemoved = 0;   // Удалённые тождественные операции
+    size_t branchesPruned = 0;      // Условные выражения с константным условием
+};
+
+/**
+ * @brief Алгебраические упрощения AST между разбором и вычислением
+ */
+class Optimizer {
+public:
+    explicit Optimizer(OptimizerOptions options = {});
+    
+    std::unique_ptr<Node> optimize(std::unique_ptr<Node> root);
+    
+    const OptimizationReport& report() const { return report_; }
+    
+private:
+    std::unique_ptr<Node> rewrite(std::unique_ptr<Node> node);
+    std::unique_ptr<Node> rewriteUnary(std::unique_ptr<Node> node);
+    std::unique_ptr<Node> rewriteBinary(std::unique_ptr<Node> node);
+    // Упрощение узла op с уже упрощёнными операндами
+    std::unique_ptr<Node> simplifyBinary(BinaryOp op, std::unique_ptr<Node> left,
+                                         std::unique_ptr<Node> right);
+    std::unique_ptr<Node> rewriteFunction(std::unique_ptr<Node> node);
+    std::unique_ptr<Node> rewriteIntPower(std::unique_ptr<Node> node);
+    std::unique_ptr<Node> rewriteConditional(std::unique_ptr<Node> node);
+    std::unique_ptr<Node> rewriteReduction(std::unique_ptr<Node> node);
+    std::unique_ptr<Node> rewriteIntegral(std::unique_ptr<Node> node);
+    std::unique_ptr<Node> rewriteSolve(std::unique_ptr<Node> node);
+    std::unique_ptr<Node> tryFold(std::unique_ptr<Node> node);
+    
+    OptimizerOptions options_;
+    OptimizationReport report_;
+};
+
+/**
+ * @brief Количество узлов в дереве
+ */
+size_t countNodes(const Node* root);
+
+} // namespace calc
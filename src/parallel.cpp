@@ -0,0 +1,84 @@
+#include "parallel.hpp"
+#include "cancellation.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace calc {
+
+namespace {
+    thread_local size_t serialScopes = 0;
+}
+
+SerialScope::SerialScope() {
+    ++serialScopes;
+}
+
+SerialScope::~SerialScope() {
+    --serialScopes;
+}
+
+size_t hardwareThreads() {
+    return std::max<size_t>(1, std::thread::hardware_concurrency());
+}
+
+void parallelFor(size_t tasks, const std::function<void(size_t task)>& body, size_t threads) {
+    if (threads == 0) {
+        threads = hardwareThreads();
+    }
+    if (serialScopes > 0) {
+        threads = 1;
+    }
+    threads = std::min(threads, tasks);
+    if (threads <= 1) {
+        for (size_t task = 0; task < tasks; ++task) {
+            body(task);
+        }
+        return;
+    }
+
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+    std::mutex errorMutex;
+    const CancellationToken* token = CancellationScope::currentToken();
+
+    auto worker = [&]() {
+        while (!failed.load(std::memory_order_relaxed)) {
+            size_t task = next.fetch_add(1, std::memory_order_relaxed);
+            if (task >= tasks) {
+                return;
+            }
+            try {
+                body(task);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(errorMutex);
+                if (!error) {
+                    error = std::current_exception();
+                }
+                failed.store(true, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    pool.reserve(threads - 1);
+    for (size_t i = 1; i < threads; ++i) {
+        pool.emplace_back([&] {
+            CancellationScope cancellation(token);
+            worker();
+        });
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+} // namespace calc
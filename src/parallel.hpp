@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace calc {
+
+/**
+ * @brief Число потоков по умолчанию: аппаратный параллелизм, не меньше 1
+ */
+size_t hardwareThreads();
+
+/**
+ * @brief Выполнить body(task) для каждого task из [0, tasks)
+ *
+ * Задачи раздаются потокам по одной через атомарный счётчик, поэтому
+ * задачи разной длительности распределяются равномерно; вызывающий поток
+ * работает наравне с остальными. threads == 0 — hardwareThreads().
+ * Первое исключение из body перебрасывается после остановки всех потоков;
+ * ещё не начатые задачи после него не выполняются. Рабочие потоки видят
+ * токен CancellationScope вызывающего потока.
+ */
+void parallelFor(size_t tasks, const std::function<void(size_t task)>& body, size_t threads = 0);
+
+/**
+ * @brief Пока объект жив, parallelFor в этом потоке выполняется последовательно
+ *
+ * Для потоков, которые уже заняты своей долей общей работы (стадии
+ * конвейера пакетного режима): вложенный sum/integrate не запускает ещё
+ * по потоку на ядро.
+ */
+class SerialScope {
+public:
+    SerialScope();
+    ~SerialScope();
+
+    SerialScope(const SerialScope&) = delete;
+    SerialScope& operator=(const SerialScope&) = delete;
+};
+
+} // namespace calc
@@ -3,8 +3,32 @@
 
 namespace calc {
 
-Parser::Parser(std::vector<Token> tokens) 
-    : tokens_(std::move(tokens)), pos_(0) {
+namespace {
+    // Разбор рекурсивен: без ограничения глубокая вложенность переполняет
+    // стек (1 МБ у главного потока Windows, 512 КБ у рабочих потоков macOS)
+    constexpr size_t MAX_NESTING_DEPTH = 256;
+
+    // Уровень вложенности на время разбора вложенной конструкции
+    class NestingGuard {
+    public:
+        explicit NestingGuard(size_t& depth) : depth_(depth) {
+            if (depth_ >= MAX_NESTING_DEPTH) {
+                throw ParseError("Expression nested too deeply (max 256 levels)");
+            }
+            ++depth_;
+        }
+        ~NestingGuard() { --depth_; }
+
+        NestingGuard(const NestingGuard&) = delete;
+        NestingGuard& operator=(const NestingGuard&) = delete;
+
+    private:
+        size_t& depth_;
+    };
+}
+
+Parser::Parser(std::vector<Token> tokens, const Variables* variables) 
+    : tokens_(std::move(tokens)), pos_(0), variables_(variables) {
     if (tokens_.empty()) {
         throw ParseError("Empty token stream");
     }
@@ -79,10 +103,61 @@ std::unique_ptr<Node> Parser::parse() {
 }
 
 std::unique_ptr<Node> Parser::parseExpression() {
-    return parseBitwiseOr();
+    return parseConditional();
+}
+
+// Условное выражение cond ? a : b (самый низкий приоритет, правоассоциативно)
+std::unique_ptr<Node> Parser::parseConditional() {
+    // Сюда приходят и скобки, и аргументы функций, и ветви условий
+    NestingGuard guard(depth_);
+    auto condition = parseEquality();
+    
+    if (!match(TokenType::Question)) {
+        return condition;
+    }
+    auto thenBranch = parseConditional();
+    if (!match(TokenType::Colon)) {
+        throw ParseError("Expected ':' in conditional expression");
+    }
+    auto elseBranch = parseConditional();
+    return std::make_unique<ConditionalNode>(std::move(condition), std::move(thenBranch),
+                                             std::move(elseBranch));
+}
+
+// Равенство и неравенство
+std::unique_ptr<Node> Parser::parseEquality() {
+    auto left = parseComparison();
+    
+    while (current().type == TokenType::Equal || current().type == TokenType::NotEqual) {
+        BinaryOp binOp = current().type == TokenType::Equal ? BinaryOp::Equal : BinaryOp::NotEqual;
+        advance();
+        auto right = parseComparison();
+        left = std::make_unique<BinaryOpNode>(binOp, std::move(left), std::move(right));
+    }
+    
+    return left;
 }
 
-// Битовое ИЛИ (самый низкий приоритет)
+// Сравнения (ниже битовых операций: x AND 4 > 0 — это (x AND 4) > 0)
+std::unique_ptr<Node> Parser::parseComparison() {
+    auto left = parseBitwiseOr();
+    
+    while (true) {
+        BinaryOp binOp;
+        switch (current().type) {
+            case TokenType::Less: binOp = BinaryOp::Less; break;
+            case TokenType::LessEqual: binOp = BinaryOp::LessEqual; break;
+            case TokenType::Greater: binOp = BinaryOp::Greater; break;
+            case TokenType::GreaterEqual: binOp = BinaryOp::GreaterEqual; break;
+            default: return left;
+        }
+        advance();
+        auto right = parseBitwiseOr();
+        left = std::make_unique<BinaryOpNode>(binOp, std::move(left), std::move(right));
+    }
+}
+
+// Битовое ИЛИ
 std::unique_ptr<Node> Parser::parseBitwiseOr() {
     auto left = parseBitwiseXor();
     
@@ -184,6 +259,7 @@ std::unique_ptr<Node> Parser::parsePower() {
     
     if (current().type == TokenType::Power) {
         advance();
+        NestingGuard guard(depth_);
         auto right = parsePower(); // Right associative
         left = std::make_unique<BinaryOpNode>(BinaryOp::Power, std::move(left), std::move(right));
     }
@@ -192,25 +268,29 @@ std::unique_ptr<Node> Parser::parsePower() {
 }
 
 std::unique_ptr<Node> Parser::parseUnary() {
-    if (current().type == TokenType::Plus) {
-        advance();
-        auto operand = parseUnary();
-        return std::make_unique<UnaryOpNode>(UnaryOp::Plus, std::move(operand));
-    }
-    
-    if (current().type == TokenType::Minus) {
+    // Цепочка знаков (--+-x) сворачивается в один узел: те же проверки
+    // операнда, но глубина дерева не растёт с длиной цепочки
+    bool hasSign = false;
+    bool negative = false;
+    while (current().type == TokenType::Plus || current().type == TokenType::Minus) {
+        negative ^= current().type == TokenType::Minus;
+        hasSign = true;
         advance();
-        auto operand = parseUnary();
-        return std::make_unique<UnaryOpNode>(UnaryOp::Minus, std::move(operand));
     }
     
+    std::unique_ptr<Node> operand;
     if (current().type == TokenType::BitwiseNot) {
         advance();
-        auto operand = parseUnary();
-        return std::make_unique<UnaryOpNode>(UnaryOp::BitwiseNot, std::move(operand));
+        NestingGuard guard(depth_);
+        operand = std::make_unique<UnaryOpNode>(UnaryOp::BitwiseNot, parseUnary());
+    } else {
+        operand = parsePrimary();
     }
     
-    return parsePrimary();
+    if (!hasSign) {
+        return operand;
+    }
+    return std::make_unique<UnaryOpNode>(negative ? UnaryOp::Minus : UnaryOp::Plus, std::move(operand));
 }
 
 std::unique_ptr<Node> Parser::parsePrimary() {
@@ -226,6 +306,19 @@ std::unique_ptr<Node> Parser::parsePrimary() {
         std::string name = std::get<std::string>(tok.value);
         advance();
         
+        if (name == "if" && match(TokenType::LParen)) {
+            return parseIfCall();
+        }
+        if ((name == "sum" || name == "prod") && match(TokenType::LParen)) {
+            return parseReduction(name == "sum" ? ReductionKind::Sum : ReductionKind::Product);
+        }
+        if (name == "integrate" && match(TokenType::LParen)) {
+            return parseIntegral();
+        }
+        if (name == "solve" && match(TokenType::LParen)) {
+            return parseSolve();
+        }
+        
         if (match(TokenType::LParen)) {
             auto arg = parseExpression();
             // Разрешаем опускать закрывающую скобку, если достигнут конец ввода
@@ -235,6 +328,15 @@ std::unique_ptr<Node> Parser::parsePrimary() {
             return std::make_unique<FuncCallNode>(name, std::move(arg));
         }
         
+        for (auto local = locals_.rbegin(); local != locals_.rend(); ++local) {
+            if (local->first == name) {
+                return std::make_unique<VariableNode>(name, local->second);
+            }
+        }
+        if (const double* slot = variables_ ? variables_->find(name) : nullptr) {
+            return std::make_unique<VariableNode>(name, slot);
+        }
+        
         throw ParseError("Unknown identifier: " + name);
     }
     
@@ -250,4 +352,152 @@ std::unique_ptr<Node> Parser::parsePrimary() {
     throw ParseError("Unexpected token");
 }
 
+// if(cond, a, b) — то же, что cond ? a : b; открывающая скобка уже разобрана
+std::unique_ptr<Node> Parser::parseIfCall() {
+    auto condition = parseExpression();
+    if (!match(TokenType::Comma)) {
+        throw ParseError("Expected ',' after condition in if()");
+    }
+    auto thenBranch = parseExpression();
+    if (!match(TokenType::Comma)) {
+        throw ParseError("Expected ',' after first branch in if()");
+    }
+    auto elseBranch = parseExpression();
+    // Разрешаем опускать закрывающую скобку, если достигнут конец ввода
+    if (!match(TokenType::RParen) && current().type != TokenType::End) {
+        throw ParseError("Expected ')' after if() arguments");
+    }
+    return std::make_unique<ConditionalNode>(std::move(condition), std::move(thenBranch),
+                                             std::move(elseBranch));
+}
+
+// sum(i, from, to, body) и prod(...); открывающая скобка уже разобрана.
+// Переменная цикла видна только в body и скрывает одноимённую внешнюю
+std::unique_ptr<Node> Parser::parseReduction(ReductionKind kind) {
+    const char* name = kind == ReductionKind::Sum ? "sum" : "prod";
+    if (current().type != TokenType::Identifier) {
+        throw ParseError(std::string("Expected loop variable in ") + name + "()");
+    }
+    std::string variable = std::get<std::string>(current().value);
+    advance();
+    if (!match(TokenType::Comma)) {
+        throw ParseError(std::string("Expected ',' after loop variable in ") + name + "()");
+    }
+    auto from = parseExpression();
+    if (!match(TokenType::Comma)) {
+        throw ParseError(std::string("Expected ',' after lower bound in ") + name + "()");
+    }
+    auto to = parseExpression();
+    if (!match(TokenType::Comma)) {
+        throw ParseError(std::string("Expected ',' after upper bound in ") + name + "()");
+    }
+
+    auto cell = std::make_unique<double>(0.0);
+    auto body = parseScoped(variable, cell.get());
+
+    // Разрешаем опускать закрывающую скобку, если достигнут конец ввода
+    if (!match(TokenType::RParen) && current().type != TokenType::End) {
+        throw ParseError(std::string("Expected ')' after ") + name + "() arguments");
+    }
+    return std::make_unique<ReductionNode>(kind, std::move(variable), std::move(cell),
+                                           std::move(from), std::move(to), std::move(body));
+}
+
+// Первые аргументы вызовов вида f(expr, x, ...): переменная записана после
+// expr, поэтому находится заранее — это идентификатор после первой запятой
+// вне скобок. Разбирает "expr, x," и возвращает expr
+std::unique_ptr<Node> Parser::parseLeadingBody(const char* name, std::string& variable,
+                                               std::unique_ptr<double>& cell) {
+    size_t depth = 0;
+    size_t comma = pos_;
+    for (; comma < tokens_.size() && tokens_[comma].type != TokenType::End; ++comma) {
+        TokenType type = tokens_[comma].type;
+        if (type == TokenType::LParen) {
+            ++depth;
+        } else if (type == TokenType::RParen) {
+            if (depth == 0) {
+                break;
+            }
+            --depth;
+        } else if (type == TokenType::Comma && depth == 0) {
+            break;
+        }
+    }
+    if (comma + 1 >= tokens_.size() || tokens_[comma].type != TokenType::Comma ||
+        tokens_[comma + 1].type != TokenType::Identifier) {
+        throw ParseError(std::string("Expected variable in ") + name + "()");
+    }
+    variable = std::get<std::string>(tokens_[comma + 1].value);
+
+    cell = std::make_unique<double>(0.0);
+    auto body = parseScoped(variable, cell.get());
+    if (pos_ != comma) {
+        throw ParseError(std::string("Expected ',' after expression in ") + name + "()");
+    }
+    advance();
+    advance();
+    if (!match(TokenType::Comma)) {
+        throw ParseError(std::string("Expected ',' after variable in ") + name + "()");
+    }
+    return body;
+}
+
+// integrate(expr, x, a, b[, tol]); открывающая скобка уже разобрана
+std::unique_ptr<Node> Parser::parseIntegral() {
+    std::string variable;
+    std::unique_ptr<double> cell;
+    auto body = parseLeadingBody("integrate", variable, cell);
+    auto lower = parseExpression();
+    if (!match(TokenType::Comma)) {
+        throw ParseError("Expected ',' after lower bound in integrate()");
+    }
+    auto upper = parseExpression();
+    std::unique_ptr<Node> tolerance;
+    if (match(TokenType::Comma)) {
+        tolerance = parseExpression();
+    }
+    // Разрешаем опускать закрывающую скобку, если достигнут конец ввода
+    if (!match(TokenType::RParen) && current().type != TokenType::End) {
+        throw ParseError("Expected ')' after integrate() arguments");
+    }
+    return std::make_unique<IntegralNode>(std::move(variable), std::move(cell), std::move(body),
+                                          std::move(lower), std::move(upper), std::move(tolerance));
+}
+
+// solve(expr, x, lo, hi[, n]); открывающая скобка уже разобрана
+std::unique_ptr<Node> Parser::parseSolve() {
+    std::string variable;
+    std::unique_ptr<double> cell;
+    auto body = parseLeadingBody("solve", variable, cell);
+    auto lower = parseExpression();
+    if (!match(TokenType::Comma)) {
+        throw ParseError("Expected ',' after lower bound in solve()");
+    }
+    auto upper = parseExpression();
+    std::unique_ptr<Node> index;
+    if (match(TokenType::Comma)) {
+        index = parseExpression();
+    }
+    // Разрешаем опускать закрывающую скобку, если достигнут конец ввода
+    if (!match(TokenType::RParen) && current().type != TokenType::End) {
+        throw ParseError("Expected ')' after solve() arguments");
+    }
+    return std::make_unique<SolveNode>(std::move(variable), std::move(cell), std::move(body),
+                                       std::move(lower), std::move(upper), std::move(index));
+}
+
+// Выражение, в котором variable ссылается на cell (тела sum, prod, integrate)
+std::unique_ptr<Node> Parser::parseScoped(const std::string& variable, const double* cell) {
+    locals_.emplace_back(variable, cell);
+    std::unique_ptr<Node> body;
+    try {
+        body = parseExpression();
+    } catch (...) {
+        locals_.pop_back();
+        throw;
+    }
+    locals_.pop_back();
+    return body;
+}
+
 } // namespace calc
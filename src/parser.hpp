@@ -6,22 +6,38 @@
 #include "ast/binary_op.hpp"
 #include "ast/unary_op.hpp"
 #include "ast/func_call.hpp"
+#include "ast/variable.hpp"
+#include "ast/conditional.hpp"
+#include "ast/reduction.hpp"
+#include "ast/integral.hpp"
+#include "ast/solve.hpp"
+#include "variables.hpp"
 #include "error.hpp"
 #include <memory>
 #include <vector>
 #include <stack>
 #include <unordered_map>
+#include <utility>
 
 namespace calc {
 
 class Parser {
 public:
-    explicit Parser(std::vector<Token> tokens);
+    /**
+     * @param variables Таблица объявленных переменных; идентификатор вне
+     *                  вызова функции, отсутствующий в ней, считается ошибкой
+     */
+    explicit Parser(std::vector<Token> tokens, const Variables* variables = nullptr);
     std::unique_ptr<Node> parse();
     
 private:
     std::vector<Token> tokens_;
     size_t pos_;
+    const Variables* variables_;
+    // Переменные циклов sum/prod, видимые в разбираемом теле (внутренние — в конце)
+    std::vector<std::pair<std::string, const double*>> locals_;
+    // Текущая вложенность скобок, условий, степеней и NOT (см. NestingGuard)
+    size_t depth_ = 0;
     
     Token& current();
     Token& peek(size_t offset = 0);
@@ -29,6 +45,9 @@ private:
     bool match(TokenType type);
     
     std::unique_ptr<Node> parseExpression();
+    std::unique_ptr<Node> parseConditional();
+    std::unique_ptr<Node> parseEquality();
+    std::unique_ptr<Node> parseComparison();
     std::unique_ptr<Node> parseBitwiseOr();
     std::unique_ptr<Node> parseBitwiseXor();
     std::unique_ptr<Node> parseBitwiseAnd();
@@ -38,6 +57,13 @@ private:
     std::unique_ptr<Node> parsePower();
     std::unique_ptr<Node> parseUnary();
     std::unique_ptr<Node> parsePrimary();
+    std::unique_ptr<Node> parseIfCall();
+    std::unique_ptr<Node> parseReduction(ReductionKind kind);
+    std::unique_ptr<Node> parseIntegral();
+    std::unique_ptr<Node> parseSolve();
+    std::unique_ptr<Node> parseLeadingBody(const char* name, std::string& variable,
+                                           std::unique_ptr<double>& cell);
+    std::unique_ptr<Node> parseScoped(const std::string& variable, const double* cell);
     
     int getPrecedence(TokenType type);
     bool isRightAssociative(TokenType type);
@@ -0,0 +1,314 @@
+#include "pipeline.hpp"
+#include "bounded_queue.hpp"
+#include "parallel.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace calc {
+
+namespace {
+    // Кусок ввода из целых строк и его результаты
+    struct Chunk {
+        size_t sequence = 0;
+        std::string_view text;      // Строки куска: в input или в отображённом файле
+        std::string input;
+        std::string output;
+        size_t lines = 0;
+        size_t errors = 0;
+    };
+
+    using ChunkPtr = std::unique_ptr<Chunk>;
+
+    // Чтение файла кусками не меньше chunkSize байт, обрезанными по '\n';
+    // хвост незаконченной строки переходит в следующий кусок
+    class StreamSource {
+    public:
+        StreamSource(std::FILE* file, size_t chunkSize)
+            : file_(file), chunkSize_(std::max<size_t>(chunkSize, 1)) {}
+
+        bool next(Chunk& chunk) {
+            chunk.input.assign(carry_);
+            carry_.clear();
+            while (!eof_) {
+                size_t used = chunk.input.size();
+                chunk.input.resize(used + chunkSize_);
+                size_t read = std::fread(&chunk.input[used], 1, chunkSize_, file_);
+                chunk.input.resize(used + read);
+                if (read == 0) {
+                    if (std::ferror(file_)) {
+                        throw std::runtime_error(std::string("Read error: ") + std::strerror(errno));
+                    }
+                    eof_ = true;
+                    break;
+                }
+                // До этого чтения в куске не было '\n'
+                size_t newline = chunk.input.rfind('\n');
+                if (newline != std::string::npos) {
+                    carry_.assign(chunk.input, newline + 1, std::string::npos);
+                    chunk.input.resize(newline + 1);
+                    chunk.text = chunk.input;
+                    return true;
+                }
+            }
+            // Последняя строка без '\n'
+            chunk.text = chunk.input;
+            return !chunk.input.empty();
+        }
+
+    private:
+        std::FILE* file_;
+        size_t chunkSize_;
+        std::string carry_;
+        bool eof_ = false;
+    };
+
+    // Срезы ввода в памяти: не меньше chunkSize байт до конца строки
+    class MemorySource {
+    public:
+        MemorySource(std::string_view input, size_t chunkSize)
+            : rest_(input), chunkSize_(std::max<size_t>(chunkSize, 1)) {}
+
+        bool next(Chunk& chunk) {
+            if (rest_.empty()) {
+                return false;
+            }
+            size_t end = std::min(rest_.size(), chunkSize_);
+            size_t newline = rest_.find('\n', end - 1);
+            end = newline == std::string_view::npos ? rest_.size() : newline + 1;
+            chunk.text = rest_.substr(0, end);
+            rest_.remove_prefix(end);
+            return true;
+        }
+
+    private:
+        std::string_view rest_;
+        size_t chunkSize_;
+    };
+
+    // Глубина очереди при добавлении: среднее и максимум
+    class DepthGauge {
+    public:
+        void record(size_t depth) {
+            total_.fetch_add(depth, std::memory_order_relaxed);
+            samples_.fetch_add(1, std::memory_order_relaxed);
+            size_t max = max_.load(std::memory_order_relaxed);
+            while (depth > max && !max_.compare_exchange_weak(max, depth, std::memory_order_relaxed)) {
+            }
+        }
+
+        double mean() const {
+            size_t samples = samples_.load();
+            return samples == 0 ? 0.0 : static_cast<double>(total_.load()) / samples;
+        }
+
+        size_t max() const { return max_.load(); }
+
+    private:
+        std::atomic<size_t> total_{0};
+        std::atomic<size_t> samples_{0};
+        std::atomic<size_t> max_{0};
+    };
+
+    void evaluateChunk(Chunk& chunk, const Variables& variables, const BatchOptions& options) {
+        chunk.output.clear();
+        BatchStats stats = evaluateLines(chunk.text, variables, options, chunk.output);
+        chunk.lines = stats.lines;
+        chunk.errors = stats.errors;
+    }
+
+    template <typename Source>
+    PipelineStats runStages(Source& source, BufferedWriter& output, const Variables& variables,
+                            const PipelineOptions& options) {
+        auto started = std::chrono::steady_clock::now();
+        PipelineStats stats;
+        stats.threads = options.threads > 0 ? options.threads : hardwareThreads();
+        size_t capacity = options.queueCapacity > 0 ? options.queueCapacity : 2 * stats.threads;
+
+        BoundedQueue<ChunkPtr> work(capacity);
+        BoundedQueue<ChunkPtr> done(capacity);
+        // Кусков в работе не больше, чем помещается в очереди и потоки:
+        // окно переупорядочения и запас буферов для повторного использования
+        const size_t window = work.capacity() + done.capacity() + stats.threads + 1;
+        BoundedQueue<ChunkPtr> spare(window);
+
+        std::atomic<size_t> written{0};
+        std::atomic<bool> readerDone{false};
+        std::atomic<size_t> workersDone{0};
+        std::atomic<bool> stop{false};
+        DepthGauge inputDepth;
+        DepthGauge outputDepth;
+
+        std::exception_ptr error;
+        std::mutex errorMutex;
+        auto fail = [&]() {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+            stop.store(true);
+        };
+
+        // Добавление с ожиданием; false — конвейер остановлен
+        auto push = [&stop](BoundedQueue<ChunkPtr>& queue, ChunkPtr& chunk, size_t* stalls) {
+            Backoff backoff;
+            while (!queue.tryPush(chunk)) {
+                if (stop.load(std::memory_order_relaxed)) {
+                    return false;
+                }
+                if (stalls) {
+                    ++*stalls;
+                }
+                backoff.wait();
+            }
+            return true;
+        };
+
+        std::thread reader([&]() {
+            try {
+                for (size_t sequence = 0; !stop.load(std::memory_order_relaxed); ++sequence) {
+                    // Не уходить вперёд записи дальше окна переупорядочения
+                    Backoff backoff;
+                    while (sequence >= written.load(std::memory_order_acquire) + window &&
+                           !stop.load(std::memory_order_relaxed)) {
+                        ++stats.readerStalls;
+                        backoff.wait();
+                    }
+                    if (stop.load(std::memory_order_relaxed)) {
+                        break;
+                    }
+                    ChunkPtr chunk;
+                    if (!spare.tryPop(chunk)) {
+                        chunk = std::make_unique<Chunk>();
+                    }
+                    if (!source.next(*chunk)) {
+                        break;
+                    }
+                    chunk->sequence = sequence;
+                    stats.bytes += chunk->text.size();
+                    ++stats.chunks;
+                    inputDepth.record(work.size());
+                    if (!push(work, chunk, &stats.readerStalls)) {
+                        break;
+                    }
+                }
+            } catch (...) {
+                fail();
+            }
+            readerDone.store(true, std::memory_order_release);
+        });
+
+        std::vector<std::thread> workers;
+        for (size_t t = 0; t < stats.threads; ++t) {
+            workers.emplace_back([&]() {
+                // Вложенные sum/integrate не размножают потоки
+                SerialScope serial;
+                Backoff backoff;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    ChunkPtr chunk;
+                    if (!work.tryPop(chunk)) {
+                        // readerDone читается до повторной попытки: если и она
+                        // неудачна, новых кусков уже не будет
+                        bool finished = readerDone.load(std::memory_order_acquire);
+                        if (!work.tryPop(chunk)) {
+                            if (finished) {
+                                break;
+                            }
+                            backoff.wait();
+                            continue;
+                        }
+                    }
+                    backoff.reset();
+                    try {
+                        evaluateChunk(*chunk, variables, options.batch);
+                    } catch (...) {
+                        fail();
+                        break;
+                    }
+                    outputDepth.record(done.size());
+                    if (!push(done, chunk, nullptr)) {
+                        break;
+                    }
+                }
+                workersDone.fetch_add(1, std::memory_order_release);
+            });
+        }
+
+        // Запись в вызывающем потоке: куски ждут в кольце по номеру, пока
+        // не будут записаны все предыдущие
+        std::vector<ChunkPtr> pending(window);
+        size_t next = 0;
+        size_t held = 0;
+        Backoff backoff;
+        try {
+            while (!stop.load(std::memory_order_relaxed)) {
+                ChunkPtr chunk;
+                if (!done.tryPop(chunk)) {
+                    bool finished = workersDone.load(std::memory_order_acquire) == stats.threads;
+                    if (!done.tryPop(chunk)) {
+                        if (finished) {
+                            break;
+                        }
+                        backoff.wait();
+                        continue;
+                    }
+                }
+                backoff.reset();
+                pending[chunk->sequence % window] = std::move(chunk);
+                stats.reorderMax = std::max(stats.reorderMax, ++held);
+                while (ChunkPtr& ready = pending[next % window]) {
+                    output.write(ready->output);
+                    stats.lines += ready->lines;
+                    stats.errors += ready->errors;
+                    spare.tryPush(ready);
+                    ready.reset();
+                    --held;
+                    written.store(++next, std::memory_order_release);
+                }
+            }
+            output.flush();
+        } catch (...) {
+            fail();
+        }
+
+        stop.store(true);
+        reader.join();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+
+        stats.inputDepth = inputDepth.mean();
+        stats.inputDepthMax = inputDepth.max();
+        stats.outputDepth = outputDepth.mean();
+        stats.outputDepthMax = outputDepth.max();
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        return stats;
+    }
+}
+
+PipelineStats runPipeline(std::FILE* input, BufferedWriter& output, const Variables& variables,
+                          const PipelineOptions& options) {
+    StreamSource source(input, options.chunkSize);
+    return runStages(source, output, variables, options);
+}
+
+PipelineStats runPipeline(std::string_view input, BufferedWriter& output, const Variables& variables,
+                          const PipelineOptions& options) {
+    MemorySource source(input, options.chunkSize);
+    return runStages(source, output, variables, options);
+}
+
+} // namespace calc
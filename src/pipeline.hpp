@@ -0,0 +1,66 @@
+#pragma once
+
+#include "batch.hpp"
+#include "variables.hpp"
+#include <cstddef>
+#include <cstdio>
+#include <string_view>
+
+namespace calc {
+
+/**
+ * @brief Параметры конвейера пакетного режима
+ */
+struct PipelineOptions {
+    size_t threads = 0;             // Рабочих потоков; 0 — hardwareThreads()
+    size_t chunkSize = 1 << 18;     // Байт ввода в куске (кусок — целые строки)
+    size_t queueCapacity = 0;       // Кусков в каждой очереди; 0 — 2 * threads
+    BatchOptions batch;
+};
+
+/**
+ * @brief Итог конвейера: объём работы и загрузка очередей
+ *
+ * Глубина очереди замеряется при каждом добавлении куска. Постоянно
+ * полная очередь к рабочим значит, что узкое место — вычисление;
+ * постоянно пустая — чтение.
+ */
+struct PipelineStats {
+    size_t lines = 0;
+    size_t errors = 0;
+    size_t bytes = 0;               // Байт ввода
+    size_t chunks = 0;
+    size_t threads = 0;             // Рабочих потоков
+    double seconds = 0.0;
+    double inputDepth = 0.0;        // Средняя глубина очереди к рабочим
+    size_t inputDepthMax = 0;
+    double outputDepth = 0.0;       // Средняя глубина очереди к записи
+    size_t outputDepthMax = 0;
+    size_t reorderMax = 0;          // Больше всего готовых кусков, ждавших более раннего
+    size_t readerStalls = 0;        // Ожиданий чтения из-за противодавления
+};
+
+/**
+ * @brief Вычислить все строки input в нескольких потоках, сохранив порядок
+ *
+ * Поток чтения режет ввод на куски по границам строк и нумерует их;
+ * рабочие потоки разбирают и вычисляют куски независимо (evaluateLine);
+ * вызывающий поток собирает результаты по номерам и пишет их в output.
+ * Стадии связаны ограниченными очередями без блокировок, и чтение не
+ * уходит вперёд записи больше чем на ёмкость очередей, поэтому память
+ * не зависит от размера ввода. Вывод совпадает с runBatch побайтно.
+ * Ошибки чтения и записи — std::runtime_error после остановки потоков.
+ */
+PipelineStats runPipeline(std::FILE* input, BufferedWriter& output, const Variables& variables,
+                          const PipelineOptions& options);
+
+/**
+ * @brief runPipeline для ввода, целиком лежащего в памяти (отображённого файла)
+ *
+ * Куски — срезы input без копирования; страницы файла подгружаются
+ * рабочими потоками при первом обращении. input должен жить до возврата.
+ */
+PipelineStats runPipeline(std::string_view input, BufferedWriter& output, const Variables& variables,
+                          const PipelineOptions& options);
+
+} // namespace calc
@@ -0,0 +1,157 @@
+#include "preview.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "evaluator.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+namespace calc {
+
+PreviewService::PreviewService(Sink sink, PreviewOptions options)
+    : sink_(std::move(sink)), options_(options) {
+    options_.cacheEntries = std::max<size_t>(options_.cacheEntries, 1);
+    worker_ = std::thread([this] { run(); });
+}
+
+PreviewService::~PreviewService() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        if (running_) {
+            running_->cancel();
+        }
+    }
+    wake_.notify_one();
+    worker_.join();
+}
+
+uint64_t PreviewService::request(std::string expression) {
+    uint64_t request;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ = std::move(expression);
+        request = ++latest_;
+        hasPending_ = true;
+        lastRequest_ = std::chrono::steady_clock::now();
+        ++stats_.requests;
+        // Вычисление прежнего запроса больше не нужно
+        if (running_) {
+            running_->cancel();
+        }
+    }
+    wake_.notify_one();
+    return request;
+}
+
+PreviewStats PreviewService::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+const PreviewService::Entry* PreviewService::findCached(std::string_view text) {
+    auto found = index_.find(text);
+    if (found == index_.end()) {
+        return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return &entries_.front();
+}
+
+void PreviewService::store(Entry entry) {
+    if (findCached(entry.text)) {
+        return;
+    }
+    if (entries_.size() >= options_.cacheEntries) {
+        index_.erase(entries_.back().text);
+        entries_.pop_back();
+    }
+    entries_.push_front(std::move(entry));
+    index_.emplace(entries_.front().text, entries_.begin());
+}
+
+void PreviewService::post(uint64_t request, const Entry& entry, bool cached, std::unique_lock<std::mutex>& lock) {
+    PreviewResult result;
+    result.request = request;
+    result.expression = entry.text;
+    result.valid = entry.valid;
+    result.value = entry.value;
+    result.cached = cached;
+    ++stats_.posted;
+    lock.unlock();
+    sink_(result);
+    lock.lock();
+}
+
+void PreviewService::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        wake_.wait(lock, [this] { return stopping_ || hasPending_; });
+        if (stopping_) {
+            return;
+        }
+
+        // Кэш принадлежит этому потоку: поиск идёт без блокировки, и
+        // request() не ждёт хэширования длинного текста
+        std::string text = pending_;
+        uint64_t request = latest_;
+        auto quiet = lastRequest_ + options_.debounce;
+        lock.unlock();
+        const Entry* cached = findCached(text);
+        lock.lock();
+        if (request != latest_) {
+            continue;
+        }
+
+        // Известный результат не ждёт паузы во вводе
+        if (cached) {
+            hasPending_ = false;
+            ++stats_.cacheHits;
+            post(request, *cached, true, lock);
+            continue;
+        }
+        if (std::chrono::steady_clock::now() < quiet) {
+            wake_.wait_until(lock, quiet);
+            continue;
+        }
+
+        pending_.clear();
+        hasPending_ = false;
+        CancellationToken token;
+        running_ = &token;
+        lock.unlock();
+
+        Entry entry{std::move(text), false, 0.0};
+        bool cancelled = false;
+        try {
+            CancellationScope scope(&token);
+            Lexer lexer(entry.text);
+            Parser parser(lexer.tokenize());
+            auto ast = parser.parse();
+            Evaluator evaluator;
+            entry.value = evaluator.evaluate(ast);
+            entry.valid = true;
+        } catch (const CancelledError&) {
+            cancelled = true;
+        } catch (const std::exception&) {
+            // Незаконченное выражение: предпросмотр пуст
+        }
+
+        lock.lock();
+        running_ = nullptr;
+        if (cancelled) {
+            ++stats_.cancelled;
+            continue;
+        }
+        ++stats_.evaluations;
+        store(entry);
+        if (request != latest_) {
+            ++stats_.dropped;
+            continue;
+        }
+        post(request, entry, false, lock);
+    }
+}
+
+} // namespace calc
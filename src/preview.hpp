@@ -0,0 +1,110 @@
+#pragma once
+
+#include "cancellation.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+namespace calc {
+
+/**
+ * @brief Параметры PreviewService
+ */
+struct PreviewOptions {
+    std::chrono::milliseconds debounce{60};     // Тишина во вводе перед вычислением
+    size_t cacheEntries = 256;                  // Результатов в LRU-кэше по тексту
+};
+
+/**
+ * @brief Результат предпросмотра
+ */
+struct PreviewResult {
+    uint64_t request = 0;           // Номер, который вернул request()
+    std::string expression;
+    bool valid = false;             // false — ошибка разбора или вычисления
+    double value = 0.0;
+    bool cached = false;
+};
+
+/**
+ * @brief Счётчики PreviewService
+ */
+struct PreviewStats {
+    size_t requests = 0;
+    size_t evaluations = 0;         // Вычислено до конца
+    size_t cacheHits = 0;
+    size_t cancelled = 0;           // Прервано новым запросом
+    size_t dropped = 0;             // Вычислено, но к концу уже устарело
+    size_t posted = 0;              // Передано получателю
+};
+
+/**
+ * @brief Предпросмотр результата при вводе
+ *
+ * request() не блокирует: запрос заменяет ожидающий, а вычисление
+ * устаревшего запроса отменяется (CancellationScope). Фоновый поток
+ * ждёт debounce без новых запросов, вычисляет последний и передаёт
+ * результат получателю, только если за это время не пришёл новый.
+ * Результаты кэшируются по тексту; ответ из кэша приходит без ожидания.
+ *
+ * Получатель вызывается в фоновом потоке; результаты приходят в порядке
+ * запросов, но не на каждый запрос.
+ */
+class PreviewService {
+public:
+    using Sink = std::function<void(const PreviewResult&)>;
+
+    explicit PreviewService(Sink sink, PreviewOptions options = {});
+    ~PreviewService();
+
+    PreviewService(const PreviewService&) = delete;
+    PreviewService& operator=(const PreviewService&) = delete;
+
+    /**
+     * @brief Запросить предпросмотр; возвращает номер запроса
+     */
+    uint64_t request(std::string expression);
+
+    PreviewStats stats() const;
+
+private:
+    struct Entry {
+        std::string text;
+        bool valid;
+        double value;
+    };
+
+    void run();
+    const Entry* findCached(std::string_view text);
+    void store(Entry entry);
+    void post(uint64_t request, const Entry& entry, bool cached, std::unique_lock<std::mutex>& lock);
+
+    Sink sink_;
+    PreviewOptions options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;
+    std::string pending_;
+    uint64_t latest_ = 0;
+    bool hasPending_ = false;
+    bool stopping_ = false;
+    std::chrono::steady_clock::time_point lastRequest_;
+    CancellationToken* running_ = nullptr;     // Токен вычисляемого запроса
+    PreviewStats stats_;
+
+    // Кэш доступен только фоновому потоку; ключи указывают на text элементов списка
+    std::list<Entry> entries_;
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;
+
+    std::thread worker_;
+};
+
+} // namespace calc
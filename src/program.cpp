@@ -0,0 +1,381 @@
+#include "program.hpp"
+#include "ast/number.hpp"
+#include "ast/binary_op.hpp"
+#include "ast/unary_op.hpp"
+#include "ast/func_call.hpp"
+#include "ast/variable.hpp"
+#include "ast/int_power.hpp"
+#include "ast/conditional.hpp"
+#include "ast/reduction.hpp"
+#include "ast/integral.hpp"
+#include "ast/solve.hpp"
+#include "variables.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace calc {
+
+namespace {
+    // Стек такой глубины размещается на стеке вызова
+    constexpr size_t INLINE_STACK = 64;
+
+    constexpr uint8_t LAST_UNARY_OP = static_cast<uint8_t>(UnaryOp::BitwiseNot);
+    constexpr uint8_t LAST_BINARY_OP = static_cast<uint8_t>(BinaryOp::NotEqual);
+
+    Instruction makeInstruction(OpCode op, uint8_t sub, int32_t operand) {
+        Instruction instruction;
+        instruction.op = op;
+        instruction.sub = sub;
+        instruction.reserved = 0;
+        instruction.operand = operand;
+        return instruction;
+    }
+
+    double loadVariable(const ProgramView& program, const double* const* slots, int32_t index) {
+        const double* slot = slots ? slots[index] : nullptr;
+        if (!slot) {
+            throw EvalError("Unbound variable: " + std::string(program.variableName(index)));
+        }
+        double val = *slot;
+        if (std::isnan(val)) {
+            throw EvalError("Invalid value of variable " + std::string(program.variableName(index)) + ": NaN");
+        }
+        if (std::isinf(val)) {
+            throw EvalError("Invalid value of variable " + std::string(program.variableName(index)) + ": Infinity");
+        }
+        return val;
+    }
+
+    void collectSlots(const Node* node, std::unordered_map<std::string_view, const double*>& slots) {
+        if (!node) {
+            return;
+        }
+        if (const auto* var = dynamic_cast<const VariableNode*>(node)) {
+            slots.emplace(var->name(), var->slot());
+        }
+        for (size_t i = 0; i < node->childCount(); ++i) {
+            collectSlots(node->child(i), slots);
+        }
+    }
+}
+
+std::vector<const double*> ProgramView::bind(const Variables& variables) const {
+    std::vector<const double*> slots(variableCount_);
+    for (size_t i = 0; i < variableCount_; ++i) {
+        slots[i] = variables.find(std::string(variableName(i)));
+    }
+    return slots;
+}
+
+std::vector<const double*> ProgramView::bind(const Node& root) const {
+    std::unordered_map<std::string_view, const double*> found;
+    collectSlots(&root, found);
+    std::vector<const double*> slots(variableCount_);
+    for (size_t i = 0; i < variableCount_; ++i) {
+        auto slot = found.find(variableName(i));
+        slots[i] = slot != found.end() ? slot->second : nullptr;
+    }
+    return slots;
+}
+
+double ProgramView::evaluate(const double* const* slots) const {
+    // Пустая программа бывает только у пустого ProgramView: validate её отвергает
+    if (codeSize_ == 0) {
+        throw EvalError("Empty program");
+    }
+    double inlineStack[INLINE_STACK];
+    std::vector<double> heapStack;
+    double* stack = inlineStack;
+    if (maxStack_ > INLINE_STACK) {
+        heapStack.resize(maxStack_);
+        stack = heapStack.data();
+    }
+
+    // top — число значений на стеке; корректность обеспечивает compile или validate
+    size_t top = 0;
+    size_t pc = 0;
+    while (pc < codeSize_) {
+        const Instruction& instruction = code_[pc++];
+        switch (instruction.op) {
+            case OpCode::Number:
+                stack[top++] = constants_[instruction.operand];
+                break;
+            case OpCode::Variable:
+                stack[top++] = loadVariable(*this, slots, instruction.operand);
+                break;
+            case OpCode::Unary:
+                stack[top - 1] = applyUnary(static_cast<UnaryOp>(instruction.sub), stack[top - 1]);
+                break;
+            case OpCode::Binary:
+                --top;
+                stack[top - 1] = applyBinary(static_cast<BinaryOp>(instruction.sub),
+                                             stack[top - 1], stack[top]);
+                break;
+            case OpCode::Call:
+                stack[top - 1] = applyFunction(static_cast<Function>(instruction.sub), stack[top - 1]);
+                break;
+            case OpCode::IntPower:
+                stack[top - 1] = applyIntPower(stack[top - 1], instruction.operand);
+                break;
+            case OpCode::JumpIfFalse:
+                if (stack[--top] == 0.0) {
+                    pc = static_cast<size_t>(instruction.operand);
+                }
+                break;
+            case OpCode::Jump:
+                pc = static_cast<size_t>(instruction.operand);
+                break;
+        }
+    }
+    return stack[0];
+}
+
+void ProgramView::validate(size_t stringsSize) const {
+    if (codeSize_ == 0) {
+        throw FormatError("Empty program");
+    }
+
+    // Открытые ветви условных выражений: ветвь [.., end) должна оставить на
+    // стеке ровно одно значение поверх depth; ветви вложены друг в друга
+    struct Branch {
+        size_t end;
+        size_t depth;
+        size_t elseEnd;     // Для ветви then — конец ветви else, иначе 0
+    };
+    std::vector<Branch> branches;
+    
+    size_t depth = 0;
+    for (size_t i = 0; i < codeSize_; ++i) {
+        bool atJump = false;
+        while (!branches.empty() && branches.back().end == i) {
+            Branch branch = branches.back();
+            branches.pop_back();
+            if (depth != branch.depth + 1) {
+                throw FormatError("Conditional branch must leave one value on the stack");
+            }
+            if (branch.elseEnd != 0) {
+                // Конец ветви then — завершающая её инструкция Jump
+                branches.push_back({branch.elseEnd, branch.depth, 0});
+                depth = branch.depth;
+                atJump = true;
+                break;
+            }
+        }
+        if (atJump) {
+            continue;
+        }
+        
+        const Instruction& instruction = code_[i];
+        size_t pops = 0;
+        size_t pushes = 1;
+        switch (instruction.op) {
+            case OpCode::Number:
+                if (instruction.operand < 0 || static_cast<size_t>(instruction.operand) >= constantCount_) {
+                    throw FormatError("Constant index out of range");
+                }
+                break;
+            case OpCode::Variable:
+                if (instruction.operand < 0 || static_cast<size_t>(instruction.operand) >= variableCount_) {
+                    throw FormatError("Variable index out of range");
+                }
+                break;
+            case OpCode::Unary:
+                if (instruction.sub > LAST_UNARY_OP) {
+                    throw FormatError("Invalid unary operator");
+                }
+                pops = 1;
+                break;
+            case OpCode::Binary:
+                if (instruction.sub > LAST_BINARY_OP) {
+                    throw FormatError("Invalid binary operator");
+                }
+                pops = 2;
+                break;
+            case OpCode::Call:
+                if (instruction.sub >= static_cast<uint8_t>(Function::Unknown)) {
+                    throw FormatError("Invalid function");
+                }
+                pops = 1;
+                break;
+            case OpCode::IntPower:
+                pops = 1;
+                break;
+            case OpCode::JumpIfFalse: {
+                // cond; JumpIfFalse L1; then; Jump L2; L1: else; L2:
+                size_t limit = branches.empty() ? codeSize_ : branches.back().end;
+                size_t elseBegin = static_cast<size_t>(std::max(instruction.operand, 0));
+                if (elseBegin < i + 3 || elseBegin >= limit ||
+                    code_[elseBegin - 1].op != OpCode::Jump) {
+                    throw FormatError("Invalid conditional jump");
+                }
+                size_t elseEnd = static_cast<size_t>(std::max(code_[elseBegin - 1].operand, 0));
+                if (elseEnd <= elseBegin || elseEnd > limit) {
+                    throw FormatError("Invalid conditional jump");
+                }
+                if (depth < 1) {
+                    throw FormatError("Stack underflow");
+                }
+                --depth;
+                branches.push_back({elseBegin - 1, depth, elseEnd});
+                continue;
+            }
+            case OpCode::Jump:
+                // Допустим только как конец ветви then (обрабатывается выше)
+                throw FormatError("Unstructured jump");
+            default:
+                throw FormatError("Invalid instruction");
+        }
+        if (depth < pops) {
+            throw FormatError("Stack underflow");
+        }
+        depth = depth - pops + pushes;
+        if (depth > maxStack_) {
+            throw FormatError("Stack depth exceeds declared maximum");
+        }
+    }
+    while (!branches.empty()) {
+        // Ветви, оканчивающиеся вместе с программой; ветвь then здесь
+        // закончиться не может, её конец — инструкция Jump
+        if (branches.back().end != codeSize_ || branches.back().elseEnd != 0 ||
+            depth != branches.back().depth + 1) {
+            throw FormatError("Conditional branch must leave one value on the stack");
+        }
+        branches.pop_back();
+    }
+    if (depth != 1) {
+        throw FormatError("Program leaves " + std::to_string(depth) + " values on the stack");
+    }
+
+    for (size_t i = 0; i < variableCount_; ++i) {
+        const NameRef& ref = variables_[i];
+        if (ref.offset > stringsSize || ref.length > stringsSize - ref.offset) {
+            throw FormatError("Variable name out of range");
+        }
+    }
+}
+
+Program Program::compile(const Node& root, const std::vector<std::string>& parameters,
+                         const Substitutions& substitutions) {
+    Program program;
+    for (const auto& name : parameters) {
+        program.variableIndex(name);
+    }
+    program.emit(root, 0, substitutions);
+    return program;
+}
+
+uint32_t Program::variableIndex(const std::string& name) {
+    for (size_t i = 0; i < variables_.size(); ++i) {
+        const NameRef& ref = variables_[i];
+        if (std::string_view(strings_.data() + ref.offset, ref.length) == name) {
+            return static_cast<uint32_t>(i);
+        }
+    }
+    NameRef ref;
+    ref.offset = static_cast<uint32_t>(strings_.size());
+    ref.length = static_cast<uint32_t>(name.size());
+    strings_.insert(strings_.end(), name.begin(), name.end());
+    variables_.push_back(ref);
+    return static_cast<uint32_t>(variables_.size() - 1);
+}
+
+void Program::emit(const Node& node, size_t depth, const Substitutions& substitutions) {
+    // depth — число значений на стеке до вычисления node
+    maxStack_ = std::max(maxStack_, depth + 1);
+
+    auto substituted = substitutions.find(&node);
+    if (substituted != substitutions.end()) {
+        code_.push_back(makeInstruction(OpCode::Number, 0, static_cast<int32_t>(constants_.size())));
+        constants_.push_back(substituted->second);
+        return;
+    }
+    if (const auto* num = dynamic_cast<const NumberNode*>(&node)) {
+        code_.push_back(makeInstruction(OpCode::Number, 0, static_cast<int32_t>(constants_.size())));
+        constants_.push_back(num->value());
+        return;
+    }
+    if (const auto* var = dynamic_cast<const VariableNode*>(&node)) {
+        code_.push_back(makeInstruction(OpCode::Variable, 0,
+                                        static_cast<int32_t>(variableIndex(var->name()))));
+        return;
+    }
+    if (const auto* unary = dynamic_cast<const UnaryOpNode*>(&node)) {
+        if (!unary->operand()) {
+            throw EvalError("Invalid operand: null pointer");
+        }
+        emit(*unary->operand(), depth, substitutions);
+        code_.push_back(makeInstruction(OpCode::Unary, static_cast<uint8_t>(unary->op()), 0));
+        return;
+    }
+    if (const auto* binary = dynamic_cast<const BinaryOpNode*>(&node)) {
+        // Левоассоциативная цепочка 1 + 2 + 3 + ... — спуск по левым
+        // потомкам; он идёт циклом, чтобы длинная строка не переполняла стек
+        std::vector<const BinaryOpNode*> spine;
+        const Node* leftmost = binary;
+        while (const auto* link = dynamic_cast<const BinaryOpNode*>(leftmost)) {
+            if (link != binary && substitutions.count(link) != 0) {
+                break;
+            }
+            if (!link->left() || !link->right()) {
+                throw EvalError("Invalid operands: null pointer");
+            }
+            spine.push_back(link);
+            leftmost = link->left();
+        }
+        emit(*leftmost, depth, substitutions);
+        for (auto link = spine.rbegin(); link != spine.rend(); ++link) {
+            emit(*(*link)->right(), depth + 1, substitutions);
+            code_.push_back(makeInstruction(OpCode::Binary, static_cast<uint8_t>((*link)->op()), 0));
+        }
+        return;
+    }
+    if (const auto* call = dynamic_cast<const FuncCallNode*>(&node)) {
+        if (!call->argument()) {
+            throw EvalError("Invalid function argument: null pointer");
+        }
+        if (call->function() == Function::Unknown) {
+            throw EvalError("Unknown function: " + call->name());
+        }
+        emit(*call->argument(), depth, substitutions);
+        code_.push_back(makeInstruction(OpCode::Call, static_cast<uint8_t>(call->function()), 0));
+        return;
+    }
+    if (const auto* power = dynamic_cast<const IntPowerNode*>(&node)) {
+        if (!power->base()) {
+            throw EvalError("Invalid operands: null pointer");
+        }
+        emit(*power->base(), depth, substitutions);
+        code_.push_back(makeInstruction(OpCode::IntPower, 0, power->exponent()));
+        return;
+    }
+    if (const auto* conditional = dynamic_cast<const ConditionalNode*>(&node)) {
+        if (!conditional->condition() || !conditional->thenBranch() || !conditional->elseBranch()) {
+            throw EvalError("Invalid operands: null pointer");
+        }
+        emit(*conditional->condition(), depth, substitutions);
+        size_t jumpIfFalse = code_.size();
+        code_.push_back(makeInstruction(OpCode::JumpIfFalse, 0, 0));
+        emit(*conditional->thenBranch(), depth, substitutions);
+        size_t jump = code_.size();
+        code_.push_back(makeInstruction(OpCode::Jump, 0, 0));
+        code_[jumpIfFalse].operand = static_cast<int32_t>(code_.size());
+        emit(*conditional->elseBranch(), depth, substitutions);
+        code_[jump].operand = static_cast<int32_t>(code_.size());
+        return;
+    }
+    if (const auto* reduction = dynamic_cast<const ReductionNode*>(&node)) {
+        // Тело перебирается во время вычисления; в постфиксной записи цикла нет
+        throw EvalError(std::string(reduction->name()) + "() cannot be compiled");
+    }
+    if (dynamic_cast<const IntegralNode*>(&node)) {
+        throw EvalError("integrate() cannot be compiled");
+    }
+    if (dynamic_cast<const SolveNode*>(&node)) {
+        throw EvalError("solve() cannot be compiled");
+    }
+    throw EvalError("Cannot compile expression node");
+}
+
+} // namespace calc
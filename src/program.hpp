@@ -0,0 +1,208 @@
+#pragma once
+
+#include "ast/node.hpp"
+#include "vecmath.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace calc {
+
+class Variables;
+
+/**
+ * @brief Код инструкции плоской программы
+ *
+ * Значения входят в двоичный формат библиотеки формул: новые коды
+ * добавляются только в конец.
+ */
+enum class OpCode : uint8_t {
+    Number,     // Константа constants[operand]
+    Variable,   // Переменная с индексом operand
+    Unary,      // sub — UnaryOp
+    Binary,     // sub — BinaryOp
+    Call,       // sub — Function
+    IntPower,   // Целая степень с показателем operand
+    JumpIfFalse, // Снять условие; если оно равно нулю, перейти к инструкции operand
+    Jump         // Перейти к инструкции operand
+};
+
+/**
+ * @brief Инструкция стековой машины (8 байт, без указателей)
+ */
+struct Instruction {
+    OpCode op;
+    uint8_t sub;
+    uint16_t reserved;
+    int32_t operand;
+};
+
+static_assert(sizeof(Instruction) == 8, "Instruction is part of the binary format");
+
+/**
+ * @brief Ссылка на строку в общем блоке строк
+ */
+struct NameRef {
+    uint32_t offset;
+    uint32_t length;
+};
+
+/**
+ * @brief Ошибка одного элемента пакетного вычисления
+ */
+struct BatchError {
+    size_t index;
+    std::string message;
+};
+
+/**
+ * @brief Невладеющее представление скомпилированного выражения
+ *
+ * Выражение в постфиксной записи: массив инструкций, таблица констант и
+ * имена переменных. Все ссылки внутри — индексы, поэтому представление
+ * одинаково работает над памятью Program и над отображённым в память
+ * файлом библиотеки формул (formula_library.hpp). Вычисление не выделяет
+ * память, если глубина стека не больше 64.
+ *
+ * Условное выражение компилируется в структурированную форму
+ *
+ *   cond; JumpIfFalse L1; then; Jump L2; L1: else; L2: ...
+ *
+ * Скалярное вычисление переходит только в выбранную ветвь, пакетное —
+ * вычисляет обе и выбирает результат маской.
+ */
+class ProgramView {
+public:
+    ProgramView() = default;
+    ProgramView(const Instruction* code, size_t codeSize,
+                const double* constants, size_t constantCount,
+                const NameRef* variables, size_t variableCount,
+                const char* strings, size_t maxStack)
+        : code_(code), codeSize_(codeSize),
+          constants_(constants), constantCount_(constantCount),
+          variables_(variables), variableCount_(variableCount),
+          strings_(strings), maxStack_(maxStack) {}
+
+    const Instruction* code() const { return code_; }
+    size_t size() const { return codeSize_; }
+    const double* constants() const { return constants_; }
+    size_t constantCount() const { return constantCount_; }
+    size_t variableCount() const { return variableCount_; }
+    size_t maxStack() const { return maxStack_; }
+
+    std::string_view variableName(size_t index) const {
+        const NameRef& ref = variables_[index];
+        return std::string_view(strings_ + ref.offset, ref.length);
+    }
+
+    /**
+     * @brief Ячейки переменных программы из таблицы (nullptr для необъявленных)
+     */
+    std::vector<const double*> bind(const Variables& variables) const;
+
+    /**
+     * @brief Ячейки переменных программы, на которые ссылаются узлы дерева
+     *
+     * Для программ, скомпилированных из части дерева: переменные циклов
+     * sum/prod не объявлены в Variables, но известны узлам VariableNode.
+     */
+    std::vector<const double*> bind(const Node& root) const;
+
+    /**
+     * @brief Вычисление с проверками, как Node::evaluate
+     *
+     * slots[i] — ячейка переменной с индексом i. Ошибки и их тексты
+     * совпадают с вычислением исходного дерева.
+     */
+    double evaluate(const double* const* slots = nullptr) const;
+
+    /**
+     * @brief Пакетное вычисление над столбцами значений переменных
+     *
+     * columns[i] — count значений переменной с индексом i (nullptr — не
+     * связана), results — count результатов. Каждая инструкция выполняется
+     * над блоком элементов без ветвлений по данным; у условного выражения
+     * вычисляются обе ветви, а результат выбирается маской, поэтому время
+     * не зависит от того, как перемешаны условия (если весь блок выбирает
+     * одну ветвь, другая пропускается).
+     *
+     * Элементы, для которых evaluate выбросил бы ошибку, получают NaN, а
+     * сообщение evaluate для них дописывается в errors (если задан).
+     * Функции вычисляются vecmath с точностью accuracy; при Libm
+     * результаты побитово совпадают с evaluate. Возвращает число ошибок.
+     */
+    size_t evaluateBatch(const double* const* columns, size_t count, double* results,
+                         std::vector<BatchError>* errors = nullptr,
+                         vecmath::Accuracy accuracy = vecmath::Accuracy::Libm) const;
+
+    /**
+     * @brief Проверка структуры программы из недоверенного источника
+     *
+     * Коды и индексы в допустимых границах, переходы образуют вложенные
+     * условные выражения, каждая ветвь оставляет на стеке одно значение,
+     * стек не опустошается и не превышает maxStack, в конце на стеке ровно
+     * одно значение; имена переменных лежат внутри блока строк размера
+     * stringsSize.
+     * Ошибки — FormatError.
+     */
+    void validate(size_t stringsSize) const;
+
+private:
+    const Instruction* code_ = nullptr;
+    size_t codeSize_ = 0;
+    const double* constants_ = nullptr;
+    size_t constantCount_ = 0;
+    const NameRef* variables_ = nullptr;
+    size_t variableCount_ = 0;
+    const char* strings_ = nullptr;
+    size_t maxStack_ = 0;
+};
+
+/**
+ * @brief Скомпилированное выражение, владеющее своими данными
+ */
+class Program {
+public:
+    /**
+     * @brief Заранее вычисленные значения поддеревьев (по адресу узла)
+     */
+    using Substitutions = std::unordered_map<const Node*, double>;
+
+    /**
+     * @brief Компиляция дерева в постфиксную запись
+     *
+     * Переменные нумеруются в порядке parameters, затем в порядке
+     * появления в дереве. Вызов неизвестной функции — EvalError
+     * "Unknown function: name" (дерево сообщило бы то же при вычислении),
+     * sum(), prod(), integrate() и solve() — EvalError "sum() cannot be compiled".
+     * Поддерево из substitutions компилируется в константу (см. sweep.hpp).
+     */
+    static Program compile(const Node& root, const std::vector<std::string>& parameters = {},
+                           const Substitutions& substitutions = {});
+
+    ProgramView view() const {
+        return ProgramView(code_.data(), code_.size(), constants_.data(), constants_.size(),
+                           variables_.data(), variables_.size(), strings_.data(), maxStack_);
+    }
+
+    const std::vector<Instruction>& code() const { return code_; }
+    const std::vector<double>& constants() const { return constants_; }
+    const std::vector<NameRef>& variables() const { return variables_; }
+    const std::vector<char>& strings() const { return strings_; }
+    size_t maxStack() const { return maxStack_; }
+
+private:
+    void emit(const Node& node, size_t depth, const Substitutions& substitutions);
+    uint32_t variableIndex(const std::string& name);
+
+    std::vector<Instruction> code_;
+    std::vector<double> constants_;
+    std::vector<NameRef> variables_;
+    std::vector<char> strings_;
+    size_t maxStack_ = 0;
+};
+
+} // namespace calc
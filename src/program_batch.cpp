@@ -0,0 +1,375 @@
+#include "program.hpp"
+#include "ast/binary_op.hpp"
+#include "ast/unary_op.hpp"
+#include "ast/func_call.hpp"
+#include "ast/int_power.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+
+namespace calc {
+
+namespace {
+    // Число элементов, над которыми выполняется одна инструкция: стек
+    // блоков при типичной глубине помещается в L1
+    constexpr size_t BLOCK = 256;
+
+    constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+    constexpr double MAX_INT64 = static_cast<double>(INT64_MAX);
+    constexpr double MIN_INT64 = static_cast<double>(INT64_MIN);
+
+    // Каждое значение на стеке конечно или равно NaN («отравлено»): NaN
+    // отмечает элемент, на котором проверенное вычисление выбросило бы
+    // ошибку. Отравление распространяется по арифметике само, а операции,
+    // способные «потерять» NaN (pow(NaN, 0), сравнения, x^0), проверяют его явно.
+    inline double poison(double v) {
+        return std::abs(v) <= std::numeric_limits<double>::max() ? v : NaN;
+    }
+
+    inline bool inInt64Range(double v) {
+        // Отрицательная форма ловит и NaN
+        return v <= MAX_INT64 && v >= MIN_INT64;
+    }
+
+    template <typename F>
+    void mapUnary(double* x, size_t n, F f) {
+        for (size_t k = 0; k < n; ++k) {
+            x[k] = f(x[k]);
+        }
+    }
+
+    template <typename F>
+    void mapBinary(double* a, const double* b, size_t n, F f) {
+        for (size_t k = 0; k < n; ++k) {
+            a[k] = f(a[k], b[k]);
+        }
+    }
+
+    void unaryBlock(UnaryOp op, double* x, size_t n) {
+        switch (op) {
+            case UnaryOp::Plus:
+                return;
+            case UnaryOp::Minus:
+                mapUnary(x, n, [](double v) { return -v; });
+                return;
+            case UnaryOp::BitwiseNot:
+                mapUnary(x, n, [](double v) {
+                    if (!inInt64Range(v)) {
+                        return NaN;
+                    }
+                    return static_cast<double>(~static_cast<int64_t>(v));
+                });
+                return;
+        }
+    }
+
+    double bitwise(BinaryOp op, double l, double r) {
+        if (!inInt64Range(l) || !inInt64Range(r)) {
+            return NaN;
+        }
+        int64_t left = static_cast<int64_t>(l);
+        int64_t right = static_cast<int64_t>(r);
+        switch (op) {
+            case BinaryOp::BitwiseAnd: return static_cast<double>(left & right);
+            case BinaryOp::BitwiseOr: return static_cast<double>(left | right);
+            case BinaryOp::BitwiseXor: return static_cast<double>(left ^ right);
+            default: break;
+        }
+        if (right < 0 || right >= 64) {
+            return NaN;
+        }
+        return static_cast<double>(op == BinaryOp::LeftShift ? left << right : left >> right);
+    }
+
+    void binaryBlock(BinaryOp op, double* a, const double* b, size_t n) {
+        switch (op) {
+            case BinaryOp::Add:
+                mapBinary(a, b, n, [](double l, double r) { return poison(l + r); });
+                return;
+            case BinaryOp::Subtract:
+                mapBinary(a, b, n, [](double l, double r) { return poison(l - r); });
+                return;
+            case BinaryOp::Multiply:
+                mapBinary(a, b, n, [](double l, double r) { return poison(l * r); });
+                return;
+            case BinaryOp::Divide:
+                mapBinary(a, b, n, [](double l, double r) {
+                    double q = poison(l / r);
+                    return std::abs(r) < 1e-15 ? NaN : q;
+                });
+                return;
+            case BinaryOp::Modulo:
+                mapBinary(a, b, n, [](double l, double r) {
+                    return std::abs(r) < 1e-15 ? NaN : std::fmod(l, r);
+                });
+                return;
+            case BinaryOp::Power:
+                mapBinary(a, b, n, [](double l, double r) {
+                    if (l != l || r != r || (l == 0.0 && r < 0.0)) {
+                        return NaN;
+                    }
+                    return poison(std::pow(l, r));
+                });
+                return;
+            case BinaryOp::BitwiseAnd:
+            case BinaryOp::BitwiseOr:
+            case BinaryOp::BitwiseXor:
+            case BinaryOp::LeftShift:
+            case BinaryOp::RightShift:
+                mapBinary(a, b, n, [op](double l, double r) { return bitwise(op, l, r); });
+                return;
+            // Сравнения: маска 1/0, NaN сохраняется
+            case BinaryOp::Less:
+                mapBinary(a, b, n, [](double l, double r) {
+                    double mask = l < r ? 1.0 : 0.0;
+                    return l != l || r != r ? NaN : mask;
+                });
+                return;
+            case BinaryOp::LessEqual:
+                mapBinary(a, b, n, [](double l, double r) {
+                    double mask = l <= r ? 1.0 : 0.0;
+                    return l != l || r != r ? NaN : mask;
+                });
+                return;
+            case BinaryOp::Greater:
+                mapBinary(a, b, n, [](double l, double r) {
+                    double mask = l > r ? 1.0 : 0.0;
+                    return l != l || r != r ? NaN : mask;
+                });
+                return;
+            case BinaryOp::GreaterEqual:
+                mapBinary(a, b, n, [](double l, double r) {
+                    double mask = l >= r ? 1.0 : 0.0;
+                    return l != l || r != r ? NaN : mask;
+                });
+                return;
+            case BinaryOp::Equal:
+                mapBinary(a, b, n, [](double l, double r) {
+                    double mask = l == r ? 1.0 : 0.0;
+                    return l != l || r != r ? NaN : mask;
+                });
+                return;
+            case BinaryOp::NotEqual:
+                mapBinary(a, b, n, [](double l, double r) {
+                    double mask = l != r ? 1.0 : 0.0;
+                    return l != l || r != r ? NaN : mask;
+                });
+                return;
+        }
+    }
+
+    // y = f(x) с отравлением значений, которые applyFunction отвергает
+    void functionBlock(Function function, const double* x, double* y, size_t n,
+                       vecmath::Accuracy accuracy) {
+        vecmath::evaluate(function, x, y, n, accuracy);
+        if (function == Function::Exp) {
+            // Проверенный режим отвергает x > 709 раньше фактического переполнения
+            for (size_t k = 0; k < n; ++k) {
+                y[k] = x[k] > 709.0 ? NaN : poison(y[k]);
+            }
+            return;
+        }
+        mapUnary(y, n, poison);
+    }
+
+    // cond = cond ? then : else без ветвлений; NaN в условии сохраняется
+    void selectBlock(double* cond, const double* thenValues, const double* elseValues, size_t n) {
+        for (size_t k = 0; k < n; ++k) {
+            double c = cond[k];
+            double picked = c != 0.0 ? thenValues[k] : elseValues[k];
+            cond[k] = c == c ? picked : NaN;
+        }
+    }
+
+    // Какие ветви условного выражения нужны блоку
+    enum class Branches {
+        Both,       // Условия перемешаны: вычислить обе и выбрать маской
+        ThenOnly,   // Все условия истинны
+        ElseOnly    // Все условия ложны
+    };
+
+    struct PendingSelect {
+        size_t end;         // Индекс инструкции после ветви else
+        Branches branches;
+    };
+
+    Branches branchesFor(const double* cond, size_t n) {
+        size_t trueCount = 0;
+        size_t falseCount = 0;
+        for (size_t k = 0; k < n; ++k) {
+            double c = cond[k];
+            trueCount += (c != 0.0 && c == c) ? 1 : 0;
+            falseCount += c == 0.0 ? 1 : 0;
+        }
+        if (trueCount == n) {
+            return Branches::ThenOnly;
+        }
+        return falseCount == n ? Branches::ElseOnly : Branches::Both;
+    }
+
+    // Глубина стека блоков, когда вычисляются обе ветви: условие остаётся
+    // на стеке до выбора, а значение ветви then — на время ветви else
+    size_t batchStackDepth(const ProgramView& program) {
+        std::vector<size_t> ends;
+        size_t depth = 0;
+        size_t maxDepth = 0;
+        for (size_t i = 0; i <= program.size(); ++i) {
+            while (!ends.empty() && ends.back() == i) {
+                ends.pop_back();
+                depth -= 2;
+            }
+            if (i == program.size()) {
+                break;
+            }
+            const Instruction& instruction = program.code()[i];
+            switch (instruction.op) {
+                case OpCode::Number:
+                case OpCode::Variable:
+                    ++depth;
+                    break;
+                case OpCode::Binary:
+                    --depth;
+                    break;
+                case OpCode::JumpIfFalse:
+                    ends.push_back(static_cast<size_t>(program.code()[instruction.operand - 1].operand));
+                    break;
+                default:
+                    break;
+            }
+            maxDepth = std::max(maxDepth, depth);
+        }
+        return maxDepth;
+    }
+}
+
+size_t ProgramView::evaluateBatch(const double* const* columns, size_t count, double* results,
+                                  std::vector<BatchError>* errors,
+                                  vecmath::Accuracy accuracy) const {
+    // Корректность кода обеспечивает compile или validate
+    size_t depth = batchStackDepth(*this);
+    std::vector<double> storage((depth + 1) * BLOCK);
+    std::vector<double*> stack(depth);
+    for (size_t k = 0; k < depth; ++k) {
+        stack[k] = storage.data() + k * BLOCK;
+    }
+    double* scratch = storage.data() + depth * BLOCK;
+
+    std::vector<PendingSelect> pending;
+    std::vector<const double*> slots(variableCount_);
+    size_t failures = 0;
+
+    for (size_t offset = 0; offset < count; offset += BLOCK) {
+        size_t n = std::min(BLOCK, count - offset);
+        size_t top = 0;
+        size_t pc = 0;
+        pending.clear();
+
+        while (true) {
+            while (!pending.empty() && pending.back().end == pc) {
+                if (pending.back().branches == Branches::Both) {
+                    selectBlock(stack[top - 3], stack[top - 2], stack[top - 1], n);
+                    top -= 2;
+                } else {
+                    // На стеке условие и значение единственной вычисленной ветви
+                    std::swap(stack[top - 2], stack[top - 1]);
+                    top -= 1;
+                }
+                pending.pop_back();
+            }
+            if (pc == codeSize_) {
+                break;
+            }
+
+            const Instruction& instruction = code_[pc++];
+            switch (instruction.op) {
+                case OpCode::Number:
+                    std::fill(stack[top], stack[top] + n, constants_[instruction.operand]);
+                    ++top;
+                    break;
+                case OpCode::Variable: {
+                    const double* column = columns ? columns[instruction.operand] : nullptr;
+                    double* out = stack[top++];
+                    if (!column) {
+                        // Ошибку сообщит evaluate, если переменная нужна выбранной ветви
+                        std::fill(out, out + n, NaN);
+                        break;
+                    }
+                    for (size_t k = 0; k < n; ++k) {
+                        out[k] = poison(column[offset + k]);
+                    }
+                    break;
+                }
+                case OpCode::Unary:
+                    unaryBlock(static_cast<UnaryOp>(instruction.sub), stack[top - 1], n);
+                    break;
+                case OpCode::Binary:
+                    --top;
+                    binaryBlock(static_cast<BinaryOp>(instruction.sub), stack[top - 1], stack[top], n);
+                    break;
+                case OpCode::Call:
+                    functionBlock(static_cast<Function>(instruction.sub), stack[top - 1], scratch, n,
+                                  accuracy);
+                    std::swap(stack[top - 1], scratch);
+                    break;
+                case OpCode::IntPower: {
+                    int exponent = instruction.operand;
+                    mapUnary(stack[top - 1], n, [exponent](double v) {
+                        // x^0 == 1 и для NaN, поэтому отравление проверяется явно
+                        return v != v ? NaN : poison(applyIntPowerUnchecked(v, exponent));
+                    });
+                    break;
+                }
+                case OpCode::JumpIfFalse: {
+                    // Условие остаётся на стеке до выбора в конце ветви else
+                    size_t elseBegin = static_cast<size_t>(instruction.operand);
+                    size_t end = static_cast<size_t>(code_[elseBegin - 1].operand);
+                    Branches branches = branchesFor(stack[top - 1], n);
+                    pending.push_back({end, branches});
+                    if (branches == Branches::ElseOnly) {
+                        pc = elseBegin;
+                    }
+                    break;
+                }
+                case OpCode::Jump:
+                    // Конец ветви then ближайшего условного выражения
+                    if (pending.back().branches == Branches::ThenOnly) {
+                        pc = static_cast<size_t>(instruction.operand);
+                    }
+                    break;
+            }
+        }
+
+        const double* values = stack[0];
+        for (size_t k = 0; k < n; ++k) {
+            results[offset + k] = values[k];
+        }
+
+        // Отравленные элементы перевычисляются с проверками ради точного
+        // сообщения об ошибке
+        for (size_t k = 0; k < n; ++k) {
+            if (values[k] == values[k]) {
+                continue;
+            }
+            size_t index = offset + k;
+            for (size_t v = 0; v < variableCount_; ++v) {
+                const double* column = columns ? columns[v] : nullptr;
+                slots[v] = column ? column + index : nullptr;
+            }
+            try {
+                results[index] = evaluate(slots.data());
+            } catch (const EvalError& e) {
+                results[index] = NaN;
+                ++failures;
+                if (errors) {
+                    errors->push_back({index, e.what()});
+                }
+            }
+        }
+    }
+    return failures;
+}
+
+} // namespace calc
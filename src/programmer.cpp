@@ -0,0 +1,347 @@
+#include "programmer.hpp"
+#include "error.hpp"
+#include "radix.hpp"
+#include <cctype>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace calc {
+
+namespace {
+    constexpr size_t MAX_INPUT_LENGTH = 10000;
+    constexpr size_t MAX_NESTING_DEPTH = 256;
+
+    enum class Kind {
+        Number,
+        Or,
+        Xor,
+        And,
+        Not,
+        LeftShift,
+        RightShift,
+        RotateLeft,
+        RotateRight,
+        Plus,
+        Minus,
+        Multiply,
+        Divide,
+        Modulo,
+        Power,
+        LParen,
+        RParen,
+        End
+    };
+
+    struct Token {
+        Kind kind;
+        std::string_view text;      // Цифры числа
+    };
+
+    bool isWordChar(char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) != 0;
+    }
+
+    // Слова операций; в них есть буквы вне A–F, поэтому с шестнадцатеричными
+    // числами они не путаются
+    Kind wordKind(std::string_view word) {
+        if (word == "AND") return Kind::And;
+        if (word == "OR") return Kind::Or;
+        if (word == "XOR") return Kind::Xor;
+        if (word == "NOT") return Kind::Not;
+        if (word == "ROL") return Kind::RotateLeft;
+        if (word == "ROR") return Kind::RotateRight;
+        return Kind::Number;
+    }
+
+    std::vector<Token> tokenize(std::string_view input) {
+        if (input.size() > MAX_INPUT_LENGTH) {
+            throw ParseError("Input string too long (max 10000 characters)");
+        }
+        std::vector<Token> tokens;
+        size_t pos = 0;
+        while (true) {
+            while (pos < input.size() && std::isspace(static_cast<unsigned char>(input[pos]))) {
+                ++pos;
+            }
+            if (pos == input.size()) {
+                tokens.push_back({Kind::End, {}});
+                return tokens;
+            }
+            char c = input[pos];
+            if (isWordChar(c)) {
+                size_t start = pos;
+                while (pos < input.size() && isWordChar(input[pos])) {
+                    ++pos;
+                }
+                std::string_view word = input.substr(start, pos - start);
+                tokens.push_back({wordKind(word), word});
+                continue;
+            }
+            char next = pos + 1 < input.size() ? input[pos + 1] : '\0';
+            Kind kind;
+            size_t length = 1;
+            switch (c) {
+                case '|': kind = Kind::Or; break;
+                case '&': kind = Kind::And; break;
+                case '~': kind = Kind::Not; break;
+                case '+': kind = Kind::Plus; break;
+                case '-': kind = Kind::Minus; break;
+                case '/': kind = Kind::Divide; break;
+                case '%': kind = Kind::Modulo; break;
+                case '^': kind = Kind::Power; break;
+                case '(': kind = Kind::LParen; break;
+                case ')': kind = Kind::RParen; break;
+                case '*':
+                    kind = next == '*' ? Kind::Power : Kind::Multiply;
+                    length = next == '*' ? 2 : 1;
+                    break;
+                case '<':
+                case '>':
+                    if (next != c) {
+                        throw ParseError(std::string("Unexpected character: ") + c);
+                    }
+                    kind = c == '<' ? Kind::LeftShift : Kind::RightShift;
+                    length = 2;
+                    break;
+                default:
+                    throw ParseError(std::string("Unexpected character: ") + c);
+            }
+            tokens.push_back({kind, input.substr(pos, length)});
+            pos += length;
+        }
+    }
+
+    // Неотрицательный счётчик сдвига; больше 64 бит — насыщение
+    uint64_t shiftCount(const WideInt& count) {
+        if (count.isNegative()) {
+            throw EvalError("Negative shift count");
+        }
+        for (size_t i = 1; i < count.limbCount(); ++i) {
+            if (count.limb(i) != 0) {
+                return UINT64_MAX;
+            }
+        }
+        return count.limb(0);
+    }
+
+    WideInt power(WideInt base, const WideInt& exponent) {
+        if (exponent.isNegative()) {
+            throw EvalError("Negative exponent");
+        }
+        WideInt result = WideInt::fromInt64(1, base.bits());
+        size_t top = exponent.limbCount();
+        while (top > 0 && exponent.limb(top - 1) == 0) {
+            --top;
+        }
+        for (size_t i = 0; i < top; ++i) {
+            uint64_t limb = exponent.limb(i);
+            for (int bit = 0; bit < 64; ++bit) {
+                if (i + 1 == top && (limb >> bit) == 0) {
+                    return result;
+                }
+                // Впереди ещё единичный бит показателя, а степень основания
+                // обнулилась (чётное основание в узком слове)
+                if (base.isZero()) {
+                    return base;
+                }
+                if ((limb >> bit) & 1) {
+                    result *= base;
+                }
+                base *= base;
+            }
+        }
+        return result;
+    }
+
+    // Уровень вложенности на время разбора вложенной конструкции
+    class NestingGuard {
+    public:
+        explicit NestingGuard(size_t& depth) : depth_(depth) {
+            if (depth_ >= MAX_NESTING_DEPTH) {
+                throw ParseError("Expression nested too deeply (max 256 levels)");
+            }
+            ++depth_;
+        }
+        ~NestingGuard() { --depth_; }
+
+        NestingGuard(const NestingGuard&) = delete;
+        NestingGuard& operator=(const NestingGuard&) = delete;
+
+    private:
+        size_t& depth_;
+    };
+
+    class IntegerParser {
+    public:
+        IntegerParser(std::string_view input, int radix, unsigned bits)
+            : tokens_(tokenize(input)), radix_(radix), bits_(bits) {}
+
+        WideInt parse() {
+            WideInt value = parseOr();
+            if (current() != Kind::End) {
+                throw ParseError("Unexpected token after expression");
+            }
+            return value;
+        }
+
+    private:
+        Kind current() const { return tokens_[pos_].kind; }
+
+        WideInt parseOr() {
+            WideInt left = parseXor();
+            while (current() == Kind::Or) {
+                ++pos_;
+                left |= parseXor();
+            }
+            return left;
+        }
+
+        WideInt parseXor() {
+            WideInt left = parseAnd();
+            while (current() == Kind::Xor) {
+                ++pos_;
+                left ^= parseAnd();
+            }
+            return left;
+        }
+
+        WideInt parseAnd() {
+            WideInt left = parseShift();
+            while (current() == Kind::And) {
+                ++pos_;
+                left &= parseShift();
+            }
+            return left;
+        }
+
+        // Сдвиги и циклические сдвиги
+        WideInt parseShift() {
+            WideInt left = parseTerm();
+            while (true) {
+                Kind op = current();
+                if (op != Kind::LeftShift && op != Kind::RightShift &&
+                    op != Kind::RotateLeft && op != Kind::RotateRight) {
+                    return left;
+                }
+                ++pos_;
+                uint64_t count = shiftCount(parseTerm());
+                switch (op) {
+                    case Kind::LeftShift: left = left.shiftLeft(count); break;
+                    case Kind::RightShift: left = left.shiftRightArithmetic(count); break;
+                    case Kind::RotateLeft: left = left.rotateLeft(count); break;
+                    default: left = left.rotateRight(count); break;
+                }
+            }
+        }
+
+        // Сложение и вычитание
+        WideInt parseTerm() {
+            WideInt left = parseFactor();
+            while (current() == Kind::Plus || current() == Kind::Minus) {
+                Kind op = current();
+                ++pos_;
+                WideInt right = parseFactor();
+                if (op == Kind::Plus) {
+                    left += right;
+                } else {
+                    left -= right;
+                }
+            }
+            return left;
+        }
+
+        // Умножение, деление, остаток
+        WideInt parseFactor() {
+            WideInt left = parsePower();
+            while (current() == Kind::Multiply || current() == Kind::Divide || current() == Kind::Modulo) {
+                Kind op = current();
+                ++pos_;
+                WideInt right = parsePower();
+                if (op == Kind::Multiply) {
+                    left *= right;
+                    continue;
+                }
+                if (right.isZero()) {
+                    throw EvalError(op == Kind::Divide ? "Division by zero" : "Modulo by zero");
+                }
+                WideInt quotient(bits_);
+                WideInt remainder(bits_);
+                WideInt::divide(left, right, quotient, remainder);
+                left = op == Kind::Divide ? std::move(quotient) : std::move(remainder);
+            }
+            return left;
+        }
+
+        WideInt parsePower() {
+            WideInt left = parseUnary();
+            if (current() == Kind::Power) {
+                ++pos_;
+                NestingGuard guard(depth_);
+                WideInt right = parsePower(); // Правоассоциативна
+                left = power(std::move(left), right);
+            }
+            return left;
+        }
+
+        WideInt parseUnary() {
+            bool negative = false;
+            while (current() == Kind::Plus || current() == Kind::Minus) {
+                negative ^= current() == Kind::Minus;
+                ++pos_;
+            }
+            WideInt operand(bits_);
+            if (current() == Kind::Not) {
+                ++pos_;
+                NestingGuard guard(depth_);
+                operand = ~parseUnary();
+            } else {
+                operand = parsePrimary();
+            }
+            return negative ? -operand : operand;
+        }
+
+        WideInt parsePrimary() {
+            const Token& token = tokens_[pos_];
+            if (token.kind == Kind::Number) {
+                ++pos_;
+                try {
+                    return WideInt::parse(token.text, radix_, bits_);
+                } catch (const std::invalid_argument& e) {
+                    throw ParseError(std::string(e.what()) + ": " + std::string(token.text));
+                }
+            }
+            if (token.kind == Kind::LParen) {
+                ++pos_;
+                NestingGuard guard(depth_);
+                WideInt value = parseOr();
+                if (current() != Kind::RParen) {
+                    throw ParseError("Expected ')'");
+                }
+                ++pos_;
+                return value;
+            }
+            if (token.kind == Kind::End) {
+                throw ParseError("Unexpected end of input");
+            }
+            throw ParseError("Unexpected token");
+        }
+
+        std::vector<Token> tokens_;
+        size_t pos_ = 0;
+        size_t depth_ = 0;
+        int radix_;
+        unsigned bits_;
+    };
+}
+
+WideInt evaluateInteger(std::string_view expression, int radix, unsigned bits) {
+    if (radix < MIN_RADIX || radix > MAX_RADIX) {
+        throw std::invalid_argument("Base must be from 2 to 36");
+    }
+    // Разрядность проверяется до разбора: неверная — ошибка аргумента, а не выражения
+    static_cast<void>(WideInt(bits));
+    return IntegerParser(expression, radix, bits).parse();
+}
+
+} // namespace calc
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "wide_int.hpp"
+#include <string_view>
+
+namespace calc {
+
+/**
+ * @brief Вычислить целочисленное выражение программистского режима
+ *
+ * Числа записываются в системе radix без префиксов, все значения и операции —
+ * в разрядности bits с заворачиванием (см. WideInt). Операции по возрастанию
+ * приоритета: OR (|), XOR, AND (&), сдвиги << и >> (арифметический) и
+ * циклические ROL/ROR, + и -, * / %, степень ^ (или **), унарные + - NOT (~).
+ * Сдвиги на разрядность и больше дают 0 (или −1), циклические берутся по
+ * модулю разрядности. Ошибки: ParseError — синтаксис и цифры, EvalError —
+ * деление на ноль, отрицательный сдвиг или показатель.
+ */
+WideInt evaluateInteger(std::string_view expression, int radix, unsigned bits);
+
+} // namespace calc
@@ -0,0 +1,418 @@
+#include "radix.hpp"
+#include "batch.hpp"
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace calc {
+
+namespace {
+    // Таблицы цифр: запись байта (или пары десятичных цифр) одним memcpy
+    struct DigitTables {
+        char decimal[100][2];
+        char hex[256][2];
+        char octal[64][2];
+        char binary[256][8];
+        uint8_t value[256];     // Значение цифры символа или 0xFF
+
+        constexpr DigitTables() : decimal(), hex(), octal(), binary(), value() {
+            const char digits[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+            for (int i = 0; i < 100; ++i) {
+                decimal[i][0] = digits[i / 10];
+                decimal[i][1] = digits[i % 10];
+            }
+            for (int i = 0; i < 256; ++i) {
+                hex[i][0] = digits[i >> 4];
+                hex[i][1] = digits[i & 15];
+                for (int bit = 0; bit < 8; ++bit) {
+                    binary[i][bit] = static_cast<char>('0' + ((i >> (7 - bit)) & 1));
+                }
+                value[i] = 0xFF;
+            }
+            for (int i = 0; i < 64; ++i) {
+                octal[i][0] = digits[i >> 3];
+                octal[i][1] = digits[i & 7];
+            }
+            for (int i = 0; i < 36; ++i) {
+                value[static_cast<unsigned char>(digits[i])] = static_cast<uint8_t>(i);
+                if (i >= 10) {
+                    value[static_cast<unsigned char>(digits[i] - 'A' + 'a')] = static_cast<uint8_t>(i);
+                }
+            }
+        }
+    };
+
+    constexpr DigitTables TABLES;
+
+    enum class ParseStatus { Ok, Empty, BadDigit, Overflow };
+
+    int decimalDigits(uint64_t value) {
+        int digits = 1;
+        while (value >= 10000) {
+            value /= 10000;
+            digits += 4;
+        }
+        if (value >= 1000) return digits + 3;
+        if (value >= 100) return digits + 2;
+        if (value >= 10) return digits + 1;
+        return digits;
+    }
+
+    char* copyDigits(char* first, char* last, const char* digits, size_t count) {
+        if (static_cast<size_t>(last - first) < count) {
+            return nullptr;
+        }
+        std::memcpy(first, digits, count);
+        return first + count;
+    }
+
+    // Цифры пишутся с конца временного буфера по байту, затем копируются
+    // без ведущих нулей
+    char* formatPowerOfTwo(char* first, char* last, uint64_t value, int shift) {
+        char buffer[64];
+        char* end = buffer + sizeof(buffer);
+        char* p = end;
+        switch (shift) {
+            case 1:
+                while (value) {
+                    p -= 8;
+                    std::memcpy(p, TABLES.binary[value & 0xFF], 8);
+                    value >>= 8;
+                }
+                break;
+            case 3:
+                while (value) {
+                    p -= 2;
+                    std::memcpy(p, TABLES.octal[value & 63], 2);
+                    value >>= 6;
+                }
+                break;
+            case 4:
+                while (value) {
+                    p -= 2;
+                    std::memcpy(p, TABLES.hex[value & 0xFF], 2);
+                    value >>= 8;
+                }
+                break;
+            default: {
+                uint64_t mask = (uint64_t(1) << shift) - 1;
+                while (value) {
+                    *--p = "0123456789ABCDEFGHIJKLMNOPQRSTUV"[value & mask];
+                    value >>= shift;
+                }
+                break;
+            }
+        }
+        while (p < end && *p == '0') {
+            ++p;
+        }
+        return copyDigits(first, last, p, static_cast<size_t>(end - p));
+    }
+
+    char* formatDecimal(char* first, char* last, uint64_t value) {
+        int digits = decimalDigits(value);
+        if (last - first < digits) {
+            return nullptr;
+        }
+        char* p = first + digits;
+        while (value >= 100) {
+            p -= 2;
+            std::memcpy(p, TABLES.decimal[value % 100], 2);
+            value /= 100;
+        }
+        if (value >= 10) {
+            std::memcpy(p - 2, TABLES.decimal[value], 2);
+        } else {
+            p[-1] = static_cast<char>('0' + value);
+        }
+        return first + digits;
+    }
+
+    bool littleEndian() {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        return false;
+#else
+        return true;
+#endif
+    }
+
+    constexpr uint64_t ONES = 0x0101010101010101ULL;
+    constexpr uint64_t HIGH = 0x8080808080808080ULL;
+
+    // Старший бит байта — байт строго между low и high (все байты < 0x80)
+    uint64_t bytesBetween(uint64_t x, unsigned low, unsigned high) {
+        return ((ONES * (127 + high) - x) & ~x & (x + ONES * (127 - low))) & HIGH;
+    }
+
+    // Восемь символов '0'/'1' — байт; первый символ — старший бит
+    bool binaryChunk(const char* text, uint64_t& bits) {
+        uint64_t x;
+        std::memcpy(&x, text, 8);
+        if ((x & ~ONES) != ONES * '0') {
+            return false;
+        }
+        // Бит i-го байта переносится в разряд 7 - i старшего байта произведения
+        bits = ((x & ONES) * 0x8040201008040201ULL) >> 56;
+        return true;
+    }
+
+    // Восемь шестнадцатеричных цифр — 32 бита
+    bool hexChunk(const char* text, uint64_t& bits) {
+        uint64_t x;
+        std::memcpy(&x, text, 8);
+        if (x & HIGH) {
+            return false;
+        }
+        uint64_t lower = x | (ONES * 0x20);
+        uint64_t digits = bytesBetween(x, '0' - 1, '9' + 1);
+        uint64_t letters = bytesBetween(lower, 'a' - 1, 'f' + 1);
+        if ((digits | letters) != HIGH) {
+            return false;
+        }
+        // Значения цифр в байтах: младшие 4 бита, у букв ещё + 9
+        uint64_t nibbles = (x & (ONES * 0x0F)) + (letters >> 7) * 9;
+        // Сборка попарно: первый символ лежит в младшем байте и старше по значению
+        nibbles = ((nibbles & 0x000F000F000F000FULL) << 4) | ((nibbles >> 8) & 0x000F000F000F000FULL);
+        nibbles = ((nibbles & 0x000000FF000000FFULL) << 8) | ((nibbles >> 16) & 0x000000FF000000FFULL);
+        bits = ((nibbles & 0xFFFFULL) << 16) | (nibbles >> 32);
+        return true;
+    }
+
+    ParseStatus parseDigits(std::string_view digits, int radix, uint64_t& result) {
+        if (digits.empty()) {
+            return ParseStatus::Empty;
+        }
+        // Ведущие нули не влияют на переполнение
+        size_t zeros = digits.find_first_not_of('0');
+        if (zeros == std::string_view::npos) {
+            result = 0;
+            return ParseStatus::Ok;
+        }
+        digits.remove_prefix(zeros);
+
+        uint64_t value = 0;
+        const char* p = digits.data();
+        const char* end = p + digits.size();
+        if (radix == 2 || radix == 16) {
+            size_t limit = radix == 2 ? 64 : 16;
+            if (digits.size() > limit) {
+                for (; p < end; ++p) {
+                    if (TABLES.value[static_cast<unsigned char>(*p)] >= radix) {
+                        return ParseStatus::BadDigit;
+                    }
+                }
+                return ParseStatus::Overflow;
+            }
+            if (littleEndian()) {
+                int shift = radix == 2 ? 8 : 32;
+                uint64_t bits;
+                while (end - p >= 8) {
+                    if (!(radix == 2 ? binaryChunk(p, bits) : hexChunk(p, bits))) {
+                        return ParseStatus::BadDigit;
+                    }
+                    value = (value << shift) | bits;
+                    p += 8;
+                }
+            }
+            int bitsPerDigit = radix == 2 ? 1 : 4;
+            for (; p < end; ++p) {
+                uint8_t digit = TABLES.value[static_cast<unsigned char>(*p)];
+                if (digit >= radix) {
+                    return ParseStatus::BadDigit;
+                }
+                value = (value << bitsPerDigit) | digit;
+            }
+            result = value;
+            return ParseStatus::Ok;
+        }
+
+        uint64_t max = std::numeric_limits<uint64_t>::max();
+        uint64_t limit = max / static_cast<uint64_t>(radix);
+        uint64_t lastDigit = max % static_cast<uint64_t>(radix);
+        bool overflow = false;
+        for (; p < end; ++p) {
+            uint8_t digit = TABLES.value[static_cast<unsigned char>(*p)];
+            if (digit >= radix) {
+                return ParseStatus::BadDigit;
+            }
+            if (value > limit || (value == limit && digit > lastDigit)) {
+                overflow = true;
+            }
+            value = value * static_cast<uint64_t>(radix) + digit;
+        }
+        if (overflow) {
+            return ParseStatus::Overflow;
+        }
+        result = value;
+        return ParseStatus::Ok;
+    }
+
+    const char* statusMessage(ParseStatus status) {
+        switch (status) {
+            case ParseStatus::Empty:
+                return "Missing digits";
+            case ParseStatus::BadDigit:
+                return "Invalid digit for the given base";
+            case ParseStatus::Overflow:
+                return "Number does not fit in 64 bits";
+            default:
+                return "";
+        }
+    }
+
+    void checkRadix(int radix) {
+        if (radix < MIN_RADIX || radix > MAX_RADIX) {
+            throw std::invalid_argument("Base must be from 2 to 36");
+        }
+    }
+
+    std::string_view trim(std::string_view text) {
+        size_t begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string_view::npos) {
+            return {};
+        }
+        size_t end = text.find_last_not_of(" \t\r");
+        return text.substr(begin, end - begin + 1);
+    }
+
+    // Знак отделяется от модуля
+    ParseStatus parseSigned(std::string_view text, int radix, bool& negative, uint64_t& magnitude) {
+        negative = !text.empty() && text.front() == '-';
+        if (negative) {
+            text.remove_prefix(1);
+        }
+        return parseDigits(text, radix, magnitude);
+    }
+}
+
+char* formatUnsigned(char* first, char* last, uint64_t value, int radix) {
+    checkRadix(radix);
+    if (value == 0) {
+        if (first == last) {
+            return nullptr;
+        }
+        *first = '0';
+        return first + 1;
+    }
+    switch (radix) {
+        case 2:
+            return formatPowerOfTwo(first, last, value, 1);
+        case 4:
+            return formatPowerOfTwo(first, last, value, 2);
+        case 8:
+            return formatPowerOfTwo(first, last, value, 3);
+        case 16:
+            return formatPowerOfTwo(first, last, value, 4);
+        case 32:
+            return formatPowerOfTwo(first, last, value, 5);
+        case 10:
+            return formatDecimal(first, last, value);
+        default: {
+            auto [end, error] = std::to_chars(first, last, value, radix);
+            if (error != std::errc()) {
+                return nullptr;
+            }
+            for (char* p = first; p < end; ++p) {
+                if (*p >= 'a') {
+                    *p = static_cast<char>(*p - 'a' + 'A');
+                }
+            }
+            return end;
+        }
+    }
+}
+
+char* formatInteger(char* first, char* last, int64_t value, int radix) {
+    if (value >= 0) {
+        return formatUnsigned(first, last, static_cast<uint64_t>(value), radix);
+    }
+    if (first == last) {
+        return nullptr;
+    }
+    *first = '-';
+    // Модуль INT64_MIN не помещается в int64_t
+    return formatUnsigned(first + 1, last, 0 - static_cast<uint64_t>(value), radix);
+}
+
+uint64_t parseUnsigned(std::string_view digits, int radix) {
+    checkRadix(radix);
+    uint64_t value = 0;
+    ParseStatus status = parseDigits(digits, radix, value);
+    if (status == ParseStatus::Overflow) {
+        throw std::out_of_range(statusMessage(status));
+    }
+    if (status != ParseStatus::Ok) {
+        throw std::invalid_argument(statusMessage(status));
+    }
+    return value;
+}
+
+int64_t parseInteger(std::string_view text, int radix) {
+    checkRadix(radix);
+    bool negative = false;
+    uint64_t magnitude = 0;
+    ParseStatus status = parseSigned(trim(text), radix, negative, magnitude);
+    if (status == ParseStatus::Overflow) {
+        throw std::out_of_range(statusMessage(status));
+    }
+    if (status != ParseStatus::Ok) {
+        throw std::invalid_argument(statusMessage(status));
+    }
+    // Приведение по модулю 2^64: дополнительный код
+    return static_cast<int64_t>(negative ? 0 - magnitude : magnitude);
+}
+
+bool isRadixDigit(char c, int radix) {
+    return TABLES.value[static_cast<unsigned char>(c)] < radix;
+}
+
+bool convertLine(std::string_view line, int from, int to, std::string& out) {
+    line = trim(line);
+    if (line.empty()) {
+        out += '\n';
+        return true;
+    }
+    bool negative = false;
+    uint64_t magnitude = 0;
+    ParseStatus status = parseSigned(line, from, negative, magnitude);
+    if (status != ParseStatus::Ok) {
+        out += "error: ";
+        out += statusMessage(status);
+        out += '\n';
+        return false;
+    }
+    char buffer[RADIX_BUFFER_SIZE];
+    char* p = buffer;
+    if (negative && magnitude != 0) {
+        *p++ = '-';
+    }
+    char* end = formatUnsigned(p, buffer + sizeof(buffer), magnitude, to);
+    out.append(buffer, static_cast<size_t>(end - buffer));
+    out += '\n';
+    return true;
+}
+
+ConvertStats runConvert(LineReader& input, BufferedWriter& output, int from, int to) {
+    checkRadix(from);
+    checkRadix(to);
+    ConvertStats stats;
+    std::string result;
+    std::string_view line;
+    while (input.next(line)) {
+        // Результаты копятся и уходят в output блоками
+        if (!convertLine(line, from, to, result)) {
+            ++stats.errors;
+        }
+        ++stats.lines;
+        if (result.size() >= 64 * 1024) {
+            output.write(result);
+            result.clear();
+        }
+    }
+    output.write(result);
+    output.flush();
+    return stats;
+}
+
+} // namespace calc
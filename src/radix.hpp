@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace calc {
+
+class LineReader;
+class BufferedWriter;
+
+constexpr int MIN_RADIX = 2;
+constexpr int MAX_RADIX = 36;
+
+/**
+ * @brief Размер буфера, в который помещается любое 64-битное число в любой системе
+ *
+ * Самая длинная запись — знак и 64 двоичные цифры.
+ */
+constexpr size_t RADIX_BUFFER_SIZE = 65;
+
+/**
+ * @brief Записать value в системе radix (2–36) в [first, last), без выделения памяти
+ *
+ * Цифры больше 9 — заглавные латинские буквы. Возвращает конец записанного
+ * или nullptr, если буфер мал. Системы 2, 8 и 16 пишутся по байту
+ * (таблицами цифр на байт), 10 — парами цифр.
+ */
+char* formatUnsigned(char* first, char* last, uint64_t value, int radix);
+
+/**
+ * @brief Как formatUnsigned, отрицательное — знаком и модулем ("-FF")
+ */
+char* formatInteger(char* first, char* last, int64_t value, int radix);
+
+/**
+ * @brief Разобрать цифры системы radix (без знака и пробелов; регистр букв не важен)
+ *
+ * Длинные двоичные и шестнадцатеричные строки разбираются по восемь
+ * символов за шаг. Ошибки: std::invalid_argument — пусто или недопустимая
+ * цифра, std::out_of_range — значение больше 64 бит.
+ */
+uint64_t parseUnsigned(std::string_view digits, int radix);
+
+/**
+ * @brief Разобрать число со знаком: пробелы по краям и необязательный '-'
+ *
+ * Модуль до 2^64 − 1; модули больше 2^63 − 1 приводятся по модулю 2^64
+ * (FFFFFFFFFFFFFFFF — это −1), как в программистском режиме. Ошибки — как
+ * у parseUnsigned.
+ */
+int64_t parseInteger(std::string_view text, int radix);
+
+/**
+ * @brief Является ли c цифрой системы radix
+ */
+bool isRadixDigit(char c, int radix);
+
+/**
+ * @brief Итог конвертации строк
+ */
+struct ConvertStats {
+    size_t lines = 0;
+    size_t errors = 0;
+};
+
+/**
+ * @brief Перевести одну строку из системы from в систему to и дописать в out
+ *
+ * Строка — необязательный '-' и модуль до 2^64 − 1, пробелы по краям
+ * пропускаются; знак сохраняется. Дописывается число или "error: сообщение"
+ * и '\n'; пустая строка даёт пустую. false — строка с ошибкой.
+ */
+bool convertLine(std::string_view line, int from, int to, std::string& out);
+
+/**
+ * @brief Перевести все строки input, по строке результата на строку ввода
+ */
+ConvertStats runConvert(LineReader& input, BufferedWriter& output, int from, int to);
+
+} // namespace calc
@@ -0,0 +1,413 @@
+#include "ast/reduction.hpp"
+#include "ast/unary_op.hpp"
+#include "ast/binary_op.hpp"
+#include "ast/int_power.hpp"
+#include "ast/variable.hpp"
+#include "program.hpp"
+#include "parallel.hpp"
+#include "cancellation.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace calc {
+
+namespace {
+    // Границы вне ±2^53 не различимы как целые числа
+    constexpr double MAX_BOUND = 9007199254740992.0;
+
+    // Больше слагаемых не перебрать за разумное время
+    constexpr double MAX_TERMS = 1e10;
+
+    // Короткие диапазоны вычисляются по дереву: компиляция дороже
+    constexpr size_t TREE_TERMS = 64;
+
+    // Слагаемых в одном вызове evaluateBatch
+    constexpr size_t BLOCK = 1024;
+
+    // Размер части зависит только от числа слагаемых, поэтому порядок
+    // суммирования и результат не зависят от числа потоков
+    constexpr size_t MIN_CHUNK = 32 * BLOCK;
+    constexpr size_t MAX_CHUNKS = 4096;
+
+    constexpr size_t NO_ERROR = std::numeric_limits<size_t>::max();
+
+    // Компенсированное суммирование (Ноймайер): ошибка округления каждого
+    // сложения накапливается отдельно
+    struct CompensatedSum {
+        double sum = 0.0;
+        double compensation = 0.0;
+
+        void add(double value) {
+            double total = sum + value;
+            if (std::abs(sum) >= std::abs(value)) {
+                compensation += (sum - total) + value;
+            } else {
+                compensation += (value - total) + sum;
+            }
+            sum = total;
+        }
+
+        double result() const { return sum + compensation; }
+    };
+
+    bool usesCell(const Node* node, const double* cell) {
+        if (!node) {
+            return false;
+        }
+        if (const auto* var = dynamic_cast<const VariableNode*>(node)) {
+            return var->slot() == cell;
+        }
+        for (size_t i = 0; i < node->childCount(); ++i) {
+            if (usesCell(node->child(i), cell)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Многочлен от переменной цикла: coefficients[k] при i^k
+    struct Polynomial {
+        static constexpr int MAX_DEGREE = 3;
+        long double coefficients[MAX_DEGREE + 1] = {0.0L, 0.0L, 0.0L, 0.0L};
+        int degree = 0;
+    };
+
+    bool multiply(const Polynomial& a, const Polynomial& b, Polynomial& out) {
+        if (a.degree + b.degree > Polynomial::MAX_DEGREE) {
+            return false;
+        }
+        Polynomial product;
+        product.degree = a.degree + b.degree;
+        for (int i = 0; i <= a.degree; ++i) {
+            for (int j = 0; j <= b.degree && i + j <= Polynomial::MAX_DEGREE; ++j) {
+                product.coefficients[i + j] += a.coefficients[i] * b.coefficients[j];
+            }
+        }
+        out = product;
+        return true;
+    }
+
+    bool power(const Polynomial& base, int exponent, Polynomial& out) {
+        if (exponent < 0 || exponent > Polynomial::MAX_DEGREE) {
+            return false;
+        }
+        Polynomial result;
+        result.coefficients[0] = 1.0L;
+        for (int k = 0; k < exponent; ++k) {
+            if (!multiply(result, base, result)) {
+                return false;
+            }
+        }
+        out = result;
+        return true;
+    }
+
+    // Оценка сверху |p(i)| при |i| <= reach не превосходит DBL_MAX: иначе
+    // проверенное вычисление узла может переполниться в double, а сумма в
+    // замкнутой форме — нет (например, i * 1e200 * 1e200 - i * 1e200 * 1e200)
+    bool fitsDouble(const Polynomial& p, long double reach) {
+        long double bound = 0.0L;
+        long double power = 1.0L;
+        for (int k = 0; k <= p.degree; ++k) {
+            bound += std::abs(p.coefficients[k]) * power;
+            power *= reach;
+        }
+        return bound <= std::numeric_limits<double>::max();
+    }
+
+    bool asPolynomial(const Node* node, const double* cell, long double reach, Polynomial& out);
+
+    // Распознаёт тело степени не выше 3: + - *, унарный минус, целые степени
+    // и деление на инвариант, который проверенное деление не отвергает.
+    // Инвариантные поддеревья (без переменной цикла) вычисляются один раз
+    bool recognise(const Node* node, const double* cell, long double reach, Polynomial& out) {
+        if (!node) {
+            return false;
+        }
+        if (!usesCell(node, cell)) {
+            try {
+                out = Polynomial{};
+                out.coefficients[0] = node->evaluate();
+                return true;
+            } catch (const EvalError&) {
+                // Ошибка должна возникнуть при переборе, если он непуст
+                return false;
+            }
+        }
+        if (dynamic_cast<const VariableNode*>(node)) {
+            out = Polynomial{};
+            out.coefficients[1] = 1.0L;
+            out.degree = 1;
+            return true;
+        }
+        if (const auto* unary = dynamic_cast<const UnaryOpNode*>(node)) {
+            if (unary->op() != UnaryOp::Plus && unary->op() != UnaryOp::Minus) {
+                return false;
+            }
+            if (!asPolynomial(unary->operand(), cell, reach, out)) {
+                return false;
+            }
+            if (unary->op() == UnaryOp::Minus) {
+                for (auto& c : out.coefficients) {
+                    c = -c;
+                }
+            }
+            return true;
+        }
+        if (const auto* intPower = dynamic_cast<const IntPowerNode*>(node)) {
+            Polynomial base;
+            return asPolynomial(intPower->base(), cell, reach, base) &&
+                   power(base, intPower->exponent(), out);
+        }
+        const auto* binary = dynamic_cast<const BinaryOpNode*>(node);
+        if (!binary) {
+            return false;
+        }
+        Polynomial left;
+        Polynomial right;
+        if (!asPolynomial(binary->left(), cell, reach, left) ||
+            !asPolynomial(binary->right(), cell, reach, right)) {
+            return false;
+        }
+        switch (binary->op()) {
+            case BinaryOp::Add:
+            case BinaryOp::Subtract: {
+                double sign = binary->op() == BinaryOp::Add ? 1.0 : -1.0;
+                out = left;
+                out.degree = std::max(left.degree, right.degree);
+                for (int k = 0; k <= right.degree; ++k) {
+                    out.coefficients[k] += sign * right.coefficients[k];
+                }
+                return true;
+            }
+            case BinaryOp::Multiply:
+                return multiply(left, right, out);
+            case BinaryOp::Divide:
+                // Тот же порог, что у BinaryOpNode: иначе каждое слагаемое —
+                // "Division by zero", а замкнутая форма дала бы число
+                if (right.degree != 0 || std::abs(right.coefficients[0]) < 1e-15L) {
+                    return false;
+                }
+                out = left;
+                for (auto& c : out.coefficients) {
+                    c /= right.coefficients[0];
+                }
+                return true;
+            case BinaryOp::Power: {
+                double exponent = static_cast<double>(right.coefficients[0]);
+                if (right.degree != 0 || exponent != std::floor(exponent)) {
+                    return false;
+                }
+                return power(left, static_cast<int>(std::max(-1.0, std::min(exponent, 4.0))), out);
+            }
+            default:
+                return false;
+        }
+    }
+
+    // Многочлен, значения которого и всех его подвыражений представимы в
+    // double при |i| <= reach
+    bool asPolynomial(const Node* node, const double* cell, long double reach, Polynomial& out) {
+        return recognise(node, cell, reach, out) && fitsDouble(out, reach);
+    }
+
+    // Сумма p(i) для i = from..to в замкнутой форме: сдвиг j = i - from и
+    // суммы степеней 0..m, m = to - from
+    double closedFormSum(const Polynomial& p, double from, double to) {
+        long double a = from;
+        long double m = to - from;
+        const long double* c = p.coefficients;
+        long double q0 = c[0] + a * (c[1] + a * (c[2] + a * c[3]));
+        long double q1 = c[1] + a * (2.0L * c[2] + 3.0L * a * c[3]);
+        long double q2 = c[2] + 3.0L * a * c[3];
+        long double q3 = c[3];
+
+        long double s0 = m + 1.0L;
+        long double s1 = m * (m + 1.0L) / 2.0L;
+        long double s2 = m * (m + 1.0L) * (2.0L * m + 1.0L) / 6.0L;
+        long double s3 = s1 * s1;
+        return static_cast<double>(q0 * s0 + q1 * s1 + q2 * s2 + q3 * s3);
+    }
+
+    double integerBound(const Node* node, const char* name) {
+        if (!node) {
+            throw EvalError("Invalid operands: null pointer");
+        }
+        double value = node->evaluate();
+        if (value != std::floor(value)) {
+            throw EvalError(std::string("Bounds of ") + name + "() must be integers");
+        }
+        if (std::abs(value) > MAX_BOUND) {
+            throw EvalError(std::string("Bounds of ") + name + "() are out of range");
+        }
+        return value;
+    }
+
+    double finish(const ReductionNode& node, double value) {
+        if (!std::isfinite(value)) {
+            throw EvalError(std::string("Overflow in ") + node.name() + "()");
+        }
+        return value;
+    }
+
+    // Перебор по дереву: переменная цикла пишется в ячейку узла
+    double iterateTree(const ReductionNode& node, double from, size_t count, const ProgressStage& stage) {
+        bool isSum = node.kind() == ReductionKind::Sum;
+        CompensatedSum sum;
+        double product = 1.0;
+        for (size_t k = 0; k < count; ++k) {
+            stage.report(k, count);
+            *node.cell() = from + static_cast<double>(k);
+            double term = node.body()->evaluate();
+            if (isSum) {
+                sum.add(term);
+            } else {
+                product *= term;
+            }
+        }
+        stage.report(count, count);
+        return finish(node, isSum ? sum.result() : product);
+    }
+
+    struct Chunk {
+        CompensatedSum sum;
+        double product = 1.0;
+        std::string error;
+    };
+
+    // Тело компилируется один раз; части диапазона вычисляются пакетами в
+    // нескольких потоках и объединяются по порядку
+    double iterateProgram(const ReductionNode& node, const Program& program, double from,
+                          size_t count, size_t threads, const ProgressStage& stage) {
+        ProgramView view = program.view();
+        bool isSum = node.kind() == ReductionKind::Sum;
+
+        // Столбец 0 — переменная цикла, прочие переменные тела постоянны
+        std::vector<const double*> slots = view.bind(*node.body());
+        std::vector<std::vector<double>> constantColumns(view.variableCount());
+        for (size_t v = 1; v < view.variableCount(); ++v) {
+            if (slots[v]) {
+                constantColumns[v].assign(BLOCK, *slots[v]);
+            }
+        }
+
+        size_t chunkSize = std::max(MIN_CHUNK, (count + MAX_CHUNKS - 1) / MAX_CHUNKS);
+        chunkSize = (chunkSize + BLOCK - 1) / BLOCK * BLOCK;
+        size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+        std::vector<Chunk> chunks(chunkCount);
+        std::atomic<size_t> firstFailed{NO_ERROR};
+        std::atomic<size_t> done{0};
+
+        parallelFor(chunkCount, [&](size_t index) {
+            // Части после ошибки не нужны: сообщается ошибка наименьшего i
+            if (index > firstFailed.load(std::memory_order_relaxed)) {
+                return;
+            }
+            std::vector<double> xs(BLOCK);
+            std::vector<double> results(BLOCK);
+            std::vector<const double*> columns(view.variableCount(), nullptr);
+            columns[0] = xs.data();
+            for (size_t v = 1; v < columns.size(); ++v) {
+                if (!constantColumns[v].empty()) {
+                    columns[v] = constantColumns[v].data();
+                }
+            }
+            std::vector<BatchError> errors;
+
+            Chunk& chunk = chunks[index];
+            size_t begin = index * chunkSize;
+            size_t end = std::min(count, begin + chunkSize);
+            for (size_t offset = begin; offset < end; offset += BLOCK) {
+                size_t n = std::min(BLOCK, end - offset);
+                for (size_t k = 0; k < n; ++k) {
+                    xs[k] = from + static_cast<double>(offset + k);
+                }
+                errors.clear();
+                if (view.evaluateBatch(columns.data(), n, results.data(), &errors) > 0) {
+                    chunk.error = errors.front().message;
+                    size_t expected = firstFailed.load(std::memory_order_relaxed);
+                    while (index < expected &&
+                           !firstFailed.compare_exchange_weak(expected, index, std::memory_order_relaxed)) {
+                    }
+                    return;
+                }
+                stage.report(done.fetch_add(n, std::memory_order_relaxed) + n, count);
+                if (isSum) {
+                    for (size_t k = 0; k < n; ++k) {
+                        chunk.sum.add(results[k]);
+                    }
+                } else {
+                    for (size_t k = 0; k < n; ++k) {
+                        chunk.product *= results[k];
+                    }
+                }
+            }
+        }, threads);
+
+        CompensatedSum sum;
+        double compensation = 0.0;
+        double product = 1.0;
+        for (const Chunk& chunk : chunks) {
+            if (!chunk.error.empty()) {
+                throw EvalError(chunk.error);
+            }
+            sum.add(chunk.sum.sum);
+            compensation += chunk.sum.compensation;
+            product *= chunk.product;
+        }
+        return finish(node, isSum ? sum.result() + compensation : product);
+    }
+}
+
+double evaluateReduction(const ReductionNode& node, size_t threads) {
+    if (!node.body() || !node.cell()) {
+        throw EvalError("Invalid operands: null pointer");
+    }
+    double from = integerBound(node.from(), node.name());
+    double to = integerBound(node.to(), node.name());
+    bool isSum = node.kind() == ReductionKind::Sum;
+    if (to < from) {
+        return isSum ? 0.0 : 1.0;
+    }
+
+    double terms = to - from + 1.0;
+    Polynomial polynomial;
+    // Диапазон, который не перебрать, считается только по формуле: там
+    // проверяется лишь свободный член
+    long double reach = terms > MAX_TERMS ? 0.0L : std::max(std::abs(from), std::abs(to));
+    if (asPolynomial(node.body(), node.cell(), reach, polynomial) && (isSum || polynomial.degree == 0)) {
+        double value = isSum ? closedFormSum(polynomial, from, to)
+                             : std::pow(static_cast<double>(polynomial.coefficients[0]), terms);
+        // При переполнении перебор сообщает ошибку наименьшего i (например,
+        // "Overflow in multiplication") или переполнение самой суммы
+        if (std::isfinite(value) || terms > MAX_TERMS) {
+            return finish(node, value);
+        }
+    }
+
+
+    if (terms > MAX_TERMS) {
+        throw EvalError(std::string("Too many terms in ") + node.name() + "()");
+    }
+    size_t count = static_cast<size_t>(terms);
+    ProgressStage stage;
+    if (count < TREE_TERMS) {
+        return iterateTree(node, from, count, stage);
+    }
+
+    Program program;
+    try {
+        program = Program::compile(*node.body(), {node.variable()});
+    } catch (const EvalError&) {
+        // Вложенные sum/prod и неизвестные функции — перебор по дереву
+        return iterateTree(node, from, count, stage);
+    }
+    return iterateProgram(node, program, from, count, threads, stage);
+}
+
+} // namespace calc
@@ -0,0 +1,426 @@
+#include "server.hpp"
+#include "server_protocol.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "program.hpp"
+#include "error.hpp"
+#include "format.hpp"
+#include <stdexcept>
+
+#ifdef __linux__
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <list>
+#include <string_view>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace calc {
+
+#ifdef __linux__
+
+namespace {
+    // Событий за один epoll_wait
+    constexpr int MAX_EVENTS = 256;
+
+    // Байт за один recv и за проход цикла с одного соединения (чтобы одно
+    // соединение не задерживало остальные)
+    constexpr size_t READ_SIZE = 64 << 10;
+    constexpr size_t READ_LIMIT = 1 << 20;
+
+    // Неотправленных ответов, после которых соединение перестаёт читаться,
+    // пока клиент не заберёт их
+    constexpr size_t OUTPUT_LIMIT = 1 << 20;
+
+    std::runtime_error systemError(const std::string& what) {
+        return std::runtime_error(what + ": " + std::strerror(errno));
+    }
+
+    // Разобранное выражение: программа, если компилируется, иначе дерево
+    struct CachedExpression {
+        std::string text;
+        std::unique_ptr<Node> ast;
+        Program program;
+        std::vector<const double*> slots;
+        bool compiled = false;
+        std::string error;              // Ошибка разбора: отвечается без вычисления
+
+        CachedExpression(std::string_view source, const Variables& variables, const ServerOptions& options)
+            : text(source) {
+            try {
+                Lexer lexer(text);
+                Parser parser(lexer.tokenize(), &variables);
+                ast = parser.parse();
+                if (options.optimize) {
+                    Optimizer optimizer(options.optimizer);
+                    ast = optimizer.optimize(std::move(ast));
+                }
+            } catch (const ParseError& e) {
+                error = e.what();
+                return;
+            }
+            try {
+                program = Program::compile(*ast);
+                slots = program.view().bind(variables);
+                compiled = true;
+                ast.reset();
+            } catch (const EvalError&) {
+                // sum/integrate/solve и неизвестные функции вычисляются по дереву
+            }
+        }
+
+        double evaluate() const {
+            return compiled ? program.view().evaluate(slots.data()) : ast->evaluate();
+        }
+    };
+
+    // LRU-кэш выражений соединения по тексту запроса
+    class ExpressionCache {
+    public:
+        explicit ExpressionCache(size_t capacity) : capacity_(std::max<size_t>(capacity, 1)) {}
+
+        const CachedExpression& find(std::string_view text, const Variables& variables,
+                                     const ServerOptions& options, bool& hit) {
+            auto found = index_.find(text);
+            hit = found != index_.end();
+            if (hit) {
+                entries_.splice(entries_.begin(), entries_, found->second);
+                return entries_.front();
+            }
+            if (entries_.size() >= capacity_) {
+                index_.erase(entries_.back().text);
+                entries_.pop_back();
+            }
+            entries_.emplace_front(text, variables, options);
+            index_.emplace(entries_.front().text, entries_.begin());
+            return entries_.front();
+        }
+
+    private:
+        size_t capacity_;
+        std::list<CachedExpression> entries_;
+        // Ключи указывают на text элементов списка: узлы списка не перемещаются
+        std::unordered_map<std::string_view, std::list<CachedExpression>::iterator> index_;
+    };
+}
+
+struct Server::Connection {
+    Connection(int socket, size_t cacheEntries) : fd(socket), cache(cacheEntries) {}
+
+    int fd;
+    protocol::FrameBuffer input;
+    std::string output;
+    size_t sent = 0;
+    ExpressionCache cache;
+    bool closing = false;       // Клиент закрыл соединение или нарушил протокол
+    bool queued = false;        // В ready_
+    uint32_t events = EPOLLIN;  // Зарегистрированные в epoll события
+};
+
+Server::Server(std::string path, const Variables& variables, ServerOptions options)
+    : path_(std::move(path)), variables_(variables), options_(options) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path_.empty() || path_.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("Invalid socket path: " + path_);
+    }
+    std::memcpy(address.sun_path, path_.c_str(), path_.size() + 1);
+
+    // Файл сокета от упавшего сервера мешает bind; живой сервер — нет
+    struct stat st;
+    if (::stat(path_.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+        int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        bool alive = probe >= 0 &&
+                     ::connect(probe, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0;
+        if (probe >= 0) {
+            ::close(probe);
+        }
+        if (alive) {
+            throw std::runtime_error("Socket already in use: " + path_);
+        }
+        ::unlink(path_.c_str());
+    }
+
+    listener_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener_ < 0) {
+        throw systemError("Cannot create socket");
+    }
+    if (::bind(listener_, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        std::runtime_error error = systemError("Cannot bind " + path_);
+        ::close(listener_);
+        throw error;
+    }
+    epoll_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wakeup_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event listenEvent{};
+    listenEvent.events = EPOLLIN;
+    listenEvent.data.fd = listener_;
+    epoll_event wakeupEvent{};
+    wakeupEvent.events = EPOLLIN;
+    wakeupEvent.data.fd = wakeup_;
+    if (::listen(listener_, SOMAXCONN) != 0 || epoll_ < 0 || wakeup_ < 0 ||
+        ::epoll_ctl(epoll_, EPOLL_CTL_ADD, listener_, &listenEvent) != 0 ||
+        ::epoll_ctl(epoll_, EPOLL_CTL_ADD, wakeup_, &wakeupEvent) != 0) {
+        std::runtime_error error = systemError("Cannot listen on " + path_);
+        ::close(listener_);
+        if (epoll_ >= 0) {
+            ::close(epoll_);
+        }
+        if (wakeup_ >= 0) {
+            ::close(wakeup_);
+        }
+        ::unlink(path_.c_str());
+        throw error;
+    }
+}
+
+Server::~Server() {
+    for (auto& entry : connections_) {
+        ::close(entry.first);
+    }
+    ::close(listener_);
+    ::close(epoll_);
+    ::close(wakeup_);
+    ::unlink(path_.c_str());
+}
+
+void Server::stop() {
+    // write в eventfd допустим в обработчике сигнала
+    uint64_t one = 1;
+    ssize_t written = ::write(wakeup_, &one, sizeof(one));
+    (void)written;
+}
+
+void Server::run() {
+    epoll_event events[MAX_EVENTS];
+    bool running = true;
+    while (running) {
+        // Недочитанные из-за размера пакета запросы — без ожидания
+        int count = ::epoll_wait(epoll_, events, MAX_EVENTS, ready_.empty() ? -1 : 0);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw systemError("epoll_wait failed");
+        }
+        for (int i = 0; i < count; ++i) {
+            int fd = events[i].data.fd;
+            if (fd == listener_) {
+                accept();
+                continue;
+            }
+            if (fd == wakeup_) {
+                running = false;
+                continue;
+            }
+            auto found = connections_.find(fd);
+            if (found == connections_.end()) {
+                continue;
+            }
+            Connection& connection = *found->second;
+            if (events[i].events & EPOLLOUT) {
+                // Закрывающееся соединение закрывается, когда ушёл последний ответ
+                if (!send(connection) ||
+                    (connection.closing && !connection.queued && connection.output.empty())) {
+                    close(fd);
+                    continue;
+                }
+            }
+            if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !connection.closing &&
+                !receive(connection)) {
+                close(fd);
+            }
+        }
+        evaluateBatch();
+    }
+}
+
+void Server::accept() {
+    while (true) {
+        int fd = ::accept4(listener_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            // EAGAIN — очередь пуста; нехватка дескрипторов — повтор при следующем событии
+            return;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (::epoll_ctl(epoll_, EPOLL_CTL_ADD, fd, &event) != 0) {
+            ::close(fd);
+            continue;
+        }
+        connections_.emplace(fd, std::make_unique<Connection>(fd, options_.cacheEntries));
+        ++stats_.connections;
+    }
+}
+
+bool Server::receive(Connection& connection) {
+    size_t total = 0;
+    while (total < READ_LIMIT) {
+        char* buffer = connection.input.prepare(READ_SIZE);
+        ssize_t read = ::recv(connection.fd, buffer, READ_SIZE, 0);
+        if (read > 0) {
+            connection.input.commit(static_cast<size_t>(read));
+            total += static_cast<size_t>(read);
+            continue;
+        }
+        if (read == 0) {
+            connection.closing = true;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        return false;
+    }
+    if (!connection.queued && (connection.closing || connection.input.complete())) {
+        connection.queued = true;
+        ready_.push_back(&connection);
+    }
+    return true;
+}
+
+void Server::evaluateBatch() {
+    std::vector<Connection*> batch;
+    batch.swap(ready_);
+    size_t requests = 0;
+    for (Connection* connection : batch) {
+        connection->queued = false;
+        std::string_view payload;
+        try {
+            while (requests < options_.maxBatch && connection->input.next(payload)) {
+                bool hit = false;
+                const CachedExpression& expression =
+                    connection->cache.find(payload, variables_, options_, hit);
+                if (hit) {
+                    ++stats_.cacheHits;
+                }
+                ++requests;
+                if (!expression.error.empty()) {
+                    protocol::appendResponse(connection->output, protocol::ResponseStatus::Error,
+                                             expression.error);
+                    ++stats_.errors;
+                    continue;
+                }
+                try {
+                    char buf[FORMAT_BUFFER_SIZE];
+                    char* end = formatNumber(buf, buf + sizeof(buf), expression.evaluate(), options_.format);
+                    protocol::appendResponse(connection->output, protocol::ResponseStatus::Ok,
+                                             std::string_view(buf, static_cast<size_t>(end - buf)));
+                } catch (const EvalError& e) {
+                    protocol::appendResponse(connection->output, protocol::ResponseStatus::Error, e.what());
+                    ++stats_.errors;
+                }
+            }
+        } catch (const std::runtime_error&) {
+            // Слишком длинный кадр: дальше поток байтов не разобрать
+            connection->closing = true;
+            connection->input = protocol::FrameBuffer();
+        }
+        if (connection->input.complete()) {
+            // Пакет заполнен: остальное — в следующем проходе
+            connection->queued = true;
+            ready_.push_back(connection);
+        }
+    }
+    if (requests > 0) {
+        stats_.requests += requests;
+        ++stats_.batches;
+        stats_.largestBatch = std::max(stats_.largestBatch, requests);
+    }
+
+    // Ответы каждому соединению — одной записью на пакет
+    for (Connection* connection : batch) {
+        int fd = connection->fd;
+        if (!send(*connection) ||
+            (connection->closing && !connection->queued && connection->output.empty())) {
+            close(fd);
+        }
+    }
+}
+
+bool Server::send(Connection& connection) {
+    while (connection.sent < connection.output.size()) {
+        ssize_t written = ::send(connection.fd, connection.output.data() + connection.sent,
+                                 connection.output.size() - connection.sent, MSG_NOSIGNAL);
+        if (written > 0) {
+            connection.sent += static_cast<size_t>(written);
+            continue;
+        }
+        if (written < 0 && errno == EINTR) {
+            continue;
+        }
+        if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        return false;
+    }
+    if (connection.sent == connection.output.size()) {
+        connection.output.clear();
+    } else {
+        connection.output.erase(0, connection.sent);
+    }
+    connection.sent = 0;
+    watch(connection);
+    return true;
+}
+
+void Server::watch(Connection& connection) {
+    // Противодавление: пока клиент не забрал ответы, его запросы не читаются
+    uint32_t events = 0;
+    if (!connection.closing && connection.output.size() < OUTPUT_LIMIT) {
+        events |= EPOLLIN;
+    }
+    if (!connection.output.empty()) {
+        events |= EPOLLOUT;
+    }
+    if (events != connection.events) {
+        epoll_event event{};
+        event.events = events;
+        event.data.fd = connection.fd;
+        ::epoll_ctl(epoll_, EPOLL_CTL_MOD, connection.fd, &event);
+        connection.events = events;
+    }
+}
+
+void Server::close(int fd) {
+    auto found = connections_.find(fd);
+    if (found == connections_.end()) {
+        return;
+    }
+    ready_.erase(std::remove(ready_.begin(), ready_.end(), found->second.get()), ready_.end());
+    ::close(fd);
+    connections_.erase(found);
+}
+
+#else
+
+struct Server::Connection {};
+
+Server::Server(std::string path, const Variables& variables, ServerOptions options)
+    : path_(std::move(path)), variables_(variables), options_(options) {
+    throw std::runtime_error("calc --serve requires Linux (epoll)");
+}
+
+Server::~Server() = default;
+
+void Server::run() {}
+
+void Server::stop() {}
+
+#endif
+
+} // namespace calc
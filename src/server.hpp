@@ -0,0 +1,103 @@
+#pragma once
+
+#include "format.hpp"
+#include "optimizer.hpp"
+#include "variables.hpp"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace calc {
+
+/**
+ * @brief Параметры сервера вычислений
+ */
+struct ServerOptions {
+    bool optimize = false;
+    OptimizerOptions optimizer;
+    size_t cacheEntries = 1024;     // Разобранных выражений в кэше соединения
+    size_t maxBatch = 4096;         // Запросов в одном микропакете
+    FormatOptions format;           // Запись значений в ответах
+};
+
+/**
+ * @brief Счётчики сервера с момента запуска
+ */
+struct ServerStats {
+    size_t connections = 0;         // Принятых соединений
+    size_t requests = 0;
+    size_t errors = 0;              // Ответов с ошибкой вычисления или разбора
+    size_t batches = 0;             // Микропакетов (проходов цикла событий с запросами)
+    size_t largestBatch = 0;
+    size_t cacheHits = 0;           // Запросов, выражение которых уже было в кэше
+};
+
+/**
+ * @brief Сервер вычислений на Unix domain socket (calc --serve)
+ *
+ * Один поток с циклом событий epoll. Протокол — кадры с длиной (см.
+ * server_protocol.hpp), запросы соединения можно слать конвейером. За
+ * проход цикла из всех готовых соединений читается всё доступное, все
+ * целые запросы вычисляются одним микропакетом, а ответы каждому
+ * соединению уходят одной записью: системные вызовы делятся на запросы
+ * пакета. Каждое соединение хранит LRU-кэш разобранных (и, где можно,
+ * скомпилированных в Program) выражений, так что повторный запрос не
+ * проходит лексер и парсер. Переменные задаются при запуске и общие для
+ * всех запросов.
+ *
+ * Только Linux: на других системах конструктор выбрасывает
+ * std::runtime_error. Ошибки сокетов — std::runtime_error.
+ */
+class Server {
+public:
+    /**
+     * @brief Создать сокет path и начать приём соединений
+     *
+     * Оставшийся от упавшего сервера файл сокета удаляется; если по
+     * адресу отвечает живой сервер — ошибка.
+     */
+    Server(std::string path, const Variables& variables, ServerOptions options = ServerOptions());
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    /**
+     * @brief Цикл событий; возвращается после stop()
+     */
+    void run();
+
+    /**
+     * @brief Остановить run() (из любого потока и из обработчика сигнала)
+     */
+    void stop();
+
+    /**
+     * @brief Счётчики; читать после возврата run()
+     */
+    const ServerStats& stats() const { return stats_; }
+
+private:
+    struct Connection;
+
+    void accept();
+    bool receive(Connection& connection);
+    void evaluateBatch();
+    bool send(Connection& connection);
+    void watch(Connection& connection);
+    void close(int fd);
+
+    std::string path_;
+    const Variables& variables_;
+    ServerOptions options_;
+    ServerStats stats_;
+    int listener_ = -1;
+    int epoll_ = -1;
+    int wakeup_ = -1;               // eventfd для stop()
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+    std::vector<Connection*> ready_; // Соединения с непрочитанными запросами
+};
+
+} // namespace calc
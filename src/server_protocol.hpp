@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace calc {
+
+/**
+ * @brief Протокол сервера вычислений (calc --serve)
+ *
+ * Запросы и ответы — кадры: длина полезной нагрузки (uint32, little
+ * endian) и сама нагрузка. Нагрузка запроса — текст выражения. Нагрузка
+ * ответа — байт состояния (ResponseStatus) и текст: значение или
+ * сообщение об ошибке. Клиент может отправить несколько запросов, не
+ * дожидаясь ответов; ответы приходят в порядке запросов.
+ */
+namespace protocol {
+
+constexpr size_t HEADER_SIZE = 4;
+
+// Кадр длиннее — ошибка протокола, сервер закрывает соединение
+constexpr size_t MAX_PAYLOAD = 1 << 16;
+
+enum class ResponseStatus : uint8_t {
+    Ok = 0,
+    Error = 1
+};
+
+inline void appendFrame(std::string& out, std::string_view payload) {
+    uint32_t length = static_cast<uint32_t>(payload.size());
+    char header[HEADER_SIZE] = {
+        static_cast<char>(length & 0xFF), static_cast<char>((length >> 8) & 0xFF),
+        static_cast<char>((length >> 16) & 0xFF), static_cast<char>((length >> 24) & 0xFF)
+    };
+    out.append(header, HEADER_SIZE);
+    out.append(payload.data(), payload.size());
+}
+
+inline void appendResponse(std::string& out, ResponseStatus status, std::string_view text) {
+    uint32_t length = static_cast<uint32_t>(text.size() + 1);
+    char header[HEADER_SIZE + 1] = {
+        static_cast<char>(length & 0xFF), static_cast<char>((length >> 8) & 0xFF),
+        static_cast<char>((length >> 16) & 0xFF), static_cast<char>((length >> 24) & 0xFF),
+        static_cast<char>(status)
+    };
+    out.append(header, sizeof(header));
+    out.append(text.data(), text.size());
+}
+
+/**
+ * @brief Буфер приёма: байты из сокета и выделение из них целых кадров
+ *
+ * Нагрузка выдаётся как string_view внутрь буфера и действительна до
+ * следующего prepare(). Кадр длиннее MAX_PAYLOAD — std::runtime_error.
+ */
+class FrameBuffer {
+public:
+    /**
+     * @brief Место для записи не меньше size байт
+     */
+    char* prepare(size_t size) {
+        if (begin_ > 0 && begin_ == end_) {
+            begin_ = end_ = 0;
+        }
+        if (data_.size() - end_ < size && begin_ > 0) {
+            // Прочитанные кадры вытесняются, прежде чем буфер растёт
+            std::memmove(data_.data(), data_.data() + begin_, end_ - begin_);
+            end_ -= begin_;
+            begin_ = 0;
+        }
+        if (data_.size() - end_ < size) {
+            data_.resize(end_ + size);
+        }
+        return data_.data() + end_;
+    }
+
+    void commit(size_t size) { end_ += size; }
+
+    /**
+     * @brief Следующий целый кадр; false — кадр ещё не дочитан
+     */
+    bool next(std::string_view& payload) {
+        if (end_ - begin_ < HEADER_SIZE) {
+            return false;
+        }
+        size_t length = frameLength();
+        if (length > MAX_PAYLOAD) {
+            throw std::runtime_error("Frame too large: " + std::to_string(length) + " bytes");
+        }
+        if (end_ - begin_ < HEADER_SIZE + length) {
+            return false;
+        }
+        payload = std::string_view(data_.data() + begin_ + HEADER_SIZE, length);
+        begin_ += HEADER_SIZE + length;
+        return true;
+    }
+
+    /**
+     * @brief Есть ли в буфере целый кадр (или заголовок слишком длинного)
+     */
+    bool complete() const {
+        if (end_ - begin_ < HEADER_SIZE) {
+            return false;
+        }
+        size_t length = frameLength();
+        return length > MAX_PAYLOAD || end_ - begin_ >= HEADER_SIZE + length;
+    }
+
+    /**
+     * @brief Непрочитанных байт в буфере
+     */
+    size_t pending() const { return end_ - begin_; }
+
+private:
+    size_t frameLength() const {
+        const unsigned char* header = reinterpret_cast<const unsigned char*>(data_.data() + begin_);
+        return static_cast<size_t>(header[0]) | (static_cast<size_t>(header[1]) << 8) |
+               (static_cast<size_t>(header[2]) << 16) | (static_cast<size_t>(header[3]) << 24);
+    }
+
+    std::vector<char> data_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+};
+
+} // namespace protocol
+
+} // namespace calc
@@ -0,0 +1,303 @@
+#include "ast/solve.hpp"
+#include "program.hpp"
+#include "parallel.hpp"
+#include "cancellation.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace calc {
+
+namespace {
+    // Отрезков сетки просмотра: корни, ближе друг к другу, чем шаг сетки,
+    // могут не различиться
+    constexpr size_t SCAN_INTERVALS = 1 << 14;
+
+    // Точек в одном вызове evaluateBatch при просмотре
+    constexpr size_t BLOCK = 1024;
+
+    // Итераций Брента на отрезок; метод сходится не медленнее бисекции,
+    // которой для double хватает 64 шагов на порядок ширины
+    constexpr size_t MAX_ITERATIONS = 200;
+
+    // Отрезков со сменой знака в одной задаче потока
+    constexpr size_t BRACKETS_PER_TASK = 8;
+
+    // Корень не найден (ошибка при уточнении или полюс)
+    const double NO_ROOT = std::numeric_limits<double>::quiet_NaN();
+
+    constexpr double EPSILON = std::numeric_limits<double>::epsilon();
+
+    // Функция expr(x): скомпилированная программа или, если тело не
+    // компилируется, дерево (тогда только в одном потоке)
+    class Equation {
+    public:
+        explicit Equation(const SolveNode& node) : node_(node) {
+            try {
+                program_ = Program::compile(*node.body(), {node.variable()});
+                compiled_ = true;
+            } catch (const EvalError&) {
+                // Вложенные solve/integrate/sum и неизвестные функции — по дереву
+                return;
+            }
+            slots_ = program_.view().bind(*node.body());
+        }
+
+        bool compiled() const { return compiled_; }
+
+        // Значения в точках xs; в точках с ошибкой — NaN
+        void scan(const double* xs, size_t count, double* values, size_t threads,
+                  const ProgressStage& stage) const {
+            if (!compiled_) {
+                for (size_t k = 0; k < count; ++k) {
+                    stage.report(k, 2 * count);
+                    try {
+                        values[k] = (*this)(xs[k], nullptr);
+                    } catch (const EvalError&) {
+                        values[k] = NO_ROOT;
+                    }
+                }
+                return;
+            }
+            ProgramView view = program_.view();
+            std::vector<std::vector<double>> constantColumns(view.variableCount());
+            for (size_t v = 1; v < view.variableCount(); ++v) {
+                if (slots_[v]) {
+                    constantColumns[v].assign(BLOCK, *slots_[v]);
+                }
+            }
+            size_t tasks = (count + BLOCK - 1) / BLOCK;
+            parallelFor(tasks, [&](size_t task) {
+                CancellationScope::checkpoint();
+                size_t offset = task * BLOCK;
+                size_t n = std::min(BLOCK, count - offset);
+                std::vector<const double*> columns(view.variableCount(), nullptr);
+                columns[0] = xs + offset;
+                for (size_t v = 1; v < columns.size(); ++v) {
+                    if (!constantColumns[v].empty()) {
+                        columns[v] = constantColumns[v].data();
+                    }
+                }
+                std::vector<BatchError> errors;
+                view.evaluateBatch(columns.data(), n, values + offset, &errors);
+                for (const BatchError& error : errors) {
+                    values[offset + error.index] = NO_ROOT;
+                }
+            }, threads);
+        }
+
+        // Значение в точке; slots — копия slots() для потока (для дерева не нужна)
+        double operator()(double x, std::vector<const double*>* slots) const {
+            if (!compiled_) {
+                *node_.cell() = x;
+                return node_.body()->evaluate();
+            }
+            (*slots)[0] = &x;
+            return program_.view().evaluate(slots->data());
+        }
+
+        const std::vector<const double*>& slots() const { return slots_; }
+
+    private:
+        const SolveNode& node_;
+        Program program_;
+        bool compiled_ = false;
+        std::vector<const double*> slots_;
+    };
+
+    struct Bracket {
+        double a;
+        double b;
+        double fa;
+        double fb;
+    };
+
+    // Метод Брента (zeroin) на отрезке со сменой знака; false — бюджет
+    // итераций исчерпан
+    template <typename F>
+    bool brent(const F& f, Bracket bracket, double& root, size_t& evaluations) {
+        double a = bracket.a;
+        double b = bracket.b;
+        double fa = bracket.fa;
+        double fb = bracket.fb;
+        double c = b;
+        double fc = fb;
+        double d = b - a;
+        double e = d;
+        for (size_t iteration = 0; iteration < MAX_ITERATIONS; ++iteration) {
+            if ((fb > 0.0) == (fc > 0.0)) {
+                c = a;
+                fc = fa;
+                d = b - a;
+                e = d;
+            }
+            if (std::abs(fc) < std::abs(fb)) {
+                a = b;
+                b = c;
+                c = a;
+                fa = fb;
+                fb = fc;
+                fc = fa;
+            }
+            double tolerance = 2.0 * EPSILON * std::abs(b) + std::numeric_limits<double>::min();
+            double middle = 0.5 * (c - b);
+            if (std::abs(middle) <= tolerance || fb == 0.0) {
+                root = b;
+                return true;
+            }
+            if (std::abs(e) >= tolerance && std::abs(fa) > std::abs(fb)) {
+                // Обратная квадратичная интерполяция или секущая
+                double s = fb / fa;
+                double p;
+                double q;
+                if (a == c) {
+                    p = 2.0 * middle * s;
+                    q = 1.0 - s;
+                } else {
+                    double r = fb / fc;
+                    q = fa / fc;
+                    p = s * (2.0 * middle * q * (q - r) - (b - a) * (r - 1.0));
+                    q = (q - 1.0) * (r - 1.0) * (s - 1.0);
+                }
+                if (p > 0.0) {
+                    q = -q;
+                } else {
+                    p = -p;
+                }
+                if (2.0 * p < std::min(3.0 * middle * q - std::abs(tolerance * q), std::abs(e * q))) {
+                    e = d;
+                    d = p / q;
+                } else {
+                    d = middle;
+                    e = d;
+                }
+            } else {
+                d = middle;
+                e = d;
+            }
+            a = b;
+            fa = fb;
+            b += std::abs(d) > tolerance ? d : (middle > 0.0 ? tolerance : -tolerance);
+            fb = f(b);
+            ++evaluations;
+        }
+        return false;
+    }
+}
+
+std::vector<double> findRoots(const SolveNode& node, size_t threads) {
+    if (!node.body() || !node.cell() || !node.lower() || !node.upper()) {
+        throw EvalError("Invalid operands: null pointer");
+    }
+    double lo = node.lower()->evaluate();
+    double hi = node.upper()->evaluate();
+    if (!(lo < hi) || !std::isfinite(hi - lo)) {
+        throw EvalError("Invalid interval in solve()");
+    }
+
+    // Прогресс: первая половина — просмотр сетки, вторая — уточнение корней
+    ProgressStage stage;
+    Equation f(node);
+    if (!f.compiled()) {
+        threads = 1;
+    }
+
+    // Просмотр: значения на равномерной сетке пакетами
+    std::vector<double> xs(SCAN_INTERVALS + 1);
+    for (size_t k = 0; k < SCAN_INTERVALS; ++k) {
+        xs[k] = lo + (hi - lo) * (static_cast<double>(k) / SCAN_INTERVALS);
+    }
+    xs[SCAN_INTERVALS] = hi;
+    std::vector<double> values(xs.size());
+    f.scan(xs.data(), xs.size(), values.data(), threads, stage);
+    stage.report(1, 2);
+
+    SolveReport report;
+    report.evaluations = xs.size();
+    std::vector<double> exact;
+    std::vector<Bracket> brackets;
+    for (size_t k = 0; k < xs.size(); ++k) {
+        if (values[k] == 0.0) {
+            exact.push_back(xs[k]);
+        }
+        if (k + 1 < xs.size() && std::isfinite(values[k]) && std::isfinite(values[k + 1]) &&
+            (values[k] < 0.0) != (values[k + 1] < 0.0) && values[k] != 0.0 && values[k + 1] != 0.0) {
+            brackets.push_back(Bracket{xs[k], xs[k + 1], values[k], values[k + 1]});
+        }
+    }
+    report.brackets = brackets.size();
+
+    // Уточнение: отрезки независимы и раздаются потокам
+    std::vector<double> refined(brackets.size(), NO_ROOT);
+    std::vector<size_t> evaluations(brackets.size(), 0);
+    std::vector<char> exhausted(brackets.size(), 0);
+    size_t tasks = (brackets.size() + BRACKETS_PER_TASK - 1) / BRACKETS_PER_TASK;
+    std::atomic<size_t> done{0};
+    parallelFor(tasks, [&](size_t task) {
+        stage.report(tasks + done.fetch_add(1, std::memory_order_relaxed), 2 * tasks);
+        std::vector<const double*> slots = f.slots();
+        auto function = [&](double x) { return f(x, &slots); };
+        size_t end = std::min(brackets.size(), (task + 1) * BRACKETS_PER_TASK);
+        for (size_t i = task * BRACKETS_PER_TASK; i < end; ++i) {
+            const Bracket& bracket = brackets[i];
+            double root = NO_ROOT;
+            double value;
+            try {
+                if (!brent(function, bracket, root, evaluations[i])) {
+                    exhausted[i] = 1;
+                    continue;
+                }
+                value = function(root);
+                ++evaluations[i];
+            } catch (const EvalError&) {
+                // Функция не определена внутри отрезка: корня со сменой знака нет
+                continue;
+            }
+            // У полюса (1/x) знак меняется, но |f| растёт к точке смены
+            if (std::abs(value) <= std::max(std::abs(bracket.fa), std::abs(bracket.fb))) {
+                refined[i] = root;
+            }
+        }
+    }, threads);
+    stage.report(1, 1);
+
+    if (std::find(exhausted.begin(), exhausted.end(), 1) != exhausted.end()) {
+        throw EvalError("solve() did not converge in " + std::to_string(MAX_ITERATIONS) + " iterations");
+    }
+
+    std::vector<double> roots = exact;
+    for (size_t i = 0; i < brackets.size(); ++i) {
+        report.evaluations += evaluations[i];
+        if (!std::isnan(refined[i])) {
+            roots.push_back(refined[i]);
+        }
+    }
+    std::sort(roots.begin(), roots.end());
+    report.roots = roots;
+    node.setReport(std::move(report));
+    return roots;
+}
+
+double evaluateSolve(const SolveNode& node, size_t threads) {
+    double index = 1.0;
+    if (node.index()) {
+        index = node.index()->evaluate();
+        if (index < 1.0 || index != std::floor(index)) {
+            throw EvalError("Root index of solve() must be a positive integer");
+        }
+    }
+    std::vector<double> roots = findRoots(node, threads);
+    if (roots.empty()) {
+        throw EvalError("solve() found no root in the interval");
+    }
+    if (index > static_cast<double>(roots.size())) {
+        throw EvalError("solve() found only " + std::to_string(roots.size()) + " root(s) in the interval");
+    }
+    return roots[static_cast<size_t>(index) - 1];
+}
+
+} // namespace calc
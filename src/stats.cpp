@@ -0,0 +1,467 @@
+#include "stats.hpp"
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "format.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+    // Счётчик выделений текущего потока; nullptr — замер не идёт
+    thread_local calc::AllocationScope* currentScope = nullptr;
+}
+
+namespace calc {
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    double secondsSince(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Число узлов и высота дерева; обход без рекурсии, чтобы глубокие
+    // деревья не упирались в стек
+    void measureTree(const Node* root, size_t& nodes, size_t& depth) {
+        nodes = 0;
+        depth = 0;
+        std::vector<std::pair<const Node*, size_t>> pending = {{root, 1}};
+        while (!pending.empty()) {
+            auto [node, level] = pending.back();
+            pending.pop_back();
+            ++nodes;
+            depth = std::max(depth, level);
+            for (size_t i = 0; i < node->childCount(); ++i) {
+                pending.push_back({node->child(i), level + 1});
+            }
+        }
+    }
+
+    std::string formatNanos(double nanos) {
+        char buf[32];
+        if (nanos < 1e3) {
+            std::snprintf(buf, sizeof(buf), "%.0f ns", nanos);
+        } else if (nanos < 1e6) {
+            std::snprintf(buf, sizeof(buf), "%.1f us", nanos / 1e3);
+        } else if (nanos < 1e9) {
+            std::snprintf(buf, sizeof(buf), "%.1f ms", nanos / 1e6);
+        } else {
+            std::snprintf(buf, sizeof(buf), "%.2f s", nanos / 1e9);
+        }
+        return buf;
+    }
+
+    std::string formatBytes(double bytes) {
+        char buf[32];
+        if (bytes < 1024) {
+            std::snprintf(buf, sizeof(buf), "%.0f B", bytes);
+        } else if (bytes < 1024 * 1024) {
+            std::snprintf(buf, sizeof(buf), "%.1f KB", bytes / 1024);
+        } else {
+            std::snprintf(buf, sizeof(buf), "%.1f MB", bytes / (1024 * 1024));
+        }
+        return buf;
+    }
+
+    std::string formatCount(double count) {
+        char buf[32];
+        std::snprintf(buf, sizeof(buf), "%.0f", count);
+        return buf;
+    }
+
+    struct Metric {
+        const char* label;
+        const Histogram* histogram;
+        std::string (*format)(double);
+        bool timed;                 // Время фазы: с гистограммой в текстовом отчёте
+    };
+
+    // В JSON нет inf и nan: такие значения пишутся как null
+    void appendJsonNumber(std::string& out, double value) {
+        if (std::isfinite(value)) {
+            appendNumber(out, value);
+        } else {
+            out += "null";
+        }
+    }
+
+    void appendJsonHistogram(std::string& out, const Histogram& histogram) {
+        out += "{\"count\":";
+        appendNumber(out, static_cast<double>(histogram.count()));
+        const std::pair<const char*, double> fields[] = {
+            {"min", histogram.min()},
+            {"mean", histogram.mean()},
+            {"p50", histogram.quantile(0.5)},
+            {"p90", histogram.quantile(0.9)},
+            {"p99", histogram.quantile(0.99)},
+            {"max", histogram.max()},
+        };
+        for (const auto& [name, value] : fields) {
+            out += ",\"";
+            out += name;
+            out += "\":";
+            appendJsonNumber(out, value);
+        }
+        out += ",\"buckets\":[";
+        bool first = true;
+        for (size_t i = 0; i < Histogram::BUCKETS; ++i) {
+            if (histogram.bucket(i) == 0) {
+                continue;
+            }
+            out += first ? "" : ",";
+            out += "{\"low\":";
+            appendNumber(out, Histogram::bucketLow(i));
+            out += ",\"count\":";
+            appendNumber(out, static_cast<double>(histogram.bucket(i)));
+            out += '}';
+            first = false;
+        }
+        out += "]}";
+    }
+}
+
+AllocationScope::AllocationScope() : previous_(currentScope) {
+    currentScope = this;
+}
+
+AllocationScope::~AllocationScope() {
+    currentScope = previous_;
+    // Выделения вложенного замера входят и во внешний
+    if (previous_) {
+        previous_->bytes_ += bytes_;
+        previous_->count_ += count_;
+    }
+}
+
+void AllocationScope::record(size_t size) {
+    if (AllocationScope* scope = currentScope) {
+        scope->bytes_ += size;
+        ++scope->count_;
+    }
+}
+
+size_t peakResidentBytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<size_t>(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss);            // Байты
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024;     // Килобайты
+#endif
+#endif
+}
+
+double profileExpression(std::string_view expression, const Variables& variables, const BatchOptions& options,
+                         ExpressionStats& stats) {
+    stats = ExpressionStats();
+    AllocationScope total;
+    // Фаза, в которой вылетело исключение, тоже попадает в stats
+    struct Finish {
+        ExpressionStats& stats;
+        AllocationScope& total;
+        bool done = false;
+        ~Finish() {
+            stats.allocatedBytes = total.bytes();
+            stats.allocations = total.count();
+            stats.failed = !done;
+        }
+    } finish{stats, total};
+
+    Clock::time_point start = Clock::now();
+    std::vector<Token> tokens;
+    try {
+        Lexer lexer(expression);
+        tokens = lexer.tokenize();
+    } catch (...) {
+        stats.lexSeconds = secondsSince(start);
+        throw;
+    }
+    stats.lexSeconds = secondsSince(start);
+    stats.lexed = true;
+    stats.tokens = tokens.empty() ? 0 : tokens.size() - 1;
+
+    std::unique_ptr<Node> ast;
+    {
+        AllocationScope parsing;
+        start = Clock::now();
+        try {
+            Parser parser(std::move(tokens), &variables);
+            ast = parser.parse();
+        } catch (...) {
+            stats.parseSeconds = secondsSince(start);
+            throw;
+        }
+        stats.parseSeconds = secondsSince(start);
+        stats.astBytes = parsing.bytes();
+    }
+    stats.parsed = true;
+    measureTree(ast.get(), stats.nodes, stats.depth);
+
+    if (options.optimize) {
+        start = Clock::now();
+        Optimizer optimizer(options.optimizer);
+        ast = optimizer.optimize(std::move(ast));
+        stats.optimizeSeconds = secondsSince(start);
+        stats.optimized = true;
+        size_t depth = 0;
+        measureTree(ast.get(), stats.optimizedNodes, depth);
+        stats.depth = depth;
+    }
+
+    stats.evaluated = true;
+    start = Clock::now();
+    double value = 0.0;
+    try {
+        value = Evaluator(options.mode).evaluate(ast);
+    } catch (...) {
+        stats.evaluateSeconds = secondsSince(start);
+        throw;
+    }
+    stats.evaluateSeconds = secondsSince(start);
+    finish.done = true;
+    return value;
+}
+
+void Histogram::add(double value) {
+    size_t index = 0;
+    if (value >= 1.0) {
+        int exponent = 0;
+        double mantissa = std::frexp(value, &exponent);     // value = m * 2^exponent, m в [0.5, 1)
+        size_t octave = std::min<size_t>(static_cast<size_t>(exponent - 1), OCTAVES - 1);
+        size_t sub = std::min<size_t>(static_cast<size_t>((mantissa * 2.0 - 1.0) * SUB_BUCKETS),
+                                      SUB_BUCKETS - 1);
+        index = 1 + octave * SUB_BUCKETS + sub;
+    }
+    ++buckets_[index];
+    min_ = count_ == 0 ? value : std::min(min_, value);
+    max_ = count_ == 0 ? value : std::max(max_, value);
+    sum_ += value;
+    ++count_;
+}
+
+void Histogram::merge(const Histogram& other) {
+    if (other.count_ == 0) {
+        return;
+    }
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        buckets_[i] += other.buckets_[i];
+    }
+    min_ = count_ == 0 ? other.min_ : std::min(min_, other.min_);
+    max_ = count_ == 0 ? other.max_ : std::max(max_, other.max_);
+    sum_ += other.sum_;
+    count_ += other.count_;
+}
+
+double Histogram::bucketLow(size_t index) {
+    if (index == 0) {
+        return 0.0;
+    }
+    size_t octave = (index - 1) / SUB_BUCKETS;
+    size_t sub = (index - 1) % SUB_BUCKETS;
+    return std::ldexp(1.0 + static_cast<double>(sub) / SUB_BUCKETS, static_cast<int>(octave));
+}
+
+double Histogram::quantile(double q) const {
+    if (count_ == 0) {
+        return 0.0;
+    }
+    double rank = q * static_cast<double>(count_);
+    double seen = 0.0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        if (buckets_[i] == 0) {
+            continue;
+        }
+        if (seen + buckets_[i] >= rank) {
+            // Линейно внутри корзины, в пределах наблюдавшихся min и max
+            double low = std::max(bucketLow(i), min_);
+            double high = std::min(i + 1 < BUCKETS ? bucketLow(i + 1) : max_, max_);
+            double share = (rank - seen) / static_cast<double>(buckets_[i]);
+            return low + (high - low) * share;
+        }
+        seen += static_cast<double>(buckets_[i]);
+    }
+    return max_;
+}
+
+void StatsCollector::add(const ExpressionStats& stats) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ++expressions_;
+    if (stats.failed) {
+        ++errors_;
+    }
+    if (stats.lexed) {
+        lex_.add(stats.lexSeconds * 1e9);
+        tokens_.add(static_cast<double>(stats.tokens));
+    }
+    if (stats.parsed) {
+        parse_.add(stats.parseSeconds * 1e9);
+        nodes_.add(static_cast<double>(stats.nodes));
+        depth_.add(static_cast<double>(stats.depth));
+        astBytes_.add(static_cast<double>(stats.astBytes));
+    }
+    if (stats.optimized) {
+        optimize_.add(stats.optimizeSeconds * 1e9);
+        optimizedNodes_.add(static_cast<double>(stats.optimizedNodes));
+    }
+    if (stats.evaluated) {
+        evaluate_.add(stats.evaluateSeconds * 1e9);
+    }
+    allocated_.add(static_cast<double>(stats.allocatedBytes));
+    allocations_.add(static_cast<double>(stats.allocations));
+}
+
+std::string StatsCollector::text() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out;
+    char line[160];
+    std::string peak = formatBytes(static_cast<double>(peakResidentBytes()));
+
+    if (expressions_ == 1) {
+        // Одно выражение: значения без распределений
+        out += errors_ > 0 ? "Stats: 1 expression (failed)\n" : "Stats: 1 expression\n";
+        if (lex_.count() > 0) {
+            std::snprintf(line, sizeof(line), "  lex       %10s   %s tokens\n",
+                          formatNanos(lex_.max()).c_str(), formatCount(tokens_.max()).c_str());
+            out += line;
+        }
+        if (parse_.count() > 0) {
+            std::snprintf(line, sizeof(line), "  parse     %10s   %s nodes, depth %s, %s of AST\n",
+                          formatNanos(parse_.max()).c_str(), formatCount(nodes_.max()).c_str(),
+                          formatCount(depth_.max()).c_str(), formatBytes(astBytes_.max()).c_str());
+            out += line;
+        }
+        if (optimize_.count() > 0) {
+            std::snprintf(line, sizeof(line), "  optimize  %10s   %s nodes\n",
+                          formatNanos(optimize_.max()).c_str(), formatCount(optimizedNodes_.max()).c_str());
+            out += line;
+        }
+        if (evaluate_.count() > 0) {
+            std::snprintf(line, sizeof(line), "  evaluate  %10s\n", formatNanos(evaluate_.max()).c_str());
+            out += line;
+        }
+        std::snprintf(line, sizeof(line), "  memory    %10s   in %s allocations, peak RSS %s\n",
+                      formatBytes(allocated_.max()).c_str(), formatCount(allocations_.max()).c_str(),
+                      peak.c_str());
+        out += line;
+        return out;
+    }
+
+    std::snprintf(line, sizeof(line), "Stats: %zu expressions, %zu errors, peak RSS %s\n",
+                  expressions_, errors_, peak.c_str());
+    out += line;
+    std::snprintf(line, sizeof(line), "  %-12s %10s %10s %10s %10s %10s %10s\n",
+                  "", "min", "p50", "p90", "p99", "max", "mean");
+    out += line;
+    const Metric metrics[] = {
+        {"lex", &lex_, formatNanos, true},
+        {"parse", &parse_, formatNanos, true},
+        {"optimize", &optimize_, formatNanos, true},
+        {"evaluate", &evaluate_, formatNanos, true},
+        {"tokens", &tokens_, formatCount, false},
+        {"nodes", &nodes_, formatCount, false},
+        {"depth", &depth_, formatCount, false},
+        {"AST", &astBytes_, formatBytes, false},
+        {"allocated", &allocated_, formatBytes, false},
+    };
+    for (const Metric& metric : metrics) {
+        const Histogram& h = *metric.histogram;
+        if (h.count() == 0) {
+            continue;
+        }
+        std::snprintf(line, sizeof(line), "  %-12s %10s %10s %10s %10s %10s %10s\n", metric.label,
+                      metric.format(h.min()).c_str(), metric.format(h.quantile(0.5)).c_str(),
+                      metric.format(h.quantile(0.9)).c_str(), metric.format(h.quantile(0.99)).c_str(),
+                      metric.format(h.max()).c_str(), metric.format(h.mean()).c_str());
+        out += line;
+    }
+    for (const Metric& metric : metrics) {
+        const Histogram& h = *metric.histogram;
+        if (!metric.timed || h.count() == 0) {
+            continue;
+        }
+        // Строка на октаву: корзины внутри октавы складываются
+        std::vector<size_t> octaves(1 + Histogram::OCTAVES, 0);
+        for (size_t i = 0; i < Histogram::BUCKETS; ++i) {
+            octaves[i == 0 ? 0 : 1 + (i - 1) / Histogram::SUB_BUCKETS] += h.bucket(i);
+        }
+        size_t largest = *std::max_element(octaves.begin(), octaves.end());
+        std::snprintf(line, sizeof(line), "%s time:\n", metric.label);
+        out += line;
+        for (size_t k = 0; k < octaves.size(); ++k) {
+            if (octaves[k] == 0) {
+                continue;
+            }
+            double low = k == 0 ? 0.0 : std::ldexp(1.0, static_cast<int>(k) - 1);
+            std::string bar(std::max<size_t>(1, octaves[k] * 40 / largest), '#');
+            std::snprintf(line, sizeof(line), "  >= %10s %10zu  %s\n", formatNanos(low).c_str(), octaves[k],
+                          bar.c_str());
+            out += line;
+        }
+    }
+    return out;
+}
+
+std::string StatsCollector::json() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string out = "{\"expressions\":";
+    appendNumber(out, static_cast<double>(expressions_));
+    out += ",\"errors\":";
+    appendNumber(out, static_cast<double>(errors_));
+    out += ",\"peak_rss_bytes\":";
+    appendNumber(out, static_cast<double>(peakResidentBytes()));
+    out += ",\"metrics\":{";
+    const std::pair<const char*, const Histogram*> metrics[] = {
+        {"lex_ns", &lex_},
+        {"parse_ns", &parse_},
+        {"optimize_ns", &optimize_},
+        {"evaluate_ns", &evaluate_},
+        {"tokens", &tokens_},
+        {"nodes", &nodes_},
+        {"optimized_nodes", &optimizedNodes_},
+        {"depth", &depth_},
+        {"ast_bytes", &astBytes_},
+        {"allocated_bytes", &allocated_},
+        {"allocations", &allocations_},
+    };
+    bool first = true;
+    for (const auto& [key, histogram] : metrics) {
+        if (histogram->count() == 0) {
+            continue;
+        }
+        out += first ? "\"" : ",\"";
+        out += key;
+        out += "\":";
+        appendJsonHistogram(out, *histogram);
+        first = false;
+    }
+    out += "}}";
+    return out;
+}
+
+} // namespace calc
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "batch.hpp"
+#include "variables.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace calc {
+
+/**
+ * @brief Замер одного выражения по фазам
+ *
+ * Фазы, до которых вычисление не дошло (ошибка разбора), остаются с
+ * флагом false и нулевыми значениями.
+ */
+struct ExpressionStats {
+    double lexSeconds = 0.0;
+    double parseSeconds = 0.0;
+    double optimizeSeconds = 0.0;
+    double evaluateSeconds = 0.0;
+    size_t tokens = 0;              // Без завершающего End
+    size_t nodes = 0;               // Узлов после разбора
+    size_t optimizedNodes = 0;      // Узлов после оптимизатора
+    size_t depth = 0;               // Высота дерева — глубина рекурсии evaluate
+    size_t astBytes = 0;            // Выделено при разборе: узлы и имена
+    size_t allocatedBytes = 0;      // Выделено всеми фазами
+    size_t allocations = 0;
+    bool lexed = false;
+    bool parsed = false;
+    bool optimized = false;
+    bool evaluated = false;         // Дошло до вычисления (возможно, с ошибкой)
+    bool failed = false;
+};
+
+/**
+ * @brief Вычислить выражение, замеряя фазы
+ *
+ * То же, что Lexer → Parser → (Optimizer) → evaluate, но с замером
+ * времени каждой фазы, подсчётом токенов, узлов и выделений памяти.
+ * Ошибки выбрасываются как обычно (ParseError/EvalError); stats к этому
+ * моменту заполнен пройденными фазами и failed.
+ */
+double profileExpression(std::string_view expression, const Variables& variables, const BatchOptions& options,
+                         ExpressionStats& stats);
+
+/**
+ * @brief Счётчик выделений памяти текущего потока
+ *
+ * Пока объект жив, глобальный operator new этого потока добавляет в него
+ * размер каждого выделения. Вне замеров operator new проверяет только
+ * указатель потока, поэтому без --stats подсчёт ничего не стоит.
+ * Замена operator new — в allocation_hook.cpp, который компонуется только
+ * в программы; в libcalc счётчик остаётся нулевым.
+ */
+class AllocationScope {
+public:
+    AllocationScope();
+    ~AllocationScope();
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+
+    size_t bytes() const { return bytes_; }
+    size_t count() const { return count_; }
+
+    static void record(size_t size);
+
+private:
+    AllocationScope* previous_;
+    size_t bytes_ = 0;
+    size_t count_ = 0;
+};
+
+/**
+ * @brief Наибольший резидентный объём процесса в байтах (0 — неизвестно)
+ */
+size_t peakResidentBytes();
+
+/**
+ * @brief Логарифмическая гистограмма
+ *
+ * Корзина 0 — значения меньше 1, дальше каждая октава [2^e, 2^(e+1))
+ * делится на SUB_BUCKETS равных корзин. Квантили интерполируются внутри
+ * корзины, поэтому точны до 1/SUB_BUCKETS значения.
+ */
+class Histogram {
+public:
+    static constexpr size_t SUB_BUCKETS = 8;
+    static constexpr size_t OCTAVES = 64;
+    static constexpr size_t BUCKETS = 1 + OCTAVES * SUB_BUCKETS;
+
+    void add(double value);
+    void merge(const Histogram& other);
+
+    size_t count() const { return count_; }
+    double min() const { return count_ > 0 ? min_ : 0.0; }
+    double max() const { return count_ > 0 ? max_ : 0.0; }
+    double mean() const { return count_ > 0 ? sum_ / count_ : 0.0; }
+    double quantile(double q) const;
+
+    size_t bucket(size_t index) const { return buckets_[index]; }
+    static double bucketLow(size_t index);
+
+private:
+    std::array<size_t, BUCKETS> buckets_{};
+    size_t count_ = 0;
+    double sum_ = 0.0;
+    double min_ = 0.0;
+    double max_ = 0.0;
+};
+
+/**
+ * @brief Сводка замеров многих выражений (пакетный режим)
+ *
+ * add потокобезопасен: рабочие потоки конвейера пишут в одну сводку.
+ * Времена хранятся в наносекундах.
+ */
+class StatsCollector {
+public:
+    void add(const ExpressionStats& stats);
+
+    size_t expressions() const { return expressions_; }
+    size_t errors() const { return errors_; }
+
+    const Histogram& lexNanos() const { return lex_; }
+    const Histogram& parseNanos() const { return parse_; }
+    const Histogram& optimizeNanos() const { return optimize_; }
+    const Histogram& evaluateNanos() const { return evaluate_; }
+    const Histogram& tokens() const { return tokens_; }
+    const Histogram& nodes() const { return nodes_; }
+    const Histogram& depth() const { return depth_; }
+    const Histogram& astBytes() const { return astBytes_; }
+    const Histogram& allocatedBytes() const { return allocated_; }
+
+    /**
+     * @brief Отчёт для человека: значения одного выражения или
+     * распределения (min/p50/p90/p99/max) и гистограммы времён фаз
+     */
+    std::string text() const;
+
+    /**
+     * @brief Тот же отчёт одним объектом JSON
+     */
+    std::string json() const;
+
+private:
+    mutable std::mutex mutex_;
+    size_t expressions_ = 0;
+    size_t errors_ = 0;
+    Histogram lex_;
+    Histogram parse_;
+    Histogram optimize_;
+    Histogram evaluate_;
+    Histogram tokens_;
+    Histogram nodes_;
+    Histogram optimizedNodes_;
+    Histogram depth_;
+    Histogram astBytes_;
+    Histogram allocated_;
+    Histogram allocations_;
+};
+
+} // namespace calc
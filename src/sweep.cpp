@@ -0,0 +1,183 @@
+#include "sweep.hpp"
+#include "program.hpp"
+#include "optimizer.hpp"
+#include "cancellation.hpp"
+#include "ast/variable.hpp"
+#include "error.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace calc {
+
+namespace {
+    // Точек в одном блоке пакетного вычисления
+    constexpr size_t CHUNK = 1024;
+
+    // Больше точек не перечислить за разумное время
+    constexpr double MAX_POINTS = 1e12;
+
+    // Допуск на округление шага при включении stop (в долях шага)
+    constexpr double STOP_TOLERANCE = 1e-9;
+
+    // Подстановка значений максимальных независимых поддеревьев; поддерево,
+    // вычисление которого даёт ошибку, выносится по частям
+    void hoist(const Node* node, const std::unordered_set<const Node*>& dependent,
+               Program::Substitutions& substitutions, SweepReport& report) {
+        if (!node) {
+            return;
+        }
+        if (dependent.count(node) == 0) {
+            try {
+                substitutions.emplace(node, node->evaluate());
+                if (node->childCount() > 0) {
+                    ++report.hoistedSubtrees;
+                    report.hoistedNodes += countNodes(node);
+                }
+                return;
+            } catch (const EvalError&) {
+                // Ошибка должна возникнуть в тех точках, где поддерево вычисляется
+            }
+        }
+        for (size_t i = 0; i < node->childCount(); ++i) {
+            hoist(node->child(i), dependent, substitutions, report);
+        }
+    }
+
+    // Восстанавливает ячейку переменной табулирования после run()
+    class CellGuard {
+    public:
+        explicit CellGuard(double* cell) : cell_(cell), saved_(cell ? *cell : 0.0) {}
+        ~CellGuard() {
+            if (cell_) {
+                *cell_ = saved_;
+            }
+        }
+        CellGuard(const CellGuard&) = delete;
+        CellGuard& operator=(const CellGuard&) = delete;
+
+    private:
+        double* cell_;
+        double saved_;
+    };
+}
+
+Sweep::Sweep(const Node& root, std::string variable, vecmath::Accuracy accuracy)
+    : root_(root), variable_(std::move(variable)), accuracy_(accuracy) {
+    markDependent(&root_);
+}
+
+bool Sweep::markDependent(const Node* node) {
+    if (!node) {
+        return false;
+    }
+    bool dependent = false;
+    if (const auto* var = dynamic_cast<const VariableNode*>(node)) {
+        dependent = var->name() == variable_;
+    }
+    // Обходятся все дети: их зависимость понадобится при выносе
+    for (size_t i = 0; i < node->childCount(); ++i) {
+        if (markDependent(node->child(i))) {
+            dependent = true;
+        }
+    }
+    if (dependent) {
+        dependent_.insert(node);
+    }
+    return dependent;
+}
+
+SweepReport Sweep::run(double start, double stop, double step, const Variables& variables,
+                       const SweepSink& sink) const {
+    if (!std::isfinite(start) || !std::isfinite(stop) || !std::isfinite(step) || step == 0.0) {
+        throw EvalError("Invalid sweep range");
+    }
+    double span = (stop - start) / step;
+    if (span < 0.0) {
+        throw EvalError("Sweep step points away from stop");
+    }
+    if (!(span < MAX_POINTS)) {
+        throw EvalError("Too many sweep points");
+    }
+    size_t count = static_cast<size_t>(std::floor(span + STOP_TOLERANCE)) + 1;
+
+    SweepReport report;
+    report.nodes = countNodes(&root_);
+    report.dependentNodes = dependent_.size();
+
+    Program::Substitutions substitutions;
+    hoist(&root_, dependent_, substitutions, report);
+    Program program;
+    bool compiled = false;
+    try {
+        program = Program::compile(root_, {variable_}, substitutions);
+        compiled = true;
+    } catch (const EvalError&) {
+        // sum/integrate/solve: вычисление деревом в каждой точке
+        report.hoistedSubtrees = 0;
+        report.hoistedNodes = 0;
+    }
+    ProgramView view = program.view();
+
+    // Столбец 0 — переменная табулирования; прочие переменные остаются в
+    // программе только внутри невынесенных поддеревьев и постоянны
+    std::vector<double> xs(CHUNK);
+    std::vector<double> results(CHUNK);
+    std::vector<std::vector<double>> constantColumns(view.variableCount());
+    std::vector<const double*> columns(view.variableCount(), nullptr);
+    if (compiled) {
+        columns[0] = xs.data();
+    }
+    for (size_t v = 1; v < view.variableCount(); ++v) {
+        if (const double* slot = variables.find(std::string(view.variableName(v)))) {
+            constantColumns[v].assign(CHUNK, *slot);
+            columns[v] = constantColumns[v].data();
+        }
+    }
+
+    // Дерево читает переменную из её ячейки в таблице, с которой разобрано
+    double* cell = compiled ? nullptr : const_cast<double*>(variables.find(variable_));
+    CellGuard guard(cell);
+
+    ProgressStage stage;
+    std::vector<BatchError> errors;
+    for (size_t offset = 0; offset < count; offset += CHUNK) {
+        stage.report(offset, count);
+        size_t n = std::min(CHUNK, count - offset);
+        for (size_t k = 0; k < n; ++k) {
+            xs[k] = start + static_cast<double>(offset + k) * step;
+        }
+        errors.clear();
+        if (compiled) {
+            report.errors += view.evaluateBatch(columns.data(), n, results.data(), &errors, accuracy_);
+        } else {
+            for (size_t k = 0; k < n; ++k) {
+                if (cell) {
+                    *cell = xs[k];
+                }
+                try {
+                    results[k] = root_.evaluate();
+                } catch (const EvalError& e) {
+                    results[k] = std::numeric_limits<double>::quiet_NaN();
+                    errors.push_back({k, e.what()});
+                    ++report.errors;
+                }
+            }
+        }
+
+        size_t next = 0;
+        for (size_t k = 0; k < n; ++k) {
+            if (next < errors.size() && errors[next].index == k) {
+                sink(xs[k], results[k], &errors[next].message);
+                ++next;
+            } else {
+                sink(xs[k], results[k], nullptr);
+            }
+        }
+    }
+    report.points = count;
+    return report;
+}
+
+} // namespace calc
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "ast/node.hpp"
+#include "variables.hpp"
+#include "vecmath.hpp"
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <unordered_set>
+
+namespace calc {
+
+/**
+ * @brief Итог табулирования
+ */
+struct SweepReport {
+    size_t nodes = 0;             // Узлов в дереве
+    size_t dependentNodes = 0;    // Узлов, зависящих от переменной
+    size_t hoistedSubtrees = 0;   // Независимых поддеревьев, вычисленных один раз
+    size_t hoistedNodes = 0;      // Узлов в этих поддеревьях
+    size_t points = 0;
+    size_t errors = 0;
+};
+
+/**
+ * @brief Получатель точек табулирования
+ *
+ * error == nullptr — в точке x получено значение value, иначе error —
+ * сообщение, которое выбросило бы вычисление дерева (value — NaN).
+ */
+using SweepSink = std::function<void(double x, double value, const std::string* error)>;
+
+/**
+ * @brief Табулирование выражения по одной переменной
+ *
+ * При создании узлы дерева делятся на зависящие от переменной («ось»)
+ * и независимые. run() вычисляет каждое максимальное независимое
+ * поддерево один раз, при текущих значениях остальных переменных,
+ * компилирует ось с подставленными значениями в Program и вычисляет её
+ * блоками точек (ProgramView::evaluateBatch). Точки передаются
+ * получателю по мере вычисления и не накапливаются. Выражения с
+ * sum/prod/integrate/solve не компилируются и вычисляются деревом в
+ * каждой точке (переменная записывается в свою ячейку таблицы и
+ * восстанавливается после run()).
+ *
+ * Значения и ошибки в каждой точке совпадают с вычислением дерева (при
+ * accuracy = Libm; Ulp1/Ulp4 ускоряют функции ценой отличий в младших
+ * разрядах). Независимое поддерево, вычисление которого даёт ошибку (например, в
+ * ветви, выбираемой не во всех точках), не выносится.
+ */
+class Sweep {
+public:
+    /**
+     * @param root     Дерево; должно жить дольше объекта
+     * @param variable Переменная табулирования (объявлена в таблице,
+     *                 с которой разобрано дерево)
+     * @param accuracy Точность функций при пакетном вычислении оси
+     */
+    Sweep(const Node& root, std::string variable,
+          vecmath::Accuracy accuracy = vecmath::Accuracy::Libm);
+
+    /**
+     * @brief Точки start + k * step, k = 0, 1, ..., не дальше stop
+     *
+     * stop включается с допуском на округление шага. Нулевой или
+     * направленный от stop шаг и бесконечные границы — EvalError.
+     * Значения остальных переменных берутся из variables. Между блоками
+     * проверяется отмена (CancellationScope) и сообщается прогресс.
+     */
+    SweepReport run(double start, double stop, double step, const Variables& variables,
+                    const SweepSink& sink) const;
+
+    const std::string& variable() const { return variable_; }
+
+private:
+    bool markDependent(const Node* node);
+
+    const Node& root_;
+    std::string variable_;
+    vecmath::Accuracy accuracy_;
+    std::unordered_set<const Node*> dependent_;
+};
+
+} // namespace calc
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace calc {
+
+/**
+ * @brief Таблица переменных выражения
+ *
+ * Каждой переменной соответствует ячейка со стабильным адресом:
+ * узлы AST хранят указатель на неё, поэтому значение можно менять
+ * между вычислениями без повторного разбора выражения.
+ */
+class Variables {
+public:
+    /**
+     * @brief Получить ячейку переменной, создав её (со значением 0) при необходимости
+     */
+    double* bind(const std::string& name) {
+        auto it = values_.find(name);
+        if (it == values_.end()) {
+            it = values_.emplace(name, 0.0).first;
+            names_.push_back(name);
+        }
+        return &it->second;
+    }
+    
+    /**
+     * @brief Найти ячейку переменной (nullptr, если переменная не объявлена)
+     */
+    const double* find(const std::string& name) const {
+        auto it = values_.find(name);
+        return it == values_.end() ? nullptr : &it->second;
+    }
+    
+    void set(const std::string& name, double value) {
+        *bind(name) = value;
+    }
+    
+    /**
+     * @brief Имена переменных в порядке объявления
+     */
+    const std::vector<std::string>& names() const { return names_; }
+    
+private:
+    // Ссылки на элементы unordered_map не инвалидируются при рехешировании
+    std::unordered_map<std::string, double> values_;
+    std::vector<std::string> names_;
+};
+
+} // namespace calc
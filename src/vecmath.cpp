@@ -0,0 +1,605 @@
+#include "vecmath.hpp"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace calc {
+namespace vecmath {
+
+namespace {
+
+// Все ядра ниже — функции без ветвлений от одного аргумента: циклы в
+// mapBlocks разворачиваются в векторный код. Целочисленные операции
+// ограничены сложением и логическими сдвигами uint64, которые есть в SSE2;
+// преобразование int <-> double делается через "магическую" константу SHIFT.
+
+constexpr double SHIFT = 6755399441055744.0;  // 1.5 * 2^52
+constexpr double NaN = std::numeric_limits<double>::quiet_NaN();
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+inline uint64_t toBits(double x) {
+    uint64_t u;
+    std::memcpy(&u, &x, sizeof(u));
+    return u;
+}
+
+inline double fromBits(uint64_t u) {
+    double x;
+    std::memcpy(&x, &u, sizeof(x));
+    return x;
+}
+
+// Округление до ближайшего целого (|x| < 2^51)
+inline double roundShift(double x) {
+    return (x + SHIFT) - SHIFT;
+}
+
+// Целое значение kd (|kd| < 2^51) в дополнительном коде
+inline uint64_t integerBits(double kd) {
+    return toBits(kd + SHIFT) - toBits(SHIFT);
+}
+
+// 2^k для целого kd в нормальном диапазоне
+inline double pow2(double kd) {
+    return fromBits((integerBits(kd) + 1023) << 52);
+}
+
+template <typename Kernel>
+inline void mapBlocks(const double* x, double* y, size_t n, Kernel kernel) {
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        double block[LANES];
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            block[lane] = kernel(x[i + lane]);
+        }
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            y[i + lane] = block[lane];
+        }
+    }
+    for (; i < n; ++i) {
+        y[i] = kernel(x[i]);
+    }
+}
+
+template <typename Scalar>
+inline void mapScalar(const double* x, double* y, size_t n, Scalar scalar) {
+    for (size_t i = 0; i < n; ++i) {
+        y[i] = scalar(x[i]);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// exp: редукция x = k*ln2 + r, |r| <= ln2/2, рациональная аппроксимация
+// из fdlibm (e_exp.c), ошибка < 1 ULP
+
+constexpr double LN2_HI = 6.93147180369123816490e-01;
+constexpr double LN2_LO = 1.90821492927058770002e-10;
+constexpr double INV_LN2 = 1.44269504088896338700e+00;
+constexpr double EXP_P1 = 1.66666666666666019037e-01;
+constexpr double EXP_P2 = -2.77777777770155933842e-03;
+constexpr double EXP_P3 = 6.61375632143793436117e-05;
+constexpr double EXP_P4 = -1.65339022054652515390e-06;
+constexpr double EXP_P5 = 4.13813679705723846039e-08;
+
+inline double expKernel(double x) {
+    // Ограничение держит k в [-1077, 1025]; NaN проходит сравнения без изменений
+    x = x > 710.0 ? 710.0 : x;
+    x = x < -746.0 ? -746.0 : x;
+
+    double kd = roundShift(x * INV_LN2);
+    double hi = x - kd * LN2_HI;
+    double lo = kd * LN2_LO;
+    double r = hi - lo;
+    double t = r * r;
+    double c = r - t * (EXP_P1 + t * (EXP_P2 + t * (EXP_P3 + t * (EXP_P4 + t * EXP_P5))));
+    double y = 1.0 - ((lo - (r * c) / (2.0 - c)) - hi);
+
+    // 2^k двумя множителями, чтобы переполнение и субнормальные результаты
+    // округлялись один раз
+    double k1 = roundShift(kd * 0.5);
+    double k2 = kd - k1;
+    return (y * pow2(k1)) * pow2(k2);
+}
+
+// ---------------------------------------------------------------------------
+// log: x = 2^k * (1 + f), 1 + f в [sqrt(2)/2, sqrt(2)), s = f/(2+f),
+// многочлен из fdlibm (e_log.c), ошибка < 1 ULP
+
+constexpr double LG1 = 6.666666666666735130e-01;
+constexpr double LG2 = 3.999999999940941908e-01;
+constexpr double LG3 = 2.857142874366239149e-01;
+constexpr double LG4 = 2.222219843214978396e-01;
+constexpr double LG5 = 1.818357216161805012e-01;
+constexpr double LG6 = 1.531383769920937332e-01;
+constexpr double LG7 = 1.479819860511658591e-01;
+constexpr double TWO54 = 1.80143985094819840000e+16;
+
+struct LogParts {
+    double k;   // Показатель
+    double f;   // Мантисса минус 1
+};
+
+// Разложение положительного конечного x
+inline LogParts logDecompose(double x) {
+    bool subnormal = x < std::numeric_limits<double>::min();
+    x = subnormal ? x * TWO54 : x;
+
+    uint64_t bits = toBits(x);
+    uint64_t hx = bits >> 32;
+    double exponent = static_cast<double>(static_cast<int>((hx >> 20) & 0x7ff));
+    hx &= 0x000fffff;
+    // Если мантисса >= sqrt(2), берём её половину и увеличиваем показатель
+    uint64_t i = (hx + 0x95f64) & 0x100000;
+    double m = fromBits(((hx | (i ^ 0x3ff00000)) << 32) | (bits & 0xffffffffu));
+
+    LogParts parts;
+    parts.k = exponent - 1023.0 + static_cast<double>(i >> 20) - (subnormal ? 54.0 : 0.0);
+    parts.f = m - 1.0;
+    return parts;
+}
+
+// log(1 + f) - f - (f^2/2 - ...) для использования в log и log10
+inline double logPolynomial(double s) {
+    double z = s * s;
+    double w = z * z;
+    double t1 = w * (LG2 + w * (LG4 + w * LG6));
+    double t2 = z * (LG1 + w * (LG3 + w * (LG5 + w * LG7)));
+    return t2 + t1;
+}
+
+// Особые значения логарифмов: x <= 0, Infinity, NaN
+inline double logSpecial(double x, double result) {
+    result = x == INF ? INF : result;
+    result = x == 0.0 ? -INF : result;
+    result = x < 0.0 ? NaN : result;
+    return x != x ? x : result;
+}
+
+inline double logKernel(double x) {
+    LogParts p = logDecompose(x);
+    double f = p.f;
+    double hfsq = 0.5 * f * f;
+    double s = f / (2.0 + f);
+    double r = logPolynomial(s);
+    double result = p.k * LN2_HI - ((hfsq - (s * (hfsq + r) + p.k * LN2_LO)) - f);
+    return logSpecial(x, result);
+}
+
+// log10(x) = k*log10(2) + log(1 + f)/ln(10) со старшей и младшей частью
+// log10(2), как в fdlibm (e_log10.c)
+constexpr double IVLN10 = 4.34294481903251816668e-01;
+constexpr double LOG10_2HI = 3.01029995663611771306e-01;
+constexpr double LOG10_2LO = 3.69423907715893078616e-13;
+
+inline double log10Kernel(double x) {
+    LogParts p = logDecompose(x);
+    double f = p.f;
+    double hfsq = 0.5 * f * f;
+    double s = f / (2.0 + f);
+    double r = logPolynomial(s);
+    // log(1 + f) без слагаемого k*ln2
+    double logm = f - (hfsq - s * (hfsq + r));
+    double z = p.k * LOG10_2LO + IVLN10 * logm;
+    return logSpecial(x, z + p.k * LOG10_2HI);
+}
+
+// ---------------------------------------------------------------------------
+// sin/cos: редукция x = n*pi/2 + (y0 + y1) тремя частями pi/2 (алгоритм
+// средних аргументов из fdlibm e_rem_pio2.c), ядра k_sin.c/k_cos.c
+
+constexpr double INV_PIO2 = 6.36619772367581382433e-01;
+constexpr double PIO2_1 = 1.57079632673412561417e+00;
+constexpr double PIO2_1T = 6.07710050650619224932e-11;
+constexpr double PIO2_2 = 6.07710050630396597660e-11;
+constexpr double PIO2_2T = 2.02226624879595063154e-21;
+constexpr double PIO2_3 = 2.02226624871116645580e-21;
+constexpr double PIO2_3T = 8.47842766036889956997e-32;
+
+// Граница редукции; за ней используется libm
+constexpr double TRIG_REDUCTION_LIMIT = 823549.6561950207;  // 2^19 * pi/2
+
+constexpr double S1 = -1.66666666666666324348e-01;
+constexpr double S2 = 8.33333333332248946124e-03;
+constexpr double S3 = -1.98412698298579493134e-04;
+constexpr double S4 = 2.75573137070700676789e-06;
+constexpr double S5 = -2.50507602534068634195e-08;
+constexpr double S6 = 1.58969099521155010221e-10;
+
+constexpr double C1 = 4.16666666666666019037e-02;
+constexpr double C2 = -1.38888888888741095749e-03;
+constexpr double C3 = 2.48015872894767294178e-05;
+constexpr double C4 = -2.75573143513906633035e-07;
+constexpr double C5 = 2.08757232129817482790e-09;
+constexpr double C6 = -1.13596475577881948265e-11;
+
+struct Reduced {
+    double y0;
+    double y1;
+    uint64_t quadrant;
+};
+
+inline Reduced reducePio2(double x) {
+    double fn = roundShift(x * INV_PIO2);
+    double ax = std::abs(x);
+
+    // Первый раунд точен до 85 бит
+    double r1 = x - fn * PIO2_1;
+    double w1 = fn * PIO2_1T;
+    double y1 = r1 - w1;
+
+    // Второй и третий раунды нужны при сильном сокращении разрядов (x близок
+    // к кратному pi/2); считаются всегда и выбираются по величине остатка
+    double t = r1;
+    double w2 = fn * PIO2_2;
+    double r2 = t - w2;
+    w2 = fn * PIO2_2T - ((t - r2) - w2);
+    double y2 = r2 - w2;
+
+    t = r2;
+    double w3 = fn * PIO2_3;
+    double r3 = t - w3;
+    w3 = fn * PIO2_3T - ((t - r3) - w3);
+    double y3 = r3 - w3;
+
+    bool second = std::abs(y1) < ax * 0x1p-16;
+    bool third = second && std::abs(y2) < ax * 0x1p-49;
+    double r = third ? r3 : (second ? r2 : r1);
+    double w = third ? w3 : (second ? w2 : w1);
+
+    Reduced red;
+    red.y0 = third ? y3 : (second ? y2 : y1);
+    red.y1 = (r - red.y0) - w;
+    red.quadrant = integerBits(fn) & 3;
+    return red;
+}
+
+inline double sinPoly(double x, double y) {
+    double z = x * x;
+    double v = z * x;
+    double r = S2 + z * (S3 + z * (S4 + z * (S5 + z * S6)));
+    return x - ((z * (0.5 * y - v * r) - y) - v * S1);
+}
+
+inline double cosPoly(double x, double y) {
+    double z = x * x;
+    double r = z * (C1 + z * (C2 + z * (C3 + z * (C4 + z * (C5 + z * C6)))));
+    // qx ~ x^2/4 убирает потерю точности при вычитании из 1 (k_cos.c)
+    double ax = std::abs(x);
+    double qx = fromBits((toBits(ax) - (uint64_t(2) << 52)) & 0xffffffff00000000ull);
+    qx = ax > 0.78125 ? 0.28125 : qx;
+    qx = ax < 0.3 ? 0.0 : qx;
+    double hz = 0.5 * z - qx;
+    double a = 1.0 - qx;
+    return a - (hz - (z * r - x * y));
+}
+
+inline double negateIf(double value, bool negate) {
+    return fromBits(toBits(value) ^ (negate ? 0x8000000000000000ull : 0));
+}
+
+inline double sinFromReduced(const Reduced& red) {
+    double s = sinPoly(red.y0, red.y1);
+    double c = cosPoly(red.y0, red.y1);
+    double value = (red.quadrant & 1) ? c : s;
+    return negateIf(value, (red.quadrant & 2) != 0);
+}
+
+inline double cosFromReduced(const Reduced& red) {
+    double s = sinPoly(red.y0, red.y1);
+    double c = cosPoly(red.y0, red.y1);
+    double value = (red.quadrant & 1) ? s : c;
+    return negateIf(value, ((red.quadrant + 1) & 2) != 0);
+}
+
+inline double tanFromReduced(const Reduced& red) {
+    double s = sinPoly(red.y0, red.y1);
+    double c = cosPoly(red.y0, red.y1);
+    // tan(y + pi/2) = -cos(y)/sin(y)
+    return (red.quadrant & 1) ? -c / s : s / c;
+}
+
+// Блочное ядро тригонометрической функции; аргументы за границей редукции
+// пересчитываются через libm отдельным проходом по блоку, до записи в y
+// (x и y могут совпадать)
+template <typename Kernel, typename Scalar>
+inline void mapTrigBlocks(const double* x, double* y, size_t n, Kernel kernel, Scalar scalar) {
+    auto large = [](double v) { return std::abs(v) > TRIG_REDUCTION_LIMIT && std::isfinite(v); };
+    size_t i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        double block[LANES];
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            block[lane] = kernel(x[i + lane]);
+        }
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            if (large(x[i + lane])) {
+                block[lane] = scalar(x[i + lane]);
+            }
+        }
+        for (size_t lane = 0; lane < LANES; ++lane) {
+            y[i + lane] = block[lane];
+        }
+    }
+    for (; i < n; ++i) {
+        y[i] = large(x[i]) ? scalar(x[i]) : kernel(x[i]);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// atan: fdlibm s_atan.c, четыре опорные точки и многочлен степени 22;
+// ветви заменены выбором коэффициентов дробно-линейной замены
+
+constexpr double AT0 = 3.33333333333329318027e-01;
+constexpr double AT1 = -1.99999999998764832476e-01;
+constexpr double AT2 = 1.42857142725034663711e-01;
+constexpr double AT3 = -1.11111104054623557880e-01;
+constexpr double AT4 = 9.09088713343650656196e-02;
+constexpr double AT5 = -7.69187620504482999495e-02;
+constexpr double AT6 = 6.66107313738753120669e-02;
+constexpr double AT7 = -5.83357013379057348645e-02;
+constexpr double AT8 = 4.97687799461593236017e-02;
+constexpr double AT9 = -3.65315727442169155270e-02;
+constexpr double AT10 = 1.62858201153657823623e-02;
+
+inline double atanKernel(double x) {
+    double ax = std::abs(x);
+
+    // t = (a*|x| + b) / (c*|x| + d), atan(|x|) = hi + atan(t) (hi + lo)
+    double a = 1.0, b = 0.0, c = 0.0, d = 1.0, hi = 0.0, lo = 0.0;
+    bool r0 = ax >= 0.4375, r1 = ax >= 0.6875, r2 = ax >= 1.1875, r3 = ax >= 2.4375;
+    // atan(0.5): t = (2x - 1)/(2 + x)
+    a = r0 ? 2.0 : a; b = r0 ? -1.0 : b; c = r0 ? 1.0 : c; d = r0 ? 2.0 : d;
+    hi = r0 ? 4.63647609000806093515e-01 : hi; lo = r0 ? 2.26987774529616870924e-17 : lo;
+    // atan(1): t = (x - 1)/(x + 1)
+    a = r1 ? 1.0 : a; b = r1 ? -1.0 : b; c = r1 ? 1.0 : c; d = r1 ? 1.0 : d;
+    hi = r1 ? 7.85398163397448278999e-01 : hi; lo = r1 ? 3.06161699786838301793e-17 : lo;
+    // atan(1.5): t = (x - 1.5)/(1 + 1.5x)
+    a = r2 ? 1.0 : a; b = r2 ? -1.5 : b; c = r2 ? 1.5 : c; d = r2 ? 1.0 : d;
+    hi = r2 ? 9.82793723247329054082e-01 : hi; lo = r2 ? 1.39033110312309984516e-17 : lo;
+    // atan(inf): t = -1/x
+    a = r3 ? 0.0 : a; b = r3 ? -1.0 : b; c = r3 ? 1.0 : c; d = r3 ? 0.0 : d;
+    hi = r3 ? 1.57079632679489655800e+00 : hi; lo = r3 ? 6.12323399573676603587e-17 : lo;
+
+    double t = (a * ax + b) / (c * ax + d);
+    // Бесконечный аргумент: (0*inf - 1)/inf даёт NaN, нужен t = -0
+    t = ax == INF ? -0.0 : t;
+
+    double z = t * t;
+    double w = z * z;
+    double s1 = z * (AT0 + w * (AT2 + w * (AT4 + w * (AT6 + w * (AT8 + w * AT10)))));
+    double s2 = w * (AT1 + w * (AT3 + w * (AT5 + w * (AT7 + w * AT9))));
+    double result = hi - ((t * (s1 + s2) - lo) - t);
+
+    result = x != x ? x : result;
+    return std::copysign(result, x);
+}
+
+// ---------------------------------------------------------------------------
+// asin/acos: рациональная аппроксимация из fdlibm e_asin.c/e_acos.c;
+// для |x| > 0.5 — через sqrt((1 - |x|)/2)
+
+constexpr double PIO2_HI = 1.57079632679489655800e+00;
+constexpr double PIO2_LO = 6.12323399573676603587e-17;
+constexpr double PI = 3.14159265358979311600e+00;
+constexpr double PS0 = 1.66666666666666657415e-01;
+constexpr double PS1 = -3.25565818622400915405e-01;
+constexpr double PS2 = 2.01212532134862925881e-01;
+constexpr double PS3 = -4.00555345006794114027e-02;
+constexpr double PS4 = 7.91534994289814532176e-04;
+constexpr double PS5 = 3.47933107596021167570e-05;
+constexpr double QS1 = -2.40339491173441421878e+00;
+constexpr double QS2 = 2.02094576023350569471e+00;
+constexpr double QS3 = -6.88283971605453293030e-01;
+constexpr double QS4 = 7.70381505559019352791e-02;
+
+// (asin(sqrt(z)) - sqrt(z)) / sqrt(z)^3 для z в [0, 0.25]
+inline double asinRatio(double z) {
+    double p = z * (PS0 + z * (PS1 + z * (PS2 + z * (PS3 + z * (PS4 + z * PS5)))));
+    double q = 1.0 + z * (QS1 + z * (QS2 + z * (QS3 + z * QS4)));
+    return p / q;
+}
+
+inline double asinKernel(double x) {
+    double ax = std::abs(x);
+    bool large = ax > 0.5;
+
+    double z = large ? (1.0 - ax) * 0.5 : x * x;
+    double r = asinRatio(z);
+    double s = std::sqrt(z);
+
+    double small = x + x * r;
+    double big = PIO2_HI - (2.0 * (s + s * r) - PIO2_LO);
+    double result = large ? std::copysign(big, x) : small;
+    return ax > 1.0 ? NaN : result;
+}
+
+inline double acosKernel(double x) {
+    double ax = std::abs(x);
+    bool large = ax > 0.5;
+
+    double z = large ? (1.0 - ax) * 0.5 : x * x;
+    double r = asinRatio(z);
+    double s = std::sqrt(z);
+
+    double small = PIO2_HI - (x - (PIO2_LO - x * r));
+    double positive = 2.0 * (s + s * r);
+    double negative = PI - 2.0 * (s + (s * r - PIO2_LO));
+    double result = large ? (x > 0.0 ? positive : negative) : small;
+    return ax > 1.0 ? NaN : result;
+}
+
+// ---------------------------------------------------------------------------
+// Гиперболические функции через exp; при |x| < 1 — ряд Тейлора,
+// чтобы избежать вычитания близких чисел
+
+inline double sinhSeries(double x) {
+    double z = x * x;
+    return x + x * z * (1.0 / 6 + z * (1.0 / 120 + z * (1.0 / 5040 + z * (1.0 / 362880 +
+        z * (1.0 / 39916800 + z * (1.0 / 6227020800.0 + z * (1.0 / 1307674368000.0 +
+        z * (1.0 / 355687428096000.0))))))));
+}
+
+inline double sinhKernel(double x) {
+    double ax = std::abs(x);
+    double e = expKernel(ax);
+    double mid = 0.5 * (e - 1.0 / e);
+    // При |x| > 20 exp(|x|) может переполниться раньше sinh: e^x/2 = (e^(x/2)/2)*e^(x/2)
+    double half = expKernel(0.5 * ax);
+    double big = (0.5 * half) * half;
+    double result = ax < 1.0 ? sinhSeries(ax) : (ax > 20.0 ? big : mid);
+    return std::copysign(result, x);
+}
+
+inline double coshKernel(double x) {
+    double ax = std::abs(x);
+    double e = expKernel(ax);
+    double mid = 0.5 * (e + 1.0 / e);
+    double half = expKernel(0.5 * ax);
+    double big = (0.5 * half) * half;
+    return ax > 20.0 ? big : mid;
+}
+
+inline double tanhKernel(double x) {
+    double ax = std::abs(x);
+    // |x| < 1: sinh / sqrt(1 + sinh^2)
+    double s = sinhSeries(ax);
+    double small = s / std::sqrt(1.0 + s * s);
+    // |x| >= 1: 1 - 2/(exp(2|x|) + 1); при переполнении exp результат равен 1
+    double big = 1.0 - 2.0 / (expKernel(2.0 * ax) + 1.0);
+    double result = ax < 1.0 ? small : big;
+    result = x != x ? x : result;
+    return std::copysign(result, x);
+}
+
+// ---------------------------------------------------------------------------
+
+double factorialScalar(double x) {
+    if (!(x >= 0.0) || x != std::floor(x) || x > 170.0) {
+        return NaN;
+    }
+    double result = 1.0;
+    for (int i = 2; i <= static_cast<int>(x); ++i) {
+        result *= i;
+    }
+    return result;
+}
+
+void evaluateLibm(Function function, const double* x, double* y, size_t n) {
+    switch (function) {
+        case Function::Sin: mapScalar(x, y, n, [](double v) { return std::sin(v); }); return;
+        case Function::Cos: mapScalar(x, y, n, [](double v) { return std::cos(v); }); return;
+        case Function::Tan: mapScalar(x, y, n, [](double v) { return std::tan(v); }); return;
+        case Function::Asin: mapScalar(x, y, n, [](double v) { return std::asin(v); }); return;
+        case Function::Acos: mapScalar(x, y, n, [](double v) { return std::acos(v); }); return;
+        case Function::Atan: mapScalar(x, y, n, [](double v) { return std::atan(v); }); return;
+        case Function::Sinh: mapScalar(x, y, n, [](double v) { return std::sinh(v); }); return;
+        case Function::Cosh: mapScalar(x, y, n, [](double v) { return std::cosh(v); }); return;
+        case Function::Tanh: mapScalar(x, y, n, [](double v) { return std::tanh(v); }); return;
+        case Function::Log:
+        case Function::Ln: mapScalar(x, y, n, [](double v) { return std::log(v); }); return;
+        case Function::Log10: mapScalar(x, y, n, [](double v) { return std::log10(v); }); return;
+        case Function::Exp: mapScalar(x, y, n, [](double v) { return std::exp(v); }); return;
+        default: break;
+    }
+    // Точные функции одинаковы на всех уровнях
+    evaluate(function, x, y, n, Accuracy::Ulp4);
+}
+
+} // namespace
+
+bool hasKernel(Function function, Accuracy accuracy) {
+    switch (accuracy) {
+        case Accuracy::Libm:
+            return false;
+        case Accuracy::Ulp1:
+            switch (function) {
+                case Function::Sqrt:
+                case Function::Exp:
+                case Function::Log:
+                case Function::Ln:
+                case Function::Sin:
+                case Function::Cos:
+                case Function::Atan:
+                    return true;
+                default:
+                    return false;
+            }
+        case Accuracy::Ulp4:
+            switch (function) {
+                case Function::Factorial:
+                case Function::Unknown:
+                    return false;
+                default:
+                    return true;
+            }
+    }
+    return false;
+}
+
+void evaluate(Function function, const double* x, double* y, size_t n, Accuracy accuracy) {
+    // Функции, точные на всех уровнях (корректно округляются или не округляют)
+    switch (function) {
+        case Function::Sqrt: mapBlocks(x, y, n, [](double v) { return std::sqrt(v); }); return;
+        case Function::Abs: mapBlocks(x, y, n, [](double v) { return std::abs(v); }); return;
+        case Function::Ceil: mapBlocks(x, y, n, [](double v) { return std::ceil(v); }); return;
+        case Function::Floor: mapBlocks(x, y, n, [](double v) { return std::floor(v); }); return;
+        case Function::Round: mapScalar(x, y, n, [](double v) { return std::round(v); }); return;
+        case Function::Factorial: mapScalar(x, y, n, factorialScalar); return;
+        case Function::Unknown: mapScalar(x, y, n, [](double) { return NaN; }); return;
+        default: break;
+    }
+
+    if (!hasKernel(function, accuracy)) {
+        evaluateLibm(function, x, y, n);
+        return;
+    }
+
+    switch (function) {
+        case Function::Exp:
+            mapBlocks(x, y, n, expKernel);
+            return;
+        case Function::Log:
+        case Function::Ln:
+            mapBlocks(x, y, n, logKernel);
+            return;
+        case Function::Log10:
+            mapBlocks(x, y, n, log10Kernel);
+            return;
+        case Function::Sin:
+            mapTrigBlocks(x, y, n, [](double v) { return sinFromReduced(reducePio2(v)); },
+                          [](double v) { return std::sin(v); });
+            return;
+        case Function::Cos:
+            mapTrigBlocks(x, y, n, [](double v) { return cosFromReduced(reducePio2(v)); },
+                          [](double v) { return std::cos(v); });
+            return;
+        case Function::Tan:
+            mapTrigBlocks(x, y, n, [](double v) { return tanFromReduced(reducePio2(v)); },
+                          [](double v) { return std::tan(v); });
+            return;
+        case Function::Atan:
+            mapBlocks(x, y, n, atanKernel);
+            return;
+        case Function::Asin:
+            mapBlocks(x, y, n, asinKernel);
+            return;
+        case Function::Acos:
+            mapBlocks(x, y, n, acosKernel);
+            return;
+        case Function::Sinh:
+            mapBlocks(x, y, n, sinhKernel);
+            return;
+        case Function::Cosh:
+            mapBlocks(x, y, n, coshKernel);
+            return;
+        case Function::Tanh:
+            mapBlocks(x, y, n, tanhKernel);
+            return;
+        default:
+            evaluateLibm(function, x, y, n);
+            return;
+    }
+}
+
+} // namespace vecmath
+} // namespace calc
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "ast/func_call.hpp"
+#include <cstddef>
+
+namespace calc {
+namespace vecmath {
+
+/**
+ * @brief Ширина блока: ядра обрабатывают данные блоками по LANES значений
+ *
+ * Тело каждого ядра не содержит ветвлений (только выборки через ?:),
+ * поэтому компилятор отображает блок на SSE2/AVX/NEON без интринсиков.
+ */
+constexpr size_t LANES = 4;
+
+/**
+ * @brief Уровень точности пакетных функций
+ *
+ * Libm — libm по одному значению, результат побитово совпадает со
+ *        скалярным FuncCallNode. Точность равна точности libm платформы
+ *        (glibc: exp/log/sin/cos менее 1 ULP, log10 и гиперболические
+ *        функции — до 3 ULP); правильное округление не гарантируется.
+ * Ulp1 — собственные ядра с ошибкой не более 1 ULP для exp, log, sin,
+ *        cos, atan; остальные функции вычисляются как в Libm.
+ * Ulp4 — не более 4 ULP: собственные ядра для всех трансцендентных
+ *        функций, включая tan, asin, acos, log10 и гиперболические.
+ *
+ * sqrt, abs, ceil, floor, round вычисляются точно на всех уровнях.
+ *
+ * Ошибки измеряются тестами test_vecmath.cpp на случайных аргументах.
+ * Для sin/cos/tan при |x| > 2^19 * pi/2 используется libm на всех уровнях.
+ */
+enum class Accuracy {
+    Libm,
+    Ulp1,
+    Ulp4
+};
+
+/**
+ * @brief y[i] = f(x[i]) для i < n
+ *
+ * Вне области определения результат — NaN, при переполнении — ±Infinity
+ * (как в IEEE 754); ошибки не выбрасываются. Неизвестная функция даёт NaN.
+ * Массивы x и y могут совпадать.
+ */
+void evaluate(Function function, const double* x, double* y, size_t n,
+              Accuracy accuracy = Accuracy::Libm);
+
+/**
+ * @brief Использует ли данный уровень собственное ядро (а не libm)
+ */
+bool hasKernel(Function function, Accuracy accuracy);
+
+} // namespace vecmath
+} // namespace calc
@@ -0,0 +1,609 @@
+#include "wide_int.hpp"
+#include "radix.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__SIZEOF_INT128__)
+#define CALC_HAS_INT128 1
+#endif
+
+namespace calc {
+
+namespace {
+#ifdef CALC_HAS_INT128
+    // __extension__: без предупреждения -Wpedantic о нестандартном типе
+    __extension__ typedef unsigned __int128 uint128;
+
+    inline uint128 load128(const uint64_t* limbs) {
+        return (static_cast<uint128>(limbs[1]) << 64) | limbs[0];
+    }
+
+    inline void store128(uint64_t* limbs, uint128 value) {
+        limbs[0] = static_cast<uint64_t>(value);
+        limbs[1] = static_cast<uint64_t>(value >> 64);
+    }
+
+    // Делитель divideSmall: остаток и слово помещаются в 128 бит
+    constexpr uint64_t MAX_SMALL_DIVISOR = UINT64_MAX;
+#else
+    // Без 128-битного типа слово делится половинами по 32 бита
+    constexpr uint64_t MAX_SMALL_DIVISOR = UINT32_MAX;
+#endif
+
+    // Полное произведение: младшее слово — результат, старшее — в high
+    inline uint64_t multiplyFull(uint64_t a, uint64_t b, uint64_t& high) {
+#ifdef CALC_HAS_INT128
+        uint128 product = static_cast<uint128>(a) * b;
+        high = static_cast<uint64_t>(product >> 64);
+        return static_cast<uint64_t>(product);
+#else
+        uint64_t aLow = a & 0xFFFFFFFFu, aHigh = a >> 32;
+        uint64_t bLow = b & 0xFFFFFFFFu, bHigh = b >> 32;
+        uint64_t lowLow = aLow * bLow;
+        uint64_t lowHigh = aLow * bHigh;
+        uint64_t highLow = aHigh * bLow;
+        uint64_t middle = (lowLow >> 32) + (lowHigh & 0xFFFFFFFFu) + (highLow & 0xFFFFFFFFu);
+        high = aHigh * bHigh + (lowHigh >> 32) + (highLow >> 32) + (middle >> 32);
+        return (middle << 32) | (lowLow & 0xFFFFFFFFu);
+#endif
+    }
+
+    void checkRadix(int radix) {
+        if (radix < MIN_RADIX || radix > MAX_RADIX) {
+            throw std::invalid_argument("Base must be from 2 to 36");
+        }
+    }
+
+    // Бит на цифру для систем, цифры которых ровно делят слово (2, 4, 16), иначе 0
+    int alignedDigitBits(int radix) {
+        switch (radix) {
+            case 2: return 1;
+            case 4: return 2;
+            case 16: return 4;
+            default: return 0;
+        }
+    }
+
+    // Наибольшее число цифр, степень основания для которого не больше limit
+    int chunkDigits(int radix, uint64_t limit, uint64_t& power) {
+        int digits = 0;
+        power = 1;
+        while (power <= limit / static_cast<uint64_t>(radix)) {
+            power *= static_cast<uint64_t>(radix);
+            ++digits;
+        }
+        return digits;
+    }
+
+    // Цифры value, дополненные слева нулями до width
+    void appendDigits(std::string& out, uint64_t value, int radix, int width) {
+        char buffer[RADIX_BUFFER_SIZE];
+        char* end = formatUnsigned(buffer, buffer + sizeof(buffer), value, radix);
+        int length = static_cast<int>(end - buffer);
+        if (length < width) {
+            out.append(static_cast<size_t>(width - length), '0');
+        }
+        out.append(buffer, end);
+    }
+
+    std::string_view trim(std::string_view text) {
+        size_t begin = text.find_first_not_of(" \t\r");
+        if (begin == std::string_view::npos) {
+            return {};
+        }
+        size_t end = text.find_last_not_of(" \t\r");
+        return text.substr(begin, end - begin + 1);
+    }
+}
+
+WideInt::WideInt(unsigned bits) : bits_(bits) {
+    if (bits == 0 || bits > WIDE_INT_MAX_BITS) {
+        throw std::invalid_argument("Word size must be from 1 to 65536 bits");
+    }
+    if (limbCount() > INLINE_LIMBS) {
+        heap_ = std::make_unique<uint64_t[]>(limbCount());
+    }
+}
+
+WideInt& WideInt::operator=(const WideInt& other) {
+    if (this == &other) {
+        return *this;
+    }
+    size_t count = limbCount(other.bits_);
+    if (count > INLINE_LIMBS) {
+        if (!heap_ || limbCount() != count) {
+            heap_ = std::make_unique<uint64_t[]>(count);
+        }
+    } else {
+        heap_.reset();
+    }
+    bits_ = other.bits_;
+    std::copy(other.data(), other.data() + count, data());
+    return *this;
+}
+
+WideInt WideInt::fromInt64(int64_t value, unsigned bits) {
+    WideInt result(bits);
+    uint64_t* limbs = result.data();
+    limbs[0] = static_cast<uint64_t>(value);
+    if (value < 0) {
+        std::fill(limbs + 1, limbs + result.limbCount(), ~uint64_t{0});
+    }
+    result.normalize();
+    return result;
+}
+
+WideInt WideInt::parse(std::string_view text, int radix, unsigned bits) {
+    checkRadix(radix);
+    WideInt result(bits);
+    text = trim(text);
+    bool negative = !text.empty() && text.front() == '-';
+    if (negative) {
+        text.remove_prefix(1);
+    }
+    if (text.empty()) {
+        throw std::invalid_argument("Missing digits");
+    }
+
+    uint64_t* limbs = result.data();
+    size_t count = result.limbCount();
+    if (int digitBits = alignedDigitBits(radix)) {
+        // Каждое слово — отдельный кусок строки справа налево; куски старше
+        // разрядности только проверяются
+        size_t perLimb = static_cast<size_t>(64 / digitBits);
+        size_t index = 0;
+        for (size_t end = text.size(); end > 0; ++index) {
+            size_t length = std::min(perLimb, end);
+            uint64_t value = parseUnsigned(text.substr(end - length, length), radix);
+            if (index < count) {
+                limbs[index] = value;
+            }
+            end -= length;
+        }
+    } else {
+        // Слева направо кусками, степень основания для которых помещается в слово
+        uint64_t power;
+        size_t perChunk = static_cast<size_t>(chunkDigits(radix, UINT64_MAX, power));
+        size_t first = text.size() % perChunk;
+        if (first == 0) {
+            first = perChunk;
+        }
+        limbs[0] = parseUnsigned(text.substr(0, first), radix);
+        result.normalize();
+        for (size_t begin = first; begin < text.size(); begin += perChunk) {
+            result.multiplyAdd(power, parseUnsigned(text.substr(begin, perChunk), radix));
+        }
+    }
+    result.normalize();
+    return negative ? -result : result;
+}
+
+bool WideInt::isZero() const {
+    const uint64_t* limbs = data();
+    return std::all_of(limbs, limbs + limbCount(), [](uint64_t limb) { return limb == 0; });
+}
+
+bool WideInt::isNegative() const {
+    return (data()[(bits_ - 1) / 64] >> ((bits_ - 1) % 64)) & 1;
+}
+
+int64_t WideInt::toInt64() const {
+    uint64_t low = data()[0];
+    if (bits_ < 64 && isNegative()) {
+        low |= ~topMask();
+    }
+    return static_cast<int64_t>(low);
+}
+
+WideInt WideInt::resized(unsigned bits) const {
+    WideInt result(bits);
+    uint64_t* limbs = result.data();
+    size_t count = std::min(limbCount(), result.limbCount());
+    std::copy(data(), data() + count, limbs);
+    if (bits > bits_ && isNegative()) {
+        limbs[limbCount() - 1] |= ~topMask();
+        std::fill(limbs + limbCount(), limbs + result.limbCount(), ~uint64_t{0});
+    }
+    result.normalize();
+    return result;
+}
+
+std::string WideInt::toString(int radix, bool asSigned) const {
+    checkRadix(radix);
+    bool negative = asSigned && isNegative();
+    WideInt magnitude = negative ? -*this : *this;
+    std::string out;
+    if (negative) {
+        out.push_back('-');
+    }
+
+    const uint64_t* limbs = magnitude.data();
+    size_t top = limbCount();
+    while (top > 1 && limbs[top - 1] == 0) {
+        --top;
+    }
+    if (int digitBits = alignedDigitBits(radix)) {
+        int perLimb = 64 / digitBits;
+        out.reserve(out.size() + top * static_cast<size_t>(perLimb));
+        appendDigits(out, limbs[top - 1], radix, 0);
+        for (size_t i = top - 1; i > 0; --i) {
+            appendDigits(out, limbs[i - 1], radix, perLimb);
+        }
+        return out;
+    }
+
+    if (radix == 8 || radix == 32) {
+        // Цифра — группа из 3 или 5 бит, группы пересекают границы слов
+        unsigned digitBits = radix == 8 ? 3 : 5;
+        size_t used = (top - 1) * 64;
+        for (uint64_t high = limbs[top - 1]; high != 0; high >>= 1) {
+            ++used;
+        }
+        size_t digits = std::max<size_t>(1, (used + digitBits - 1) / digitBits);
+        out.reserve(out.size() + digits);
+        for (size_t digit = digits; digit-- > 0;) {
+            size_t position = digit * digitBits;
+            size_t index = position / 64;
+            unsigned shift = static_cast<unsigned>(position % 64);
+            uint64_t value = limbs[index] >> shift;
+            if (shift + digitBits > 64 && index + 1 < top) {
+                value |= limbs[index + 1] << (64 - shift);
+            }
+            out.push_back("0123456789ABCDEFGHIJKLMNOPQRSTUV"[value & (radix - 1)]);
+        }
+        return out;
+    }
+
+    // Куски по perChunk цифр — остатки от деления на степень основания;
+    // делятся только ненулевые слова
+    uint64_t power;
+    int perChunk = chunkDigits(radix, MAX_SMALL_DIVISOR, power);
+    std::vector<uint64_t> chunks;
+    chunks.reserve(top * 64 / static_cast<size_t>(perChunk) + 1);
+    do {
+        chunks.push_back(magnitude.divideSmall(power, top));
+        while (top > 1 && limbs[top - 1] == 0) {
+            --top;
+        }
+    } while (top > 1 || limbs[0] != 0);
+    appendDigits(out, chunks.back(), radix, 0);
+    for (size_t i = chunks.size() - 1; i > 0; --i) {
+        appendDigits(out, chunks[i - 1], radix, perChunk);
+    }
+    return out;
+}
+
+WideInt& WideInt::operator+=(const WideInt& other) {
+    checkSameWidth(other);
+    uint64_t* a = data();
+    const uint64_t* b = other.data();
+    size_t count = limbCount();
+    if (count == 1) {
+        a[0] += b[0];
+#ifdef CALC_HAS_INT128
+    } else if (count == 2) {
+        store128(a, load128(a) + load128(b));
+#endif
+    } else {
+        uint64_t carry = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t sum = a[i] + carry;
+            carry = sum < carry;
+            sum += b[i];
+            carry += sum < b[i];
+            a[i] = sum;
+        }
+    }
+    normalize();
+    return *this;
+}
+
+WideInt& WideInt::operator-=(const WideInt& other) {
+    checkSameWidth(other);
+    uint64_t* a = data();
+    const uint64_t* b = other.data();
+    size_t count = limbCount();
+    if (count == 1) {
+        a[0] -= b[0];
+#ifdef CALC_HAS_INT128
+    } else if (count == 2) {
+        store128(a, load128(a) - load128(b));
+#endif
+    } else {
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < count; ++i) {
+            uint64_t left = a[i];
+            uint64_t difference = left - b[i];
+            uint64_t nextBorrow = left < b[i];
+            nextBorrow |= difference < borrow;
+            a[i] = difference - borrow;
+            borrow = nextBorrow;
+        }
+    }
+    normalize();
+    return *this;
+}
+
+WideInt& WideInt::operator*=(const WideInt& other) {
+    checkSameWidth(other);
+    uint64_t* a = data();
+    const uint64_t* b = other.data();
+    size_t count = limbCount();
+    if (count == 1) {
+        a[0] *= b[0];
+#ifdef CALC_HAS_INT128
+    } else if (count == 2) {
+        store128(a, load128(a) * load128(b));
+#endif
+    } else {
+        // Школьное умножение; слова произведения старше разрядности не считаются
+        std::vector<uint64_t> product(count, 0);
+        for (size_t i = 0; i < count; ++i) {
+            if (a[i] == 0) {
+                continue;
+            }
+            uint64_t carry = 0;
+            for (size_t j = 0; i + j < count; ++j) {
+                uint64_t high;
+                uint64_t low = multiplyFull(a[i], b[j], high);
+                low += product[i + j];
+                high += low < product[i + j];
+                low += carry;
+                high += low < carry;
+                product[i + j] = low;
+                carry = high;
+            }
+        }
+        std::copy(product.begin(), product.end(), a);
+    }
+    normalize();
+    return *this;
+}
+
+WideInt WideInt::operator~() const {
+    WideInt result(*this);
+    uint64_t* limbs = result.data();
+    for (size_t i = 0, count = limbCount(); i < count; ++i) {
+        limbs[i] = ~limbs[i];
+    }
+    result.normalize();
+    return result;
+}
+
+WideInt WideInt::operator-() const {
+    // −x = ~x + 1
+    WideInt result = ~*this;
+    uint64_t* limbs = result.data();
+    for (size_t i = 0, count = limbCount(); i < count; ++i) {
+        if (++limbs[i] != 0) {
+            break;
+        }
+    }
+    result.normalize();
+    return result;
+}
+
+WideInt WideInt::shiftLeft(uint64_t count) const {
+    WideInt result(bits_);
+    if (count >= bits_) {
+        return result;
+    }
+    const uint64_t* a = data();
+    uint64_t* r = result.data();
+    size_t limbs = limbCount();
+    if (limbs == 1) {
+        r[0] = a[0] << count;
+#ifdef CALC_HAS_INT128
+    } else if (limbs == 2) {
+        store128(r, load128(a) << count);
+#endif
+    } else {
+        size_t limbShift = static_cast<size_t>(count / 64);
+        unsigned bitShift = static_cast<unsigned>(count % 64);
+        for (size_t i = limbs; i-- > limbShift;) {
+            size_t source = i - limbShift;
+            uint64_t value = a[source] << bitShift;
+            if (bitShift != 0 && source > 0) {
+                value |= a[source - 1] >> (64 - bitShift);
+            }
+            r[i] = value;
+        }
+    }
+    result.normalize();
+    return result;
+}
+
+WideInt WideInt::shiftRightLogical(uint64_t count) const {
+    WideInt result(bits_);
+    if (count >= bits_) {
+        return result;
+    }
+    const uint64_t* a = data();
+    uint64_t* r = result.data();
+    size_t limbs = limbCount();
+    if (limbs == 1) {
+        r[0] = a[0] >> count;
+#ifdef CALC_HAS_INT128
+    } else if (limbs == 2) {
+        store128(r, load128(a) >> count);
+#endif
+    } else {
+        size_t limbShift = static_cast<size_t>(count / 64);
+        unsigned bitShift = static_cast<unsigned>(count % 64);
+        for (size_t i = 0; i + limbShift < limbs; ++i) {
+            size_t source = i + limbShift;
+            uint64_t value = a[source] >> bitShift;
+            if (bitShift != 0 && source + 1 < limbs) {
+                value |= a[source + 1] << (64 - bitShift);
+            }
+            r[i] = value;
+        }
+    }
+    return result;
+}
+
+WideInt WideInt::shiftRightArithmetic(uint64_t count) const {
+    // Для отрицательных: x >> n = ~(~x >>> n), освободившиеся биты — единицы
+    if (!isNegative()) {
+        return shiftRightLogical(count);
+    }
+    return ~(~*this).shiftRightLogical(count);
+}
+
+WideInt WideInt::rotateLeft(uint64_t count) const {
+    count %= bits_;
+    if (count == 0) {
+        return *this;
+    }
+    if (bits_ == 64) {
+        WideInt result(bits_);
+        result.data()[0] = (data()[0] << count) | (data()[0] >> (64 - count));
+        return result;
+    }
+#ifdef CALC_HAS_INT128
+    if (bits_ == 128) {
+        WideInt result(bits_);
+        uint128 value = load128(data());
+        store128(result.data(), (value << count) | (value >> (128 - count)));
+        return result;
+    }
+#endif
+    WideInt result = shiftLeft(count);
+    result |= shiftRightLogical(bits_ - count);
+    return result;
+}
+
+WideInt WideInt::rotateRight(uint64_t count) const {
+    count %= bits_;
+    return rotateLeft(count == 0 ? 0 : bits_ - count);
+}
+
+void WideInt::divide(const WideInt& dividend, const WideInt& divisor,
+                     WideInt& quotient, WideInt& remainder) {
+    dividend.checkSameWidth(divisor);
+    if (divisor.isZero()) {
+        throw std::domain_error("Division by zero");
+    }
+    bool dividendNegative = dividend.isNegative();
+    bool divisorNegative = divisor.isNegative();
+    // Модуль MIN — 2^(bits−1), без знака он представим
+    divideUnsigned(dividendNegative ? -dividend : dividend,
+                   divisorNegative ? -divisor : divisor, quotient, remainder);
+    if (dividendNegative != divisorNegative) {
+        quotient = -quotient;
+    }
+    if (dividendNegative) {
+        remainder = -remainder;
+    }
+}
+
+void WideInt::divideUnsigned(const WideInt& dividend, const WideInt& divisor,
+                             WideInt& quotient, WideInt& remainder) {
+    unsigned bits = dividend.bits_;
+    size_t count = dividend.limbCount();
+    const uint64_t* a = dividend.data();
+    const uint64_t* b = divisor.data();
+    WideInt q(bits);
+    WideInt r(bits);
+    bool smallDivisor = std::all_of(b + 1, b + count, [](uint64_t limb) { return limb == 0; });
+
+    if (count == 1) {
+        q.data()[0] = a[0] / b[0];
+        r.data()[0] = a[0] % b[0];
+#ifdef CALC_HAS_INT128
+    } else if (count == 2) {
+        store128(q.data(), load128(a) / load128(b));
+        store128(r.data(), load128(a) % load128(b));
+#endif
+    } else if (smallDivisor && b[0] <= MAX_SMALL_DIVISOR) {
+        q = dividend;
+        r.data()[0] = q.divideSmall(b[0], count);
+    } else {
+        // Деление столбиком по битам, начиная со старшего ненулевого
+        uint64_t* qLimbs = q.data();
+        uint64_t* rLimbs = r.data();
+        size_t top = count;
+        while (top > 0 && a[top - 1] == 0) {
+            --top;
+        }
+        for (size_t bit = top * 64; bit-- > 0;) {
+            // r = r * 2 + очередной бит делимого; вышедший за разрядность бит
+            // означает r > divisor
+            uint64_t carry = (rLimbs[(bits - 1) / 64] >> ((bits - 1) % 64)) & 1;
+            for (size_t i = count; i-- > 1;) {
+                rLimbs[i] = (rLimbs[i] << 1) | (rLimbs[i - 1] >> 63);
+            }
+            rLimbs[0] = (rLimbs[0] << 1) | ((a[bit / 64] >> (bit % 64)) & 1);
+            r.normalize();
+
+            bool subtract = carry != 0;
+            if (!subtract) {
+                subtract = true;
+                for (size_t i = count; i-- > 0;) {
+                    if (rLimbs[i] != b[i]) {
+                        subtract = rLimbs[i] > b[i];
+                        break;
+                    }
+                }
+            }
+            if (subtract) {
+                r -= divisor;
+                qLimbs[bit / 64] |= uint64_t{1} << (bit % 64);
+            }
+        }
+    }
+    quotient = std::move(q);
+    remainder = std::move(r);
+}
+
+bool WideInt::operator==(const WideInt& other) const {
+    return bits_ == other.bits_ && std::equal(data(), data() + limbCount(), other.data());
+}
+
+uint64_t WideInt::topMask() const {
+    unsigned used = bits_ % 64;
+    return used == 0 ? ~uint64_t{0} : (uint64_t{1} << used) - 1;
+}
+
+void WideInt::throwWidthMismatch() {
+    throw std::invalid_argument("Operands have different word sizes");
+}
+
+uint64_t WideInt::divideSmall(uint64_t divisor, size_t count) {
+    uint64_t* limbs = data();
+    uint64_t remainder = 0;
+    for (size_t i = count; i-- > 0;) {
+#ifdef CALC_HAS_INT128
+        uint128 current = (static_cast<uint128>(remainder) << 64) | limbs[i];
+        limbs[i] = static_cast<uint64_t>(current / divisor);
+        remainder = static_cast<uint64_t>(current % divisor);
+#else
+        // Остаток меньше 2^32, поэтому остаток и половина слова помещаются в 64 бита
+        uint64_t high = (remainder << 32) | (limbs[i] >> 32);
+        uint64_t highQuotient = high / divisor;
+        remainder = high % divisor;
+        uint64_t low = (remainder << 32) | (limbs[i] & 0xFFFFFFFFu);
+        limbs[i] = (highQuotient << 32) | (low / divisor);
+        remainder = low % divisor;
+#endif
+    }
+    return remainder;
+}
+
+void WideInt::multiplyAdd(uint64_t multiplier, uint64_t addend) {
+    uint64_t* limbs = data();
+    uint64_t carry = addend;
+    for (size_t i = 0, count = limbCount(); i < count; ++i) {
+        uint64_t high;
+        uint64_t low = multiplyFull(limbs[i], multiplier, high);
+        low += carry;
+        high += low < carry;
+        limbs[i] = low;
+        carry = high;
+    }
+    normalize();
+}
+
+} // namespace calc
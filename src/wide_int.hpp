@@ -0,0 +1,228 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace calc {
+
+/**
+ * @brief Наибольшая разрядность WideInt
+ */
+constexpr unsigned WIDE_INT_MAX_BITS = 65536;
+
+/**
+ * @brief Целое фиксированной разрядности (1–65536 бит) в дополнительном коде
+ *
+ * Все операции выполняются по модулю 2^bits, как в регистре процессора:
+ * переполнение заворачивает значение. Операнды бинарных операций обязаны
+ * иметь одну разрядность (иначе std::invalid_argument). Значение хранится
+ * 64-битными словами от младшего; биты старше разрядности всегда нулевые.
+ * До 128 бит слова лежат в самом объекте, и операции идут по быстрому пути
+ * (uint64_t, unsigned __int128 там, где он есть), шире — циклами по словам.
+ */
+class WideInt {
+public:
+    /**
+     * @brief Ноль разрядности bits
+     */
+    explicit WideInt(unsigned bits = 64);
+
+    /**
+     * @brief value, приведённое к разрядности bits (знак расширяется)
+     */
+    static WideInt fromInt64(int64_t value, unsigned bits);
+
+    /**
+     * @brief Разобрать число: пробелы по краям, необязательный '-' и цифры radix
+     *
+     * Модуль любой длины приводится по модулю 2^bits (FF при 8 битах — это −1).
+     * Ошибки — std::invalid_argument с сообщениями src/radix.hpp.
+     */
+    static WideInt parse(std::string_view text, int radix, unsigned bits);
+
+    WideInt(const WideInt& other) : bits_(other.bits_) {
+        if (other.heap_) {
+            heap_ = std::make_unique<uint64_t[]>(limbCount());
+            std::copy(other.heap_.get(), other.heap_.get() + limbCount(), heap_.get());
+        } else {
+            inline_[0] = other.inline_[0];
+            inline_[1] = other.inline_[1];
+        }
+    }
+
+    // Перемещённый объект остаётся нулём 64 бит
+    WideInt(WideInt&& other) noexcept
+        : bits_(other.bits_), inline_{other.inline_[0], other.inline_[1]}, heap_(std::move(other.heap_)) {
+        other.bits_ = 64;
+        other.inline_[0] = other.inline_[1] = 0;
+    }
+
+    WideInt& operator=(const WideInt& other);
+
+    WideInt& operator=(WideInt&& other) noexcept {
+        bits_ = other.bits_;
+        inline_[0] = other.inline_[0];
+        inline_[1] = other.inline_[1];
+        heap_ = std::move(other.heap_);
+        if (this != &other) {
+            other.bits_ = 64;
+            other.inline_[0] = other.inline_[1] = 0;
+        }
+        return *this;
+    }
+
+    ~WideInt() = default;
+
+    unsigned bits() const { return bits_; }
+    size_t limbCount() const { return limbCount(bits_); }
+    uint64_t limb(size_t index) const { return data()[index]; }
+
+    bool isZero() const;
+    bool isNegative() const;
+
+    /**
+     * @brief Младшие 64 бита как знаковое число (узкие значения — со знаком)
+     */
+    int64_t toInt64() const;
+
+    /**
+     * @brief То же значение в разрядности bits: расширение знаком или усечение
+     */
+    WideInt resized(unsigned bits) const;
+
+    /**
+     * @brief Запись в системе radix (2–36), цифры больше 9 — заглавные буквы
+     *
+     * asSigned — знак и модуль ("-1"), иначе битовый образ без знака
+     * ("FF" для −1 при 8 битах). Системы 2 и 16 пишутся по слову, 8 — группами
+     * бит, остальные — делением на наибольшую степень основания, помещающуюся
+     * в слово.
+     */
+    std::string toString(int radix, bool asSigned) const;
+
+    WideInt& operator+=(const WideInt& other);
+    WideInt& operator-=(const WideInt& other);
+    WideInt& operator*=(const WideInt& other);
+    WideInt& operator&=(const WideInt& other) {
+        checkSameWidth(other);
+        uint64_t* a = data();
+        const uint64_t* b = other.data();
+        for (size_t i = 0, count = limbCount(); i < count; ++i) {
+            a[i] &= b[i];
+        }
+        return *this;
+    }
+
+    WideInt& operator|=(const WideInt& other) {
+        checkSameWidth(other);
+        uint64_t* a = data();
+        const uint64_t* b = other.data();
+        for (size_t i = 0, count = limbCount(); i < count; ++i) {
+            a[i] |= b[i];
+        }
+        return *this;
+    }
+
+    WideInt& operator^=(const WideInt& other) {
+        checkSameWidth(other);
+        uint64_t* a = data();
+        const uint64_t* b = other.data();
+        for (size_t i = 0, count = limbCount(); i < count; ++i) {
+            a[i] ^= b[i];
+        }
+        return *this;
+    }
+
+    WideInt operator~() const;
+    WideInt operator-() const;
+
+    /**
+     * @brief Сдвиги: count ≥ bits даёт 0 (арифметический вправо — 0 или −1)
+     */
+    WideInt shiftLeft(uint64_t count) const;
+    WideInt shiftRightLogical(uint64_t count) const;
+    WideInt shiftRightArithmetic(uint64_t count) const;
+
+    /**
+     * @brief Циклические сдвиги, count берётся по модулю bits
+     */
+    WideInt rotateLeft(uint64_t count) const;
+    WideInt rotateRight(uint64_t count) const;
+
+    /**
+     * @brief Деление со знаком с округлением к нулю, остаток — со знаком делимого
+     *
+     * Делитель 0 — std::domain_error. MIN / −1 заворачивается в MIN.
+     */
+    static void divide(const WideInt& dividend, const WideInt& divisor,
+                       WideInt& quotient, WideInt& remainder);
+
+    bool operator==(const WideInt& other) const;
+    bool operator!=(const WideInt& other) const { return !(*this == other); }
+
+private:
+    static constexpr size_t INLINE_LIMBS = 2;
+
+    static size_t limbCount(unsigned bits) { return (bits + 63) / 64; }
+
+    uint64_t* data() { return heap_ ? heap_.get() : inline_; }
+    const uint64_t* data() const { return heap_ ? heap_.get() : inline_; }
+
+    uint64_t topMask() const;
+    void normalize() { data()[limbCount() - 1] &= topMask(); }
+    void checkSameWidth(const WideInt& other) const {
+        if (bits_ != other.bits_) {
+            throwWidthMismatch();
+        }
+    }
+    [[noreturn]] static void throwWidthMismatch();
+
+    // Младшие count слов делятся на divisor на месте (старшие — нули),
+    // возвращается остаток
+    uint64_t divideSmall(uint64_t divisor, size_t count);
+    // *this = *this * multiplier + addend по модулю 2^bits
+    void multiplyAdd(uint64_t multiplier, uint64_t addend);
+
+    static void divideUnsigned(const WideInt& dividend, const WideInt& divisor,
+                               WideInt& quotient, WideInt& remainder);
+
+    unsigned bits_;
+    uint64_t inline_[INLINE_LIMBS] = {0, 0};
+    std::unique_ptr<uint64_t[]> heap_;
+};
+
+inline WideInt operator+(WideInt left, const WideInt& right) {
+    left += right;
+    return left;
+}
+
+inline WideInt operator-(WideInt left, const WideInt& right) {
+    left -= right;
+    return left;
+}
+
+inline WideInt operator*(WideInt left, const WideInt& right) {
+    left *= right;
+    return left;
+}
+
+inline WideInt operator&(WideInt left, const WideInt& right) {
+    left &= right;
+    return left;
+}
+
+inline WideInt operator|(WideInt left, const WideInt& right) {
+    left |= right;
+    return left;
+}
+
+inline WideInt operator^(WideInt left, const WideInt& right) {
+    left ^= right;
+    return left;
+}
+
+} // namespace calc
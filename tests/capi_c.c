@@ -0,0 +1,36 @@
+/* Вызовы C API из кода на C: calc.h должен компилироваться компилятором C */
+#include "calc.h"
+
+int capi_c_smoke(void) {
+    const char* names[] = {"x", "y"};
+    double values[] = {3.0, 4.0};
+    double x[] = {3.0, 6.0};
+    double y[] = {4.0, 8.0};
+    const double* columns[] = {x, y};
+    double results[2] = {0.0, 0.0};
+    double result = 0.0;
+    calc_expression* expression = NULL;
+
+    if (calc_api_version() != CALC_API_VERSION) {
+        return 1;
+    }
+    if (calc_compile("sqrt(x^2 + y^2)", names, 2, 0, &expression) != CALC_OK) {
+        return 2;
+    }
+    if (calc_evaluate(expression, values, &result) != CALC_OK || result != 5.0) {
+        calc_release(expression);
+        return 3;
+    }
+    if (calc_evaluate_batch(expression, columns, 2, results, NULL) != CALC_OK ||
+        results[0] != 5.0 || results[1] != 10.0) {
+        calc_release(expression);
+        return 4;
+    }
+    calc_release(expression);
+
+    if (calc_compile("1 +", NULL, 0, 0, &expression) != CALC_ERROR_PARSE || expression != NULL ||
+        calc_last_error()[0] == '\0') {
+        return 5;
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "sweep.hpp"
+#include "async_evaluation.hpp"
+#include "cancellation.hpp"
+#include "variables.hpp"
+#include "error.hpp"
+
+using namespace calc;
+
+namespace {
+
+std::unique_ptr<Node> parse_with(const std::string& expr, const Variables* vars = nullptr) {
+    Lexer lexer(expr);
+    Parser parser(lexer.tokenize(), vars);
+    return parser.parse();
+}
+
+// Несколько секунд на любом числе ядер: 9·10^9 слагаемых без замкнутой формы
+const char* const LONG_SUM = "sum(i, 1, 9e9, sin(i))";
+
+// Ждать первого сообщения о прогрессе не дольше нескольких секунд
+bool waitFor(const std::atomic<bool>& flag) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!flag.load() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return flag.load();
+}
+
+} // namespace
+
+TEST(AsyncTest, CancelledScopeStopsLongConstructs) {
+    CancellationToken token;
+    token.cancel();
+    // Перебор программой и деревом, произведение, интеграл, корни
+    for (const char* text : {"sum(i, 1, 100000, sin(i))", "sum(i, 1, 10, i^i)", "prod(i, 1, 100, 1 + 1 / i^i)",
+                             "integrate(x, x, 0, 1)", "solve(x - 0.5, x, 0, 1)"}) {
+        auto ast = parse_with(text);
+        {
+            CancellationScope scope(&token);
+            EXPECT_THROW(ast->evaluate(), CancelledError) << text;
+        }
+        EXPECT_NO_THROW(ast->evaluate()) << text;
+    }
+
+    // Отмена прерывает табулирование целиком, а не отдельные точки
+    Variables vars;
+    vars.bind("x");
+    auto ast = parse_with("1 / x", &vars);
+    Sweep sweep(*ast, "x");
+    size_t points = 0;
+    CancellationScope scope(&token);
+    EXPECT_THROW(sweep.run(0.0, 10000.0, 1.0, vars, [&](double, double, const std::string*) { ++points; }),
+                 CancelledError);
+    EXPECT_EQ(points, 0u);
+}
+
+TEST(AsyncTest, ProgressComesFromOutermostConstruct) {
+    for (const char* text : {"sum(i, 1, 200000, sin(i))", "sum(i, 1, 10, sum(j, 1, 1000, sin(i * j)))",
+                             "solve(sin(x), x, 1, 10)"}) {
+        std::vector<double> fractions;
+        CancellationToken token;
+        {
+            CancellationScope scope(&token, [&](double fraction) { fractions.push_back(fraction); });
+            parse_with(text)->evaluate();
+        }
+        ASSERT_FALSE(fractions.empty()) << text;
+        EXPECT_EQ(fractions.back(), 1.0) << text;
+        for (size_t k = 0; k < fractions.size(); ++k) {
+            EXPECT_GE(fractions[k], 0.0) << text;
+            EXPECT_LE(fractions[k], 1.0) << text;
+            if (k > 0) {
+                EXPECT_GT(fractions[k], fractions[k - 1]) << text;
+            }
+        }
+    }
+}
+
+TEST(AsyncTest, ResultsAndErrorsPassThroughFuture) {
+    std::atomic<int> finished{0};
+    AsyncOptions options;
+    options.finished = [&] { ++finished; };
+    {
+        AsyncEvaluation evaluation(parse_with("sum(i, 1, 100, i) * 2"), options);
+        EXPECT_EQ(evaluation.get(), 10100.0);
+        AsyncEvaluation failing(parse_with("1 / (2 - 2)"), options);
+        failing.wait();
+        EXPECT_TRUE(failing.ready());
+        EXPECT_THROW(failing.get(), EvalError);
+    }
+    EXPECT_EQ(finished.load(), 2);
+
+    Variables vars;
+    vars.set("x", 4.0);
+    options.mode = EvalMode::Deferred;
+    AsyncEvaluation deferred(parse_with("sqrt(x) + x", &vars), options);
+    EXPECT_EQ(deferred.get(), 6.0);
+}
+
+TEST(AsyncTest, CancelStopsRunningEvaluation) {
+    std::atomic<bool> started{false};
+    AsyncOptions options;
+    options.progress = [&](double) { started = true; };
+    AsyncEvaluation evaluation(parse_with(LONG_SUM), options);
+    ASSERT_TRUE(waitFor(started));
+    EXPECT_FALSE(evaluation.ready());
+
+    auto begin = std::chrono::steady_clock::now();
+    evaluation.cancel();
+    EXPECT_THROW(evaluation.get(), CancelledError);
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(2));
+}
+
+TEST(AsyncTest, SharedTokenAndDestructorCancel) {
+    AsyncOptions options;
+    options.token = std::make_shared<CancellationToken>();
+    AsyncEvaluation first(parse_with(LONG_SUM), options);
+    AsyncEvaluation second(parse_with("sum(i, 1, 9e9, cos(i))"), options);
+    options.token->cancel();
+    EXPECT_THROW(first.get(), CancelledError);
+    EXPECT_THROW(second.get(), CancelledError);
+
+    // Брошенное вычисление отменяется деструктором, а не досчитывается
+    auto begin = std::chrono::steady_clock::now();
+    {
+        AsyncEvaluation abandoned(parse_with(LONG_SUM));
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(2));
+}
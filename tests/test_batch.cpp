@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include "batch.hpp"
+#include "variables.hpp"
+
+using namespace calc;
+
+namespace {
+
+// Временный файл с содержимым text, открытый с начала
+std::FILE* input_file(const std::string& text) {
+    std::FILE* file = std::tmpfile();
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::rewind(file);
+    return file;
+}
+
+std::string read_all(std::FILE* file) {
+    std::rewind(file);
+    std::string text;
+    char buf[256];
+    size_t read;
+    while ((read = std::fread(buf, 1, sizeof(buf), file)) > 0) {
+        text.append(buf, read);
+    }
+    return text;
+}
+
+std::string run(const std::string& text, BatchStats* stats = nullptr, size_t bufferSize = 64,
+                const BatchOptions& options = BatchOptions()) {
+    Variables vars;
+    vars.set("x", 3.0);
+    std::FILE* in = input_file(text);
+    std::FILE* out = std::tmpfile();
+    BatchStats result;
+    {
+        LineReader reader(in, bufferSize);
+        BufferedWriter writer(out, bufferSize);
+        result = runBatch(reader, writer, vars, options);
+    }
+    std::string output = read_all(out);
+    std::fclose(in);
+    std::fclose(out);
+    if (stats) {
+        *stats = result;
+    }
+    return output;
+}
+
+} // namespace
+
+TEST(BatchTest, OneResultPerLine) {
+    BatchStats stats;
+    EXPECT_EQ(run("1 + 2\nx * 2\n2 ^ 0.5\n", &stats), "3\n6\n1.4142135623730951\n");
+    EXPECT_EQ(stats.lines, 3u);
+    EXPECT_EQ(stats.errors, 0u);
+}
+
+TEST(BatchTest, ErrorsAreReportedInline) {
+    BatchStats stats;
+    std::string output = run("1 / 0\n2 +\nfoo(1)\n4\n", &stats);
+    EXPECT_EQ(output, "error: Division by zero\n"
+                      "error: Unexpected token\n"
+                      "error: Unknown function: foo\n"
+                      "4\n");
+    EXPECT_EQ(stats.lines, 4u);
+    EXPECT_EQ(stats.errors, 3u);
+}
+
+TEST(BatchTest, BlankLinesStayInPlace) {
+    BatchStats stats;
+    EXPECT_EQ(run("1\n\n  \t\n2\n", &stats), "1\n\n\n2\n");
+    EXPECT_EQ(stats.lines, 4u);
+    EXPECT_EQ(stats.errors, 0u);
+}
+
+TEST(BatchTest, CrLfAndMissingFinalNewline) {
+    EXPECT_EQ(run("1 + 1\r\n2 + 2\r\n3 + 3"), "2\n4\n6\n");
+    EXPECT_EQ(run("7\r"), "7\n");
+    EXPECT_EQ(run(""), "");
+}
+
+TEST(BatchTest, LinesLongerThanBuffer) {
+    std::string sum = "0";
+    for (int i = 1; i <= 200; ++i) {
+        sum += " + " + std::to_string(i);
+    }
+    std::string input;
+    for (int k = 0; k < 5; ++k) {
+        input += sum + "\n" + "x\n";
+    }
+    std::string expected;
+    for (int k = 0; k < 5; ++k) {
+        expected += "20100\n3\n";
+    }
+    EXPECT_EQ(run(input, nullptr, 8), expected);
+    EXPECT_EQ(run(input, nullptr, 1), expected);
+}
+
+TEST(BatchTest, ManyLinesThroughSmallBuffers) {
+    std::string input;
+    std::string expected;
+    for (int i = 0; i < 1000; ++i) {
+        input += std::to_string(i) + " * 2\n";
+        expected += std::to_string(i * 2) + "\n";
+    }
+    BatchStats stats;
+    EXPECT_EQ(run(input, &stats, 16), expected);
+    EXPECT_EQ(stats.lines, 1000u);
+}
+
+TEST(BatchTest, OptimizedMatchesPlain) {
+    const std::string input = "x^2 + 2*x + 1\n(x - x) * sin(x)\n1 / (x - 3)\n";
+    BatchOptions options;
+    options.optimize = true;
+    EXPECT_EQ(run(input, nullptr, 64, options), run(input));
+}
+
+TEST(BatchTest, DeferredChecksMatchPlain) {
+    const std::string input = "x^2 + sin(x)\n1 / (x - 3)\nsqrt(-x)\n10 ^ 400\nsum(i, 1, 4, i / x)\n";
+    BatchOptions options;
+    options.mode = EvalMode::Deferred;
+    EXPECT_EQ(run(input, nullptr, 64, options), run(input));
+}
+
+TEST(BatchTest, EvaluateLineAppends) {
+    Variables vars;
+    BatchOptions options;
+    std::string out = "head\n";
+    EXPECT_TRUE(evaluateLine("2 * 21", vars, options, out));
+    EXPECT_FALSE(evaluateLine("(", vars, options, out));
+    EXPECT_EQ(out.substr(0, 8), "head\n42\n");
+    EXPECT_EQ(out.substr(8, 7), "error: ");
+}
+
+TEST(BatchTest, InMemoryInputMatchesStream) {
+    std::string input;
+    for (int i = 0; i < 500; ++i) {
+        input += std::to_string(i) + " / (x - " + std::to_string(i % 5) + ")\r\n";
+    }
+    input += "x";     // Без '\n' в конце
+
+    Variables vars;
+    vars.set("x", 3.0);
+    std::FILE* out = std::tmpfile();
+    BatchStats stats;
+    {
+        BufferedWriter writer(out, 64);
+        stats = runBatch(std::string_view(input), writer, vars, BatchOptions());
+    }
+    std::string output = read_all(out);
+    std::fclose(out);
+
+    BatchStats streamed;
+    EXPECT_EQ(output, run(input, &streamed));
+    EXPECT_EQ(stats.lines, 501u);
+    EXPECT_EQ(stats.errors, streamed.errors);
+    EXPECT_EQ(stats.errors, 100u);
+}
+
+TEST(BatchTest, EvaluateLinesSplitsInPlace) {
+    Variables vars;
+    std::string out;
+    BatchStats stats = evaluateLines("1\n\n2 +\r\n3", vars, BatchOptions(), out);
+    EXPECT_EQ(stats.lines, 4u);
+    EXPECT_EQ(stats.errors, 1u);
+    EXPECT_EQ(out.substr(0, 3), "1\n\n");
+    EXPECT_EQ(out.substr(out.size() - 2), "3\n");
+    out.clear();
+    EXPECT_EQ(evaluateLines("", vars, BatchOptions(), out).lines, 0u);
+    EXPECT_EQ(out, "");
+}
@@ -1,5 +1,8 @@
 #include <gtest/gtest.h>
 #include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
 #include "lexer.hpp"
 #include "parser.hpp"
 #include "evaluator.hpp"
@@ -164,6 +167,96 @@ TEST(CalculatorTest, OperatorPrecedence) {
     EXPECT_DOUBLE_EQ(evaluate_expression("2 ^ 3 ^ 2"), 512.0);  // Right associative
 }
 
+// Comparisons and conditional expressions
+TEST(CalculatorTest, Comparisons) {
+    EXPECT_DOUBLE_EQ(evaluate_expression("3 < 5"), 1.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("3 > 5"), 0.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("2 <= 2"), 1.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("2 >= 3"), 0.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("5 == 5"), 1.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("5 != 5"), 0.0);
+    // Сдвиги по-прежнему сдвиги и связывают сильнее сравнений
+    EXPECT_DOUBLE_EQ(evaluate_expression("1 << 3 < 9"), 1.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("16 >> 2 >= 4"), 1.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("1 + 1 == 2"), 1.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("6 AND 4 > 0"), 1.0);
+    EXPECT_THROW(evaluate_expression("1 = 1"), ParseError);
+    EXPECT_THROW(evaluate_expression("!1"), ParseError);
+}
+
+TEST(CalculatorTest, ConditionalExpressions) {
+    EXPECT_DOUBLE_EQ(evaluate_expression("1 ? 2 : 3"), 2.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("0 ? 2 : 3"), 3.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("0 ? 2 : 1 ? 4 : 5"), 4.0);  // Right associative
+    EXPECT_DOUBLE_EQ(evaluate_expression("2 > 1 ? 10 : 20"), 10.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("if(2 > 1, 10, 20)"), 10.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("if(0, 1, if(1, 2, 3)) * 3"), 6.0);
+    // Невыбранная ветвь не вычисляется
+    EXPECT_DOUBLE_EQ(evaluate_expression("0 ? 1 / 0 : 7"), 7.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("if(1, 5, ln(-1))"), 5.0);
+    EXPECT_THROW(evaluate_expression("1 ? 1 / 0 : 7"), EvalError);
+    EXPECT_THROW(evaluate_expression("1 ? 2"), ParseError);
+    EXPECT_THROW(evaluate_expression("if(1, 2)"), ParseError);
+}
+
+TEST(CalculatorTest, SumsAndProducts) {
+    EXPECT_DOUBLE_EQ(evaluate_expression("sum(i, 1, 100, i)"), 5050.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("prod(k, 1, 5, k)"), 120.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("sum(i, 1, 4, sum(j, 1, i, j))"), 20.0);
+    EXPECT_DOUBLE_EQ(evaluate_expression("sum(i, 1, 3, prod(i, 1, 2, i))"), 6.0);  // Внутренняя i скрывает внешнюю
+    EXPECT_DOUBLE_EQ(evaluate_expression("sum(i, 5, 4, i) + prod(i, 5, 4, i)"), 1.0);  // Пустые диапазоны
+    EXPECT_DOUBLE_EQ(evaluate_expression("2 * sum(i, 1, 3, i ^ 2) + 1"), 29.0);
+    EXPECT_THROW(evaluate_expression("sum(i, 1, 2.5, i)"), EvalError);
+    EXPECT_THROW(evaluate_expression("sum(i, 1, 10, 1 / (i - 5))"), EvalError);
+    EXPECT_THROW(evaluate_expression("sum(1, 1, 10, 1)"), ParseError);
+    EXPECT_THROW(evaluate_expression("sum(i, 1, 10)"), ParseError);
+    EXPECT_THROW(evaluate_expression("sum(i, 1, i, 1)"), ParseError);  // Переменная цикла видна только в теле
+    EXPECT_THROW(evaluate_expression("sum(i, 1, 3, i) + i"), ParseError);
+}
+
+// Deferred mode: same results and same error messages as checked mode
+TEST(CalculatorTest, DeferredModeMatchesChecked) {
+    const char* exprs[] = {
+        "2 + 3 * 4", "sin(1) * cos(2) + tan(0.5)", "2 ^ 0.5 - sqrt(2)", "10 % 3",
+        "5 AND 3 OR 8", "1 << 10 >> 2", "NOT 5", "factorial(10) / factorial(8)",
+        "2 < 3 ? sqrt(-1) : 1", "2 > 3 ? sqrt(-1) : 1", "(1 / 0) < 1 ? 2 : 3",
+        // Ошибки, которые отмечаются флагами IEEE 754
+        "1 / 0", "0 ^ -1", "(-8) ^ (1/3)", "10 ^ 400", "1e308 * 10",
+        "sqrt(-1)", "log(0)", "ln(-2)", "asin(2)", "sinh(1000)",
+        // Ошибки, которые IEEE 754 ошибками не считает
+        "1 / 1e-16", "5 % 1e-20", "exp(709.5)", "factorial(2.5)", "factorial(171)",
+        "1e30 AND 1", "1 << 64", "unknown(1)",
+        // Ошибки внутри sum/prod проверяются при переборе
+        "sum(i, 1, 3, 1 / (i - 2))", "ln(-1) + sum(i, 1, 3, 1 / 0)", "prod(i, 1, 200, i)"
+    };
+    
+    for (const char* expr : exprs) {
+        Lexer lexer(expr);
+        Parser parser(lexer.tokenize());
+        auto ast = parser.parse();
+        
+        // Значения сравниваются побитово, ошибки — по тексту
+        uint64_t checkedBits = 0;
+        uint64_t deferredBits = 0;
+        std::string checkedError;
+        std::string deferredError;
+        try {
+            double value = Evaluator(EvalMode::Checked).evaluate(ast);
+            std::memcpy(&checkedBits, &value, sizeof(value));
+        } catch (const EvalError& e) {
+            checkedError = e.what();
+        }
+        try {
+            double value = Evaluator(EvalMode::Deferred).evaluate(ast);
+            std::memcpy(&deferredBits, &value, sizeof(value));
+        } catch (const EvalError& e) {
+            deferredError = e.what();
+        }
+        EXPECT_EQ(deferredError, checkedError) << expr;
+        EXPECT_EQ(deferredBits, checkedBits) << expr;
+    }
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
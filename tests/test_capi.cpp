@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include <thread>
+#include <vector>
+#include "calc.h"
+
+extern "C" int capi_c_smoke(void);
+
+namespace {
+    // Дескриптор, освобождаемый в конце теста
+    struct Compiled {
+        calc_expression* handle = nullptr;
+        calc_status status;
+
+        Compiled(const char* expression, std::vector<const char*> names, unsigned flags = 0)
+            : status(calc_compile(expression, names.data(), names.size(), flags, &handle)) {}
+        ~Compiled() { calc_release(handle); }
+    };
+}
+
+TEST(CApiTest, UsableFromC) {
+    EXPECT_EQ(capi_c_smoke(), 0);
+}
+
+TEST(CApiTest, CompileAndEvaluate) {
+    EXPECT_EQ(calc_api_version(), CALC_API_VERSION);
+
+    Compiled expression("x * 2 + y ^ 2", {"x", "y"});
+    ASSERT_EQ(expression.status, CALC_OK);
+    EXPECT_EQ(calc_variable_count(expression.handle), 2u);
+    double values[] = {1.5, 3.0};
+    double result = 0.0;
+    ASSERT_EQ(calc_evaluate(expression.handle, values, &result), CALC_OK);
+    EXPECT_EQ(result, 12.0);
+
+    Compiled constant("2 + 3", {});
+    ASSERT_EQ(constant.status, CALC_OK);
+    ASSERT_EQ(calc_evaluate(constant.handle, nullptr, &result), CALC_OK);
+    EXPECT_EQ(result, 5.0);
+
+    Compiled optimized("x * 1 + 0 * 1", {"x"}, CALC_COMPILE_OPTIMIZE);
+    ASSERT_EQ(optimized.status, CALC_OK);
+    ASSERT_EQ(calc_evaluate(optimized.handle, values, &result), CALC_OK);
+    EXPECT_EQ(result, 1.5);
+}
+
+TEST(CApiTest, ErrorsAreReturnedAsCodes) {
+    Compiled syntax("1 +", {});
+    EXPECT_EQ(syntax.status, CALC_ERROR_PARSE);
+    EXPECT_EQ(syntax.handle, nullptr);
+    EXPECT_NE(std::string(calc_last_error()), "");
+
+    Compiled unknown("x + z", {"x"});
+    EXPECT_EQ(unknown.status, CALC_ERROR_PARSE);
+    EXPECT_EQ(std::string(calc_last_error()), "Unknown identifier: z");
+
+    Compiled division("1 / x", {"x"});
+    ASSERT_EQ(division.status, CALC_OK);
+    double zero = 0.0;
+    double result = 42.0;
+    EXPECT_EQ(calc_evaluate(division.handle, &zero, &result), CALC_ERROR_EVAL);
+    EXPECT_EQ(std::string(calc_last_error()), "Division by zero");
+    EXPECT_EQ(result, 42.0);
+}
+
+TEST(CApiTest, InvalidArguments) {
+    calc_expression* handle = nullptr;
+    EXPECT_EQ(calc_compile(nullptr, nullptr, 0, 0, &handle), CALC_ERROR_ARGUMENT);
+    EXPECT_EQ(calc_compile("1", nullptr, 0, 0, nullptr), CALC_ERROR_ARGUMENT);
+    EXPECT_EQ(calc_compile("x", nullptr, 1, 0, &handle), CALC_ERROR_ARGUMENT);
+    for (const char* name : {"2x", "pi", "AND", "x y", "", "x+1"}) {
+        EXPECT_EQ(Compiled("1", {name}).status, CALC_ERROR_ARGUMENT) << name;
+    }
+    EXPECT_EQ(Compiled("x", {"x", "x"}).status, CALC_ERROR_ARGUMENT);
+    EXPECT_EQ(std::string(calc_last_error()), "Duplicate variable name: x");
+    EXPECT_EQ(Compiled("x", {"x"}, CALC_COMPILE_ULP1 | CALC_COMPILE_ULP4).status, CALC_ERROR_ARGUMENT);
+
+    Compiled expression("x", {"x"});
+    double result = 0.0;
+    EXPECT_EQ(calc_evaluate(expression.handle, nullptr, &result), CALC_ERROR_ARGUMENT);
+    EXPECT_EQ(calc_evaluate(nullptr, &result, &result), CALC_ERROR_ARGUMENT);
+    EXPECT_EQ(calc_evaluate_batch(expression.handle, nullptr, 4, &result, nullptr), CALC_ERROR_ARGUMENT);
+    EXPECT_EQ(calc_evaluate_batch(expression.handle, nullptr, 0, nullptr, nullptr), CALC_OK);
+    calc_release(nullptr);
+}
+
+TEST(CApiTest, BatchMatchesScalar) {
+    Compiled expression("sqrt(x) / (y - 2)", {"x", "y"});
+    ASSERT_EQ(expression.status, CALC_OK);
+    std::vector<double> x = {4.0, 9.0, 16.0, -1.0, 25.0};
+    std::vector<double> y = {3.0, 4.0, 2.0, 5.0, 7.0};
+    const double* columns[] = {x.data(), y.data()};
+    std::vector<double> results(x.size());
+    size_t failed = 0;
+    EXPECT_EQ(calc_evaluate_batch(expression.handle, columns, x.size(), results.data(), &failed),
+              CALC_ERROR_EVAL);
+    EXPECT_EQ(failed, 2u);
+    EXPECT_EQ(std::string(calc_last_error()), "row 2: Division by zero");
+
+    for (size_t row = 0; row < x.size(); ++row) {
+        double values[] = {x[row], y[row]};
+        double scalar = 0.0;
+        if (calc_evaluate(expression.handle, values, &scalar) == CALC_OK) {
+            EXPECT_EQ(results[row], scalar) << row;
+        } else {
+            EXPECT_TRUE(std::isnan(results[row])) << row;
+        }
+    }
+}
+
+TEST(CApiTest, AccuracyFlagsSelectBatchKernels) {
+    std::vector<double> x(1000);
+    for (size_t i = 0; i < x.size(); ++i) {
+        x[i] = 0.01 * static_cast<double>(i) - 5.0;
+    }
+    const double* columns[] = {x.data()};
+    for (unsigned flags : {CALC_COMPILE_ULP1, CALC_COMPILE_ULP4}) {
+        Compiled expression("sin(x) * exp(x) + log(x + 6)", {"x"}, flags);
+        ASSERT_EQ(expression.status, CALC_OK);
+        std::vector<double> results(x.size());
+        ASSERT_EQ(calc_evaluate_batch(expression.handle, columns, x.size(), results.data(), nullptr), CALC_OK);
+        for (size_t row = 0; row < x.size(); ++row) {
+            double scalar = 0.0;
+            ASSERT_EQ(calc_evaluate(expression.handle, &x[row], &scalar), CALC_OK);
+            EXPECT_NEAR(results[row], scalar, 1e-13 * (1.0 + std::abs(scalar))) << flags << " " << x[row];
+        }
+    }
+}
+
+TEST(CApiTest, UncompilableExpressionsEvaluateConcurrently) {
+    // sum() вычисляется деревом, остальное — скомпилированной программой
+    for (const char* text : {"sum(i, 1, n, i * x)", "n * (n + 1) / 2 * x"}) {
+        Compiled expression(text, {"n", "x"});
+        ASSERT_EQ(expression.status, CALC_OK);
+        std::vector<std::thread> threads;
+        std::vector<int> mismatches(4, 0);
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&, t] {
+                for (int k = 1; k <= 200; ++k) {
+                    double values[] = {static_cast<double>(k % 20 + 1), static_cast<double>(t + 1)};
+                    double result = 0.0;
+                    double n = values[0];
+                    if (calc_evaluate(expression.handle, values, &result) != CALC_OK ||
+                        result != n * (n + 1) / 2 * values[1]) {
+                        ++mismatches[t];
+                    }
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        for (int t = 0; t < 4; ++t) {
+            EXPECT_EQ(mismatches[t], 0) << text;
+        }
+
+        double n[] = {3.0, 4.0};
+        double x[] = {1.0, 0.5};
+        const double* columns[] = {n, x};
+        double results[2];
+        ASSERT_EQ(calc_evaluate_batch(expression.handle, columns, 2, results, nullptr), CALC_OK);
+        EXPECT_EQ(results[0], 6.0);
+        EXPECT_EQ(results[1], 5.0);
+    }
+}
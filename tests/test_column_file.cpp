@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include "column_file.hpp"
+#include "error.hpp"
+#include "variables.hpp"
+
+using namespace calc;
+using column_format::ColumnType;
+
+namespace {
+
+// Образ файла в буфере, выровненном как отображение
+struct Image {
+    std::vector<double> storage;
+    size_t size = 0;
+
+    const char* data() const { return reinterpret_cast<const char*>(storage.data()); }
+    char* data() { return reinterpret_cast<char*>(storage.data()); }
+};
+
+Image write_file(const std::vector<ColumnSpec>& specs, uint64_t rows,
+                 const std::vector<std::vector<double>>& floats, const std::vector<std::vector<int64_t>>& ints) {
+    std::FILE* file = std::tmpfile();
+    {
+        ColumnWriter writer(file, specs, rows);
+        size_t f = 0;
+        size_t i = 0;
+        for (const ColumnSpec& spec : specs) {
+            if (spec.type == ColumnType::Float64) {
+                // Порциями, чтобы проверить переходы между столбцами
+                const std::vector<double>& values = floats[f++];
+                writer.append(values.data(), values.size() / 2);
+                writer.append(values.data() + values.size() / 2, values.size() - values.size() / 2);
+            } else {
+                writer.append(ints[i].data(), ints[i].size());
+                ++i;
+            }
+        }
+        writer.finish();
+    }
+    Image image;
+    image.size = static_cast<size_t>(std::ftell(file));
+    image.storage.resize(image.size / sizeof(double) + 1);
+    std::rewind(file);
+    EXPECT_EQ(std::fread(image.data(), 1, image.size, file), image.size);
+    std::fclose(file);
+    return image;
+}
+
+struct Collected {
+    std::vector<double> values;
+    std::vector<std::pair<uint64_t, std::string>> errors;
+};
+
+ColumnSink collect(Collected& out) {
+    return [&out](uint64_t first, const double* values, size_t count, const std::vector<BatchError>& errors) {
+        EXPECT_EQ(first, out.values.size());
+        out.values.insert(out.values.end(), values, values + count);
+        for (const BatchError& error : errors) {
+            out.errors.emplace_back(first + error.index, error.message);
+        }
+    };
+}
+
+} // namespace
+
+TEST(ColumnFileTest, RoundTrip) {
+    std::vector<double> price = {1.5, 2.0, 3.25, -4.0, 1e300};
+    std::vector<int64_t> qty = {1, 2, 3, 4, -5};
+    Image image = write_file({{"price", ColumnType::Float64}, {"qty", ColumnType::Int64}}, 5, {price}, {qty});
+    ColumnFile file(image.data(), image.size);
+    ASSERT_EQ(file.rows(), 5u);
+    ASSERT_EQ(file.columnCount(), 2u);
+    EXPECT_EQ(file.name(0), "price");
+    EXPECT_EQ(file.type(1), ColumnType::Int64);
+    EXPECT_EQ(file.find("qty"), 1u);
+    EXPECT_FALSE(file.find("discount"));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(file.float64(0)) % column_format::ALIGNMENT,
+              reinterpret_cast<uintptr_t>(image.data()) % column_format::ALIGNMENT);
+    EXPECT_EQ(std::vector<double>(file.float64(0), file.float64(0) + 5), price);
+    EXPECT_EQ(std::vector<int64_t>(file.int64(1), file.int64(1) + 5), qty);
+    EXPECT_THROW(file.int64(0), std::invalid_argument);
+}
+
+TEST(ColumnFileTest, WriterRejectsMisuse) {
+    std::FILE* file = std::tmpfile();
+    ColumnWriter writer(file, {{"a", ColumnType::Float64}, {"b", ColumnType::Int64}}, 2);
+    double values[3] = {1, 2, 3};
+    EXPECT_THROW(writer.append(values, 3), std::invalid_argument);    // Третье значение — в столбец int64
+    EXPECT_THROW(writer.finish(), std::runtime_error);
+    std::fclose(file);
+}
+
+TEST(ColumnFileTest, CorruptFilesAreRejected) {
+    Image image = write_file({{"x", ColumnType::Float64}}, 3, {{1, 2, 3}}, {});
+    EXPECT_NO_THROW(ColumnFile(image.data(), image.size));
+    EXPECT_THROW(ColumnFile(image.data(), image.size - 8), FormatError);
+    EXPECT_THROW(ColumnFile(image.data(), 16), FormatError);
+
+    Image renamed = image;
+    renamed.data()[sizeof(column_format::ColumnFileHeader) + sizeof(column_format::ColumnEntry)] = 'y';
+    EXPECT_THROW(ColumnFile(renamed.data(), renamed.size), FormatError);
+
+    Image magic = image;
+    magic.data()[0] = 'X';
+    EXPECT_THROW(ColumnFile(magic.data(), magic.size), FormatError);
+}
+
+TEST(ColumnFileTest, EvaluatesBlocksFromTheFile) {
+    const size_t rows = 10000;
+    std::vector<double> x(rows);
+    std::vector<int64_t> n(rows);
+    for (size_t i = 0; i < rows; ++i) {
+        x[i] = static_cast<double>(i) * 0.25;
+        n[i] = static_cast<int64_t>(i % 7) - 3;
+    }
+    Image image = write_file({{"x", ColumnType::Float64}, {"n", ColumnType::Int64}}, rows, {x}, {n});
+    ColumnFile file(image.data(), image.size);
+    Variables variables;
+    variables.set("k", 2.0);
+    variables.set("x", -1.0);    // Столбец закрывает переменную
+
+    for (size_t blockRows : {1u, 333u, 4096u}) {
+        ColumnOptions options;
+        options.blockRows = blockRows;
+        Collected out;
+        ColumnStats stats = evaluateColumns(file, "x * k / n", variables, options, collect(out));
+        ASSERT_EQ(out.values.size(), rows);
+        EXPECT_EQ(stats.rows, rows);
+        EXPECT_EQ(stats.columns, 2u);
+        EXPECT_EQ(stats.converted, 1u);
+        EXPECT_TRUE(stats.compiled);
+        EXPECT_EQ(stats.errors, out.errors.size());
+        for (size_t i = 0; i < rows; i += 97) {
+            if (n[i] == 0) {
+                EXPECT_TRUE(std::isnan(out.values[i]));
+            } else {
+                EXPECT_EQ(out.values[i], x[i] * 2.0 / static_cast<double>(n[i]));
+            }
+        }
+        ASSERT_FALSE(out.errors.empty());
+        EXPECT_EQ(out.errors[0].first, 3u);
+        EXPECT_EQ(out.errors[0].second, "Division by zero");
+    }
+}
+
+TEST(ColumnFileTest, TreeFallbackMatchesBlocks) {
+    std::vector<double> x = {0.5, 1.5, -2.0, 4.0};
+    Image image = write_file({{"x", ColumnType::Float64}}, x.size(), {x}, {});
+    ColumnFile file(image.data(), image.size);
+    Collected blocks;
+    Collected rows;
+    evaluateColumns(file, "sqrt(x) + 1", Variables(), ColumnOptions(), collect(blocks));
+    ColumnStats stats = evaluateColumns(file, "sum(i, 1, 1, sqrt(x)) + 1", Variables(), ColumnOptions(),
+                                        collect(rows));
+    EXPECT_FALSE(stats.compiled);
+    ASSERT_EQ(rows.values.size(), x.size());
+    for (size_t i = 0; i < x.size(); ++i) {
+        if (i == 2) {
+            EXPECT_TRUE(std::isnan(rows.values[i]));
+        } else {
+            EXPECT_EQ(rows.values[i], blocks.values[i]);
+        }
+    }
+    ASSERT_EQ(rows.errors.size(), 1u);
+    EXPECT_EQ(rows.errors, blocks.errors);
+    EXPECT_THROW(evaluateColumns(file, "y + 1", Variables(), ColumnOptions(), collect(rows)), ParseError);
+
+    // Столбец e не закрывает константу молча
+    Image constant = write_file({{"e", ColumnType::Float64}}, x.size(), {x}, {});
+    ColumnFile shadowing(constant.data(), constant.size);
+    EXPECT_THROW(evaluateColumns(shadowing, "e * 2", Variables(), ColumnOptions(), collect(rows)), ParseError);
+
+    // Выражение без ссылки на такой столбец вычисляется
+    Image unused = write_file({{"x", ColumnType::Float64}, {"pi", ColumnType::Float64}}, x.size(), {x, x}, {});
+    ColumnFile skipping(unused.data(), unused.size);
+    Collected skipped;
+    stats = evaluateColumns(skipping, "sqrt(x) + 1", Variables(), ColumnOptions(), collect(skipped));
+    EXPECT_EQ(stats.columns, 1u);
+    EXPECT_EQ(skipped.values.size(), x.size());
+    EXPECT_EQ(skipped.errors, blocks.errors);
+    EXPECT_THROW(evaluateColumns(skipping, "x * pi", Variables(), ColumnOptions(), collect(skipped)), ParseError);
+}
@@ -0,0 +1,429 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "optimizer.hpp"
+#include "program.hpp"
+#include "batch.hpp"
+#include "format.hpp"
+#include "variables.hpp"
+#include "error.hpp"
+
+using namespace calc;
+
+// Проверки асимптотики: каждая стадия прогоняется на входах, удваивающихся
+// по длине, и показатель k в time ≈ c·n^k оценивается наклоном прямой МНК
+// в логарифмических координатах. n log n на этом диапазоне даёт k ≈ 1.1,
+// квадратичный рост — k ≈ 2; порог 1.6 посередине оставляет запас на шум
+// загруженной машины (кэш, частота, соседние тесты ctest -j)
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    constexpr double MAX_EXPONENT = 1.6;
+    constexpr size_t MAX_INPUT = 10000;         // Предел длины строки в Lexer
+    constexpr size_t SIZES = 5;                 // Входы от n/16 до n
+    constexpr int REPEATS = 7;                  // Лучший из замеров каждого размера
+    constexpr int ATTEMPTS = 5;                 // Повторная оценка при выбросе
+    constexpr double SAMPLE_SECONDS = 0.003;
+
+    volatile double sink;
+
+    struct Shape {
+        const char* name;
+        std::string (*make)(size_t units);
+    };
+
+    std::string additive(size_t units) {
+        std::string text = "1";
+        for (size_t i = 1; i < units; ++i) {
+            text += i % 2 ? " + " : " - ";
+            text += std::to_string(i % 997) + ".5";
+        }
+        return text;
+    }
+
+    std::string mixed(size_t units) {
+        const char* const operators[] = {" * ", " / ", " + ", " % ", " - ", " ^ "};
+        std::string text = "2";
+        for (size_t i = 1; i < units; ++i) {
+            text += operators[i % 6];
+            text += std::to_string(1 + i % 7);
+        }
+        return text;
+    }
+
+    std::string functions(size_t units) {
+        const char* const names[] = {"sin", "sqrt", "exp", "abs", "log", "cos"};
+        std::string text;
+        for (size_t i = 0; i < units; ++i) {
+            text += i == 0 ? "" : " + ";
+            text += names[i % 6];
+            text += "(0." + std::to_string(1 + i % 9) + ")";
+        }
+        return text;
+    }
+
+    std::string bitwise(size_t units) {
+        const char* const operators[] = {" AND ", " OR ", " XOR "};
+        std::string text = "255";
+        for (size_t i = 1; i < units; ++i) {
+            text += operators[i % 3];
+            text += i % 4 ? std::to_string(i % 256) : "NOT " + std::to_string(i % 256);
+            text += i % 5 ? "" : " << 1 >> 1";
+        }
+        return text;
+    }
+
+    // Сбалансированные группы: дерево растёт вширь, глубина постоянна
+    std::string groups(size_t units) {
+        std::string text;
+        for (size_t i = 0; i < units; ++i) {
+            text += i == 0 ? "" : " + ";
+            text += "((1 < 2) ? (3 * (4 - 5)) : 6)";
+        }
+        return text;
+    }
+
+    std::string signs(size_t units) {
+        return std::string(units, '-') + "1";
+    }
+
+    std::string parentheses(size_t depth) {
+        return std::string(depth, '(') + "1" + std::string(depth, ')');
+    }
+
+    // Глубина ограничена парсером, поэтому растёт число глубоких групп
+    std::string nested(size_t units) {
+        std::string group = std::string(64, '(') + "1";
+        for (int level = 0; level < 64; ++level) {
+            group += level % 2 ? " * 2)" : " - 1)";
+        }
+        std::string text;
+        for (size_t i = 0; i < units; ++i) {
+            text += i == 0 ? group : " + " + group;
+        }
+        return text;
+    }
+
+    const Shape SHAPES[] = {
+        {"additive", additive},
+        {"mixed", mixed},
+        {"functions", functions},
+        {"bitwise", bitwise},
+        {"groups", groups},
+        {"signs", signs},
+        {"nested", nested},
+    };
+
+    // Наибольшее число звеньев, удваиваемое от 1, при котором строка влезает в MAX_INPUT
+    size_t largestUnits(const Shape& shape) {
+        size_t units = 1;
+        while (shape.make(units * 2).size() <= MAX_INPUT) {
+            units *= 2;
+        }
+        return units;
+    }
+
+    std::vector<std::string> inputs(const Shape& shape) {
+        std::vector<std::string> texts;
+        size_t units = largestUnits(shape) >> (SIZES - 1);
+        for (size_t i = 0; i < SIZES; ++i, units *= 2) {
+            texts.push_back(shape.make(units));
+        }
+        return texts;
+    }
+
+    // Секунды на вызов work(): лучший из REPEATS замеров по SAMPLE_SECONDS
+    template<typename Work>
+    double secondsPerCall(Work& work) {
+        size_t calls = 1;
+        while (true) {
+            auto start = Clock::now();
+            for (size_t i = 0; i < calls; ++i) {
+                work();
+            }
+            if (std::chrono::duration<double>(Clock::now() - start).count() >= SAMPLE_SECONDS) {
+                break;
+            }
+            calls *= 2;
+        }
+        double best = std::numeric_limits<double>::infinity();
+        for (int r = 0; r < REPEATS; ++r) {
+            auto start = Clock::now();
+            for (size_t i = 0; i < calls; ++i) {
+                work();
+            }
+            best = std::min(best, std::chrono::duration<double>(Clock::now() - start).count());
+        }
+        return best / static_cast<double>(calls);
+    }
+
+    // Наклон прямой МНК через точки (log n, log time)
+    double fitExponent(const std::vector<double>& sizes, const std::vector<double>& seconds) {
+        double meanX = 0.0;
+        double meanY = 0.0;
+        for (size_t i = 0; i < sizes.size(); ++i) {
+            meanX += std::log(sizes[i]);
+            meanY += std::log(seconds[i]);
+        }
+        meanX /= static_cast<double>(sizes.size());
+        meanY /= static_cast<double>(sizes.size());
+        double covariance = 0.0;
+        double variance = 0.0;
+        for (size_t i = 0; i < sizes.size(); ++i) {
+            double dx = std::log(sizes[i]) - meanX;
+            covariance += dx * (std::log(seconds[i]) - meanY);
+            variance += dx * dx;
+        }
+        return covariance / variance;
+    }
+
+    // Показатель роста makeWork(i)() по размерам sizes[i]; лучший из ATTEMPTS
+    // оценок, чтобы один неудачный замер не ронял тест
+    template<typename MakeWork>
+    double measureExponent(const std::vector<double>& sizes, MakeWork makeWork) {
+        double best = std::numeric_limits<double>::infinity();
+        for (int attempt = 0; attempt < ATTEMPTS && best > MAX_EXPONENT; ++attempt) {
+            std::vector<double> seconds;
+            for (size_t i = 0; i < sizes.size(); ++i) {
+                auto work = makeWork(i);
+                seconds.push_back(secondsPerCall(work));
+            }
+            best = std::min(best, fitExponent(sizes, seconds));
+        }
+        return best;
+    }
+
+    std::vector<double> lengths(const std::vector<std::string>& texts) {
+        std::vector<double> sizes;
+        for (const auto& text : texts) {
+            sizes.push_back(static_cast<double>(text.size()));
+        }
+        return sizes;
+    }
+
+    std::unique_ptr<Node> parse(const std::string& text) {
+        Lexer lexer(text);
+        Parser parser(lexer.tokenize());
+        return parser.parse();
+    }
+
+    // Стадия stage(text) для всех форм выражений
+    template<typename Stage>
+    void expectScalable(const char* stageName, Stage stage) {
+        for (const Shape& shape : SHAPES) {
+            std::vector<std::string> texts = inputs(shape);
+            double exponent = measureExponent(lengths(texts), [&](size_t i) {
+                return stage(texts[i]);
+            });
+            EXPECT_LE(exponent, MAX_EXPONENT) << stageName << " on " << shape.name << " inputs of "
+                                              << texts.front().size() << ".." << texts.back().size()
+                                              << " characters";
+        }
+    }
+}
+
+TEST(ComplexityTest, FitSeparatesLinearFromQuadratic) {
+    std::vector<double> sizes = {256, 512, 1024, 2048, 4096};
+    double linear = measureExponent(sizes, [&](size_t i) {
+        size_t n = static_cast<size_t>(sizes[i]);
+        return [n] {
+            uint64_t sum = 0;
+            for (size_t a = 0; a < n * 64; ++a) {
+                sum += a ^ (sum >> 3);
+            }
+            sink = static_cast<double>(sum);
+        };
+    });
+    EXPECT_LE(linear, MAX_EXPONENT);
+
+    std::vector<double> quadraticSeconds;
+    for (double size : sizes) {
+        size_t n = static_cast<size_t>(size);
+        auto work = [n] {
+            uint64_t sum = 0;
+            for (size_t a = 0; a < n; ++a) {
+                for (size_t b = 0; b < n; ++b) {
+                    sum += a ^ (b + (sum >> 3));
+                }
+            }
+            sink = static_cast<double>(sum);
+        };
+        quadraticSeconds.push_back(secondsPerCall(work));
+    }
+    EXPECT_GT(fitExponent(sizes, quadraticSeconds), MAX_EXPONENT);
+}
+
+TEST(ComplexityTest, LexerScalesLinearly) {
+    expectScalable("lexer", [](const std::string& text) {
+        return [&text] {
+            Lexer lexer(text);
+            sink = static_cast<double>(lexer.tokenize().size());
+        };
+    });
+}
+
+TEST(ComplexityTest, ParserScalesLinearly) {
+    expectScalable("parser", [](const std::string& text) {
+        Lexer lexer(text);
+        auto tokens = std::make_shared<std::vector<Token>>(lexer.tokenize());
+        return [tokens] {
+            Parser parser(*tokens);
+            sink = parser.parse() ? 1.0 : 0.0;
+        };
+    });
+}
+
+TEST(ComplexityTest, OptimizerScalesLinearly) {
+    expectScalable("parser and optimizer", [](const std::string& text) {
+        return [&text] {
+            OptimizerOptions options;
+            options.fastMath = true;
+            Optimizer optimizer(options);
+            sink = optimizer.optimize(parse(text)) ? 1.0 : 0.0;
+        };
+    });
+}
+
+TEST(ComplexityTest, EvaluatorScalesLinearly) {
+    expectScalable("evaluator", [](const std::string& text) {
+        std::shared_ptr<Node> tree = parse(text);
+        return [tree] { sink = tree->evaluate(); };
+    });
+}
+
+TEST(ComplexityTest, ProgramScalesLinearly) {
+    expectScalable("compiler", [](const std::string& text) {
+        std::shared_ptr<Node> tree = parse(text);
+        return [tree] { sink = static_cast<double>(Program::compile(*tree).code().size()); };
+    });
+    expectScalable("program", [](const std::string& text) {
+        auto program = std::make_shared<Program>(Program::compile(*parse(text)));
+        return [program] { sink = program->view().evaluate(); };
+    });
+}
+
+TEST(ComplexityTest, LineScalesLinearly) {
+    expectScalable("evaluateLine", [](const std::string& text) {
+        return [&text] {
+            std::string out;
+            evaluateLine(text, Variables(), BatchOptions(), out);
+            sink = static_cast<double>(out.size());
+        };
+    });
+}
+
+// Длина вывода: форматирование и пакетный режим по числу строк
+TEST(ComplexityTest, FormatterAndBatchScaleLinearly) {
+    std::vector<double> sizes = {1024, 2048, 4096, 8192, 16384};
+    const double samples[] = {42.0, 0.1, 1.0 / 3.0, -1.5e300, 6.02e-23, 1e21};
+    for (double value : samples) {
+        double exponent = measureExponent(sizes, [&](size_t i) {
+            size_t count = static_cast<size_t>(sizes[i]);
+            return [count, value] {
+                std::string out;
+                for (size_t n = 0; n < count; ++n) {
+                    appendNumber(out, value * static_cast<double>(n + 1));
+                    out += '\n';
+                }
+                sink = static_cast<double>(out.size());
+            };
+        });
+        EXPECT_LE(exponent, MAX_EXPONENT) << "appendNumber of " << value;
+    }
+
+    std::vector<std::string> texts;
+    for (double size : sizes) {
+        std::string text;
+        for (size_t n = 0; n < static_cast<size_t>(size); ++n) {
+            text += n % 7 == 0 ? "1 / 0\n" : std::to_string(n) + " * 1.5 + sqrt(2)\n";
+        }
+        texts.push_back(std::move(text));
+    }
+    double exponent = measureExponent(sizes, [&](size_t i) {
+        return [&text = texts[i]] {
+            std::string out;
+            sink = static_cast<double>(evaluateLines(text, Variables(), BatchOptions(), out).lines);
+        };
+    });
+    EXPECT_LE(exponent, MAX_EXPONENT) << "evaluateLines";
+}
+
+// Патологические, но допустимые входы: ни переполнения стека, ни квадратичного роста
+
+TEST(ComplexityTest, HundredThousandUnaryMinuses) {
+    // Строка такой длины отвергается Lexer, поэтому токены подаются напрямую
+    for (size_t count : {100000u, 100001u}) {
+        std::vector<Token> tokens(count, Token(TokenType::Minus));
+        tokens.emplace_back(TokenType::Number, 5.0);
+        tokens.emplace_back(TokenType::End);
+        Parser parser(std::move(tokens));
+        auto tree = parser.parse();
+        EXPECT_EQ(tree->evaluate(), count % 2 ? -5.0 : 5.0);
+        EXPECT_EQ(Program::compile(*tree).view().evaluate(), count % 2 ? -5.0 : 5.0);
+    }
+
+    EXPECT_THROW(Lexer(std::string(100000, '-') + "5"), ParseError);
+    std::string out;
+    EXPECT_TRUE(evaluateLine(std::string(MAX_INPUT - 1, '-') + "5", Variables(), BatchOptions(), out));
+    EXPECT_EQ(out, "-5\n");
+}
+
+TEST(ComplexityTest, SignRunsKeepOperandChecks) {
+    Variables variables;
+    variables.set("x", std::numeric_limits<double>::infinity());
+    Lexer lexer("- - + -x");
+    Parser parser(lexer.tokenize(), &variables);
+    EXPECT_THROW(parser.parse()->evaluate(), EvalError);
+    EXPECT_EQ(parse("- - + -3")->evaluate(), -3.0);
+    EXPECT_EQ(parse("-NOT -2")->evaluate(), -1.0);
+    EXPECT_EQ(parse("--2^2")->evaluate(), 4.0);
+}
+
+TEST(ComplexityTest, LongestFlatChains) {
+    // Левоассоциативная цепочка на всю длину строки — дерево глубиной ~5000
+    std::string text = "1";
+    while (text.size() + 2 <= MAX_INPUT) {
+        text += "+1";
+    }
+    double expected = static_cast<double>((text.size() + 1) / 2);
+    auto tree = parse(text);
+    EXPECT_EQ(tree->evaluate(), expected);
+    EXPECT_EQ(Program::compile(*tree).view().evaluate(), expected);
+    Optimizer optimizer;
+    auto optimized = optimizer.optimize(std::move(tree));
+    EXPECT_EQ(optimized->evaluate(), expected);
+    EXPECT_EQ(optimizer.report().nodesAfter, 1u);
+}
+
+TEST(ComplexityTest, NestingIsLimited) {
+    EXPECT_EQ(parse(parentheses(255))->evaluate(), 1.0);
+
+    std::string power = "1";
+    std::string conditional;
+    std::string bitwiseNot;
+    for (int i = 0; i < 2000; ++i) {
+        power += "^1";
+        conditional += "1?1:";
+        bitwiseNot += "NOT ";
+    }
+    // Глубже предела — ParseError, а не переполнение стека
+    for (const std::string& text : {parentheses(256), parentheses((MAX_INPUT - 1) / 2),
+                                    power, conditional + "1", bitwiseNot + "1",
+                                    "sin(" + parentheses(300) + ")"}) {
+        try {
+            parse(text);
+            FAIL() << "accepted nesting of " << text.size() << " characters";
+        } catch (const ParseError& e) {
+            EXPECT_NE(std::string(e.what()).find("nested too deeply"), std::string::npos);
+        }
+    }
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include "csv.hpp"
+#include "error.hpp"
+#include "variables.hpp"
+
+using namespace calc;
+
+namespace {
+
+std::string run(const std::string& text, const std::string& expression, CsvStats* stats = nullptr,
+                CsvOptions options = CsvOptions(), const Variables& variables = Variables()) {
+    std::FILE* in = std::tmpfile();
+    std::fwrite(text.data(), 1, text.size(), in);
+    std::rewind(in);
+    std::FILE* out = std::tmpfile();
+    {
+        LineReader reader(in, 16);
+        BufferedWriter writer(out, 16);
+        CsvStats result = runCsv(reader, writer, expression, variables, options);
+        if (stats) {
+            *stats = result;
+        }
+    }
+    std::rewind(out);
+    std::string written;
+    char buf[256];
+    size_t read;
+    while ((read = std::fread(buf, 1, sizeof(buf), out)) > 0) {
+        written.append(buf, read);
+    }
+    std::fclose(in);
+    std::fclose(out);
+    return written;
+}
+
+} // namespace
+
+TEST(CsvTest, AppendsResultColumn) {
+    CsvStats stats;
+    std::string output = run("item,price,qty,discount\n"
+                             "apple,1.5,4,0\n"
+                             "\"pear, green\",2,3,0.5\n",
+                             "price * qty * (1 - discount)", &stats);
+    EXPECT_EQ(output, "item,price,qty,discount,result\n"
+                      "apple,1.5,4,0,6\n"
+                      "\"pear, green\",2,3,0.5,3\n");
+    EXPECT_EQ(stats.rows, 2u);
+    EXPECT_EQ(stats.errors, 0u);
+    EXPECT_EQ(stats.columns, 3u);    // item не читается
+    EXPECT_TRUE(stats.compiled);
+}
+
+TEST(CsvTest, ResultOnlyWithVariablesAndNamedColumn) {
+    CsvOptions options;
+    options.resultOnly = true;
+    options.resultColumn = "total";
+    Variables variables;
+    variables.set("tax", 0.25);
+    variables.set("qty", 100.0);    // Столбец закрывает переменную
+    EXPECT_EQ(run("qty, price\n2, 10\n\n3, 20\r\n", "qty * price * (1 + tax)", nullptr, options, variables),
+              "total\n25\n75\n");
+}
+
+TEST(CsvTest, ErrorsStayOnTheirRows) {
+    CsvStats stats;
+    std::string output = run("a,b\n1,2\n1,0\nx,1\n4\n9,3\n", "a / b", &stats);
+    EXPECT_EQ(output, "a,b,result\n"
+                      "1,2,0.5\n"
+                      "1,0,error: Division by zero\n"
+                      "x,1,\"error: Not a number in column a: \"\"x\"\"\"\n"
+                      "4,\"error: Expected 2 fields, got 1\"\n"
+                      "9,3,3\n");
+    EXPECT_EQ(stats.rows, 5u);
+    EXPECT_EQ(stats.errors, 3u);
+}
+
+TEST(CsvTest, BlocksMatchRowByRow) {
+    // Длинный файл через блоки разного размера и выражение с sum, которое
+    // вычисляется деревом по строкам, дают одни и те же значения
+    std::string text = "x,y\n";
+    for (int i = 0; i < 1000; ++i) {
+        text += std::to_string(i * 0.37) + "," + std::to_string(i % 7) + "\n";
+    }
+    CsvOptions options;
+    options.resultOnly = true;
+    std::string expected = run(text, "sum(k, 1, 1, x * k) + sin(y) ^ 2", nullptr, options);
+    for (size_t blockRows : {1u, 7u, 4096u}) {
+        options.blockRows = blockRows;
+        CsvStats stats;
+        EXPECT_EQ(run(text, "x + sin(y) ^ 2", &stats, options), expected) << blockRows;
+        EXPECT_TRUE(stats.compiled);
+    }
+}
+
+TEST(CsvTest, InvalidInput) {
+    EXPECT_THROW(run("", "1"), std::runtime_error);
+    EXPECT_THROW(run("a,b\n1,2\n", "a + c"), ParseError);
+    EXPECT_THROW(run("a,b\n1,2\n", "a +"), ParseError);
+}
+
+TEST(CsvTest, ReservedHeadersAreNotBound) {
+    // Столбцы e, pi, AND не мешают выражению, которое на них не ссылается
+    CsvStats stats;
+    EXPECT_EQ(run("a,pi,AND,e\n1,2,3,4\n", "a * 2 + 1e1", &stats), "a,pi,AND,e,result\n1,2,3,4,12\n");
+    EXPECT_EQ(stats.columns, 1u);
+    EXPECT_EQ(stats.errors, 0u);
+
+    // Ссылка на такой столбец прочиталась бы как константа или операция
+    EXPECT_THROW(run("e,b\n1,2\n", "e * 2"), ParseError);
+    EXPECT_THROW(run("a,pi\n1,2\n", "a * sin(pi)"), ParseError);
+    EXPECT_THROW(run("a,AND\n1,2\n", "a AND 1"), ParseError);
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include "format.hpp"
+
+using namespace calc;
+
+namespace {
+
+std::string format(double value, NumberFormat style, int precision = -1) {
+    FormatOptions options;
+    options.style = style;
+    options.precision = precision;
+    return formatNumber(value, options);
+}
+
+} // namespace
+
+TEST(FormatTest, ShortestRoundTrips) {
+    EXPECT_EQ(formatNumber(0.1 + 0.2), "0.30000000000000004");
+    EXPECT_EQ(formatNumber(0.1), "0.1");
+    EXPECT_EQ(formatNumber(3.0), "3");
+    EXPECT_EQ(formatNumber(-2.5), "-2.5");
+    EXPECT_EQ(formatNumber(1e21), "1e+21");
+    EXPECT_EQ(formatNumber(1e-7), "1e-07");
+    EXPECT_EQ(formatNumber(123456789012.0), "123456789012");
+    EXPECT_EQ(formatNumber(std::numeric_limits<double>::infinity()), "inf");
+    EXPECT_EQ(formatNumber(-std::numeric_limits<double>::infinity()), "-inf");
+    EXPECT_EQ(formatNumber(-std::nan("")), "nan");
+
+    std::mt19937_64 random(42);
+    for (int i = 0; i < 10000; ++i) {
+        uint64_t bits = random();
+        double value;
+        std::memcpy(&value, &bits, sizeof(value));
+        if (!std::isfinite(value)) {
+            continue;
+        }
+        for (NumberFormat style : {NumberFormat::Shortest, NumberFormat::Fixed, NumberFormat::Scientific,
+                                   NumberFormat::Hex, NumberFormat::Engineering}) {
+            std::string text = format(value, style);
+            ASSERT_EQ(std::strtod(text.c_str(), nullptr), value) << text;
+        }
+    }
+}
+
+TEST(FormatTest, Styles) {
+    EXPECT_EQ(format(1234.5, NumberFormat::Fixed), "1234.5");
+    EXPECT_EQ(format(1e-5, NumberFormat::Fixed), "0.00001");
+    EXPECT_EQ(format(2.0 / 3.0, NumberFormat::Fixed, 3), "0.667");
+    EXPECT_EQ(format(1234.5, NumberFormat::Scientific), "1.2345e+03");
+    EXPECT_EQ(format(1234.5, NumberFormat::Scientific, 2), "1.23e+03");
+    EXPECT_EQ(format(3.0, NumberFormat::Hex), "0x1.8p+1");
+    EXPECT_EQ(format(-1.0, NumberFormat::Hex), "-0x1p+0");
+    EXPECT_EQ(format(1.0, NumberFormat::Shortest, 3), "1");
+    EXPECT_EQ(format(2.0 / 3.0, NumberFormat::Shortest, 3), "0.667");
+}
+
+TEST(FormatTest, EngineeringExponentIsMultipleOfThree) {
+    EXPECT_EQ(format(12500.0, NumberFormat::Engineering), "12.5e+03");
+    EXPECT_EQ(format(100000.0, NumberFormat::Engineering), "100e+03");
+    EXPECT_EQ(format(1.5, NumberFormat::Engineering), "1.5e+00");
+    EXPECT_EQ(format(0.000125, NumberFormat::Engineering), "125e-06");
+    EXPECT_EQ(format(-0.0125, NumberFormat::Engineering), "-12.5e-03");
+    EXPECT_EQ(format(0.0, NumberFormat::Engineering), "0e+00");
+    EXPECT_EQ(format(12345.0, NumberFormat::Engineering, 2), "12.3e+03");
+}
+
+TEST(FormatTest, CallerBuffer) {
+    char small[4];
+    EXPECT_EQ(formatNumber(small, small + sizeof(small), 12345.0), nullptr);
+    char exact[5];
+    char* end = formatNumber(exact, exact + sizeof(exact), 12345.0);
+    ASSERT_NE(end, nullptr);
+    EXPECT_EQ(std::string(exact, end), "12345");
+
+    // Самая длинная запись помещается в FORMAT_BUFFER_SIZE
+    char buf[FORMAT_BUFFER_SIZE];
+    FormatOptions options{NumberFormat::Fixed, 1000};
+    end = formatNumber(buf, buf + sizeof(buf), -std::numeric_limits<double>::max(), options);
+    ASSERT_NE(end, nullptr);
+    EXPECT_EQ(end - buf, 1 + 309 + 1 + MAX_PRECISION);
+    end = formatNumber(buf, buf + sizeof(buf), std::numeric_limits<double>::denorm_min(),
+                       FormatOptions{NumberFormat::Fixed, -1});
+    ASSERT_NE(end, nullptr);
+    EXPECT_EQ(std::strtod(std::string(buf, end).c_str(), nullptr), std::numeric_limits<double>::denorm_min());
+}
+
+TEST(FormatTest, ParseNames) {
+    NumberFormat style = NumberFormat::Shortest;
+    EXPECT_TRUE(parseNumberFormat("engineering", style));
+    EXPECT_EQ(style, NumberFormat::Engineering);
+    EXPECT_TRUE(parseNumberFormat("hex", style));
+    EXPECT_EQ(style, NumberFormat::Hex);
+    EXPECT_FALSE(parseNumberFormat("roman", style));
+}
@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include "history.hpp"
+#include "error.hpp"
+
+using namespace calc;
+
+namespace {
+
+// История во временном каталоге; файлы удаляются до и после теста
+class HistoryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path_ = (std::filesystem::temp_directory_path() /
+                 (std::string("calc_test_") + ::testing::UnitTest::GetInstance()->current_test_info()->name() +
+                  ".log")).string();
+        removeFiles();
+    }
+
+    void TearDown() override {
+        removeFiles();
+    }
+
+    void removeFiles() {
+        for (const char* suffix : {"", ".idx", ".sorted", ".sorted.tmp"}) {
+            std::filesystem::remove(path_ + suffix);
+        }
+    }
+
+    static HistoryOptions smallIndex(size_t limit) {
+        HistoryOptions options;
+        options.unsortedLimit = limit;
+        return options;
+    }
+
+    // Номера записей с префиксом в порядке поиска: по выражению, затем по номеру
+    static std::vector<uint64_t> expected(const std::vector<std::string>& expressions, const std::string& prefix) {
+        std::vector<uint64_t> indices;
+        for (size_t i = 0; i < expressions.size(); ++i) {
+            if (expressions[i].compare(0, prefix.size(), prefix) == 0) {
+                indices.push_back(i);
+            }
+        }
+        std::stable_sort(indices.begin(), indices.end(), [&](uint64_t a, uint64_t b) {
+            return expressions[a] < expressions[b];
+        });
+        return indices;
+    }
+
+    static std::vector<uint64_t> rows(const HistoryMatches& matches) {
+        std::vector<uint64_t> indices;
+        for (size_t row = 0; row < matches.size(); ++row) {
+            indices.push_back(matches[row]);
+        }
+        return indices;
+    }
+
+    std::string path_;
+};
+
+} // namespace
+
+TEST_F(HistoryTest, EntriesPersistAcrossReopen) {
+    {
+        HistoryLog log(path_);
+        EXPECT_EQ(log.size(), 0u);
+        log.append("2 + 2", "4");
+        log.append("sqrt(16)", "4");
+        log.append("", "");
+    }
+    HistoryLog log(path_);
+    ASSERT_EQ(log.size(), 3u);
+    EXPECT_EQ(log.at(0).expression, "2 + 2");
+    EXPECT_EQ(log.at(1).expression, "sqrt(16)");
+    EXPECT_EQ(log.at(1).result, "4");
+    EXPECT_EQ(log.at(2).expression, "");
+    EXPECT_THROW(log.at(3), std::out_of_range);
+
+    log.append("1 / 3", "0.333333");
+    EXPECT_EQ(log.size(), 4u);
+    EXPECT_EQ(log.at(3).result, "0.333333");
+    EXPECT_EQ(log.expression(0), "2 + 2");
+}
+
+TEST_F(HistoryTest, PrefixSearchMatchesBruteForceAcrossMerges) {
+    std::vector<std::string> expressions;
+    for (int i = 0; i < 300; ++i) {
+        // Повторы и общие префиксы разной длины
+        expressions.push_back(std::to_string(i % 37) + " * " + std::to_string(i % 5));
+    }
+    const std::vector<std::string> prefixes = {"", "1", "12", "3 ", "36 * 4", "4", "9", "x", "36 * 45"};
+
+    {
+        // Маленький предел: PATH.sorted перестраивается много раз
+        HistoryLog log(path_, smallIndex(16));
+        for (size_t i = 0; i < expressions.size(); ++i) {
+            log.append(expressions[i], std::to_string(i));
+            if (i % 23 == 0) {
+                std::vector<std::string> added(expressions.begin(), expressions.begin() + i + 1);
+                for (const auto& prefix : prefixes) {
+                    EXPECT_EQ(rows(log.findPrefix(prefix)), expected(added, prefix)) << prefix << " after " << i;
+                }
+            }
+        }
+    }
+
+    // После открытия с другим пределом индекс поиска тот же
+    HistoryLog log(path_, smallIndex(1000));
+    for (const auto& prefix : prefixes) {
+        EXPECT_EQ(rows(log.findPrefix(prefix)), expected(expressions, prefix)) << prefix;
+    }
+}
+
+TEST_F(HistoryTest, TornAppendIsRecovered) {
+    {
+        HistoryLog log(path_);
+        log.append("1 + 1", "2");
+        log.append("2 + 2", "4");
+    }
+    // Сбой посреди записи данных: в файле половина третьей записи
+    {
+        std::FILE* file = std::fopen(path_.c_str(), "ab");
+        ASSERT_NE(file, nullptr);
+        const char torn[] = {9, 0, 0, 0, 1, 0, 0, 0, '3', ' '};
+        std::fwrite(torn, 1, sizeof(torn), file);
+        std::fclose(file);
+    }
+    // ...и оборванное смещение в индексе
+    {
+        std::FILE* file = std::fopen((path_ + ".idx").c_str(), "ab");
+        ASSERT_NE(file, nullptr);
+        std::fwrite("\x50\x00\x00", 1, 3, file);
+        std::fclose(file);
+    }
+    {
+        HistoryLog log(path_);
+        ASSERT_EQ(log.size(), 2u);
+        log.append("3 + 3", "6");
+        EXPECT_EQ(log.at(2).expression, "3 + 3");
+    }
+
+    // Сбой между записью данных и индекса: запись восстанавливается по данным
+    std::filesystem::resize_file(path_ + ".idx", std::filesystem::file_size(path_ + ".idx") - 8);
+    HistoryLog log(path_);
+    ASSERT_EQ(log.size(), 3u);
+    EXPECT_EQ(log.at(2).result, "6");
+    EXPECT_EQ(rows(log.findPrefix("3")), std::vector<uint64_t>{2});
+}
+
+TEST_F(HistoryTest, ForeignFileIsRejected) {
+    {
+        std::FILE* file = std::fopen(path_.c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        std::fputs("x,y\n1,2\n3,4\n5,6\n7,8\n9,10\n11,12\n", file);
+        std::fclose(file);
+    }
+    EXPECT_THROW(HistoryLog log(path_), FormatError);
+}
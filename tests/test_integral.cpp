@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "evaluator.hpp"
+#include "program.hpp"
+#include "variables.hpp"
+#include "error.hpp"
+
+using namespace calc;
+
+namespace {
+
+std::unique_ptr<Node> parse_with(const std::string& expr, const Variables* vars = nullptr) {
+    Lexer lexer(expr);
+    Parser parser(lexer.tokenize(), vars);
+    return parser.parse();
+}
+
+const IntegralNode& asIntegral(const std::unique_ptr<Node>& ast) {
+    return dynamic_cast<const IntegralNode&>(*ast);
+}
+
+std::string errorOf(const std::string& expr) {
+    try {
+        parse_with(expr)->evaluate();
+    } catch (const EvalError& e) {
+        return e.what();
+    }
+    return "";
+}
+
+const double PI = 3.14159265358979323846;
+
+} // namespace
+
+TEST(IntegralTest, KnownIntegrals) {
+    struct Case {
+        const char* expr;
+        double expected;
+    };
+    const Case cases[] = {
+        {"integrate(x^2, x, 0, 3)", 9.0},
+        {"integrate(sin(t), t, 0, pi)", 2.0},
+        {"integrate(exp(-(x^2)), x, -10, 10)", std::sqrt(PI)},
+        {"integrate(1 / sqrt(x), x, 0, 1)", 2.0},                 // Особенность на конце
+        {"integrate(abs(x - 1 / 3), x, 0, 1)", 5.0 / 18.0},       // Излом внутри
+        {"integrate(sin(50 * x) ^ 2, x, 0, pi)", PI / 2.0},      // Осцилляции
+        {"integrate(x, x, 2, 0)", -2.0},                          // Обратные пределы
+        {"integrate(7, x, 1, 1)", 0.0},
+        {"integrate(x * y, x, 0, 1) + integrate(y, y, 0, 2)", 0.5 * 3.0 + 2.0},
+    };
+    Variables vars;
+    vars.set("y", 3.0);
+    for (const auto& c : cases) {
+        auto ast = parse_with(c.expr, &vars);
+        EXPECT_NEAR(ast->evaluate(), c.expected, 1e-9 * std::max(1.0, std::abs(c.expected))) << c.expr;
+    }
+
+    // Вложенный интеграл вычисляется по дереву: площадь четверти круга
+    auto nested = parse_with("integrate(integrate(1, y, 0, sqrt(1 - x^2)), x, 0, 1, 1e-8)", &vars);
+    EXPECT_NEAR(nested->evaluate(), PI / 4.0, 1e-7);
+}
+
+TEST(IntegralTest, ReportsErrorEstimate) {
+    auto ast = parse_with("integrate(ln(x) * cos(3 * x), x, 0.001, 4)");
+    const auto& node = asIntegral(ast);
+    double value = evaluateIntegral(node, 1);
+    IntegrationReport report = node.report();
+    EXPECT_EQ(report.value, value);
+    EXPECT_GT(report.errorEstimate, 0.0);
+    EXPECT_LE(report.errorEstimate, 1e-10 * std::max(1.0, std::abs(value)));
+    EXPECT_EQ(report.evaluations % 15, 0u);
+    EXPECT_GT(report.intervals, 1u);
+
+    // Разбиение не зависит от числа потоков
+    for (size_t threads : {2, 4}) {
+        EXPECT_EQ(evaluateIntegral(node, threads), value) << threads;
+        EXPECT_EQ(node.report().evaluations, report.evaluations);
+    }
+
+    // Грубый допуск — меньше вычислений
+    auto coarse = parse_with("integrate(ln(x) * cos(3 * x), x, 0.001, 4, 1e-4)");
+    coarse->evaluate();
+    EXPECT_LT(asIntegral(coarse).report().evaluations, report.evaluations);
+}
+
+TEST(IntegralTest, Errors) {
+    EXPECT_EQ(errorOf("integrate(1 / x, x, -1, 1)"), errorOf("1 / 0"));
+    EXPECT_EQ(errorOf("integrate(sqrt(x), x, -1, 1)"), errorOf("sqrt(-1)"));
+    EXPECT_EQ(errorOf("integrate(x, x, 0, 1, 0)"), "Tolerance of integrate() must be positive");
+    EXPECT_NE(errorOf("integrate(x ^ -1, x, 0, 1)").find("did not converge"), std::string::npos);
+    EXPECT_EQ(errorOf("integrate(1e300, x, -1e300, 1e300)"), "Overflow in integrate()");
+
+    EXPECT_THROW(parse_with("integrate(x, 0, 1)"), ParseError);
+    EXPECT_THROW(parse_with("integrate(x)"), ParseError);
+    EXPECT_THROW(parse_with("integrate(x, x, 0)"), ParseError);
+    EXPECT_THROW(parse_with("integrate(x, x, 0, x)"), ParseError);  // Переменная видна только в expr
+
+    Variables vars;
+    vars.set("a", 1.0);
+    auto dependent = parse_with("integrate(a * x, x, 0, 1)", &vars);
+    EXPECT_THROW(Program::compile(*dependent), EvalError);
+
+    // Режим Deferred сообщает то же, что и Checked
+    auto deferred = parse_with("ln(-1) + integrate(1 / x, x, -1, 1)");
+    Evaluator evaluator(EvalMode::Deferred);
+    try {
+        evaluator.evaluate(deferred);
+        ADD_FAILURE() << "expected EvalError";
+    } catch (const EvalError& e) {
+        EXPECT_EQ(std::string(e.what()), errorOf("ln(-1)"));
+    }
+}
@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "evaluator.hpp"
+#include "optimizer.hpp"
+#include "variables.hpp"
+#include "error.hpp"
+
+using namespace calc;
+
+namespace {
+
+std::unique_ptr<Node> parse_with(const std::string& expr, const Variables& vars) {
+    Lexer lexer(expr);
+    Parser parser(lexer.tokenize(), &vars);
+    return parser.parse();
+}
+
+std::unique_ptr<Node> optimize(std::unique_ptr<Node> ast, bool fastMath = false,
+                               OptimizationReport* report = nullptr) {
+    OptimizerOptions options;
+    options.fastMath = fastMath;
+    Optimizer optimizer(options);
+    auto result = optimizer.optimize(std::move(ast));
+    if (report) {
+        *report = optimizer.report();
+    }
+    return result;
+}
+
+// Результат или текст ошибки — для сравнения оптимизированного и исходного дерева
+std::string outcome(const Node& node) {
+    try {
+        double value = node.evaluate();
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%a", value);
+        return buf;
+    } catch (const EvalError& e) {
+        return std::string("error: ") + e.what();
+    }
+}
+
+} // namespace
+
+TEST(OptimizerTest, FoldsConstantSubtrees) {
+    Variables vars;
+    vars.set("x", 3.0);
+    OptimizationReport report;
+    auto ast = optimize(parse_with("x * (2 + 3 * 4)", vars), false, &report);
+    
+    EXPECT_EQ(report.nodesBefore, 7u);
+    EXPECT_EQ(report.nodesAfter, 3u);
+    EXPECT_DOUBLE_EQ(ast->evaluate(), 42.0);
+}
+
+TEST(OptimizerTest, KeepsErrorsForRuntime) {
+    Variables vars;
+    auto ast = optimize(parse_with("1 / 0", vars));
+    EXPECT_EQ(countNodes(ast.get()), 3u);
+    EXPECT_THROW(ast->evaluate(), EvalError);
+}
+
+TEST(OptimizerTest, RemovesIdentities) {
+    Variables vars;
+    vars.set("x", 5.0);
+    for (const char* expr : {"+x", "x * 1", "1 * x", "x / 1", "x ^ 1", "-(-x)", "x - 0"}) {
+        auto ast = optimize(parse_with(expr, vars));
+        EXPECT_EQ(countNodes(ast.get()), 1u) << expr;
+        EXPECT_DOUBLE_EQ(ast->evaluate(), 5.0) << expr;
+    }
+    // x + 0 меняет знак нуля при x = -0, поэтому удаляется только в режиме fastMath
+    EXPECT_EQ(countNodes(optimize(parse_with("x + 0", vars)).get()), 3u);
+    EXPECT_EQ(countNodes(optimize(parse_with("x + 0", vars), true).get()), 1u);
+}
+
+TEST(OptimizerTest, StrengthReduction) {
+    Variables vars;
+    vars.set("x", 3.0);
+    OptimizationReport report;
+    
+    optimize(parse_with("x/8 + x/0.25", vars), false, &report);
+    EXPECT_EQ(report.strengthReduced, 1u);
+    
+    // Степени и деление на произвольную константу меняют округление
+    // и выполняются только в режиме fastMath
+    optimize(parse_with("x/3 + x^2 + x^-3", vars), false, &report);
+    EXPECT_EQ(report.strengthReduced, 0u);
+    auto fast = optimize(parse_with("x/3 + x^2 + x^-3", vars), true, &report);
+    EXPECT_EQ(report.strengthReduced, 3u);
+    EXPECT_NEAR(fast->evaluate(), 1.0 + 9.0 + 1.0 / 27.0, 1e-12);
+}
+
+TEST(OptimizerTest, BitIdenticalWithoutFastMath) {
+    Variables vars;
+    double* x = vars.bind("x");
+    const char* exprs[] = {
+        "x^2", "x^-1", "x/8", "x/0.5", "-(-x) * 1 + (-0)", "sin(x)^2 + cos(x)^2",
+        "(x + 2^3) / 4 - x ^ 1", "+x / 1024"
+    };
+    
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+    std::uniform_int_distribution<int> exponent(-1060, 1030);
+    
+    for (const char* expr : exprs) {
+        auto original = parse_with(expr, vars);
+        auto optimized = optimize(parse_with(expr, vars));
+        for (int i = 0; i < 2000; ++i) {
+            *x = std::ldexp(mantissa(gen), exponent(gen));
+            ASSERT_EQ(outcome(*optimized), outcome(*original)) << expr << " at x = " << *x;
+        }
+        *x = 0.0;
+        EXPECT_EQ(outcome(*optimized), outcome(*original)) << expr;
+    }
+}
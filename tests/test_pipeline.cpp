@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <cstdio>
+#include <filesystem>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bounded_queue.hpp"
+#include "mapped_file.hpp"
+#include "pipeline.hpp"
+#include "variables.hpp"
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+using namespace calc;
+
+namespace {
+
+std::FILE* input_file(const std::string& text) {
+    std::FILE* file = std::tmpfile();
+    std::fwrite(text.data(), 1, text.size(), file);
+    std::rewind(file);
+    return file;
+}
+
+std::string read_all(std::FILE* file) {
+    std::rewind(file);
+    std::string text;
+    char buf[4096];
+    size_t read;
+    while ((read = std::fread(buf, 1, sizeof(buf), file)) > 0) {
+        text.append(buf, read);
+    }
+    return text;
+}
+
+Variables test_variables() {
+    Variables vars;
+    vars.set("x", 3.0);
+    return vars;
+}
+
+std::string run_serial(const std::string& text) {
+    Variables vars = test_variables();
+    std::FILE* in = input_file(text);
+    std::FILE* out = std::tmpfile();
+    {
+        LineReader reader(in);
+        BufferedWriter writer(out);
+        runBatch(reader, writer, vars, BatchOptions());
+    }
+    std::string output = read_all(out);
+    std::fclose(in);
+    std::fclose(out);
+    return output;
+}
+
+std::string run_pipeline(const std::string& text, const PipelineOptions& options,
+                         PipelineStats* stats = nullptr) {
+    Variables vars = test_variables();
+    std::FILE* in = input_file(text);
+    std::FILE* out = std::tmpfile();
+    PipelineStats result;
+    {
+        BufferedWriter writer(out, 64);
+        result = runPipeline(in, writer, vars, options);
+    }
+    std::string output = read_all(out);
+    std::fclose(in);
+    std::fclose(out);
+    if (stats) {
+        *stats = result;
+    }
+    return output;
+}
+
+// Строки разной стоимости, ошибки, пустые строки и CRLF
+std::string mixed_input(int lines) {
+    const char* forms[] = {
+        "1 + 2 * 3", "x ^ 2 - 1", "1 / (x - 3)", "", "sin(x) + cos(x)\r",
+        "sum(i, 1, 200, i * x)", "foo(1)", "   ", "sqrt(-x)", "abs(-x) % 2",
+    };
+    std::string text;
+    for (int i = 0; i < lines; ++i) {
+        text += forms[i % 10];
+        text += " + " + std::to_string(i % 7);
+        text += '\n';
+    }
+    return text;
+}
+
+} // namespace
+
+TEST(BoundedQueueTest, FifoAndCapacity) {
+    BoundedQueue<int> queue(3);
+    EXPECT_EQ(queue.capacity(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        int value = i;
+        EXPECT_TRUE(queue.tryPush(value));
+    }
+    int extra = 99;
+    EXPECT_FALSE(queue.tryPush(extra));
+    EXPECT_EQ(extra, 99);
+    EXPECT_EQ(queue.size(), 4u);
+    for (int i = 0; i < 4; ++i) {
+        int value = -1;
+        EXPECT_TRUE(queue.tryPop(value));
+        EXPECT_EQ(value, i);
+    }
+    int value;
+    EXPECT_FALSE(queue.tryPop(value));
+}
+
+TEST(BoundedQueueTest, ManyProducersAndConsumers) {
+    constexpr int PRODUCERS = 4;
+    constexpr int PER_PRODUCER = 20000;
+    BoundedQueue<int> queue(8);
+    std::atomic<long long> total{0};
+    std::atomic<int> consumed{0};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < PRODUCERS; ++p) {
+        threads.emplace_back([&queue, p]() {
+            Backoff backoff;
+            for (int i = 1; i <= PER_PRODUCER; ++i) {
+                int value = p * PER_PRODUCER + i;
+                while (!queue.tryPush(value)) {
+                    backoff.wait();
+                }
+            }
+        });
+    }
+    for (int c = 0; c < 3; ++c) {
+        threads.emplace_back([&]() {
+            Backoff backoff;
+            while (consumed.load() < PRODUCERS * PER_PRODUCER) {
+                int value;
+                if (queue.tryPop(value)) {
+                    total += value;
+                    ++consumed;
+                } else {
+                    backoff.wait();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    long long n = static_cast<long long>(PRODUCERS) * PER_PRODUCER;
+    EXPECT_EQ(consumed.load(), n);
+    EXPECT_EQ(total.load(), n * (n + 1) / 2);
+}
+
+TEST(PipelineTest, MatchesSerialOutput) {
+    std::string input = mixed_input(3000);
+    std::string expected = run_serial(input);
+    for (size_t threads : {1u, 2u, 4u}) {
+        for (size_t chunkSize : {1u, 37u, 4096u}) {
+            PipelineOptions options;
+            options.threads = threads;
+            options.chunkSize = chunkSize;
+            options.queueCapacity = 1;
+            EXPECT_EQ(run_pipeline(input, options), expected)
+                << threads << " threads, chunk " << chunkSize;
+        }
+    }
+}
+
+TEST(PipelineTest, Stats) {
+    std::string input = mixed_input(1000);
+    PipelineOptions options;
+    options.threads = 3;
+    options.chunkSize = 256;
+    options.queueCapacity = 2;
+    PipelineStats stats;
+    run_pipeline(input, options, &stats);
+    EXPECT_EQ(stats.lines, 1000u);
+    EXPECT_EQ(stats.errors, 300u);      // "1 / 0", "foo(1)" и "sqrt(-3)"
+    EXPECT_EQ(stats.bytes, input.size());
+    EXPECT_EQ(stats.threads, 3u);
+    EXPECT_GE(stats.chunks, input.size() / 512);
+    EXPECT_LE(stats.inputDepthMax, 2u);
+    EXPECT_LE(stats.outputDepthMax, 2u);
+    EXPECT_GE(stats.reorderMax, 1u);
+}
+
+TEST(PipelineTest, EdgesOfInput) {
+    PipelineOptions options;
+    options.threads = 2;
+    options.chunkSize = 4;
+    EXPECT_EQ(run_pipeline("", options), "");
+    EXPECT_EQ(run_pipeline("\n", options), "\n");
+    EXPECT_EQ(run_pipeline("1 + 1\r\n2 + 2", options), "2\n4\n");
+
+    // Строка длиннее куска целиком попадает в один кусок
+    std::string longLine = "0";
+    for (int i = 1; i <= 300; ++i) {
+        longLine += " + " + std::to_string(i);
+    }
+    EXPECT_EQ(run_pipeline(longLine + "\nx\n" + longLine, options), "45150\n3\n45150\n");
+}
+
+TEST(PipelineTest, MappedFileInput) {
+    std::string input = mixed_input(2000);
+    auto path = std::filesystem::temp_directory_path() / "calc_test_pipeline.txt";
+    {
+        std::FILE* file = std::fopen(path.string().c_str(), "wb");
+        ASSERT_NE(file, nullptr);
+        std::fwrite(input.data(), 1, input.size(), file);
+        std::fclose(file);
+    }
+    std::string expected = run_serial(input);
+    {
+        MappedFile mapped(path.string());
+        mapped.adviseSequential();
+        ASSERT_EQ(mapped.size(), input.size());
+        std::string_view text(mapped.data(), mapped.size());
+
+        Variables vars = test_variables();
+        for (size_t chunkSize : {1u, 100u, 1u << 18}) {
+            PipelineOptions options;
+            options.threads = 3;
+            options.chunkSize = chunkSize;
+            std::FILE* out = std::tmpfile();
+            PipelineStats stats;
+            {
+                BufferedWriter writer(out);
+                stats = runPipeline(text, writer, vars, options);
+            }
+            EXPECT_EQ(read_all(out), expected) << "chunk " << chunkSize;
+            EXPECT_EQ(stats.lines, 2000u);
+            EXPECT_EQ(stats.bytes, input.size());
+            std::fclose(out);
+        }
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(PipelineTest, MappedFileRejectsNonRegularFiles) {
+    // Размер канала или каталога — не размер данных: пустое отображение
+    // молча потеряло бы ввод
+    EXPECT_THROW(MappedFile(std::filesystem::temp_directory_path().string()), std::runtime_error);
+#ifndef _WIN32
+    auto path = std::filesystem::temp_directory_path() / "calc_test_pipeline.fifo";
+    std::filesystem::remove(path);
+    ASSERT_EQ(::mkfifo(path.string().c_str(), 0600), 0);
+    try {
+        MappedFile mapped(path.string());
+        ADD_FAILURE() << "expected std::runtime_error";
+    } catch (const std::runtime_error& e) {
+        EXPECT_EQ(std::string(e.what()), "Not a regular file: " + path.string());
+    }
+    std::filesystem::remove(path);
+#endif
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "preview.hpp"
+
+using namespace calc;
+
+namespace {
+
+// Получатель, у которого можно дождаться ответа на запрос
+class Collector {
+public:
+    PreviewService::Sink sink() {
+        return [this](const PreviewResult& result) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            results_.push_back(result);
+            arrived_.notify_all();
+        };
+    }
+
+    bool waitFor(uint64_t request) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return arrived_.wait_for(lock, std::chrono::seconds(10), [&] {
+            return !results_.empty() && results_.back().request >= request;
+        });
+    }
+
+    std::vector<PreviewResult> results() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return results_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable arrived_;
+    std::vector<PreviewResult> results_;
+};
+
+PreviewOptions debounced(int milliseconds) {
+    PreviewOptions options;
+    options.debounce = std::chrono::milliseconds(milliseconds);
+    return options;
+}
+
+} // namespace
+
+TEST(PreviewTest, TypingBurstIsEvaluatedOnce) {
+    Collector collector;
+    PreviewService service(collector.sink(), debounced(200));
+    // Набор выражения посимвольно: промежуточные тексты устаревают сразу
+    std::string text = "sqrt(16) * 2 + 10 / 4";
+    uint64_t last = 0;
+    for (size_t length = 1; length <= text.size(); ++length) {
+        last = service.request(text.substr(0, length));
+    }
+    ASSERT_TRUE(collector.waitFor(last));
+
+    auto results = collector.results();
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].request, last);
+    EXPECT_EQ(results[0].expression, text);
+    EXPECT_TRUE(results[0].valid);
+    EXPECT_EQ(results[0].value, 10.5);
+    PreviewStats stats = service.stats();
+    EXPECT_EQ(stats.requests, text.size());
+    EXPECT_EQ(stats.evaluations, 1u);
+}
+
+TEST(PreviewTest, CachedResultSkipsDebounce) {
+    Collector collector;
+    PreviewService service(collector.sink(), debounced(1000));
+    uint64_t first = service.request("2 * 3");
+    ASSERT_TRUE(collector.waitFor(first));
+
+    // Набрали символ и стёрли: старый текст отвечается из кэша, не дожидаясь паузы
+    service.request("2 * 3 +");
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t erased = service.request("2 * 3");
+    ASSERT_TRUE(collector.waitFor(erased));
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::milliseconds(500));
+
+    auto results = collector.results();
+    EXPECT_TRUE(results.back().cached);
+    EXPECT_EQ(results.back().value, 6.0);
+    EXPECT_EQ(service.stats().evaluations, 1u);
+}
+
+TEST(PreviewTest, IncompleteExpressionsHaveNoValue) {
+    Collector collector;
+    PreviewService service(collector.sink(), debounced(0));
+    for (const char* text : {"1 +", "", "1 / 0", "sqrt(", "2 ^ 10"}) {
+        uint64_t request = service.request(text);
+        ASSERT_TRUE(collector.waitFor(request)) << text;
+        auto result = collector.results().back();
+        EXPECT_EQ(result.expression, text);
+        EXPECT_EQ(result.valid, std::string(text) == "2 ^ 10") << text;
+    }
+    EXPECT_EQ(collector.results().back().value, 1024.0);
+}
+
+TEST(PreviewTest, NewRequestCancelsLongEvaluation) {
+    Collector collector;
+    PreviewService service(collector.sink(), debounced(0));
+    service.request("sum(i, 1, 9e9, sin(i))");
+    // Дать вычислению начаться
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    auto begin = std::chrono::steady_clock::now();
+    uint64_t next = service.request("1 + 2");
+    ASSERT_TRUE(collector.waitFor(next));
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(2));
+
+    auto results = collector.results();
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].value, 3.0);
+    EXPECT_EQ(service.stats().cancelled, 1u);
+
+    // Деструктор тоже не ждёт конца долгого вычисления
+    begin = std::chrono::steady_clock::now();
+    {
+        PreviewService abandoned([](const PreviewResult&) {}, debounced(0));
+        abandoned.request("sum(i, 1, 9e9, cos(i))");
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - begin, std::chrono::seconds(2));
+}
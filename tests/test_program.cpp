@@ -0,0 +1,340 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <random>
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "optimizer.hpp"
+#include "program.hpp"
+#include "formula_library.hpp"
+#include "variables.hpp"
+#include "error.hpp"
+
+using namespace calc;
+
+namespace {
+
+std::unique_ptr<Node> parse_with(const std::string& expr, const Variables& vars) {
+    Lexer lexer(expr);
+    Parser parser(lexer.tokenize(), &vars);
+    return parser.parse();
+}
+
+template <typename Evaluate>
+std::string outcome(Evaluate evaluate) {
+    try {
+        double value = evaluate();
+        char buf[64];
+        std::snprintf(buf, sizeof(buf), "%a", value);
+        return buf;
+    } catch (const EvalError& e) {
+        return std::string("error: ") + e.what();
+    }
+}
+
+// Случайное выражение над x и y из операций, функций и констант
+std::string randomExpression(std::mt19937& rng, int depth) {
+    static const char* binary[] = {"+", "-", "*", "/", "%", "^", "AND", "XOR", "<<",
+                                   "<", ">=", "==", "!="};
+    static const char* functions[] = {"sin", "cos", "tan", "sqrt", "log", "exp", "abs",
+                                      "asin", "factorial", "round"};
+    static const char* leaves[] = {"x", "y", "2", "0.5", "3", "0", "1e308", "pi"};
+    int kind = depth <= 0 ? 0 : static_cast<int>(rng() % 5);
+    switch (kind) {
+        case 0:
+            return leaves[rng() % 8];
+        case 1:
+            return "(" + randomExpression(rng, depth - 1) + " " + binary[rng() % 13] + " " +
+                   randomExpression(rng, depth - 1) + ")";
+        case 2:
+            return std::string(functions[rng() % 10]) + "(" + randomExpression(rng, depth - 1) + ")";
+        case 3:
+            return "(" + randomExpression(rng, depth - 1) + " ? " + randomExpression(rng, depth - 1) +
+                   " : " + randomExpression(rng, depth - 1) + ")";
+        default:
+            return (rng() % 2 ? "-" : "NOT ") + randomExpression(rng, depth - 1);
+    }
+}
+
+// Буфер, выровненный на 8 байт, как отображённый файл
+std::vector<uint64_t> alignedCopy(const std::string& image) {
+    std::vector<uint64_t> buffer((image.size() + 7) / 8);
+    std::memcpy(buffer.data(), image.data(), image.size());
+    return buffer;
+}
+
+Program compileText(const std::string& expr, const std::vector<std::string>& parameters) {
+    Variables vars;
+    for (const auto& name : parameters) {
+        vars.bind(name);
+    }
+    return Program::compile(*parse_with(expr, vars), parameters);
+}
+
+} // namespace
+
+TEST(ProgramTest, MatchesTreeEvaluation) {
+    std::mt19937 rng(2024);
+    std::uniform_real_distribution<double> value(-4.0, 4.0);
+    for (int i = 0; i < 3000; ++i) {
+        Variables vars;
+        vars.set("x", value(rng));
+        vars.set("y", value(rng));
+        std::string expr = randomExpression(rng, 4);
+        auto ast = parse_with(expr, vars);
+        Program program = Program::compile(*ast);
+        ProgramView view = program.view();
+        auto slots = view.bind(vars);
+
+        EXPECT_EQ(outcome([&] { return view.evaluate(slots.data()); }),
+                  outcome([&] { return ast->evaluate(); }))
+            << expr;
+    }
+}
+
+TEST(ProgramTest, CompilesOptimizedTrees) {
+    Variables vars;
+    vars.set("x", 1.75);
+    auto ast = parse_with("x^3 + x/4 - 2^10", vars);
+    OptimizerOptions options;
+    options.fastMath = true;
+    ast = Optimizer(options).optimize(std::move(ast));
+    Program program = Program::compile(*ast);
+    auto slots = program.view().bind(vars);
+    EXPECT_EQ(program.view().evaluate(slots.data()), ast->evaluate());
+}
+
+TEST(ProgramTest, VariablesAndErrors) {
+    Program program = compileText("b * 10 + a", {"a", "b"});
+    ProgramView view = program.view();
+    ASSERT_EQ(view.variableCount(), 2u);
+    EXPECT_EQ(view.variableName(0), "a");
+    EXPECT_EQ(view.variableName(1), "b");
+
+    double a = 1.0;
+    double b = 2.0;
+    const double* slots[] = {&a, &b};
+    EXPECT_EQ(view.evaluate(slots), 21.0);
+
+    const double* unbound[] = {&a, nullptr};
+    EXPECT_THROW(view.evaluate(unbound), EvalError);
+
+    b = std::numeric_limits<double>::infinity();
+    EXPECT_THROW(view.evaluate(slots), EvalError);
+
+    Variables vars;
+    EXPECT_THROW(Program::compile(*parse_with("foo(1)", vars)), EvalError);
+}
+
+TEST(ProgramTest, ValidateRejectsMalformedCode) {
+    Program program = compileText("1 + 2", {});
+    EXPECT_NO_THROW(program.view().validate(program.strings().size()));
+
+    std::vector<Instruction> code = program.code();
+    code.pop_back();  // Два значения на стеке
+    ProgramView leftover(code.data(), code.size(), program.constants().data(),
+                         program.constants().size(), nullptr, 0, nullptr, program.maxStack());
+    EXPECT_THROW(leftover.validate(0), FormatError);
+
+    code = program.code();
+    code.erase(code.begin());  // Binary без второго операнда
+    ProgramView underflow(code.data(), code.size(), program.constants().data(),
+                          program.constants().size(), nullptr, 0, nullptr, program.maxStack());
+    EXPECT_THROW(underflow.validate(0), FormatError);
+
+    code = program.code();
+    code[0].operand = 7;  // Нет такой константы
+    ProgramView badConstant(code.data(), code.size(), program.constants().data(),
+                            program.constants().size(), nullptr, 0, nullptr, program.maxStack());
+    EXPECT_THROW(badConstant.validate(0), FormatError);
+
+    ProgramView empty;
+    EXPECT_THROW(empty.validate(0), FormatError);
+    EXPECT_THROW(empty.evaluate(), EvalError);
+}
+
+TEST(ProgramTest, ConditionalsAreLazy) {
+    Program program = compileText("x > 0 ? ln(x) : (x == 0 ? 1 / x : -x)", {"x"});
+    ProgramView view = program.view();
+    EXPECT_NO_THROW(view.validate(program.strings().size()));
+
+    double x = -2.0;
+    const double* slots[] = {&x};
+    EXPECT_EQ(view.evaluate(slots), 2.0);
+    x = 1.0;
+    EXPECT_EQ(view.evaluate(slots), 0.0);
+    x = 0.0;
+    EXPECT_THROW(view.evaluate(slots), EvalError);
+}
+
+TEST(ProgramTest, BatchMatchesScalar) {
+    // 300 элементов: полный блок и хвост
+    constexpr size_t COUNT = 300;
+    std::mt19937 rng(77);
+    std::uniform_real_distribution<double> value(-4.0, 4.0);
+    std::vector<double> xs(COUNT);
+    std::vector<double> ys(COUNT);
+    for (int i = 0; i < 300; ++i) {
+        // Каждое третье выражение получает одинаковые x — целые блоки с одной ветвью
+        double constant = value(rng);
+        for (size_t k = 0; k < COUNT; ++k) {
+            xs[k] = i % 3 == 0 ? constant : value(rng);
+            ys[k] = value(rng);
+        }
+        std::string expr = randomExpression(rng, 4);
+        Program program = compileText(expr, {"x", "y"});
+        ProgramView view = program.view();
+
+        const double* columns[] = {xs.data(), ys.data()};
+        std::vector<double> results(COUNT);
+        std::vector<BatchError> errors;
+        size_t failures = view.evaluateBatch(columns, COUNT, results.data(), &errors);
+        ASSERT_EQ(failures, errors.size());
+
+        size_t next = 0;
+        for (size_t k = 0; k < COUNT; ++k) {
+            const double* slots[] = {&xs[k], &ys[k]};
+            std::string expected = outcome([&] { return view.evaluate(slots); });
+            std::string actual;
+            if (next < errors.size() && errors[next].index == k) {
+                EXPECT_TRUE(std::isnan(results[k]));
+                actual = "error: " + errors[next++].message;
+            } else {
+                actual = outcome([&] { return results[k]; });
+            }
+            ASSERT_EQ(actual, expected) << expr << " at " << k;
+        }
+    }
+}
+
+TEST(ProgramTest, ValidateRejectsMalformedJumps) {
+    Program program = compileText("x > 0 ? 1 : 2", {"x"});
+    const std::vector<Instruction>& original = program.code();
+    auto check = [&](const std::vector<Instruction>& code) {
+        ProgramView view(code.data(), code.size(), program.constants().data(),
+                         program.constants().size(), program.variables().data(),
+                         program.variables().size(), program.strings().data(),
+                         program.maxStack());
+        view.validate(program.strings().size());
+    };
+    EXPECT_NO_THROW(check(original));
+
+    size_t jumpIfFalse = 0;
+    while (original[jumpIfFalse].op != OpCode::JumpIfFalse) {
+        ++jumpIfFalse;
+    }
+    std::vector<Instruction> code = original;
+    code[jumpIfFalse].operand = static_cast<int32_t>(jumpIfFalse);  // Переход назад
+    EXPECT_THROW(check(code), FormatError);
+
+    code = original;
+    code[jumpIfFalse].operand = static_cast<int32_t>(code.size() + 5);  // За концом
+    EXPECT_THROW(check(code), FormatError);
+
+    code = original;
+    code[jumpIfFalse + 2].operand = static_cast<int32_t>(code.size() + 1);  // Jump за концом
+    EXPECT_THROW(check(code), FormatError);
+
+    code = original;
+    code[jumpIfFalse + 2].op = OpCode::Number;  // Ветвь then без завершающего Jump
+    EXPECT_THROW(check(code), FormatError);
+
+    code = original;
+    code.insert(code.begin(), original[jumpIfFalse + 2]);  // Jump вне условного выражения
+    EXPECT_THROW(check(code), FormatError);
+}
+
+TEST(FormulaLibraryTest, RoundTripInMemory) {
+    LibraryWriter writer;
+    writer.add("zeta", compileText("x * 2", {"x"}));
+    writer.add("area", compileText("pi * r^2", {"r"}));
+    writer.add("const", compileText("sqrt(16) + 1", {}));
+    EXPECT_THROW(writer.add("area", compileText("1", {})), std::invalid_argument);
+
+    auto buffer = alignedCopy(writer.serialize());
+    FormulaLibrary library(buffer.data(), writer.serialize().size());
+    ASSERT_EQ(library.size(), 3u);
+    EXPECT_EQ(library.name(0), "area");
+    EXPECT_EQ(library.name(1), "const");
+    EXPECT_EQ(library.name(2), "zeta");
+
+    auto area = library.find("area");
+    ASSERT_TRUE(area.has_value());
+    ASSERT_EQ(area->variableCount(), 1u);
+    EXPECT_EQ(area->variableName(0), "r");
+    double r = 2.0;
+    const double* slots[] = {&r};
+    EXPECT_DOUBLE_EQ(area->evaluate(slots), 3.141592653589793 * 4.0);
+
+    auto constant = library.find("const");
+    ASSERT_TRUE(constant.has_value());
+    EXPECT_EQ(constant->evaluate(), 5.0);
+
+    EXPECT_FALSE(library.find("missing").has_value());
+    EXPECT_FALSE(library.find("").has_value());
+}
+
+TEST(FormulaLibraryTest, DetectsCorruption) {
+    LibraryWriter writer;
+    writer.add("f", compileText("x + 1.5", {"x"}));
+    writer.add("g", compileText("x * x", {"x"}));
+    std::string image = writer.serialize();
+
+    // Повреждена константа формулы f: полная проверка отвергает файл сразу,
+    // ленивая — только при обращении к формуле
+    std::string corrupted = image;
+    size_t constantsOffset = 0;
+    std::memcpy(&constantsOffset, image.data() + offsetof(library_format::LibraryHeader, constantsOffset),
+                sizeof(uint64_t));
+    corrupted[constantsOffset + 3] ^= 0x10;
+    auto buffer = alignedCopy(corrupted);
+    EXPECT_THROW(FormulaLibrary(buffer.data(), corrupted.size()), FormatError);
+
+    LibraryOptions lazy;
+    lazy.verifyOnOpen = false;
+    FormulaLibrary library(buffer.data(), corrupted.size(), lazy);
+    EXPECT_THROW(library.find("f"), FormatError);
+    EXPECT_NO_THROW(library.find("g"));
+
+    // Повреждённый заголовок и обрезанный файл
+    std::string badHeader = image;
+    badHeader[offsetof(library_format::LibraryHeader, formulaCount)] ^= 0x01;
+    buffer = alignedCopy(badHeader);
+    EXPECT_THROW(FormulaLibrary(buffer.data(), badHeader.size(), lazy), FormatError);
+
+    buffer = alignedCopy(image);
+    EXPECT_THROW(FormulaLibrary(buffer.data(), image.size() - 1, lazy), FormatError);
+    EXPECT_THROW(FormulaLibrary(buffer.data(), 10, lazy), FormatError);
+
+    std::string badMagic = image;
+    badMagic[0] = 'X';
+    buffer = alignedCopy(badMagic);
+    EXPECT_THROW(FormulaLibrary(buffer.data(), badMagic.size()), FormatError);
+}
+
+TEST(FormulaLibraryTest, MappedFileRoundTrip) {
+    LibraryWriter writer;
+    for (int i = 0; i < 200; ++i) {
+        writer.add("f" + std::to_string(i), compileText("x * " + std::to_string(i) + " + 1", {"x"}));
+    }
+    auto path = std::filesystem::temp_directory_path() / "calc_test_library.calclib";
+    writer.write(path.string());
+    {
+        FormulaLibrary library(path.string());
+        EXPECT_EQ(library.size(), 200u);
+        double x = 3.0;
+        const double* slots[] = {&x};
+        for (int i = 0; i < 200; i += 17) {
+            auto program = library.find("f" + std::to_string(i));
+            ASSERT_TRUE(program.has_value());
+            EXPECT_EQ(program->evaluate(slots), 3.0 * i + 1);
+        }
+    }
+    std::filesystem::remove(path);
+    EXPECT_THROW(FormulaLibrary(path.string()), std::runtime_error);
+}
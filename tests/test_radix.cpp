@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include "radix.hpp"
+#include "batch.hpp"
+
+using namespace calc;
+
+namespace {
+
+std::string format(int64_t value, int radix) {
+    char buffer[RADIX_BUFFER_SIZE];
+    char* end = formatInteger(buffer, buffer + sizeof(buffer), value, radix);
+    return std::string(buffer, end);
+}
+
+// Образец — std::to_chars с заглавными буквами
+std::string reference(uint64_t value, int radix) {
+    char buffer[RADIX_BUFFER_SIZE];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value, radix);
+    std::string text(buffer, result.ptr);
+    for (char& c : text) {
+        if (c >= 'a') {
+            c = static_cast<char>(c - 'a' + 'A');
+        }
+    }
+    return text;
+}
+
+std::string convert(const std::string& text, int from, int to, ConvertStats* stats = nullptr) {
+    std::FILE* in = std::tmpfile();
+    std::fwrite(text.data(), 1, text.size(), in);
+    std::rewind(in);
+    std::FILE* out = std::tmpfile();
+    ConvertStats result;
+    {
+        LineReader reader(in, 64);
+        BufferedWriter writer(out, 64);
+        result = runConvert(reader, writer, from, to);
+    }
+    std::rewind(out);
+    std::string output;
+    char buf[256];
+    size_t read;
+    while ((read = std::fread(buf, 1, sizeof(buf), out)) > 0) {
+        output.append(buf, read);
+    }
+    std::fclose(in);
+    std::fclose(out);
+    if (stats) {
+        *stats = result;
+    }
+    return output;
+}
+
+} // namespace
+
+TEST(RadixTest, FormatsLikeNumberConverter) {
+    EXPECT_EQ(format(0, 2), "0");
+    EXPECT_EQ(format(255, 16), "FF");
+    EXPECT_EQ(format(-255, 16), "-FF");
+    EXPECT_EQ(format(8, 8), "10");
+    EXPECT_EQ(format(5, 2), "101");
+    EXPECT_EQ(format(1234567890, 10), "1234567890");
+    EXPECT_EQ(format(35, 36), "Z");
+    EXPECT_EQ(format(std::numeric_limits<int64_t>::min(), 2), "-1" + std::string(63, '0'));
+    EXPECT_EQ(format(std::numeric_limits<int64_t>::min(), 10), "-9223372036854775808");
+
+    char small[4];
+    EXPECT_EQ(formatInteger(small, small + sizeof(small), 0x10000, 16), nullptr);
+    EXPECT_THROW(format(1, 37), std::invalid_argument);
+}
+
+TEST(RadixTest, RoundTripsInEveryBase) {
+    std::mt19937_64 random(7);
+    for (int i = 0; i < 4000; ++i) {
+        // Значения любой длины, включая старший бит
+        uint64_t value = random() >> (random() % 64);
+        for (int radix = MIN_RADIX; radix <= MAX_RADIX; ++radix) {
+            char buffer[RADIX_BUFFER_SIZE];
+            std::string text(buffer, formatUnsigned(buffer, buffer + sizeof(buffer), value, radix));
+            ASSERT_EQ(text, reference(value, radix)) << radix;
+            // Строчные буквы и ведущие нули (двоичные и шестнадцатеричные — по восемь символов)
+            std::string lower = "000000000" + text;
+            for (char& c : lower) {
+                c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            }
+            ASSERT_EQ(parseUnsigned(text, radix), value) << text;
+            ASSERT_EQ(parseUnsigned(lower, radix), value) << lower;
+        }
+    }
+}
+
+TEST(RadixTest, RejectsBadDigitsAndOverflow) {
+    EXPECT_THROW(parseUnsigned("", 16), std::invalid_argument);
+    EXPECT_THROW(parseUnsigned("12", 2), std::invalid_argument);
+    // Недопустимая цифра в любой позиции восьмисимвольного блока
+    for (size_t position = 0; position < 16; ++position) {
+        for (char c : {'g', 'G', '/', ':', '@', '`', ' ', '\x80'}) {
+            std::string hex = "0123456789abcdef";
+            hex[position] = c;
+            EXPECT_THROW(parseUnsigned(hex, 16), std::invalid_argument) << hex;
+            std::string binary = "0110100101101001";
+            binary[position] = c == '/' ? '2' : c;
+            EXPECT_THROW(parseUnsigned(binary, 2), std::invalid_argument) << binary;
+        }
+    }
+
+    EXPECT_EQ(parseUnsigned("FFFFFFFFFFFFFFFF", 16), std::numeric_limits<uint64_t>::max());
+    EXPECT_THROW(parseUnsigned("10000000000000000", 16), std::out_of_range);
+    EXPECT_THROW(parseUnsigned("1" + std::string(64, '0'), 2), std::out_of_range);
+    EXPECT_EQ(parseUnsigned("18446744073709551615", 10), std::numeric_limits<uint64_t>::max());
+    EXPECT_THROW(parseUnsigned("18446744073709551616", 10), std::out_of_range);
+    EXPECT_EQ(parseUnsigned("0000000000000000000000000001", 10), 1u);
+}
+
+TEST(RadixTest, SignedParsingWrapsLikeProgrammerMode) {
+    EXPECT_EQ(parseInteger(" -ff ", 16), -255);
+    EXPECT_EQ(parseInteger("FFFFFFFFFFFFFFFF", 16), -1);
+    EXPECT_EQ(parseInteger("-9223372036854775808", 10), std::numeric_limits<int64_t>::min());
+    EXPECT_THROW(parseInteger("-", 10), std::invalid_argument);
+    EXPECT_TRUE(isRadixDigit('f', 16));
+    EXPECT_FALSE(isRadixDigit('8', 8));
+}
+
+TEST(RadixTest, ConvertsLineStreams) {
+    ConvertStats stats;
+    EXPECT_EQ(convert("ff\n-1A\r\n\n  0  \nFFFFFFFFFFFFFFFF\nxyz\n10000000000000000", 16, 2, &stats),
+              "11111111\n-11010\n\n0\n" + std::string(64, '1') +
+              "\nerror: Invalid digit for the given base\nerror: Number does not fit in 64 bits\n");
+    EXPECT_EQ(stats.lines, 7u);
+    EXPECT_EQ(stats.errors, 2u);
+
+    // Знак сохраняется, модуль не приводится по модулю 2^64
+    EXPECT_EQ(convert("-0\n18446744073709551615\n", 10, 16), "0\nFFFFFFFFFFFFFFFF\n");
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "optimizer.hpp"
+#include "program.hpp"
+#include "variables.hpp"
+#include "error.hpp"
+
+using namespace calc;
+
+namespace {
+
+std::unique_ptr<Node> parse_with(const std::string& expr, const Variables* vars = nullptr) {
+    Lexer lexer(expr);
+    Parser parser(lexer.tokenize(), vars);
+    return parser.parse();
+}
+
+const ReductionNode& asReduction(const std::unique_ptr<Node>& ast) {
+    return dynamic_cast<const ReductionNode&>(*ast);
+}
+
+std::string errorOf(const std::string& expr) {
+    try {
+        parse_with(expr)->evaluate();
+    } catch (const EvalError& e) {
+        return e.what();
+    }
+    return "";
+}
+
+} // namespace
+
+TEST(ReductionTest, ClosedFormsMatchIteration) {
+    Variables vars;
+    vars.set("a", 0.25);
+    vars.set("n", 5000.0);
+    // Тела-многочлены считаются по формуле, остальные — перебором;
+    // сдвиг тела на 0 * sin(i) отключает распознавание
+    const char* bodies[] = {
+        "i", "3", "a * i ^ 2 - i / 4 + 7", "(i + a) * (i - 1) * -i", "i * (i + 1) / 2", "(2 * i - 1) ^ 3"
+    };
+    for (const char* body : bodies) {
+        for (const char* range : {"1, n", "-n, n", "-10, -3", "17, 17"}) {
+            std::string closed = std::string("sum(i, ") + range + ", " + body + ")";
+            std::string iterated = std::string("sum(i, ") + range + ", " + body + " + 0 * sin(i))";
+            double expected = parse_with(iterated, &vars)->evaluate();
+            EXPECT_NEAR(parse_with(closed, &vars)->evaluate(), expected,
+                        1e-12 * std::max(1.0, std::abs(expected))) << closed;
+        }
+    }
+    EXPECT_DOUBLE_EQ(parse_with("prod(i, 1, 10, a * 4 + 1)", &vars)->evaluate(), 1024.0);
+
+    // 10^9 слагаемых в замкнутой форме — точно
+    EXPECT_EQ(parse_with("sum(i, 1, 10^9, i)")->evaluate(), 500000000500000000.0);
+    EXPECT_DOUBLE_EQ(parse_with("sum(i, 1, 10^6, i^3)")->evaluate(), 250000500000250000000000.0);
+}
+
+TEST(ReductionTest, ResultDoesNotDependOnThreads) {
+    auto ast = parse_with("sum(i, -150000, 150000, sin(i) / (1 + i ^ 2) + 1e-3)");
+    const auto& node = asReduction(ast);
+    double serial = evaluateReduction(node, 1);
+    for (size_t threads : {2, 3, 8}) {
+        EXPECT_EQ(evaluateReduction(node, threads), serial) << threads;
+    }
+
+    // Компенсированное суммирование не теряет малые слагаемые
+    long double exact = 0.0L;
+    for (long i = -150000; i <= 150000; ++i) {
+        exact += std::sin(static_cast<long double>(i)) / (1.0L + static_cast<long double>(i) * i) + 1e-3L;
+    }
+    EXPECT_NEAR(serial, static_cast<double>(exact), 1e-12);
+
+    auto product = parse_with("prod(k, 1, 100000, 1 + 1 / (k * (k + 2)))");
+    double value = evaluateReduction(asReduction(product), 1);
+    EXPECT_EQ(evaluateReduction(asReduction(product), 4), value);
+    EXPECT_NEAR(value, 2.0, 1e-4);  // Телескопическое произведение: 2(n+1)/(n+2)
+}
+
+TEST(ReductionTest, ErrorsAndLimits) {
+    // Сообщается ошибка наименьшего i, даже если другие части закончились раньше
+    auto ast = parse_with("sum(i, 1, 200000, i == 150000 ? ln(0) : i == 90000 ? sqrt(-1) : 1)");
+    for (size_t threads : {1, 4}) {
+        try {
+            evaluateReduction(asReduction(ast), threads);
+            ADD_FAILURE() << "expected EvalError";
+        } catch (const EvalError& e) {
+            EXPECT_EQ(std::string(e.what()), errorOf("sqrt(-1)"));
+        }
+    }
+
+    EXPECT_EQ(errorOf("sum(i, 0.5, 2, i)"), "Bounds of sum() must be integers");
+    EXPECT_EQ(errorOf("prod(i, 1, 2^60, i)"), "Bounds of prod() are out of range");
+    EXPECT_EQ(errorOf("sum(i, 1, 10^12, sin(i))"), "Too many terms in sum()");
+    EXPECT_EQ(errorOf("prod(i, 1, 1000, i)"), "Overflow in prod()");
+    EXPECT_EQ(errorOf("sum(i, 1, 10^6, 1e303 * (2 + sin(i)))"), "Overflow in sum()");
+    EXPECT_EQ(errorOf("sum(i, 1, 10, i / 0)"), errorOf("1 / 0"));  // Не многочлен: перебор
+    EXPECT_EQ(errorOf("sum(i, 1, 100, 1 / 0)"), errorOf("1 / 0"));
+    EXPECT_EQ(errorOf("sum(i, 1, 0, 1 / 0)"), "");  // Пустой диапазон тело не вычисляет
+
+    // Замкнутая форма не возвращает число там, где слагаемые — ошибки
+    EXPECT_EQ(errorOf("sum(i, 1, 10, i / 1e-16)"), errorOf("1 / 1e-16"));
+    EXPECT_EQ(errorOf("sum(i, 1, 3, i * 1e308)"), errorOf("2 * 1e308"));
+    EXPECT_EQ(errorOf("sum(i, 1, 10^12, i * 1e300)"), "Overflow in sum()");
+    // Подвыражение переполняется в double, хотя в long double сокращается
+    EXPECT_EQ(errorOf("sum(i, 1, 2, i * 1e200 * 1e200 - i * 1e200 * 1e200)"), errorOf("1e200 * 1e200"));
+    EXPECT_EQ(errorOf("sum(i, 1, 100, i^3 * 1e303 - i^3 * 1e303)"), errorOf("1e6 * 1e303"));
+    EXPECT_EQ(parse_with("sum(i, 1, 100, i^3 * 1e300 - i^3 * 1e300)")->evaluate(), 0.0);
+
+    // Сумма, зависящая от свободной переменной, не компилируется
+    Variables vars;
+    vars.set("x", 1.0);
+    auto dependent = parse_with("sum(i, 1, 10, x ^ i)", &vars);
+    EXPECT_THROW(Program::compile(*dependent), EvalError);
+}
+
+TEST(ReductionTest, OptimizerKeepsLoopVariable) {
+    Variables vars;
+    vars.set("x", 0.5);
+    auto ast = parse_with("sum(i, 1 + 1, 2 * 500, (x + 0) * i ^ 2 + sin(i) * (2 + 3))", &vars);
+    double expected = ast->evaluate();
+    Optimizer optimizer;
+    auto optimized = optimizer.optimize(std::move(ast));
+    EXPECT_EQ(optimized->evaluate(), expected);
+    EXPECT_GT(optimizer.report().constantsFolded, 0u);
+}
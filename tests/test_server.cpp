@@ -0,0 +1,252 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "server_protocol.hpp"
+#include "server.hpp"
+#include "variables.hpp"
+
+#ifdef __linux__
+#include <cerrno>
+#include <filesystem>
+#include <thread>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace calc;
+
+namespace {
+
+struct Response {
+    bool ok;
+    std::string text;
+};
+
+// Ответы из сырых байтов
+std::vector<Response> decode(protocol::FrameBuffer& buffer) {
+    std::vector<Response> responses;
+    std::string_view payload;
+    while (buffer.next(payload)) {
+        responses.push_back({payload[0] == static_cast<char>(protocol::ResponseStatus::Ok),
+                             std::string(payload.substr(1))});
+    }
+    return responses;
+}
+
+void feed(protocol::FrameBuffer& buffer, std::string_view bytes) {
+    char* target = buffer.prepare(bytes.size());
+    std::memcpy(target, bytes.data(), bytes.size());
+    buffer.commit(bytes.size());
+}
+
+} // namespace
+
+TEST(ProtocolTest, FramesSurviveArbitrarySplits) {
+    std::string stream;
+    protocol::appendFrame(stream, "1 + 2");
+    protocol::appendFrame(stream, "");
+    protocol::appendFrame(stream, std::string(1000, 'x'));
+    for (size_t step : {1u, 3u, 7u, 4096u}) {
+        protocol::FrameBuffer buffer;
+        std::vector<std::string> frames;
+        for (size_t offset = 0; offset < stream.size(); offset += step) {
+            feed(buffer, std::string_view(stream).substr(offset, step));
+            std::string_view payload;
+            while (buffer.next(payload)) {
+                frames.emplace_back(payload);
+            }
+        }
+        ASSERT_EQ(frames.size(), 3u) << "step " << step;
+        EXPECT_EQ(frames[0], "1 + 2");
+        EXPECT_EQ(frames[1], "");
+        EXPECT_EQ(frames[2], std::string(1000, 'x'));
+        EXPECT_EQ(buffer.pending(), 0u);
+    }
+}
+
+TEST(ProtocolTest, ResponsesAndOversizedFrames) {
+    std::string stream;
+    protocol::appendResponse(stream, protocol::ResponseStatus::Ok, "3");
+    protocol::appendResponse(stream, protocol::ResponseStatus::Error, "Division by zero");
+    protocol::FrameBuffer buffer;
+    feed(buffer, stream);
+    std::vector<Response> responses = decode(buffer);
+    ASSERT_EQ(responses.size(), 2u);
+    EXPECT_TRUE(responses[0].ok);
+    EXPECT_EQ(responses[0].text, "3");
+    EXPECT_FALSE(responses[1].ok);
+    EXPECT_EQ(responses[1].text, "Division by zero");
+
+    protocol::FrameBuffer oversized;
+    feed(oversized, std::string("\xFF\xFF\xFF\x7F", 4));
+    EXPECT_TRUE(oversized.complete());
+    std::string_view payload;
+    EXPECT_THROW(oversized.next(payload), std::runtime_error);
+}
+
+#ifdef __linux__
+
+namespace {
+
+// Сервер в отдельном потоке на временном сокете
+class ServerFixture {
+public:
+    explicit ServerFixture(ServerOptions options = ServerOptions())
+        : path_((std::filesystem::temp_directory_path() /
+                 ("calc_test_" + std::to_string(::getpid()) + ".sock")).string()) {
+        variables_.set("x", 3.0);
+        server_ = std::make_unique<Server>(path_, variables_, options);
+        thread_ = std::thread([this]() { server_->run(); });
+    }
+
+    ~ServerFixture() {
+        stop();
+    }
+
+    void stop() {
+        if (thread_.joinable()) {
+            server_->stop();
+            thread_.join();
+        }
+    }
+
+    int connect() const {
+        int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address{};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, path_.c_str(), sizeof(address.sun_path) - 1);
+        EXPECT_EQ(::connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)), 0);
+        return fd;
+    }
+
+    const std::string& path() const { return path_; }
+    const ServerStats& stats() const { return server_->stats(); }
+
+private:
+    std::string path_;
+    Variables variables_;
+    std::unique_ptr<Server> server_;
+    std::thread thread_;
+};
+
+void send_all(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t written = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        ASSERT_GT(written, 0);
+        sent += static_cast<size_t>(written);
+    }
+}
+
+// Прочитать count ответов (или до закрытия соединения)
+std::vector<Response> receive(int fd, size_t count) {
+    protocol::FrameBuffer buffer;
+    std::vector<Response> responses;
+    while (responses.size() < count) {
+        char* target = buffer.prepare(4096);
+        ssize_t read = ::recv(fd, target, 4096, 0);
+        if (read <= 0) {
+            break;
+        }
+        buffer.commit(static_cast<size_t>(read));
+        for (Response& response : decode(buffer)) {
+            responses.push_back(std::move(response));
+        }
+    }
+    return responses;
+}
+
+} // namespace
+
+TEST(ServerTest, PipelinedRequestsAnswerInOrder) {
+    ServerFixture server;
+    int fd = server.connect();
+    const std::vector<std::string> requests = {"1 + 2", "x * 2", "1 / 0", "2 +", "0.1 + 0.2",
+                                               "sum(i, 1, 10, i)", "x * 2"};
+    std::string stream;
+    for (const std::string& request : requests) {
+        protocol::appendFrame(stream, request);
+    }
+    send_all(fd, stream);
+    std::vector<Response> responses = receive(fd, requests.size());
+    ::close(fd);
+
+    ASSERT_EQ(responses.size(), requests.size());
+    EXPECT_TRUE(responses[0].ok);
+    EXPECT_EQ(responses[0].text, "3");
+    EXPECT_EQ(responses[1].text, "6");
+    EXPECT_FALSE(responses[2].ok);
+    EXPECT_EQ(responses[2].text, "Division by zero");
+    EXPECT_FALSE(responses[3].ok);
+    EXPECT_EQ(std::stod(responses[4].text), 0.1 + 0.2);    // Без потери точности
+    EXPECT_EQ(responses[5].text, "55");
+    EXPECT_EQ(responses[6].text, "6");
+
+    server.stop();
+    EXPECT_EQ(server.stats().requests, requests.size());
+    EXPECT_EQ(server.stats().errors, 2u);
+    EXPECT_EQ(server.stats().cacheHits, 1u);
+    EXPECT_EQ(server.stats().connections, 1u);
+}
+
+TEST(ServerTest, ManyConnectionsAndSmallBatches) {
+    ServerOptions options;
+    options.maxBatch = 3;
+    options.cacheEntries = 2;
+    ServerFixture server(options);
+    std::vector<int> clients;
+    for (int c = 0; c < 4; ++c) {
+        clients.push_back(server.connect());
+    }
+    for (int c = 0; c < 4; ++c) {
+        std::string stream;
+        for (int i = 0; i < 50; ++i) {
+            protocol::appendFrame(stream, std::to_string(c) + " * 100 + " + std::to_string(i % 5));
+        }
+        send_all(clients[c], stream);
+    }
+    for (int c = 0; c < 4; ++c) {
+        std::vector<Response> responses = receive(clients[c], 50);
+        ASSERT_EQ(responses.size(), 50u);
+        for (int i = 0; i < 50; ++i) {
+            EXPECT_EQ(responses[i].text, std::to_string(c * 100 + i % 5));
+        }
+        ::close(clients[c]);
+    }
+    server.stop();
+    EXPECT_EQ(server.stats().requests, 200u);
+    EXPECT_LE(server.stats().largestBatch, 3u);
+    EXPECT_EQ(server.stats().cacheHits, 0u);    // Пять выражений по кругу в кэше на два
+}
+
+TEST(ServerTest, OversizedFrameClosesConnection) {
+    ServerFixture server;
+    int fd = server.connect();
+    std::string stream;
+    protocol::appendFrame(stream, "2 * 21");
+    stream += std::string("\xFF\xFF\xFF\x7F", 4);
+    send_all(fd, stream);
+    std::vector<Response> responses = receive(fd, 2);
+    ASSERT_EQ(responses.size(), 1u);
+    EXPECT_EQ(responses[0].text, "42");
+    ::close(fd);
+
+    // Сервер продолжает принимать соединения
+    int next = server.connect();
+    std::string request;
+    protocol::appendFrame(request, "x");
+    send_all(next, request);
+    EXPECT_EQ(receive(next, 1).at(0).text, "3");
+    ::close(next);
+}
+
+TEST(ServerTest, SocketInUseIsRejected) {
+    ServerFixture server;
+    Variables variables;
+    EXPECT_THROW(Server(server.path(), variables), std::runtime_error);
+}
+
+#endif
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+#include <vector>
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "program.hpp"
+#include "variables.hpp"
+#include "error.hpp"
+
+using namespace calc;
+
+namespace {
+
+std::unique_ptr<Node> parse_with(const std::string& expr, const Variables* vars = nullptr) {
+    Lexer lexer(expr);
+    Parser parser(lexer.tokenize(), vars);
+    return parser.parse();
+}
+
+const SolveNode& asSolve(const std::unique_ptr<Node>& ast) {
+    return dynamic_cast<const SolveNode&>(*ast);
+}
+
+std::string errorOf(const std::string& expr) {
+    try {
+        parse_with(expr)->evaluate();
+    } catch (const EvalError& e) {
+        return e.what();
+    }
+    return "";
+}
+
+const double PI = 3.14159265358979323846;
+
+} // namespace
+
+TEST(SolveTest, FindsRoots) {
+    EXPECT_NEAR(parse_with("solve(x^2 - 2, x, 0, 10)")->evaluate(), std::sqrt(2.0), 1e-15);
+    EXPECT_NEAR(parse_with("solve(x^2 - 2, x, -10, 10)")->evaluate(), -std::sqrt(2.0), 1e-15);
+    EXPECT_NEAR(parse_with("solve(x^2 - 2, x, -10, 10, 2)")->evaluate(), std::sqrt(2.0), 1e-15);
+    EXPECT_NEAR(parse_with("solve(cos(t) - t, t, 0, 1)")->evaluate(), 0.7390851332151607, 1e-15);
+    EXPECT_EQ(parse_with("solve(x - 1, x, -3, 5)")->evaluate(), 1.0);   // Корень в узле сетки
+
+    Variables vars;
+    vars.set("a", 3.0);
+    EXPECT_NEAR(parse_with("solve(x^3 - a, x, 0, 2)", &vars)->evaluate(), std::cbrt(3.0), 1e-15);
+
+    // Все корни по возрастанию
+    auto ast = parse_with("solve(sin(x), x, -10, 10)");
+    std::vector<double> roots = findRoots(asSolve(ast), 1);
+    ASSERT_EQ(roots.size(), 7u);
+    for (size_t k = 0; k < roots.size(); ++k) {
+        EXPECT_NEAR(roots[k], (static_cast<double>(k) - 3.0) * PI, 1e-14);
+    }
+    EXPECT_EQ(asSolve(ast).report().roots, roots);
+    EXPECT_EQ(asSolve(ast).report().brackets, 6u);   // Ноль попадает в узел сетки
+    for (size_t threads : {2, 4}) {
+        EXPECT_EQ(findRoots(asSolve(ast), threads), roots) << threads;
+    }
+
+    // Тело с sum не компилируется и вычисляется по дереву
+    auto tree = parse_with("solve(sum(i, 1, 3, x^i) - 14, x, 0, 5)");
+    EXPECT_NEAR(tree->evaluate(), 2.0, 1e-15);
+}
+
+TEST(SolveTest, PolesAndGaps) {
+    // Смена знака у полюса — не корень
+    EXPECT_EQ(findRoots(asSolve(parse_with("solve(1 / x, x, -1, 2)"))).size(), 0u);
+    auto tangent = parse_with("solve(tan(x), x, 1, 5)");
+    std::vector<double> roots = findRoots(asSolve(tangent));
+    ASSERT_EQ(roots.size(), 1u);
+    EXPECT_NEAR(roots[0], PI, 1e-14);
+
+    // Точки, где функция не определена, разрывают отрезки
+    EXPECT_NEAR(parse_with("solve(ln(x) - 1, x, -5, 5)")->evaluate(), std::exp(1.0), 1e-14);
+}
+
+TEST(SolveTest, Errors) {
+    EXPECT_EQ(errorOf("solve(x^2 + 1, x, -5, 5)"), "solve() found no root in the interval");
+    EXPECT_EQ(errorOf("solve(x, x, -1, 1, 2)"), "solve() found only 1 root(s) in the interval");
+    EXPECT_EQ(errorOf("solve(x, x, -1, 1, 1.5)"), "Root index of solve() must be a positive integer");
+    EXPECT_EQ(errorOf("solve(x, x, 1, -1)"), "Invalid interval in solve()");
+    EXPECT_EQ(errorOf("solve(x, x, 1, 1)"), "Invalid interval in solve()");
+
+    EXPECT_THROW(parse_with("solve(x, 0, 1)"), ParseError);
+    EXPECT_THROW(parse_with("solve(x, x, 0)"), ParseError);
+
+    Variables vars;
+    vars.set("a", 1.0);
+    EXPECT_THROW(Program::compile(*parse_with("solve(x - a, x, 0, 2)", &vars)), EvalError);
+}
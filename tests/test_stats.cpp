@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <limits>
+#include <memory>
+#include <string>
+#include "stats.hpp"
+#include "error.hpp"
+#include "variables.hpp"
+
+using namespace calc;
+
+TEST(StatsTest, ProfileCountsPhases) {
+    Variables variables;
+    variables.set("x", 4.0);
+    ExpressionStats stats;
+    EXPECT_EQ(profileExpression("1 + 2 * x", variables, BatchOptions(), stats), 9.0);
+    EXPECT_TRUE(stats.lexed && stats.parsed && stats.evaluated);
+    EXPECT_FALSE(stats.optimized);
+    EXPECT_FALSE(stats.failed);
+    EXPECT_EQ(stats.tokens, 5u);
+    EXPECT_EQ(stats.nodes, 5u);
+    EXPECT_EQ(stats.depth, 3u);
+    EXPECT_GT(stats.astBytes, 0u);
+    EXPECT_GE(stats.allocatedBytes, stats.astBytes);
+    EXPECT_GT(stats.allocations, 0u);
+    EXPECT_GE(stats.lexSeconds, 0.0);
+
+    BatchOptions options;
+    options.optimize = true;
+    EXPECT_EQ(profileExpression("x * 1 + (2 + 3)", variables, options, stats), 9.0);
+    EXPECT_TRUE(stats.optimized);
+    EXPECT_EQ(stats.nodes, 7u);
+    EXPECT_LT(stats.optimizedNodes, stats.nodes);
+}
+
+TEST(StatsTest, FailedPhasesAreRecorded) {
+    ExpressionStats stats;
+    EXPECT_THROW(profileExpression("1 +", Variables(), BatchOptions(), stats), ParseError);
+    EXPECT_TRUE(stats.lexed);
+    EXPECT_FALSE(stats.parsed);
+    EXPECT_TRUE(stats.failed);
+
+    EXPECT_THROW(profileExpression("1 / 0", Variables(), BatchOptions(), stats), EvalError);
+    EXPECT_TRUE(stats.evaluated);
+    EXPECT_TRUE(stats.failed);
+}
+
+TEST(StatsTest, AllocationScopeCountsOwnThread) {
+    AllocationScope outer;
+    {
+        AllocationScope inner;
+        auto block = std::make_unique<std::array<char, 1000>>();
+        EXPECT_GE(inner.bytes(), 1000u);
+        EXPECT_EQ(inner.count(), 1u);
+    }
+    EXPECT_GE(outer.bytes(), 1000u);
+    EXPECT_EQ(outer.count(), 1u);
+}
+
+TEST(StatsTest, HistogramQuantiles) {
+    Histogram histogram;
+    for (int i = 1; i <= 1000; ++i) {
+        histogram.add(i);
+    }
+    EXPECT_EQ(histogram.count(), 1000u);
+    EXPECT_EQ(histogram.min(), 1.0);
+    EXPECT_EQ(histogram.max(), 1000.0);
+    EXPECT_DOUBLE_EQ(histogram.mean(), 500.5);
+    // Квантиль точен до ширины корзины: 1/8 октавы
+    EXPECT_NEAR(histogram.quantile(0.5), 500.0, 500.0 / Histogram::SUB_BUCKETS);
+    EXPECT_NEAR(histogram.quantile(0.99), 990.0, 990.0 / Histogram::SUB_BUCKETS);
+    EXPECT_LE(histogram.quantile(1.0), 1000.0);
+    EXPECT_EQ(histogram.bucket(1 + 9 * Histogram::SUB_BUCKETS), 64u);    // [512, 576)
+
+    // Одинаковые значения — точный квантиль
+    Histogram same;
+    for (int i = 0; i < 3; ++i) {
+        same.add(15.0);
+    }
+    EXPECT_EQ(same.quantile(0.5), 15.0);
+    EXPECT_EQ(Histogram::bucketLow(1 + 3 * Histogram::SUB_BUCKETS + 7), 15.0);
+
+    Histogram other;
+    other.add(0.25);
+    histogram.merge(other);
+    EXPECT_EQ(histogram.count(), 1001u);
+    EXPECT_EQ(histogram.min(), 0.25);
+    EXPECT_EQ(histogram.bucket(0), 1u);
+}
+
+TEST(StatsTest, BatchLinesAreCollected) {
+    StatsCollector collector;
+    BatchOptions options;
+    options.stats = &collector;
+    std::string out;
+    BatchStats stats = evaluateLines("1 + 2\n\nsqrt(-1)\n2 ^ 10\n(\n", Variables(), options, out);
+    EXPECT_EQ(out, "3\n\nerror: sqrt: argument must be non-negative\n1024\nerror: Unexpected token\n");
+    EXPECT_EQ(stats.errors, 2u);
+    EXPECT_EQ(collector.expressions(), 4u);    // Пустая строка не замеряется
+    EXPECT_EQ(collector.errors(), 2u);
+    EXPECT_EQ(collector.lexNanos().count(), 4u);
+    EXPECT_EQ(collector.evaluateNanos().count(), 3u);
+    EXPECT_EQ(collector.tokens().max(), 5u);    // sqrt ( - 1 )
+
+    std::string json = collector.json();
+    EXPECT_EQ(json.rfind("{\"expressions\":4,\"errors\":2,\"peak_rss_bytes\":", 0), 0u);
+    EXPECT_NE(json.find("\"evaluate_ns\":{\"count\":3,"), std::string::npos);
+    EXPECT_EQ(json.find("optimize_ns"), std::string::npos);
+    EXPECT_NE(collector.text().find("Stats: 4 expressions, 2 errors"), std::string::npos);
+}
+
+TEST(StatsTest, JsonHasNoNonFiniteNumbers) {
+    StatsCollector collector;
+    ExpressionStats stats;
+    stats.lexed = true;
+    stats.evaluated = true;
+    stats.lexSeconds = std::numeric_limits<double>::infinity();
+    stats.evaluateSeconds = std::numeric_limits<double>::quiet_NaN();
+    collector.add(stats);
+
+    std::string json = collector.json();
+    EXPECT_EQ(json.find("inf"), std::string::npos) << json;
+    EXPECT_EQ(json.find("nan"), std::string::npos) << json;
+    EXPECT_NE(json.find("\"lex_ns\":{\"count\":1,\"min\":null,\"mean\":null,"), std::string::npos) << json;
+}
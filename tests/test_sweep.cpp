@@ -0,0 +1,162 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "lexer.hpp"
+#include "parser.hpp"
+#include "sweep.hpp"
+#include "variables.hpp"
+#include "error.hpp"
+
+using namespace calc;
+
+namespace {
+
+std::unique_ptr<Node> parse_with(const std::string& expr, const Variables& vars) {
+    Lexer lexer(expr);
+    Parser parser(lexer.tokenize(), &vars);
+    return parser.parse();
+}
+
+std::string format(double value) {
+    char buf[64];
+    std::snprintf(buf, sizeof(buf), "%a", value);
+    return buf;
+}
+
+struct Point {
+    double x;
+    std::string outcome;
+};
+
+std::vector<Point> collect(const Sweep& sweep, double start, double stop, double step,
+                           const Variables& vars, SweepReport* report = nullptr) {
+    std::vector<Point> points;
+    SweepReport result = sweep.run(start, stop, step, vars,
+        [&points](double x, double value, const std::string* error) {
+            points.push_back({x, error ? "error: " + *error : format(value)});
+        });
+    if (report) {
+        *report = result;
+    }
+    return points;
+}
+
+} // namespace
+
+TEST(SweepTest, MatchesTreeAtEveryPoint) {
+    const char* exprs[] = {
+        "sqrt(a) * sin(x) + exp(b) / (1 + x^2)",
+        "x == 0 ? 1 : sin(x) / x",
+        "ln(x) + a",
+        "x > 0 ? ln(a - 5) : x * b",        // Невыносимое поддерево с ошибкой
+        "(a + b) ^ 2 - cos(a * b) * x AND 7",
+        "a * b"                              // Не зависит от x
+    };
+    for (const char* expr : exprs) {
+        Variables vars;
+        vars.set("a", 2.0);
+        vars.set("b", 0.5);
+        double* x = vars.bind("x");
+        auto ast = parse_with(expr, vars);
+
+        Sweep sweep(*ast, "x");
+        auto points = collect(sweep, -2.0, 2.0, 0.125, vars);
+        ASSERT_EQ(points.size(), 33u) << expr;
+        for (const auto& point : points) {
+            *x = point.x;
+            std::string expected;
+            try {
+                expected = format(ast->evaluate());
+            } catch (const EvalError& e) {
+                expected = std::string("error: ") + e.what();
+            }
+            EXPECT_EQ(point.outcome, expected) << expr << " at x = " << point.x;
+        }
+    }
+}
+
+TEST(SweepTest, HoistsInvariantSubtrees) {
+    Variables vars;
+    vars.set("a", 1.5);
+    vars.set("b", 4.0);
+    vars.bind("x");
+    auto ast = parse_with("sin(x) * (exp(a) + sqrt(b))", vars);
+
+    SweepReport report;
+    collect(Sweep(*ast, "x"), 0.0, 1.0, 0.5, vars, &report);
+    EXPECT_EQ(report.nodes, 8u);
+    EXPECT_EQ(report.dependentNodes, 3u);   // *, sin, x
+    EXPECT_EQ(report.hoistedSubtrees, 1u);
+    EXPECT_EQ(report.hoistedNodes, 5u);     // +, exp, a, sqrt, b
+    EXPECT_EQ(report.points, 3u);
+    EXPECT_EQ(report.errors, 0u);
+
+    // Значения вынесенных поддеревьев берутся при каждом запуске заново
+    Sweep sweep(*ast, "x");
+    auto before = collect(sweep, 1.0, 1.0, 1.0, vars);
+    vars.set("b", 9.0);
+    auto after = collect(sweep, 1.0, 1.0, 1.0, vars);
+    EXPECT_NE(before[0].outcome, after[0].outcome);
+}
+
+TEST(SweepTest, UncompilableFallsBackToTree) {
+    // sum/integrate/solve не компилируются: ось вычисляется деревом
+    for (const char* expr : {"sum(i, 1, 100, i * x) + a", "integrate(t * x, t, 0, 1)",
+                             "solve(t^2 - x, t, 0, 2)", "prod(i, 1, 3, 1 / (i - x))"}) {
+        Variables vars;
+        vars.set("a", 0.5);
+        double* x = vars.bind("x");
+        *x = 7.0;
+        auto ast = parse_with(expr, vars);
+
+        SweepReport report;
+        auto points = collect(Sweep(*ast, "x"), 0.0, 3.0, 0.25, vars, &report);
+        ASSERT_EQ(points.size(), 13u) << expr;
+        EXPECT_EQ(report.hoistedSubtrees, 0u) << expr;
+        EXPECT_EQ(*x, 7.0) << expr;     // Ячейка восстановлена
+
+        size_t errors = 0;
+        for (const auto& point : points) {
+            *x = point.x;
+            std::string expected;
+            try {
+                expected = format(ast->evaluate());
+            } catch (const EvalError& e) {
+                expected = std::string("error: ") + e.what();
+                ++errors;
+            }
+            EXPECT_EQ(point.outcome, expected) << expr << " at x = " << point.x;
+        }
+        EXPECT_EQ(report.errors, errors) << expr;
+    }
+}
+
+TEST(SweepTest, RangesAndStreaming) {
+    Variables vars;
+    vars.bind("x");
+    auto ast = parse_with("x * 2", vars);
+    Sweep sweep(*ast, "x");
+
+    // Шаг 0.1 не представим точно, но stop включается
+    EXPECT_EQ(collect(sweep, 0.0, 1.0, 0.1, vars).size(), 11u);
+
+    auto descending = collect(sweep, 1.0, 0.0, -0.5, vars);
+    ASSERT_EQ(descending.size(), 3u);
+    EXPECT_EQ(descending[2].x, 0.0);
+
+    // Несколько блоков: порядок точек сохраняется
+    SweepReport report;
+    auto many = collect(sweep, 0.0, 2500.0, 1.0, vars, &report);
+    ASSERT_EQ(many.size(), 2501u);
+    EXPECT_EQ(report.points, 2501u);
+    for (size_t k = 0; k < many.size(); ++k) {
+        ASSERT_EQ(many[k].x, static_cast<double>(k));
+        ASSERT_EQ(many[k].outcome, format(2.0 * static_cast<double>(k)));
+    }
+
+    auto ignore = [](double, double, const std::string*) {};
+    EXPECT_THROW(sweep.run(0.0, 1.0, 0.0, vars, ignore), EvalError);
+    EXPECT_THROW(sweep.run(0.0, 1.0, -0.5, vars, ignore), EvalError);
+    EXPECT_THROW(sweep.run(0.0, 1e300, 1e-300, vars, ignore), EvalError);
+}
@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+#include "vecmath.hpp"
+
+using namespace calc;
+using vecmath::Accuracy;
+
+namespace {
+
+struct Case {
+    const char* name;
+    Function function;
+    long double (*reference)(long double);
+    double lo;
+    double hi;
+};
+
+const Case CASES[] = {
+    {"sin", Function::Sin, sinl, -1e5, 1e5},
+    {"sin_small", Function::Sin, sinl, -4.0, 4.0},
+    {"cos", Function::Cos, cosl, -1e5, 1e5},
+    {"cos_small", Function::Cos, cosl, -4.0, 4.0},
+    {"tan", Function::Tan, tanl, -100.0, 100.0},
+    {"exp", Function::Exp, expl, -745.0, 709.0},
+    {"exp_small", Function::Exp, expl, -2.0, 2.0},
+    {"log", Function::Log, logl, 1e-300, 1e300},
+    {"log_near_one", Function::Log, logl, 0.5, 2.0},
+    {"log10", Function::Log10, log10l, 1e-300, 1e300},
+    {"log10_near_one", Function::Log10, log10l, 0.5, 2.0},
+    {"atan", Function::Atan, atanl, -10.0, 10.0},
+    {"asin", Function::Asin, asinl, -1.0, 1.0},
+    {"acos", Function::Acos, acosl, -1.0, 1.0},
+    {"sinh", Function::Sinh, sinhl, -700.0, 700.0},
+    {"sinh_small", Function::Sinh, sinhl, -3.0, 3.0},
+    {"cosh", Function::Cosh, coshl, -700.0, 700.0},
+    {"tanh", Function::Tanh, tanhl, -20.0, 20.0},
+    {"tanh_small", Function::Tanh, tanhl, -1.5, 1.5},
+    {"sqrt", Function::Sqrt, sqrtl, 0.0, 1e10},
+};
+
+// Аргументы: для широких положительных диапазонов — равномерно по показателю
+std::vector<double> arguments(const Case& c, size_t count) {
+    std::mt19937_64 rng(12345);
+    std::vector<double> x(count);
+    if (c.lo > 0.0 && c.hi / c.lo > 1e6) {
+        std::uniform_real_distribution<double> exponent(std::log2(c.lo), std::log2(c.hi));
+        for (auto& v : x) {
+            v = std::exp2(exponent(rng));
+        }
+    } else {
+        std::uniform_real_distribution<double> uniform(c.lo, c.hi);
+        for (auto& v : x) {
+            v = uniform(rng);
+        }
+    }
+    return x;
+}
+
+// Ошибка в ULP относительно эталона повышенной точности
+double ulpError(double value, long double exact) {
+    double rounded = static_cast<double>(exact);
+    if (value == rounded) {
+        return 0.0;
+    }
+    int exponent;
+    std::frexp(rounded, &exponent);
+    long double ulp = std::ldexp(1.0L, std::max(exponent, DBL_MIN_EXP) - DBL_MANT_DIG);
+    return static_cast<double>(std::fabs(static_cast<long double>(value) - exact) / ulp);
+}
+
+double maxUlpError(const Case& c, Accuracy accuracy) {
+    auto x = arguments(c, 20000);
+    std::vector<double> y(x.size());
+    vecmath::evaluate(c.function, x.data(), y.data(), x.size(), accuracy);
+    double worst = 0.0;
+    for (size_t i = 0; i < x.size(); ++i) {
+        worst = std::max(worst, ulpError(y[i], c.reference(x[i])));
+    }
+    return worst;
+}
+
+bool sameBits(double a, double b) {
+    return std::memcmp(&a, &b, sizeof(double)) == 0;
+}
+
+} // namespace
+
+TEST(VecMathTest, LibmTierWithinThreeUlp) {
+    // Уровень Libm не округляет правильно; у glibc tanh на тестовых
+    // аргументах доходит до 2.03 ULP
+    if (LDBL_MANT_DIG <= DBL_MANT_DIG) {
+        GTEST_SKIP() << "long double has no extra precision for reference values";
+    }
+    for (const auto& c : CASES) {
+        EXPECT_LE(maxUlpError(c, Accuracy::Libm), 3.0) << c.name;
+    }
+}
+
+TEST(VecMathTest, UlpBounds) {
+    if (LDBL_MANT_DIG <= DBL_MANT_DIG) {
+        GTEST_SKIP() << "long double has no extra precision for reference values";
+    }
+    for (const auto& c : CASES) {
+        if (vecmath::hasKernel(c.function, Accuracy::Ulp1)) {
+            EXPECT_LE(maxUlpError(c, Accuracy::Ulp1), 1.0) << c.name;
+        }
+        if (vecmath::hasKernel(c.function, Accuracy::Ulp4)) {
+            EXPECT_LE(maxUlpError(c, Accuracy::Ulp4), 4.0) << c.name;
+        }
+    }
+}
+
+TEST(VecMathTest, SpecialValues) {
+    const double inf = std::numeric_limits<double>::infinity();
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    const double xs[] = {0.0, -0.0, 1.0, -1.0, inf, -inf, nan, 5e-324, 1e-310, -1e-310,
+                         709.78, 709.79, -745.1, -745.2, 1e300, -1e300, 1e6, 1e-20};
+    const Function functions[] = {Function::Exp, Function::Log, Function::Log10, Function::Sin,
+                                  Function::Cos, Function::Tan, Function::Atan, Function::Asin,
+                                  Function::Acos, Function::Sinh, Function::Cosh, Function::Tanh};
+    for (Function f : functions) {
+        for (double x : xs) {
+            double expected;
+            vecmath::evaluate(f, &x, &expected, 1, Accuracy::Libm);
+            for (Accuracy accuracy : {Accuracy::Ulp1, Accuracy::Ulp4}) {
+                double y;
+                vecmath::evaluate(f, &x, &y, 1, accuracy);
+                if (std::isnan(expected) || std::isinf(expected) || expected == 0.0) {
+                    EXPECT_TRUE(sameBits(y, expected) || (std::isnan(y) && std::isnan(expected)))
+                        << static_cast<int>(f) << "(" << x << ") = " << y << ", expected " << expected;
+                } else {
+                    EXPECT_NEAR(y, expected, std::abs(expected) * 4 * DBL_EPSILON)
+                        << static_cast<int>(f) << "(" << x << ")";
+                }
+            }
+        }
+    }
+}
+
+TEST(VecMathTest, InPlaceAndTail) {
+    // Длина не кратна LANES; большие аргументы sin идут через libm
+    std::vector<double> x = {0.5, 1.5, 1e7, -2.5, 3e9, 0.25, 7.0};
+    std::vector<double> y = x;
+    vecmath::evaluate(Function::Sin, y.data(), y.data(), y.size(), Accuracy::Ulp1);
+    for (size_t i = 0; i < x.size(); ++i) {
+        EXPECT_NEAR(y[i], std::sin(x[i]), 2 * DBL_EPSILON) << x[i];
+    }
+    y = x;
+    vecmath::evaluate(Function::Log, y.data(), y.data(), y.size(), Accuracy::Ulp4);
+    for (size_t i = 0; i < x.size(); ++i) {
+        EXPECT_TRUE(std::isnan(y[i]) == std::isnan(std::log(x[i]))) << x[i];
+        if (!std::isnan(y[i])) {
+            EXPECT_NEAR(y[i], std::log(x[i]), std::abs(std::log(x[i])) * 2 * DBL_EPSILON) << x[i];
+        }
+    }
+}
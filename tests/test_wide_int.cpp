@@ -0,0 +1,200 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include "wide_int.hpp"
+#include "programmer.hpp"
+#include "error.hpp"
+
+using namespace calc;
+
+namespace {
+
+// Случайный битовый образ во все слова, затем сдвиг: значения разной длины
+WideInt randomWide(std::mt19937_64& random, unsigned bits) {
+    std::string hex;
+    for (unsigned i = 0; i < (bits + 3) / 4; ++i) {
+        hex.push_back("0123456789ABCDEF"[random() % 16]);
+    }
+    return WideInt::parse(hex, 16, bits).shiftRightArithmetic(random() % bits);
+}
+
+WideInt evaluate(const std::string& expression, int radix, unsigned bits) {
+    return evaluateInteger(expression, radix, bits);
+}
+
+} // namespace
+
+TEST(WideIntTest, WrapsInEveryWordSize) {
+    for (unsigned bits : {1u, 7u, 8u, 16u, 32u, 63u, 64u, 65u, 127u, 128u, 129u, 256u, 4096u}) {
+        WideInt max = ~WideInt(bits);
+        EXPECT_EQ(max, WideInt::fromInt64(-1, bits)) << bits;
+        EXPECT_TRUE((max + WideInt::fromInt64(1, bits)).isZero()) << bits;
+        EXPECT_EQ(WideInt(bits) - WideInt::fromInt64(1, bits), max) << bits;
+        EXPECT_EQ(-max, WideInt::fromInt64(1, bits)) << bits;
+        EXPECT_EQ(max.toString(10, true), "-1") << bits;
+        // MIN = 100…0; −MIN и MIN / −1 заворачиваются в MIN
+        WideInt min = WideInt::fromInt64(1, bits).shiftLeft(bits - 1);
+        EXPECT_TRUE(min.isNegative()) << bits;
+        EXPECT_EQ(-min, min) << bits;
+        if (bits > 1) {
+            WideInt quotient(bits), remainder(bits);
+            WideInt::divide(min, max, quotient, remainder);
+            EXPECT_EQ(quotient, min) << bits;
+            EXPECT_TRUE(remainder.isZero()) << bits;
+        }
+    }
+    EXPECT_EQ(WideInt::fromInt64(300, 8).toInt64(), 44);
+    EXPECT_EQ(WideInt::fromInt64(200, 8).toInt64(), -56);
+    EXPECT_THROW(WideInt(0), std::invalid_argument);
+    EXPECT_THROW(WideInt(WIDE_INT_MAX_BITS + 1), std::invalid_argument);
+    EXPECT_THROW(WideInt(8) + WideInt(16), std::invalid_argument);
+}
+
+TEST(WideIntTest, MultiLimbMatchesNativeLowWords) {
+    // Усечение до 64 бит перестановочно с +, −, *, битовыми операциями и
+    // сдвигом влево: младшее слово широкого результата сверяется с uint64_t
+    std::mt19937_64 random(11);
+    for (unsigned bits : {192u, 256u, 4096u}) {
+        for (int i = 0; i < 300; ++i) {
+            WideInt a = randomWide(random, bits);
+            WideInt b = randomWide(random, bits);
+            uint64_t x = a.limb(0), y = b.limb(0);
+            unsigned shift = static_cast<unsigned>(random() % 64);
+            ASSERT_EQ((a + b).limb(0), x + y);
+            ASSERT_EQ((a - b).limb(0), x - y);
+            ASSERT_EQ((a * b).limb(0), x * y);
+            ASSERT_EQ((a & b).limb(0), (x & y));
+            ASSERT_EQ((a | b).limb(0), (x | y));
+            ASSERT_EQ((a ^ b).limb(0), (x ^ y));
+            ASSERT_EQ((~a).limb(0), ~x);
+            ASSERT_EQ(a.shiftLeft(shift).limb(0), x << shift);
+
+            // Деление проверяется обратно: q * b + r == a, |r| < |b|
+            if (b.isZero()) {
+                continue;
+            }
+            WideInt quotient(bits), remainder(bits);
+            WideInt::divide(a, b, quotient, remainder);
+            ASSERT_EQ(quotient * b + remainder, a);
+            ASSERT_TRUE(remainder.isZero() || remainder.isNegative() == a.isNegative());
+        }
+    }
+}
+
+#ifdef __SIZEOF_INT128__
+TEST(WideIntTest, MatchesNativeInt128) {
+    // 128 бит идут быстрым путём, 192 — циклами по словам; оба сверяются с __int128
+    __extension__ typedef unsigned __int128 u128;
+    __extension__ typedef __int128 i128;
+    std::mt19937_64 random(5);
+    auto native = [](const WideInt& value) {
+        return (static_cast<u128>(value.limb(1)) << 64) | value.limb(0);
+    };
+    for (int i = 0; i < 2000; ++i) {
+        WideInt a = randomWide(random, 128);
+        WideInt b = randomWide(random, 128);
+        u128 x = native(a), y = native(b);
+        unsigned shift = static_cast<unsigned>(random() % 128);
+        for (unsigned bits : {128u, 192u}) {
+            WideInt wa = a.resized(bits), wb = b.resized(bits);
+            ASSERT_EQ(native((wa + wb).resized(128)), x + y);
+            ASSERT_EQ(native((wa - wb).resized(128)), x - y);
+            ASSERT_EQ(native((wa * wb).resized(128)), x * y);
+            ASSERT_EQ(native((wa ^ wb).resized(128)), x ^ y);
+            ASSERT_EQ(native(wa.shiftLeft(shift).resized(128)), x << shift);
+            ASSERT_EQ(native(wa.shiftRightArithmetic(shift).resized(128)),
+                      static_cast<u128>(static_cast<i128>(x) >> shift));
+            if (y != 0 && !(a.isNegative() && y == ~u128{0})) {
+                WideInt quotient(bits), remainder(bits);
+                WideInt::divide(wa, wb, quotient, remainder);
+                ASSERT_EQ(native(quotient.resized(128)),
+                          static_cast<u128>(static_cast<i128>(x) / static_cast<i128>(y)));
+                ASSERT_EQ(native(remainder.resized(128)),
+                          static_cast<u128>(static_cast<i128>(x) % static_cast<i128>(y)));
+            }
+        }
+        ASSERT_EQ(native(a.shiftRightLogical(shift)), x >> shift);
+        ASSERT_EQ(native(a.rotateLeft(shift)), shift == 0 ? x : (x << shift) | (x >> (128 - shift)));
+    }
+}
+#endif
+
+TEST(WideIntTest, ShiftsAndRotatesAcrossWords) {
+    WideInt one = WideInt::fromInt64(1, 4096);
+    WideInt top = one.shiftLeft(4095);
+    EXPECT_TRUE(top.isNegative());
+    EXPECT_EQ(top.shiftRightArithmetic(4095), WideInt::fromInt64(-1, 4096));
+    EXPECT_EQ(top.shiftRightLogical(4095), one);
+    EXPECT_TRUE(one.shiftLeft(4096).isZero());
+    EXPECT_TRUE(one.shiftLeft(UINT64_MAX).isZero());
+    EXPECT_EQ(top.shiftRightArithmetic(UINT64_MAX), WideInt::fromInt64(-1, 4096));
+    EXPECT_EQ(top.rotateLeft(1), one);
+    EXPECT_EQ(one.rotateRight(1), top);
+    EXPECT_EQ(one.rotateLeft(4096 + 70), one.shiftLeft(70));
+
+    // Узкие и нечётные разрядности
+    EXPECT_EQ(WideInt::fromInt64(0x81, 8).rotateLeft(1), WideInt::fromInt64(0x03, 8));
+    EXPECT_EQ(WideInt::fromInt64(1, 100).rotateRight(1).toString(16, false), "8" + std::string(24, '0'));
+    EXPECT_EQ(WideInt::fromInt64(-8, 12).shiftRightArithmetic(2).toInt64(), -2);
+}
+
+TEST(WideIntTest, FormatsAndParsesEveryBase) {
+    WideInt power = WideInt::fromInt64(1, 256).shiftLeft(128);
+    EXPECT_EQ(power.toString(10, true), "340282366920938463463374607431768211456");
+    EXPECT_EQ(power.toString(16, false), "1" + std::string(32, '0'));
+    EXPECT_EQ(WideInt::fromInt64(-1, 256).toString(16, false), std::string(64, 'F'));
+    EXPECT_EQ(WideInt::fromInt64(-1, 10).toString(8, false), "1777");
+    EXPECT_EQ(WideInt::fromInt64(-255, 64).toString(16, true), "-FF");
+    EXPECT_EQ(WideInt(4096).toString(2, false), "0");
+
+    // Ввод длиннее разрядности заворачивается
+    EXPECT_EQ(WideInt::parse("FF", 16, 8).toInt64(), -1);
+    EXPECT_EQ(WideInt::parse("1FF", 16, 8).toInt64(), -1);
+    EXPECT_EQ(WideInt::parse(" -1 ", 10, 256), WideInt::fromInt64(-1, 256));
+    EXPECT_EQ(WideInt::parse("340282366920938463463374607431768211456", 10, 256), power);
+    EXPECT_THROW(WideInt::parse("", 10, 64), std::invalid_argument);
+    EXPECT_THROW(WideInt::parse("12", 2, 64), std::invalid_argument);
+    EXPECT_THROW(WideInt::parse("G" + std::string(40, '0'), 16, 64), std::invalid_argument);
+
+    std::mt19937_64 random(3);
+    for (unsigned bits : {5u, 64u, 128u, 320u, 4096u}) {
+        for (int i = 0; i < 20; ++i) {
+            WideInt value = randomWide(random, bits);
+            for (int radix = 2; radix <= 36; ++radix) {
+                ASSERT_EQ(WideInt::parse(value.toString(radix, false), radix, bits), value) << radix;
+                ASSERT_EQ(WideInt::parse(value.toString(radix, true), radix, bits), value) << radix;
+            }
+        }
+    }
+}
+
+TEST(WideIntTest, EvaluatesProgrammerExpressions) {
+    EXPECT_EQ(evaluate("FF + 1", 16, 8).toInt64(), 0);
+    EXPECT_EQ(evaluate("7F + 1", 16, 8).toInt64(), -128);
+    EXPECT_EQ(evaluate("1 << 100", 10, 128).toString(16, false), "1" + std::string(25, '0'));
+    EXPECT_EQ(evaluate("1 << 128", 10, 128).toInt64(), 0);
+    EXPECT_EQ(evaluate("-16 >> 2", 10, 256).toInt64(), -4);
+    EXPECT_EQ(evaluate("1 ROR 1", 10, 256).toString(16, false), "8" + std::string(63, '0'));
+    EXPECT_EQ(evaluate("80 ROL 1", 16, 8).toInt64(), 1);
+    EXPECT_EQ(evaluate("NOT 0 AND F0 | 1", 16, 8).toString(16, false), "F1");
+    EXPECT_EQ(evaluate("~0 XOR 1010", 2, 4).toString(2, false), "101");
+    EXPECT_EQ(evaluate("2 ^ 255 - 1", 10, 256).toString(16, false), "7" + std::string(63, 'F'));
+    EXPECT_EQ(evaluate("2 ** 64", 10, 64).toInt64(), 0);
+    EXPECT_EQ(evaluate("3 ^ 0", 10, 8).toInt64(), 1);
+    EXPECT_EQ(evaluate("-7 / 2", 10, 32).toInt64(), -3);
+    EXPECT_EQ(evaluate("-7 % 2", 10, 32).toInt64(), -1);
+    EXPECT_EQ(evaluate("(1 + 2) * 3", 10, 64).toInt64(), 9);
+
+    EXPECT_THROW(evaluate("1 / 0", 10, 64), EvalError);
+    EXPECT_THROW(evaluate("1 % 0", 10, 64), EvalError);
+    EXPECT_THROW(evaluate("1 << -1", 10, 64), EvalError);
+    EXPECT_THROW(evaluate("2 ^ -1", 10, 64), EvalError);
+    EXPECT_THROW(evaluate("12", 2, 64), ParseError);
+    EXPECT_THROW(evaluate("1 +", 10, 64), ParseError);
+    EXPECT_THROW(evaluate("(1", 10, 64), ParseError);
+    EXPECT_THROW(evaluate("1.5", 10, 64), ParseError);
+    EXPECT_THROW(evaluate("1 < 2", 10, 64), ParseError);
+    EXPECT_THROW(evaluate(std::string(300, '(') + "1" + std::string(300, ')'), 10, 64), ParseError);
+    EXPECT_THROW(evaluate("1", 10, 0), std::invalid_argument);
+}